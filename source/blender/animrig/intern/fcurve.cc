@@ -104,6 +104,8 @@ int insert_bezt_fcurve(FCurve *fcu, const BezTriple *bezt, eInsertKeyFlags flag)
             replace_bezt_keyframe_ypos(&fcu->bezt[i == 0 ? fcu->totvert - 1 : 0], bezt);
           }
         }
+        /* The key is changed in place, handles may not be recalculated with #INSERTKEY_FAST. */
+        BKE_fcurve_tag_keys_changed(fcu);
       }
     }
     /* Keyframing modes allow not replacing the keyframe. */
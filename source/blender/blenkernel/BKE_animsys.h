@@ -360,6 +360,11 @@ void BKE_animsys_eval_driver(struct Depsgraph *depsgraph,
 
 void BKE_animsys_update_driver_array(struct ID *id);
 
+/**
+ * Free the cached paths of the active action, see #AnimData.eval_plan.
+ */
+void BKE_animsys_eval_plan_free(struct AnimData *adt);
+
 /* ************************************* */
 
 #ifdef __cplusplus
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "BLI_array.hh"
 #include "BLI_fileops.hh"
 #include "BLI_serialize.hh"
 
@@ -35,11 +36,27 @@ class BlobReader {
   [[nodiscard]] virtual bool read(const BlobSlice &slice, void *r_data) const = 0;
 };
 
+/**
+ * Optional encodings that are applied to blobs when they are written. The encoding is stored
+ * with the blob, so bakes are always read back correctly independent of these settings.
+ */
+struct BlobWriteSettings {
+  /** Compress larger blobs with zstd. Arrays of multi-byte values are byte-shuffled first. */
+  bool use_compression = false;
+  /**
+   * Store positions as difference to the positions written for the previous frame. This only
+   * has an effect when the same #BlobSharing is used for all frames.
+   */
+  bool use_delta_positions = false;
+};
+
 /**
  * Abstract base class for writing binary data.
  */
 class BlobWriter {
  public:
+  BlobWriteSettings settings;
+
   /**
    * Write the provided binary data.
    * \return Slice where the data has been written to.
@@ -52,6 +69,16 @@ class BlobWriter {
  * sharing.
  */
 class BlobSharing {
+ public:
+  struct DeltaBase {
+    /** Data that has been written for the previous frame. */
+    Array<char> data;
+    /** Identifier of the written data. */
+    std::shared_ptr<io::serialize::DictionaryValue> io_data;
+    /** Number of delta encoded blobs that have to be decoded before this one. */
+    int chain_length;
+  };
+
  private:
   struct StoredByRuntimeValue {
     /**
@@ -83,6 +110,20 @@ class BlobSharing {
    */
   mutable Map<std::string, ImplicitSharingInfoAndData> runtime_by_stored_;
 
+  /**
+   * The last data written for every delta encoded array, by a key that identifies the array
+   * between frames.
+   */
+  Map<std::string, DeltaBase> delta_base_by_key_;
+
+  /**
+   * Recently decoded delta encoded data. When reading consecutive frames, this avoids decoding
+   * the whole chain of previous frames again. Uses its own mutex because it is accessed while
+   * #mutex_ is locked.
+   */
+  mutable std::mutex decoded_delta_mutex_;
+  mutable Map<std::string, Array<char>> decoded_delta_by_stored_;
+
  public:
   ~BlobSharing();
 
@@ -103,6 +144,26 @@ class BlobSharing {
   [[nodiscard]] std::optional<ImplicitSharingInfoAndData> read_shared(
       const io::serialize::DictionaryValue &io_data,
       FunctionRef<std::optional<ImplicitSharingInfoAndData>()> read_fn) const;
+
+  /**
+   * Find the data last written for the array identified by `key`, if it can be used as base for
+   * delta encoding the next frame.
+   */
+  [[nodiscard]] const DeltaBase *lookup_delta_base(StringRef key) const;
+
+  /** Remember the data that has just been written for the array identified by `key`. */
+  void store_delta_base(std::string key,
+                        Span<char> data,
+                        std::shared_ptr<io::serialize::DictionaryValue> io_data,
+                        int chain_length);
+
+  /**
+   * Get the decoded data of a delta encoded blob identified by `io_data`, either from a
+   * previous call or by calling `read_fn`.
+   */
+  [[nodiscard]] bool read_delta_decoded(const io::serialize::DictionaryValue &io_data,
+                                        MutableSpan<char> r_data,
+                                        FunctionRef<bool(MutableSpan<char>)> read_fn) const;
 };
 
 /**
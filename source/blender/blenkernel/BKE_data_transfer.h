@@ -14,6 +14,7 @@
 extern "C" {
 #endif
 
+struct DataTransferCache;
 struct Depsgraph;
 struct Object;
 struct ReportList;
@@ -168,6 +169,9 @@ bool BKE_object_data_transfer_mesh(struct Depsgraph *depsgraph,
                                    const char *vgroup_name,
                                    bool invert_vgroup,
                                    struct ReportList *reports);
+/**
+ * \param cache: Optional, geometry mappings are reused from it when possible, and stored in it.
+ */
 bool BKE_object_data_transfer_ex(struct Depsgraph *depsgraph,
                                  struct Object *ob_src,
                                  struct Object *ob_dst,
@@ -189,8 +193,17 @@ bool BKE_object_data_transfer_ex(struct Depsgraph *depsgraph,
                                  float mix_factor,
                                  const char *vgroup_name,
                                  bool invert_vgroup,
+                                 struct DataTransferCache *cache,
                                  struct ReportList *reports);
 
+/**
+ * Geometry mappings computed by #BKE_object_data_transfer_ex, kept to be reused by later calls as
+ * long as the mapping settings and the mesh arrays they depend on do not change. Arrays are
+ * identified by their implicit sharing info, topology mappings only by the element counts.
+ */
+struct DataTransferCache *BKE_data_transfer_cache_new(void);
+void BKE_data_transfer_cache_free(struct DataTransferCache *cache);
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,6 +9,7 @@
  */
 
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 #include "DNA_curve_types.h"
 
 #ifdef __cplusplus
@@ -564,6 +565,17 @@ void BKE_fcurve_handles_recalc(struct FCurve *fcu);
  * (if caller does not operate on selection).
  */
 void BKE_fcurve_handles_recalc_ex(struct FCurve *fcu, eBezTriple_Flag handle_sel_flag);
+/**
+ * Tag the cached segments used for batch evaluation as outdated when the keyframes changed in
+ * place. This is done by #BKE_fcurve_handles_recalc already. Reallocating the keyframes is
+ * detected without tagging.
+ */
+void BKE_fcurve_tag_keys_changed(struct FCurve *fcu);
+/**
+ * Same as #BKE_fcurve_tag_keys_changed for all F-Curves, when keyframes were edited in place
+ * without knowing their F-Curve (e.g. by the RNA properties of keyframes).
+ */
+void BKE_fcurves_tag_keys_changed_all(void);
 /**
  * Update handles, making sure the handle-types are valid (e.g. correctly deduced from an "Auto"
  * type), and recalculating their position vectors.
@@ -663,3 +675,19 @@ void BKE_fcurve_blend_read_data(struct BlendDataReader *reader, struct ListBase
 #ifdef __cplusplus
 }
 #endif
+
+namespace blender::bke {
+
+/**
+ * Evaluate the F-Curve at many times, with the same result as #evaluate_fcurve_only_curve.
+ * The coefficients of the Bezier segments are computed once and cached on the F-Curve, which
+ * makes this much faster for curves with many keyframes. Sorted times are fastest.
+ */
+void evaluate_fcurve_times(FCurve &fcu, Span<float> times, MutableSpan<float> r_values);
+
+/**
+ * Evaluate many F-Curves at the same time, see #evaluate_fcurve_times.
+ */
+void evaluate_fcurves(Span<FCurve *> fcurves, float evaltime, MutableSpan<float> r_values);
+
+}  // namespace blender::bke
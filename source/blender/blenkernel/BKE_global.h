@@ -40,6 +40,8 @@ typedef struct Global {
   char filepath_last_image[/*FILE_MAX*/ 1024];
   /** Last used location for library link/append. */
   char filepath_last_library[/*FILE_MAX*/ 1024];
+  /** Directory to write geometry nodes profiling traces to, disabled when empty. */
+  char geometry_nodes_profile_dir[/*FILE_MAX*/ 1024];
 
   /**
    * Strings of recently opened files to show in the file menu.
@@ -173,6 +175,11 @@ enum {
   /** Support simulating events (for testing). */
   G_FLAG_EVENT_SIMULATE = (1 << 3),
   G_FLAG_USERPREF_NO_SAVE_ON_EXIT = (1 << 4),
+  /**
+   * Reference large data arrays of uncompressed blend-files directly in the memory-mapped file
+   * instead of copying them, see #BLO_read_data_address_shared.
+   */
+  G_FLAG_READFILE_MMAP_SHARING = (1 << 5),
 
   G_FLAG_SCRIPT_AUTOEXEC = (1 << 13),
   /** When this flag is set ignore the preferences #USER_SCRIPT_AUTOEXEC_DISABLE. */
@@ -184,7 +191,7 @@ enum {
 /** Don't overwrite these flags when reading a file. */
 #define G_FLAG_ALL_RUNTIME \
   (G_FLAG_SCRIPT_AUTOEXEC | G_FLAG_SCRIPT_OVERRIDE_PREF | G_FLAG_EVENT_SIMULATE | \
-   G_FLAG_USERPREF_NO_SAVE_ON_EXIT | \
+   G_FLAG_USERPREF_NO_SAVE_ON_EXIT | G_FLAG_READFILE_MMAP_SHARING | \
 \
    /* #BPY_python_reset is responsible for resetting these flags on file load. */ \
    G_FLAG_SCRIPT_AUTOEXEC_FAIL | G_FLAG_SCRIPT_AUTOEXEC_FAIL_QUIET)
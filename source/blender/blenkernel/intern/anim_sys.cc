@@ -11,6 +11,7 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <string>
 
 #include "MEM_guardedalloc.h"
 
@@ -21,7 +22,9 @@
 #include "BLI_math_rotation.h"
 #include "BLI_math_vector.h"
 #include "BLI_string_utils.hh"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BLT_translation.h"
 
@@ -873,6 +876,131 @@ void animsys_evaluate_action(PointerRNA *ptr,
   animsys_evaluate_fcurves(ptr, &act->curves, anim_eval_context, flush_to_original);
 }
 
+/* ----------------------------------------- */
+
+namespace blender::bke {
+
+/**
+ * Cached RNA path resolution of the F-Curves in the active action of an evaluated data-block.
+ * Resolving paths is a large part of the cost of animation evaluation when many channels are
+ * animated, but the resolved pointers only change when the data-block is copied again by the
+ * depsgraph, which frees the #AnimData and with it the plan.
+ */
+struct AnimationEvalPlan {
+  struct Channel {
+    /** The path of the F-Curve at the time it was resolved, to detect changes in the action. */
+    std::string rna_path;
+    int array_index = -1;
+    /**
+     * Only paths that stay inside the animated data-block are cached, pointers into other
+     * data-blocks can become invalid without this data-block being copied again.
+     */
+    bool is_cached = false;
+    bool is_resolved = false;
+    PathResolvedRNA anim_rna;
+  };
+
+  struct EvalItem {
+    FCurve *fcu;
+    Channel *channel;
+    float value;
+  };
+
+  /** Matches the order of the F-Curves in the action. */
+  Vector<Channel> channels;
+  /** Reused between evaluations to avoid allocations. */
+  Vector<EvalItem> items;
+};
+
+}  // namespace blender::bke
+
+using blender::bke::AnimationEvalPlan;
+
+static bool eval_plan_channel_matches(const AnimationEvalPlan::Channel &channel,
+                                      const FCurve *fcu)
+{
+  return channel.is_cached && channel.array_index == fcu->array_index &&
+         channel.rna_path == fcu->rna_path;
+}
+
+static void eval_plan_channel_resolve(PointerRNA *ptr,
+                                      AnimationEvalPlan::Channel &channel,
+                                      const FCurve *fcu)
+{
+  channel.rna_path = fcu->rna_path;
+  channel.array_index = fcu->array_index;
+  channel.is_resolved = BKE_animsys_rna_path_resolve(
+      ptr, fcu->rna_path, fcu->array_index, &channel.anim_rna);
+  channel.is_cached = channel.is_resolved && channel.anim_rna.ptr.owner_id == ptr->owner_id;
+}
+
+/**
+ * Same as #animsys_evaluate_action, but reuses the resolved paths from the previous evaluation
+ * and evaluates the F-Curves on multiple threads. Only the evaluation of the curves is
+ * multi-threaded, writing the values through RNA may have side effects and is done in order.
+ */
+static void animsys_evaluate_action_plan(PointerRNA *ptr,
+                                         AnimData *adt,
+                                         const AnimationEvalContext *anim_eval_context,
+                                         const bool flush_to_original)
+{
+  using namespace blender;
+  bAction *act = adt->action;
+  action_idcode_patch_check(ptr->owner_id, act);
+
+  if (adt->eval_plan == nullptr) {
+    adt->eval_plan = MEM_new<AnimationEvalPlan>(__func__);
+  }
+  AnimationEvalPlan &plan = *adt->eval_plan;
+
+  /* The action has been changed, resolve all paths again. */
+  if (act->id.recalc != 0) {
+    plan.channels.clear();
+  }
+  plan.channels.resize(BLI_listbase_count(&act->curves));
+
+  plan.items.clear();
+  int channel_index = 0;
+  LISTBASE_FOREACH_INDEX (FCurve *, fcu, &act->curves, channel_index) {
+    AnimationEvalPlan::Channel &channel = plan.channels[channel_index];
+    if (!is_fcurve_evaluatable(fcu) || fcu->rna_path == nullptr) {
+      continue;
+    }
+    if (!eval_plan_channel_matches(channel, fcu)) {
+      eval_plan_channel_resolve(ptr, channel, fcu);
+    }
+    if (channel.is_resolved) {
+      plan.items.append({fcu, &channel, 0.0f});
+    }
+  }
+
+  /* Drivers on action F-Curves are evaluated in order below, because they can depend on
+   * properties written by previous curves. */
+  threading::parallel_for(plan.items.index_range(), 256, [&](const IndexRange range) {
+    for (AnimationEvalPlan::EvalItem &item : plan.items.as_mutable_span().slice(range)) {
+      if (item.fcu->driver == nullptr) {
+        item.value = calculate_fcurve(&item.channel->anim_rna, item.fcu, anim_eval_context);
+      }
+    }
+  });
+
+  for (AnimationEvalPlan::EvalItem &item : plan.items) {
+    if (item.fcu->driver != nullptr) {
+      item.value = calculate_fcurve(&item.channel->anim_rna, item.fcu, anim_eval_context);
+    }
+    BKE_animsys_write_to_rna_path(&item.channel->anim_rna, item.value);
+    if (flush_to_original) {
+      animsys_write_orig_anim_rna(ptr, item.fcu->rna_path, item.fcu->array_index, item.value);
+    }
+  }
+}
+
+void BKE_animsys_eval_plan_free(AnimData *adt)
+{
+  MEM_delete(adt->eval_plan);
+  adt->eval_plan = nullptr;
+}
+
 void animsys_blend_in_action(PointerRNA *ptr,
                              bAction *act,
                              const AnimationEvalContext *anim_eval_context,
@@ -3927,7 +4055,14 @@ void BKE_animsys_evaluate_animdata(ID *id,
     }
     /* evaluate Active Action only */
     else if (adt->action) {
-      animsys_evaluate_action(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      /* Only the depsgraph knows when the data of an evaluated data-block is reallocated, so the
+       * resolved paths can't be cached for original data-blocks. */
+      if (DEG_is_evaluated_id(id)) {
+        animsys_evaluate_action_plan(&id_ptr, adt, anim_eval_context, flush_to_original);
+      }
+      else {
+        animsys_evaluate_action(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      }
     }
   }
 
@@ -23,11 +23,29 @@
 
 #include <sstream>
 
+#include <zstd.h>
+
 namespace blender::bke::bake {
 
 using namespace io::serialize;
 using DictionaryValuePtr = std::shared_ptr<DictionaryValue>;
 
+/** Smaller blobs are not compressed, because the gain is not worth the overhead. */
+static constexpr int64_t blob_compression_min_size = 4096;
+static constexpr int blob_compression_level = 3;
+/** Write a full copy of delta encoded arrays regularly, to limit the cost of decoding. */
+static constexpr int blob_delta_max_chain_length = 8;
+/** Number of decoded delta encoded arrays that are kept to speed up decoding the next frame. */
+static constexpr int decoded_delta_max_num = 8;
+
+static std::string io_data_to_key(const DictionaryValue &io_data)
+{
+  io::serialize::JsonFormatter formatter;
+  std::stringstream ss;
+  formatter.serialize(ss, io_data);
+  return ss.str();
+}
+
 std::shared_ptr<DictionaryValue> BlobSlice::serialize() const
 {
   auto io_slice = std::make_shared<DictionaryValue>();
@@ -133,10 +151,7 @@ std::optional<ImplicitSharingInfoAndData> BlobSharing::read_shared(
 {
   std::lock_guard lock{mutex_};
 
-  io::serialize::JsonFormatter formatter;
-  std::stringstream ss;
-  formatter.serialize(ss, io_data);
-  const std::string key = ss.str();
+  const std::string key = io_data_to_key(io_data);
 
   if (const ImplicitSharingInfoAndData *shared_data = runtime_by_stored_.lookup_ptr(key)) {
     shared_data->sharing_info->add_user();
@@ -153,6 +168,51 @@ std::optional<ImplicitSharingInfoAndData> BlobSharing::read_shared(
   return data;
 }
 
+const BlobSharing::DeltaBase *BlobSharing::lookup_delta_base(const StringRef key) const
+{
+  const DeltaBase *delta_base = delta_base_by_key_.lookup_ptr_as(key);
+  if (delta_base == nullptr || delta_base->chain_length >= blob_delta_max_chain_length) {
+    return nullptr;
+  }
+  return delta_base;
+}
+
+void BlobSharing::store_delta_base(std::string key,
+                                   const Span<char> data,
+                                   DictionaryValuePtr io_data,
+                                   const int chain_length)
+{
+  delta_base_by_key_.add_overwrite(std::move(key),
+                                   DeltaBase{Array<char>(data), std::move(io_data), chain_length});
+}
+
+bool BlobSharing::read_delta_decoded(const DictionaryValue &io_data,
+                                     const MutableSpan<char> r_data,
+                                     const FunctionRef<bool(MutableSpan<char>)> read_fn) const
+{
+  const std::string key = io_data_to_key(io_data);
+  {
+    std::lock_guard lock{decoded_delta_mutex_};
+    if (const Array<char> *decoded = decoded_delta_by_stored_.lookup_ptr(key)) {
+      if (decoded->size() != r_data.size()) {
+        return false;
+      }
+      r_data.copy_from(*decoded);
+      return true;
+    }
+  }
+  if (!read_fn(r_data)) {
+    return false;
+  }
+  std::lock_guard lock{decoded_delta_mutex_};
+  /* Frames are generally read in order, so only the most recent ones are worth keeping. */
+  if (decoded_delta_by_stored_.size() >= decoded_delta_max_num) {
+    decoded_delta_by_stored_.clear();
+  }
+  decoded_delta_by_stored_.add_overwrite(key, Array<char>(r_data.as_span()));
+  return true;
+}
+
 static StringRefNull get_endian_io_name(const int endian)
 {
   if (endian == L_ENDIAN) {
@@ -194,13 +254,164 @@ static std::optional<eCustomDataType> get_data_type_from_io_name(const StringRef
   return eCustomDataType(domain);
 }
 
+/**
+ * Group the bytes by their position in the elements. The more significant bytes of similar
+ * numbers are often equal, which makes the data compress much better.
+ */
+static void shuffle_bytes(const Span<char> src, const int64_t element_size, MutableSpan<char> dst)
+{
+  const int64_t elements_num = src.size() / element_size;
+  for (const int64_t byte : IndexRange(element_size)) {
+    char *dst_bytes = dst.data() + byte * elements_num;
+    for (const int64_t i : IndexRange(elements_num)) {
+      dst_bytes[i] = src[i * element_size + byte];
+    }
+  }
+}
+
+static void unshuffle_bytes(const Span<char> src,
+                            const int64_t element_size,
+                            MutableSpan<char> dst)
+{
+  const int64_t elements_num = src.size() / element_size;
+  for (const int64_t byte : IndexRange(element_size)) {
+    const char *src_bytes = src.data() + byte * elements_num;
+    for (const int64_t i : IndexRange(elements_num)) {
+      dst[i * element_size + byte] = src_bytes[i];
+    }
+  }
+}
+
+static void xor_bytes(const Span<char> a, const Span<char> b, MutableSpan<char> dst)
+{
+  BLI_assert(a.size() == b.size() && a.size() == dst.size());
+  threading::parallel_for(dst.index_range(), 1 << 16, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      dst[i] = a[i] ^ b[i];
+    }
+  });
+}
+
+/**
+ * Write the bytes with the encoding enabled in the settings of the writer. The encoding is
+ * stored in the returned identifier so that #read_blob_decompressed can undo it.
+ * \param element_size: Size of the values in the data that byte shuffling groups bytes by.
+ */
+static DictionaryValuePtr write_blob_encoded(BlobWriter &blob_writer,
+                                             const Span<char> data,
+                                             const int64_t element_size)
+{
+  if (blob_writer.settings.use_compression && data.size() >= blob_compression_min_size) {
+    const bool use_shuffle = element_size > 1 && data.size() % element_size == 0;
+    Array<char> shuffled;
+    Span<char> src = data;
+    if (use_shuffle) {
+      shuffled.reinitialize(data.size());
+      shuffle_bytes(data, element_size, shuffled);
+      src = shuffled;
+    }
+    Array<char> compressed(ZSTD_compressBound(src.size()), NoInitialization());
+    const size_t compressed_size = ZSTD_compress(
+        compressed.data(), compressed.size(), src.data(), src.size(), blob_compression_level);
+    /* Store the data uncompressed when compression does not help. */
+    if (!ZSTD_isError(compressed_size) && int64_t(compressed_size) < data.size()) {
+      auto io_data = blob_writer.write(compressed.data(), compressed_size).serialize();
+      io_data->append_str("compression", "zstd");
+      io_data->append_int("uncompressed_size", data.size());
+      if (use_shuffle) {
+        io_data->append_int("shuffle", element_size);
+      }
+      return io_data;
+    }
+  }
+  return blob_writer.write(data.data(), data.size()).serialize();
+}
+
+/**
+ * Read the bytes of a blob written by #write_blob_encoded, the size of the decoded data has to
+ * match the size of `r_data`.
+ */
+[[nodiscard]] static bool read_blob_decompressed(const BlobReader &blob_reader,
+                                                 const DictionaryValue &io_data,
+                                                 const BlobSlice &slice,
+                                                 MutableSpan<char> r_data)
+{
+  const std::optional<StringRefNull> compression = io_data.lookup_str("compression");
+  if (!compression) {
+    if (slice.range.size() != r_data.size()) {
+      return false;
+    }
+    return blob_reader.read(slice, r_data.data());
+  }
+  if (*compression != "zstd") {
+    return false;
+  }
+  if (io_data.lookup_int("uncompressed_size") != r_data.size()) {
+    return false;
+  }
+  const int64_t shuffle = io_data.lookup_int("shuffle").value_or(1);
+  if (shuffle < 1 || r_data.size() % shuffle != 0) {
+    return false;
+  }
+
+  Array<char> compressed(slice.range.size(), NoInitialization());
+  if (!blob_reader.read(slice, compressed.data())) {
+    return false;
+  }
+  Array<char> shuffled;
+  MutableSpan<char> decompressed = r_data;
+  if (shuffle > 1) {
+    shuffled.reinitialize(r_data.size());
+    decompressed = shuffled;
+  }
+  const size_t decompressed_size = ZSTD_decompress(
+      decompressed.data(), decompressed.size(), compressed.data(), compressed.size());
+  if (ZSTD_isError(decompressed_size) || int64_t(decompressed_size) != r_data.size()) {
+    return false;
+  }
+  if (shuffle > 1) {
+    unshuffle_bytes(shuffled, shuffle, r_data);
+  }
+  return true;
+}
+
+/**
+ * Read the bytes of a blob, undoing all encodings that have been applied when writing it.
+ */
+[[nodiscard]] static bool read_blob_decoded(const BlobReader &blob_reader,
+                                            const BlobSharing &blob_sharing,
+                                            const DictionaryValue &io_data,
+                                            MutableSpan<char> r_data)
+{
+  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
+  if (!slice) {
+    return false;
+  }
+  const DictionaryValue *io_delta_base = io_data.lookup_dict("delta_base");
+  if (!io_delta_base) {
+    return read_blob_decompressed(blob_reader, io_data, *slice, r_data);
+  }
+  return blob_sharing.read_delta_decoded(io_data, r_data, [&](MutableSpan<char> r_decoded) {
+    Array<char> delta(r_decoded.size(), NoInitialization());
+    if (!read_blob_decompressed(blob_reader, io_data, *slice, delta)) {
+      return false;
+    }
+    if (!read_blob_decoded(blob_reader, blob_sharing, *io_delta_base, r_decoded)) {
+      return false;
+    }
+    xor_bytes(delta, r_decoded, r_decoded);
+    return true;
+  });
+}
+
 /**
  * Write the data and remember which endianness the data had.
  */
 static std::shared_ptr<DictionaryValue> write_blob_raw_data_with_endian(
-    BlobWriter &blob_writer, const void *data, const int64_t size_in_bytes)
+    BlobWriter &blob_writer, const void *data, const int64_t size_in_bytes, int64_t element_size)
 {
-  auto io_data = blob_writer.write(data, size_in_bytes).serialize();
+  auto io_data = write_blob_encoded(
+      blob_writer, Span<char>(static_cast<const char *>(data), size_in_bytes), element_size);
   if (ENDIAN_ORDER == B_ENDIAN) {
     io_data->append_str("endian", get_endian_io_name(ENDIAN_ORDER));
   }
@@ -211,19 +422,17 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_data_with_endian(
  * Read data of an into an array and optionally perform an endian switch if necessary.
  */
 [[nodiscard]] static bool read_blob_raw_data_with_endian(const BlobReader &blob_reader,
+                                                         const BlobSharing &blob_sharing,
                                                          const DictionaryValue &io_data,
                                                          const int64_t element_size,
                                                          const int64_t elements_num,
                                                          void *r_data)
 {
-  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
-  if (!slice) {
-    return false;
-  }
-  if (slice->range.size() != element_size * elements_num) {
-    return false;
-  }
-  if (!blob_reader.read(*slice, r_data)) {
+  if (!read_blob_decoded(blob_reader,
+                         blob_sharing,
+                         io_data,
+                         {static_cast<char *>(r_data), element_size * elements_num}))
+  {
     return false;
   }
   const StringRefNull stored_endian = io_data.lookup_str("endian").value_or("little");
@@ -254,23 +463,31 @@ static std::shared_ptr<DictionaryValue> write_blob_raw_bytes(BlobWriter &blob_wr
                                                              const void *data,
                                                              const int64_t size_in_bytes)
 {
-  return blob_writer.write(data, size_in_bytes).serialize();
+  return write_blob_encoded(
+      blob_writer, Span<char>(static_cast<const char *>(data), size_in_bytes), 1);
 }
 
 /** Read bytes ignoring endianness. */
 [[nodiscard]] static bool read_blob_raw_bytes(const BlobReader &blob_reader,
+                                              const BlobSharing &blob_sharing,
                                               const DictionaryValue &io_data,
                                               const int64_t bytes_num,
                                               void *r_data)
 {
-  const std::optional<BlobSlice> slice = BlobSlice::deserialize(io_data);
-  if (!slice) {
-    return false;
-  }
-  if (slice->range.size() != bytes_num) {
-    return false;
+  return read_blob_decoded(
+      blob_reader, blob_sharing, io_data, {static_cast<char *>(r_data), bytes_num});
+}
+
+/**
+ * Size of the individual numbers that make up a value of the type. Endianness and byte
+ * shuffling work on these.
+ */
+static int64_t get_blob_element_size(const CPPType &type)
+{
+  if (type.is_any<float2, int2, float3, float4x4, ColorGeometry4f>()) {
+    return sizeof(float);
   }
-  return blob_reader.read(*slice, r_data);
+  return type.size();
 }
 
 static std::shared_ptr<DictionaryValue> write_blob_simple_gspan(BlobWriter &blob_writer,
@@ -281,37 +498,68 @@ static std::shared_ptr<DictionaryValue> write_blob_simple_gspan(BlobWriter &blob
   if (type.size() == 1 || type.is<ColorGeometry4b>()) {
     return write_blob_raw_bytes(blob_writer, data.data(), data.size_in_bytes());
   }
-  return write_blob_raw_data_with_endian(blob_writer, data.data(), data.size_in_bytes());
+  return write_blob_raw_data_with_endian(
+      blob_writer, data.data(), data.size_in_bytes(), get_blob_element_size(type));
+}
+
+/**
+ * Write the data as difference to the data that has been written with the same key for the
+ * previous frame. Values that don't change between frames become zero bytes, which compress
+ * very well. XOR is used for the difference, so that floats are restored exactly.
+ */
+static std::shared_ptr<DictionaryValue> write_blob_delta_gspan(BlobWriter &blob_writer,
+                                                               BlobSharing &blob_sharing,
+                                                               const GSpan data,
+                                                               const std::string &delta_key)
+{
+  const Span<char> bytes(static_cast<const char *>(data.data()), data.size_in_bytes());
+  const BlobSharing::DeltaBase *delta_base = blob_sharing.lookup_delta_base(delta_key);
+  if (delta_base == nullptr || delta_base->data.size() != bytes.size()) {
+    DictionaryValuePtr io_data = write_blob_simple_gspan(blob_writer, data);
+    blob_sharing.store_delta_base(delta_key, bytes, io_data, 0);
+    return io_data;
+  }
+
+  Array<char> delta(bytes.size(), NoInitialization());
+  xor_bytes(bytes, delta_base->data, delta);
+  DictionaryValuePtr io_data = write_blob_raw_data_with_endian(
+      blob_writer, delta.data(), delta.size(), get_blob_element_size(data.type()));
+  io_data->append("delta_base", delta_base->io_data);
+  const int chain_length = delta_base->chain_length + 1;
+  blob_sharing.store_delta_base(delta_key, bytes, io_data, chain_length);
+  return io_data;
 }
 
 [[nodiscard]] static bool read_blob_simple_gspan(const BlobReader &blob_reader,
+                                                 const BlobSharing &blob_sharing,
                                                  const DictionaryValue &io_data,
                                                  GMutableSpan r_data)
 {
   const CPPType &type = r_data.type();
   BLI_assert(type.is_trivial());
   if (type.size() == 1 || type.is<ColorGeometry4b>()) {
-    return read_blob_raw_bytes(blob_reader, io_data, r_data.size_in_bytes(), r_data.data());
+    return read_blob_raw_bytes(
+        blob_reader, blob_sharing, io_data, r_data.size_in_bytes(), r_data.data());
   }
   if (type.is_any<int16_t, uint16_t, int32_t, uint32_t, int64_t, uint64_t, float>()) {
     return read_blob_raw_data_with_endian(
-        blob_reader, io_data, type.size(), r_data.size(), r_data.data());
+        blob_reader, blob_sharing, io_data, type.size(), r_data.size(), r_data.data());
   }
   if (type.is_any<float2, int2>()) {
     return read_blob_raw_data_with_endian(
-        blob_reader, io_data, sizeof(int32_t), r_data.size() * 2, r_data.data());
+        blob_reader, blob_sharing, io_data, sizeof(int32_t), r_data.size() * 2, r_data.data());
   }
   if (type.is<float3>()) {
     return read_blob_raw_data_with_endian(
-        blob_reader, io_data, sizeof(float), r_data.size() * 3, r_data.data());
+        blob_reader, blob_sharing, io_data, sizeof(float), r_data.size() * 3, r_data.data());
   }
   if (type.is<float4x4>()) {
     return read_blob_raw_data_with_endian(
-        blob_reader, io_data, sizeof(float), r_data.size() * 16, r_data.data());
+        blob_reader, blob_sharing, io_data, sizeof(float), r_data.size() * 16, r_data.data());
   }
   if (type.is<ColorGeometry4f>()) {
     return read_blob_raw_data_with_endian(
-        blob_reader, io_data, sizeof(float), r_data.size() * 4, r_data.data());
+        blob_reader, blob_sharing, io_data, sizeof(float), r_data.size() * 4, r_data.data());
   }
   return false;
 }
@@ -338,7 +586,9 @@ static std::shared_ptr<DictionaryValue> write_blob_shared_simple_gspan(
   const std::optional<ImplicitSharingInfoAndData> sharing_info_and_data = blob_sharing.read_shared(
       io_data, [&]() -> std::optional<ImplicitSharingInfoAndData> {
         void *data_mem = MEM_mallocN_aligned(size * cpp_type.size(), cpp_type.alignment(), func);
-        if (!read_blob_simple_gspan(blob_reader, io_data, {cpp_type, data_mem, size})) {
+        if (!read_blob_simple_gspan(
+                blob_reader, blob_sharing, io_data, {cpp_type, data_mem, size}))
+        {
           MEM_freeN(data_mem);
           return std::nullopt;
         }
@@ -598,7 +848,9 @@ static std::unique_ptr<Instances> try_load_instances(const DictionaryValue &io_g
   if (!io_transforms) {
     return {};
   }
-  if (!read_blob_simple_gspan(blob_reader, *io_transforms, instances->transforms())) {
+  if (!read_blob_simple_gspan(
+          blob_reader, blob_sharing, *io_transforms, instances->transforms()))
+  {
     return {};
   }
 
@@ -606,7 +858,9 @@ static std::unique_ptr<Instances> try_load_instances(const DictionaryValue &io_g
   if (!io_handles) {
     return {};
   }
-  if (!read_blob_simple_gspan(blob_reader, *io_handles, instances->reference_handles())) {
+  if (!read_blob_simple_gspan(
+          blob_reader, blob_sharing, *io_handles, instances->reference_handles()))
+  {
     return {};
   }
 
@@ -649,11 +903,15 @@ static std::shared_ptr<io::serialize::ArrayValue> serialize_material_slots(
   return io_materials;
 }
 
+/**
+ * \param delta_key: Identifies the geometry between frames, used for delta encoding positions.
+ */
 static std::shared_ptr<io::serialize::ArrayValue> serialize_attributes(
     const AttributeAccessor &attributes,
     BlobWriter &blob_writer,
     BlobSharing &blob_sharing,
-    const Set<std::string> &attributes_to_ignore)
+    const Set<std::string> &attributes_to_ignore,
+    const std::string &delta_key)
 {
   auto io_attributes = std::make_shared<io::serialize::ArrayValue>();
   attributes.for_all([&](const AttributeIDRef &attribute_id, const AttributeMetaData &meta_data) {
@@ -674,12 +932,20 @@ static std::shared_ptr<io::serialize::ArrayValue> serialize_attributes(
 
     const GAttributeReader attribute = attributes.lookup(attribute_id);
     const GVArraySpan attribute_span(attribute.varray);
-    io_attribute->append("data",
-                         write_blob_shared_simple_gspan(
-                             blob_writer,
-                             blob_sharing,
-                             attribute_span,
-                             attribute.varray.is_span() ? attribute.sharing_info : nullptr));
+    const ImplicitSharingInfo *sharing_info = attribute.varray.is_span() ?
+                                                  attribute.sharing_info :
+                                                  nullptr;
+    if (blob_writer.settings.use_delta_positions && attribute_id.name() == "position") {
+      io_attribute->append("data", blob_sharing.write_shared(sharing_info, [&]() {
+        return write_blob_delta_gspan(
+            blob_writer, blob_sharing, attribute_span, delta_key + "/position");
+      }));
+    }
+    else {
+      io_attribute->append(
+          "data",
+          write_blob_shared_simple_gspan(blob_writer, blob_sharing, attribute_span, sharing_info));
+    }
     return true;
   });
   return io_attributes;
@@ -687,7 +953,8 @@ static std::shared_ptr<io::serialize::ArrayValue> serialize_attributes(
 
 static std::shared_ptr<DictionaryValue> serialize_geometry_set(const GeometrySet &geometry,
                                                                BlobWriter &blob_writer,
-                                                               BlobSharing &blob_sharing)
+                                                               BlobSharing &blob_sharing,
+                                                               const std::string &delta_key)
 {
   auto io_geometry = std::make_shared<DictionaryValue>();
   if (geometry.has_mesh()) {
@@ -710,7 +977,8 @@ static std::shared_ptr<DictionaryValue> serialize_geometry_set(const GeometrySet
     auto io_materials = serialize_material_slots({mesh.mat, mesh.totcol});
     io_mesh->append("materials", io_materials);
 
-    auto io_attributes = serialize_attributes(mesh.attributes(), blob_writer, blob_sharing, {});
+    auto io_attributes = serialize_attributes(
+        mesh.attributes(), blob_writer, blob_sharing, {}, delta_key + "/mesh");
     io_mesh->append("attributes", io_attributes);
   }
   if (geometry.has_pointcloud()) {
@@ -723,7 +991,7 @@ static std::shared_ptr<DictionaryValue> serialize_geometry_set(const GeometrySet
     io_pointcloud->append("materials", io_materials);
 
     auto io_attributes = serialize_attributes(
-        pointcloud.attributes(), blob_writer, blob_sharing, {});
+        pointcloud.attributes(), blob_writer, blob_sharing, {}, delta_key + "/pointcloud");
     io_pointcloud->append("attributes", io_attributes);
   }
   if (geometry.has_curves()) {
@@ -747,7 +1015,8 @@ static std::shared_ptr<DictionaryValue> serialize_geometry_set(const GeometrySet
     auto io_materials = serialize_material_slots({curves_id.mat, curves_id.totcol});
     io_curves->append("materials", io_materials);
 
-    auto io_attributes = serialize_attributes(curves.attributes(), blob_writer, blob_sharing, {});
+    auto io_attributes = serialize_attributes(
+        curves.attributes(), blob_writer, blob_sharing, {}, delta_key + "/curves");
     io_curves->append("attributes", io_attributes);
   }
   if (geometry.has_instances()) {
@@ -757,19 +1026,35 @@ static std::shared_ptr<DictionaryValue> serialize_geometry_set(const GeometrySet
     io_instances->append_int("num_instances", instances.instances_num());
 
     auto io_references = io_instances->append_array("references");
-    for (const InstanceReference &reference : instances.references()) {
+    const Span<InstanceReference> references = instances.references();
+    for (const int i : references.index_range()) {
+      const InstanceReference &reference = references[i];
       BLI_assert(reference.type() == InstanceReference::Type::GeometrySet);
-      io_references->append(
-          serialize_geometry_set(reference.geometry_set(), blob_writer, blob_sharing));
+      io_references->append(serialize_geometry_set(reference.geometry_set(),
+                                                   blob_writer,
+                                                   blob_sharing,
+                                                   delta_key + "/instances/" + std::to_string(i)));
     }
 
-    io_instances->append("transforms",
-                         write_blob_simple_gspan(blob_writer, instances.transforms()));
+    if (blob_writer.settings.use_delta_positions) {
+      io_instances->append("transforms",
+                           write_blob_delta_gspan(blob_writer,
+                                                  blob_sharing,
+                                                  instances.transforms(),
+                                                  delta_key + "/instances/transforms"));
+    }
+    else {
+      io_instances->append("transforms",
+                           write_blob_simple_gspan(blob_writer, instances.transforms()));
+    }
     io_instances->append("handles",
                          write_blob_simple_gspan(blob_writer, instances.reference_handles()));
 
-    auto io_attributes = serialize_attributes(
-        instances.attributes(), blob_writer, blob_sharing, {"position"});
+    auto io_attributes = serialize_attributes(instances.attributes(),
+                                              blob_writer,
+                                              blob_sharing,
+                                              {"position"},
+                                              delta_key + "/instances");
     io_instances->append("attributes", io_attributes);
   }
   return io_geometry;
@@ -961,13 +1246,14 @@ template<typename T>
 static void serialize_bake_item(const BakeItem &item,
                                 BlobWriter &blob_writer,
                                 BlobSharing &blob_sharing,
+                                const std::string &delta_key,
                                 DictionaryValue &r_io_item)
 {
   if (const auto *geometry_state_item = dynamic_cast<const GeometryBakeItem *>(&item)) {
     r_io_item.append_str("type", "GEOMETRY");
 
     const GeometrySet &geometry = geometry_state_item->geometry;
-    auto io_geometry = serialize_geometry_set(geometry, blob_writer, blob_sharing);
+    auto io_geometry = serialize_geometry_set(geometry, blob_writer, blob_sharing, delta_key);
     r_io_item.append("data", io_geometry);
   }
   else if (const auto *attribute_state_item = dynamic_cast<const AttributeBakeItem *>(&item)) {
@@ -1038,7 +1324,7 @@ static std::unique_ptr<BakeItem> deserialize_bake_item(const DictionaryValue &io
       }
       std::string str;
       str.resize(*size);
-      if (!read_blob_raw_bytes(blob_reader, *io_string, *size, str.data())) {
+      if (!read_blob_raw_bytes(blob_reader, blob_sharing, *io_string, *size, str.data())) {
         return {};
       }
       return std::make_unique<StringBakeItem>(std::move(str));
@@ -1061,7 +1347,9 @@ static std::unique_ptr<BakeItem> deserialize_bake_item(const DictionaryValue &io
   return {};
 }
 
-static constexpr int bake_file_version = 3;
+/** Version 4 added optional blob encodings, the older bakes can still be read. */
+static constexpr int bake_file_version = 4;
+static constexpr int bake_file_min_version = 3;
 
 void serialize_bake(const BakeState &bake_state,
                     BlobWriter &blob_writer,
@@ -1072,8 +1360,9 @@ void serialize_bake(const BakeState &bake_state,
   io_root.append_int("version", bake_file_version);
   io::serialize::DictionaryValue &io_items = *io_root.append_dict("items");
   for (auto item : bake_state.items_by_id.items()) {
-    io::serialize::DictionaryValue &io_item = *io_items.append_dict(std::to_string(item.key));
-    serialize_bake_item(*item.value, blob_writer, blob_sharing, io_item);
+    const std::string item_key = std::to_string(item.key);
+    io::serialize::DictionaryValue &io_item = *io_items.append_dict(item_key);
+    serialize_bake_item(*item.value, blob_writer, blob_sharing, item_key, io_item);
   }
 
   io::serialize::JsonFormatter formatter;
@@ -1100,7 +1389,9 @@ std::optional<BakeState> deserialize_bake(std::istream &stream,
     return std::nullopt;
   }
   const std::optional<int> version = io_root->lookup_int("version");
-  if (!version.has_value() || *version != bake_file_version) {
+  if (!version.has_value() || *version < bake_file_min_version ||
+      *version > bake_file_version)
+  {
     return std::nullopt;
   }
   const io::serialize::DictionaryValue *io_items = io_root->lookup_dict("items");
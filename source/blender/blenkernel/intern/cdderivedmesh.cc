@@ -181,7 +181,13 @@ static DerivedMesh *cdDM_from_mesh_ex(Mesh *mesh, const CustomData_MeshMasks *ma
       &dm->loopData, CD_PROP_INT32, ".corner_vert", mesh->corners_num));
   cddm->corner_edges = static_cast<int *>(CustomData_get_layer_named_for_write(
       &dm->loopData, CD_PROP_INT32, ".corner_edge", mesh->corners_num));
-  dm->face_offsets = static_cast<int *>(MEM_dupallocN(mesh->face_offset_indices));
+  if (mesh->face_offset_indices) {
+    /* Copy with an explicit size, the offsets may be referenced in a memory-mapped file instead
+     * of being a guarded allocation. */
+    dm->face_offsets = static_cast<int *>(
+        MEM_malloc_arrayN(mesh->faces_num + 1, sizeof(int), __func__));
+    memcpy(dm->face_offsets, mesh->face_offset_indices, sizeof(int) * (mesh->faces_num + 1));
+  }
 #if 0
   cddm->mface = CustomData_get_layer(&dm->faceData, CD_MFACE);
 #else
@@ -4474,7 +4474,9 @@ bool CustomData_layer_validate(CustomDataLayer *layer, const uint totitems, cons
   }
 
   BLI_assert((totitems == 0) || layer->data);
-  BLI_assert(MEM_allocN_len(layer->data) >= totitems * typeInfo->size);
+  /* Data referenced in a memory-mapped file has no allocation size. */
+  BLI_assert(BLO_read_data_is_mapped(layer->sharing_info) ||
+             MEM_allocN_len(layer->data) >= totitems * typeInfo->size);
 
   if (typeInfo->validate != nullptr) {
     return typeInfo->validate(layer->data, totitems, do_fixes);
@@ -5212,8 +5214,15 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, const int
     layer->sharing_info = nullptr;
 
     if (CustomData_verify_versions(data, i)) {
-      BLO_read_data_address(reader, &layer->data);
-      if (layer->data != nullptr) {
+      const LayerTypeInfo *typeInfo = layerType_getInfo(eCustomDataType(layer->type));
+      if (typeInfo->copy == nullptr && typeInfo->free == nullptr) {
+        /* Plain data arrays can reference the data in a memory-mapped file directly. */
+        layer->sharing_info = BLO_read_data_address_shared(reader, &layer->data);
+      }
+      else {
+        BLO_read_data_address(reader, &layer->data);
+      }
+      if (layer->data != nullptr && layer->sharing_info == nullptr) {
         /* Make layer data shareable. */
         layer->sharing_info = make_implicit_sharing_info_for_layer(
             eCustomDataType(layer->type), layer->data, count);
@@ -5266,8 +5275,12 @@ void CustomData_debug_info_from_layers(const CustomData *data, const char *inden
       /* NOTE: doesn't account for multiple layers. */
       const char *name = CustomData_layertype_name(type);
       const int size = CustomData_sizeof(type);
-      const void *pt = CustomData_get_layer(data, type);
-      const int pt_size = pt ? int(MEM_allocN_len(pt) / size) : 0;
+      const CustomDataLayer &layer = data->layers[CustomData_get_active_layer_index(data, type)];
+      const void *pt = layer.data;
+      /* Data referenced in a memory-mapped file has no allocation size. */
+      const int pt_size = (pt && !BLO_read_data_is_mapped(layer.sharing_info)) ?
+                              int(MEM_allocN_len(pt) / size) :
+                              0;
       const char *structname;
       int structnum;
       CustomData_file_write_info(type, &structname, &structnum);
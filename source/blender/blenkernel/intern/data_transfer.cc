@@ -6,6 +6,9 @@
  * \ingroup bke
  */
 
+#include <algorithm>
+#include <optional>
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_customdata_types.h"
@@ -15,7 +18,9 @@
 #include "DNA_scene_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_implicit_sharing.hh"
 #include "BLI_math_matrix.h"
+#include "BLI_struct_equality_utils.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_attribute.hh"
@@ -1299,6 +1304,218 @@ void BKE_object_data_transfer_layout(Depsgraph *depsgraph,
   }
 }
 
+/**
+ * Identity of a mesh array: its implicit sharing info and the version of the shared data, which
+ * is increased when the data is changed in place. Arrays without a sharing info use a negative
+ * version, mappings that depend on them are never reused.
+ */
+struct DataTransferArrayKey {
+  const blender::ImplicitSharingInfo *sharing_info = nullptr;
+  int64_t version = 0;
+
+  BLI_STRUCT_EQUALITY_OPERATORS_2(DataTransferArrayKey, sharing_info, version)
+};
+
+static DataTransferArrayKey data_transfer_array_key(
+    const void *data, const blender::ImplicitSharingInfo *sharing_info)
+{
+  if (data == nullptr) {
+    return {};
+  }
+  if (sharing_info == nullptr) {
+    return {nullptr, -1};
+  }
+  return {sharing_info, sharing_info->version()};
+}
+
+static DataTransferArrayKey data_transfer_layer_key(const CustomData &data,
+                                                    const eCustomDataType type,
+                                                    const char *name)
+{
+  const int index = name ? CustomData_get_named_layer_index(&data, type, name) :
+                           CustomData_get_layer_index(&data, type);
+  if (index == -1) {
+    return {};
+  }
+  const CustomDataLayer &layer = data.layers[index];
+  return data_transfer_array_key(layer.data, layer.sharing_info);
+}
+
+/**
+ * Identities of the arrays of a mesh that the mappings depend on. They are only compared, so
+ * unlike hashing the data, computing them doesn't depend on the size of the mesh.
+ */
+struct DataTransferMeshKey {
+  int elems_num[4] = {};
+  DataTransferArrayKey positions;
+  /** Edges, face offsets and corner vertices. */
+  DataTransferArrayKey topology[3];
+  /** Sharp edges, sharp faces and custom normals, used by the corner normals. */
+  DataTransferArrayKey normals[3];
+  DataTransferArrayKey uv_seams;
+};
+
+static DataTransferMeshKey data_transfer_mesh_key(const Mesh &mesh)
+{
+  DataTransferMeshKey key;
+  key.elems_num[0] = mesh.verts_num;
+  key.elems_num[1] = mesh.edges_num;
+  key.elems_num[2] = mesh.corners_num;
+  key.elems_num[3] = mesh.faces_num;
+  key.positions = data_transfer_layer_key(mesh.vert_data, CD_PROP_FLOAT3, "position");
+  key.topology[0] = data_transfer_layer_key(mesh.edge_data, CD_PROP_INT32_2D, ".edge_verts");
+  key.topology[1] = data_transfer_array_key(mesh.face_offset_indices,
+                                            mesh.runtime->face_offsets_sharing_info);
+  key.topology[2] = data_transfer_layer_key(mesh.corner_data, CD_PROP_INT32, ".corner_vert");
+  key.normals[0] = data_transfer_layer_key(mesh.edge_data, CD_PROP_BOOL, "sharp_edge");
+  key.normals[1] = data_transfer_layer_key(mesh.face_data, CD_PROP_BOOL, "sharp_face");
+  key.normals[2] = data_transfer_layer_key(mesh.corner_data, CD_CUSTOMLOOPNORMAL, nullptr);
+  key.uv_seams = data_transfer_layer_key(mesh.edge_data, CD_PROP_BOOL, ".uv_seam");
+  return key;
+}
+
+/** Everything a geometry mapping depends on. The mapping has to be recomputed when it changes. */
+struct DataTransferMapKey {
+  int map_mode;
+  bool use_islands;
+  float max_distance;
+  float ray_radius;
+  float islands_handling_precision;
+  bool use_space_transform;
+  SpaceTransform space_transform;
+  int src_elems_num[4];
+  int dst_elems_num[4];
+  /** Arrays of both meshes used by the mapping. The cache holds a weak user of each of them. */
+  blender::Vector<DataTransferArrayKey, 16> arrays;
+
+  bool is_valid() const
+  {
+    return std::all_of(arrays.begin(), arrays.end(), [](const DataTransferArrayKey &array) {
+      return array.version >= 0;
+    });
+  }
+
+  friend bool operator==(const DataTransferMapKey &a, const DataTransferMapKey &b)
+  {
+    return a.map_mode == b.map_mode && a.use_islands == b.use_islands &&
+           a.max_distance == b.max_distance && a.ray_radius == b.ray_radius &&
+           a.islands_handling_precision == b.islands_handling_precision &&
+           a.use_space_transform == b.use_space_transform &&
+           (!a.use_space_transform ||
+            memcmp(&a.space_transform, &b.space_transform, sizeof(SpaceTransform)) == 0) &&
+           memcmp(a.src_elems_num, b.src_elems_num, sizeof(a.src_elems_num)) == 0 &&
+           memcmp(a.dst_elems_num, b.dst_elems_num, sizeof(a.dst_elems_num)) == 0 &&
+           a.arrays == b.arrays;
+  }
+};
+
+static DataTransferMapKey data_transfer_map_key(const int elem_type,
+                                                const int map_mode,
+                                                const SpaceTransform *space_transform,
+                                                const float max_distance,
+                                                const float ray_radius,
+                                                const float islands_handling_precision,
+                                                const bool use_islands,
+                                                const DataTransferMeshKey &src,
+                                                const DataTransferMeshKey &dst)
+{
+  DataTransferMapKey key{};
+  key.map_mode = map_mode;
+  key.use_islands = use_islands;
+  key.max_distance = max_distance;
+  key.ray_radius = ray_radius;
+  key.islands_handling_precision = islands_handling_precision;
+  key.use_space_transform = space_transform != nullptr;
+  if (space_transform) {
+    key.space_transform = *space_transform;
+  }
+  memcpy(key.src_elems_num, src.elems_num, sizeof(key.src_elems_num));
+  memcpy(key.dst_elems_num, dst.elems_num, sizeof(key.dst_elems_num));
+
+  /* Topology mappings only depend on the number of elements. */
+  if (map_mode == MREMAP_MODE_TOPOLOGY) {
+    return key;
+  }
+  for (const DataTransferMeshKey *mesh : {&src, &dst}) {
+    key.arrays.append(mesh->positions);
+    key.arrays.extend(mesh->topology, ARRAY_SIZE(mesh->topology));
+  }
+  if ((elem_type == ME_LOOP) && (map_mode & (MREMAP_USE_NORMAL | MREMAP_USE_NORPROJ))) {
+    key.arrays.extend(src.normals, ARRAY_SIZE(src.normals));
+    key.arrays.extend(dst.normals, ARRAY_SIZE(dst.normals));
+  }
+  if (use_islands) {
+    key.arrays.append(src.uv_seams);
+  }
+  return key;
+}
+
+struct DataTransferCache {
+  /** Mappings of vertices, edges, face corners and faces. */
+  MeshPairRemap maps[4] = {};
+  /** Inputs of every mapping, empty when the mapping can't be reused. */
+  std::optional<DataTransferMapKey> keys[4];
+};
+
+DataTransferCache *BKE_data_transfer_cache_new()
+{
+  return MEM_new<DataTransferCache>(__func__);
+}
+
+static void data_transfer_cache_key_clear(DataTransferCache &cache, const int index)
+{
+  if (!cache.keys[index]) {
+    return;
+  }
+  for (const DataTransferArrayKey &array : cache.keys[index]->arrays) {
+    if (array.sharing_info) {
+      array.sharing_info->remove_weak_user_and_delete_if_last();
+    }
+  }
+  cache.keys[index].reset();
+}
+
+void BKE_data_transfer_cache_free(DataTransferCache *cache)
+{
+  if (cache == nullptr) {
+    return;
+  }
+  for (const int i : blender::IndexRange(4)) {
+    BKE_mesh_remap_free(&cache->maps[i]);
+    data_transfer_cache_key_clear(*cache, i);
+  }
+  MEM_delete(cache);
+}
+
+/** Whether the cached mapping at \a index was computed from the same inputs. */
+static bool data_transfer_cache_is_valid(const DataTransferCache *cache,
+                                         const int index,
+                                         const DataTransferMapKey &key)
+{
+  return cache && cache->maps[index].items && cache->keys[index] && *cache->keys[index] == key;
+}
+
+static void data_transfer_cache_key_set(DataTransferCache *cache,
+                                        const int index,
+                                        DataTransferMapKey &&key)
+{
+  if (cache == nullptr) {
+    return;
+  }
+  data_transfer_cache_key_clear(*cache, index);
+  if (!key.is_valid()) {
+    return;
+  }
+  /* The weak users keep the sharing infos alive, so that their addresses can't be reused for
+   * other data while they are part of the key. */
+  for (const DataTransferArrayKey &array : key.arrays) {
+    if (array.sharing_info) {
+      array.sharing_info->add_weak_user();
+    }
+  }
+  cache->keys[index] = std::move(key);
+}
+
 bool BKE_object_data_transfer_ex(Depsgraph *depsgraph,
                                  Object *ob_src,
                                  Object *ob_dst,
@@ -1320,6 +1537,7 @@ bool BKE_object_data_transfer_ex(Depsgraph *depsgraph,
                                  const float mix_factor,
                                  const char *vgroup_name,
                                  const bool invert_vgroup,
+                                 DataTransferCache *cache,
                                  ReportList *reports)
 {
 #define VDATA 0
@@ -1336,7 +1554,8 @@ bool BKE_object_data_transfer_ex(Depsgraph *depsgraph,
   int vg_idx = -1;
   float *weights[DATAMAX] = {nullptr};
 
-  MeshPairRemap geom_map[DATAMAX] = {{0}};
+  MeshPairRemap geom_map_local[DATAMAX] = {{0}};
+  MeshPairRemap *geom_map = cache ? cache->maps : geom_map_local;
   bool geom_map_init[DATAMAX] = {false};
   ListBase lay_map = {nullptr};
   bool changed = false;
@@ -1377,6 +1596,12 @@ bool BKE_object_data_transfer_ex(Depsgraph *depsgraph,
   }
   BKE_mesh_wrapper_ensure_mdata(const_cast<Mesh *>(me_src));
 
+  DataTransferMeshKey src_key, dst_key;
+  if (cache) {
+    src_key = data_transfer_mesh_key(*me_src);
+    dst_key = data_transfer_mesh_key(*me_dst);
+  }
+
   if (auto_transform) {
     if (space_transform == nullptr) {
       space_transform = &auto_space_transform;
@@ -1447,16 +1672,28 @@ bool BKE_object_data_transfer_ex(Depsgraph *depsgraph,
           continue;
         }
 
-        BKE_mesh_remap_calc_verts_from_mesh(
-            map_vert_mode,
-            space_transform,
-            max_distance,
-            ray_radius,
-            reinterpret_cast<const float(*)[3]>(positions_dst.data()),
-            num_verts_dst,
-            me_src,
-            me_dst,
-            &geom_map[VDATA]);
+        DataTransferMapKey map_key = data_transfer_map_key(ME_VERT,
+                                                           map_vert_mode,
+                                                           space_transform,
+                                                           max_distance,
+                                                           ray_radius,
+                                                           islands_handling_precision,
+                                                           false,
+                                                           src_key,
+                                                           dst_key);
+        if (!data_transfer_cache_is_valid(cache, VDATA, map_key)) {
+          BKE_mesh_remap_calc_verts_from_mesh(
+              map_vert_mode,
+              space_transform,
+              max_distance,
+              ray_radius,
+              reinterpret_cast<const float(*)[3]>(positions_dst.data()),
+              num_verts_dst,
+              me_src,
+              me_dst,
+              &geom_map[VDATA]);
+          data_transfer_cache_key_set(cache, VDATA, std::move(map_key));
+        }
         geom_map_init[VDATA] = true;
       }
 
@@ -1524,18 +1761,30 @@ bool BKE_object_data_transfer_ex(Depsgraph *depsgraph,
           continue;
         }
 
-        BKE_mesh_remap_calc_edges_from_mesh(
-            map_edge_mode,
-            space_transform,
-            max_distance,
-            ray_radius,
-            reinterpret_cast<const float(*)[3]>(positions_dst.data()),
-            num_verts_dst,
-            edges_dst.data(),
-            edges_dst.size(),
-            me_src,
-            me_dst,
-            &geom_map[EDATA]);
+        DataTransferMapKey map_key = data_transfer_map_key(ME_EDGE,
+                                                           map_edge_mode,
+                                                           space_transform,
+                                                           max_distance,
+                                                           ray_radius,
+                                                           islands_handling_precision,
+                                                           false,
+                                                           src_key,
+                                                           dst_key);
+        if (!data_transfer_cache_is_valid(cache, EDATA, map_key)) {
+          BKE_mesh_remap_calc_edges_from_mesh(
+              map_edge_mode,
+              space_transform,
+              max_distance,
+              ray_radius,
+              reinterpret_cast<const float(*)[3]>(positions_dst.data()),
+              num_verts_dst,
+              edges_dst.data(),
+              edges_dst.size(),
+              me_src,
+              me_dst,
+              &geom_map[EDATA]);
+          data_transfer_cache_key_set(cache, EDATA, std::move(map_key));
+        }
         geom_map_init[EDATA] = true;
       }
 
@@ -1611,21 +1860,33 @@ bool BKE_object_data_transfer_ex(Depsgraph *depsgraph,
           continue;
         }
 
-        BKE_mesh_remap_calc_loops_from_mesh(
-            map_loop_mode,
-            space_transform,
-            max_distance,
-            ray_radius,
-            me_dst,
-            reinterpret_cast<const float(*)[3]>(positions_dst.data()),
-            num_verts_dst,
-            corner_verts_dst.data(),
-            corner_verts_dst.size(),
-            faces_dst,
-            me_src,
-            island_callback,
-            islands_handling_precision,
-            &geom_map[LDATA]);
+        DataTransferMapKey map_key = data_transfer_map_key(ME_LOOP,
+                                                           map_loop_mode,
+                                                           space_transform,
+                                                           max_distance,
+                                                           ray_radius,
+                                                           islands_handling_precision,
+                                                           island_callback != nullptr,
+                                                           src_key,
+                                                           dst_key);
+        if (!data_transfer_cache_is_valid(cache, LDATA, map_key)) {
+          BKE_mesh_remap_calc_loops_from_mesh(
+              map_loop_mode,
+              space_transform,
+              max_distance,
+              ray_radius,
+              me_dst,
+              reinterpret_cast<const float(*)[3]>(positions_dst.data()),
+              num_verts_dst,
+              corner_verts_dst.data(),
+              corner_verts_dst.size(),
+              faces_dst,
+              me_src,
+              island_callback,
+              islands_handling_precision,
+              &geom_map[LDATA]);
+          data_transfer_cache_key_set(cache, LDATA, std::move(map_key));
+        }
         geom_map_init[LDATA] = true;
       }
 
@@ -1698,18 +1959,30 @@ bool BKE_object_data_transfer_ex(Depsgraph *depsgraph,
           continue;
         }
 
-        BKE_mesh_remap_calc_faces_from_mesh(
-            map_face_mode,
-            space_transform,
-            max_distance,
-            ray_radius,
-            me_dst,
-            reinterpret_cast<const float(*)[3]>(positions_dst.data()),
-            num_verts_dst,
-            corner_verts_dst.data(),
-            faces_dst,
-            me_src,
-            &geom_map[PDATA]);
+        DataTransferMapKey map_key = data_transfer_map_key(ME_POLY,
+                                                           map_face_mode,
+                                                           space_transform,
+                                                           max_distance,
+                                                           ray_radius,
+                                                           islands_handling_precision,
+                                                           false,
+                                                           src_key,
+                                                           dst_key);
+        if (!data_transfer_cache_is_valid(cache, PDATA, map_key)) {
+          BKE_mesh_remap_calc_faces_from_mesh(
+              map_face_mode,
+              space_transform,
+              max_distance,
+              ray_radius,
+              me_dst,
+              reinterpret_cast<const float(*)[3]>(positions_dst.data()),
+              num_verts_dst,
+              corner_verts_dst.data(),
+              faces_dst,
+              me_src,
+              &geom_map[PDATA]);
+          data_transfer_cache_key_set(cache, PDATA, std::move(map_key));
+        }
         geom_map_init[PDATA] = true;
       }
 
@@ -1757,7 +2030,7 @@ bool BKE_object_data_transfer_ex(Depsgraph *depsgraph,
   }
 
   for (int i = 0; i < DATAMAX; i++) {
-    BKE_mesh_remap_free(&geom_map[i]);
+    BKE_mesh_remap_free(&geom_map_local[i]);
     MEM_SAFE_FREE(weights[i]);
   }
 
@@ -1813,5 +2086,6 @@ bool BKE_object_data_transfer_mesh(Depsgraph *depsgraph,
                                      mix_factor,
                                      vgroup_name,
                                      invert_vgroup,
+                                     nullptr,
                                      reports);
 }
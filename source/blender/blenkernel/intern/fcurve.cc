@@ -6,11 +6,15 @@
  * \ingroup bke
  */
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 #include "MEM_guardedalloc.h"
 
@@ -18,6 +22,7 @@
 #include "DNA_object_types.h"
 #include "DNA_text_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
 #include "BLI_easing.h"
 #include "BLI_ghash.h"
@@ -25,6 +30,7 @@
 #include "BLI_math_vector_types.hh"
 #include "BLI_sort_utils.h"
 #include "BLI_string_utils.hh"
+#include "BLI_task.hh"
 
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
@@ -44,11 +50,55 @@
 
 #include "CLG_log.h"
 
+#include "atomic_ops.h"
+
 #define SMALL -1.0e-10
 #define SELECT 1
 
 static CLG_LogRef LOG = {"bke.fcurve"};
 
+namespace blender::bke {
+
+/** Power basis coefficients of a Bezier segment, see #findzero and #berekeny. */
+struct FCurveSegment {
+  float x[4];
+  float y[4];
+  /** All keys and handles have the same value, see #fcurve_eval_keyframes_segment. */
+  bool is_flat;
+};
+
+/**
+ * Cached data for batch evaluation. It is never modified once computed, a recompute replaces it,
+ * so evaluating threads can keep using it without holding a lock.
+ */
+struct FCurveSegments {
+  /** The keyframes and the change counters the segments were computed for. */
+  const BezTriple *bezt;
+  int totvert;
+  uint64_t keys_changed_count;
+  uint64_t all_keys_changed_count;
+  /** Time of every keyframe, faster to search than the #BezTriple array. */
+  Array<float> key_times;
+  /** The Bezier segment starting at every keyframe except the last. */
+  Array<FCurveSegment> segments;
+};
+
+struct FCurveRuntime {
+  /** Incremented by #BKE_fcurve_tag_keys_changed. */
+  std::atomic<uint64_t> keys_changed_count = 0;
+  /** Protects replacing #segments. */
+  std::mutex segments_mutex;
+  std::shared_ptr<const FCurveSegments> segments;
+};
+
+/** Incremented by #BKE_fcurves_tag_keys_changed_all. */
+static std::atomic<uint64_t> all_keys_changed_count = 0;
+
+}  // namespace blender::bke
+
+using blender::bke::FCurveRuntime;
+using blender::bke::FCurveSegment;
+
 /* -------------------------------------------------------------------- */
 /** \name F-Curve Data Create
  * \{ */
@@ -82,6 +132,8 @@ void BKE_fcurve_free(FCurve *fcu)
   fcurve_free_driver(fcu);
   free_fmodifiers(&fcu->modifiers);
 
+  MEM_delete(fcu->runtime);
+
   /* Free the f-curve itself. */
   MEM_freeN(fcu);
 }
@@ -125,6 +177,7 @@ FCurve *BKE_fcurve_copy(const FCurve *fcu)
 
   fcu_d->next = fcu_d->prev = nullptr;
   fcu_d->grp = nullptr;
+  fcu_d->runtime = nullptr;
 
   /* Copy curve data. */
   fcu_d->bezt = static_cast<BezTriple *>(MEM_dupallocN(fcu_d->bezt));
@@ -1217,6 +1270,8 @@ static BezTriple *cycle_offset_triple(
 
 void BKE_fcurve_handles_recalc_ex(FCurve *fcu, eBezTriple_Flag handle_sel_flag)
 {
+  BKE_fcurve_tag_keys_changed(fcu);
+
   /* Error checking:
    * - Need at least two points.
    * - Need bezier keys.
@@ -1304,6 +1359,19 @@ void BKE_fcurve_handles_recalc(FCurve *fcu)
   BKE_fcurve_handles_recalc_ex(fcu, eBezTriple_Flag(SELECT));
 }
 
+void BKE_fcurve_tag_keys_changed(FCurve *fcu)
+{
+  if (fcu == nullptr || fcu->runtime == nullptr) {
+    return;
+  }
+  fcu->runtime->keys_changed_count++;
+}
+
+void BKE_fcurves_tag_keys_changed_all()
+{
+  blender::bke::all_keys_changed_count++;
+}
+
 void testhandles_fcurve(FCurve *fcu, eBezTriple_Flag sel_flag, const bool use_handle)
 {
   /* Only beztriples have handles (bpoints don't though). */
@@ -1328,6 +1396,7 @@ void sort_time_fcurve(FCurve *fcu)
   if (fcu->bezt == nullptr) {
     return;
   }
+  BKE_fcurve_tag_keys_changed(fcu);
 
   /* Keep adjusting order of beztriples until nothing moves (bubble-sort). */
   BezTriple *bezt;
@@ -2044,27 +2113,53 @@ static float fcurve_eval_keyframes_extrapolate(
   return endpoint_bezt->vec[1][1] - (fac * dx);
 }
 
-static float fcurve_eval_keyframes_interpolate(const FCurve *fcu,
-                                               const BezTriple *bezts,
-                                               float evaltime)
-{
-  const float eps = 1.e-8f;
-  uint a;
+/**
+ * Threshold for finding the keyframes around the evaluation time.
+ *
+ * The threshold here has the following constraints:
+ * - 0.001 is too coarse:
+ *   We get artifacts with 2cm driver movements at 1BU = 1m (see #40332).
+ *
+ * - 0.00001 is too fine:
+ *   Weird errors, like selecting the wrong keyframe range (see #39207), occur.
+ *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
+ */
+static constexpr float keyframe_search_threshold = 0.0001f;
 
-  /* Evaluation-time occurs somewhere in the middle of the curve. */
-  bool exact = false;
+static float fcurve_eval_bezier_segment(const FCurveSegment &segment, const float evaltime)
+{
+  if (segment.is_flat) {
+    return segment.y[0];
+  }
+  float opl[32];
+  /* Same as #findzero, with the coefficients computed in advance. */
+  if (!solve_cubic(
+          double(segment.x[0] - evaltime), segment.x[1], segment.x[2], segment.x[3], opl))
+  {
+    if (G.debug & G_DEBUG) {
+      printf("    ERROR: findzero() failed at %f\n", evaltime);
+    }
+    return 0.0f;
+  }
+  const float t = opl[0];
+  return segment.y[0] + t * segment.y[1] + t * t * segment.y[2] + t * t * t * segment.y[3];
+}
 
-  /* Use binary search to find appropriate keyframes...
-   *
-   * The threshold here has the following constraints:
-   * - 0.001 is too coarse:
-   *   We get artifacts with 2cm driver movements at 1BU = 1m (see #40332).
-   *
-   * - 0.00001 is too fine:
-   *   Weird errors, like selecting the wrong keyframe range (see #39207), occur.
-   *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
-   */
-  a = BKE_fcurve_bezt_binarysearch_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
+/**
+ * Evaluate the curve between the keyframes around \a evaltime.
+ *
+ * \param a: The index of the keyframe that \a evaltime is on when \a exact is true, otherwise
+ * of the first keyframe after \a evaltime.
+ * \param segments: Cached Bezier segments, may be empty.
+ */
+static float fcurve_eval_keyframes_segment(const FCurve *fcu,
+                                           const BezTriple *bezts,
+                                           const uint a,
+                                           const bool exact,
+                                           const float evaltime,
+                                           const blender::Span<FCurveSegment> segments)
+{
+  const float eps = 1.e-8f;
   const BezTriple *bezt = bezts + a;
 
   if (exact) {
@@ -2114,6 +2209,9 @@ static float fcurve_eval_keyframes_interpolate(const FCurve *fcu,
   switch (prevbezt->ipo) {
     /* Interpolation ...................................... */
     case BEZT_IPO_BEZ: {
+      if (!segments.is_empty()) {
+        return fcurve_eval_bezier_segment(segments[prevbezt - bezts], evaltime);
+      }
       float v1[2], v2[2], v3[2], v4[2], opl[32];
 
       /* Bezier interpolation. */
@@ -2307,6 +2405,19 @@ static float fcurve_eval_keyframes_interpolate(const FCurve *fcu,
   return 0.0f;
 }
 
+static float fcurve_eval_keyframes_interpolate(const FCurve *fcu,
+                                               const BezTriple *bezts,
+                                               float evaltime)
+{
+  /* Evaluation-time occurs somewhere in the middle of the curve. */
+  bool exact = false;
+
+  /* Use binary search to find appropriate keyframes... */
+  const uint a = BKE_fcurve_bezt_binarysearch_index_ex(
+      bezts, evaltime, fcu->totvert, keyframe_search_threshold, &exact);
+  return fcurve_eval_keyframes_segment(fcu, bezts, a, exact, evaltime, {});
+}
+
 /* Calculate F-Curve value for 'evaltime' using #BezTriple keyframes. */
 static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime)
 {
@@ -2496,6 +2607,175 @@ float calculate_fcurve(PathResolvedRNA *anim_rna,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name F-Curve Batch Evaluation
+ * \{ */
+
+namespace blender::bke {
+
+/** Same as the coefficients computed in #findzero and #berekeny. */
+static void bezier_coefficients(
+    const float q0, const float q1, const float q2, const float q3, float r_coefficients[4])
+{
+  r_coefficients[0] = q0;
+  r_coefficients[1] = 3.0f * (q1 - q0);
+  r_coefficients[2] = 3.0f * (q0 - 2.0f * q1 + q2);
+  r_coefficients[3] = q3 - q0 + 3.0f * (q1 - q2);
+}
+
+static std::shared_ptr<const FCurveSegments> fcurve_segments_compute(
+    const FCurve &fcu, const uint64_t keys_changed_count, const uint64_t all_changed_count)
+{
+  std::shared_ptr<FCurveSegments> data = std::make_shared<FCurveSegments>();
+  data->bezt = fcu.bezt;
+  data->totvert = fcu.totvert;
+  data->keys_changed_count = keys_changed_count;
+  data->all_keys_changed_count = all_changed_count;
+
+  const Span<BezTriple> bezts(fcu.bezt, fcu.totvert);
+  data->key_times.reinitialize(bezts.size());
+  for (const int i : bezts.index_range()) {
+    data->key_times[i] = bezts[i].vec[1][0];
+  }
+
+  data->segments.reinitialize(bezts.size() - 1);
+  for (const int i : data->segments.index_range()) {
+    const BezTriple &prevbezt = bezts[i];
+    const BezTriple &bezt = bezts[i + 1];
+    float v1[2], v2[2], v3[2], v4[2];
+    copy_v2_v2(v1, prevbezt.vec[1]);
+    copy_v2_v2(v2, prevbezt.vec[2]);
+    copy_v2_v2(v3, bezt.vec[0]);
+    copy_v2_v2(v4, bezt.vec[1]);
+
+    FCurveSegment &segment = data->segments[i];
+    segment.is_flat = fabsf(v1[1] - v4[1]) < FLT_EPSILON && fabsf(v2[1] - v3[1]) < FLT_EPSILON &&
+                      fabsf(v3[1] - v4[1]) < FLT_EPSILON;
+    BKE_fcurve_correct_bezpart(v1, v2, v3, v4);
+    bezier_coefficients(v1[0], v2[0], v3[0], v4[0], segment.x);
+    bezier_coefficients(v1[1], v2[1], v3[1], v4[1], segment.y);
+  }
+  return data;
+}
+
+/**
+ * Get the segments for the current keyframes. Edits of the keyframes are detected by the change
+ * counters and by the keyframe array being reallocated, the keys themselves are not compared.
+ */
+static std::shared_ptr<const FCurveSegments> fcurve_segments_ensure(FCurve &fcu)
+{
+  if (fcu.runtime == nullptr) {
+    FCurveRuntime *runtime = MEM_new<FCurveRuntime>(__func__);
+    if (atomic_cas_ptr((void **)&fcu.runtime, nullptr, runtime) != nullptr) {
+      /* Another thread created the runtime data already. */
+      MEM_delete(runtime);
+    }
+  }
+  FCurveRuntime &runtime = *fcu.runtime;
+  const uint64_t keys_changed_count = runtime.keys_changed_count;
+  const uint64_t all_changed_count = all_keys_changed_count;
+  std::lock_guard lock{runtime.segments_mutex};
+  const FCurveSegments *data = runtime.segments.get();
+  if (data == nullptr || data->bezt != fcu.bezt || data->totvert != fcu.totvert ||
+      data->keys_changed_count != keys_changed_count ||
+      data->all_keys_changed_count != all_changed_count)
+  {
+    runtime.segments = fcurve_segments_compute(fcu, keys_changed_count, all_changed_count);
+  }
+  return runtime.segments;
+}
+
+/**
+ * Same result as #BKE_fcurve_bezt_binarysearch_index_ex for a time between the first and the
+ * last keyframe. When evaluating sorted times, the keyframe is usually the same or the next one
+ * as for the previous time, so the previous result is checked first.
+ */
+static int find_keyframe_index(const Span<float> key_times,
+                               const float evaltime,
+                               const int hint,
+                               bool &r_exact)
+{
+  const auto is_before = [&](const float time) {
+    return time < evaltime && !IS_EQT(evaltime, time, keyframe_search_threshold);
+  };
+  int index = -1;
+  for (const int i : {hint, hint + 1}) {
+    if (i > 0 && i < key_times.size() && is_before(key_times[i - 1]) && !is_before(key_times[i]))
+    {
+      index = i;
+      break;
+    }
+  }
+  if (index == -1) {
+    index = std::partition_point(key_times.begin(), key_times.end(), is_before) -
+            key_times.begin();
+  }
+  r_exact = IS_EQT(evaltime, key_times[index], keyframe_search_threshold);
+  return index;
+}
+
+static float fcurve_eval_keyframes_cached(FCurve &fcu,
+                                          const FCurveSegments &data,
+                                          const float evaltime,
+                                          int &hint)
+{
+  const Span<float> key_times = data.key_times;
+  float value;
+  if (evaltime <= key_times.first()) {
+    value = fcurve_eval_keyframes_extrapolate(&fcu, fcu.bezt, evaltime, 0, +1);
+  }
+  else if (key_times.last() <= evaltime) {
+    value = fcurve_eval_keyframes_extrapolate(&fcu, fcu.bezt, evaltime, fcu.totvert - 1, -1);
+  }
+  else {
+    bool exact;
+    hint = find_keyframe_index(key_times, evaltime, hint, exact);
+    value = fcurve_eval_keyframes_segment(
+        &fcu, fcu.bezt, uint(hint), exact, evaltime, data.segments);
+  }
+  /* See #evaluate_fcurve_ex. */
+  if (fcu.flag & FCURVE_INT_VALUES) {
+    value = floorf(value + 0.5f);
+  }
+  return value;
+}
+
+void evaluate_fcurve_times(FCurve &fcu, const Span<float> times, MutableSpan<float> r_values)
+{
+  BLI_assert(times.size() == r_values.size());
+  /* Modifiers can change the time and the value, use the regular evaluation for simplicity. */
+  if (fcu.bezt == nullptr || fcu.totvert == 0 || !BLI_listbase_is_empty(&fcu.modifiers)) {
+    for (const int i : times.index_range()) {
+      r_values[i] = evaluate_fcurve_only_curve(&fcu, times[i]);
+    }
+    return;
+  }
+
+  const std::shared_ptr<const FCurveSegments> data = fcurve_segments_ensure(fcu);
+  threading::parallel_for(times.index_range(), 1024, [&](const IndexRange range) {
+    int hint = 0;
+    for (const int i : range) {
+      r_values[i] = fcurve_eval_keyframes_cached(fcu, *data, times[i], hint);
+    }
+  });
+}
+
+void evaluate_fcurves(const Span<FCurve *> fcurves,
+                      const float evaltime,
+                      MutableSpan<float> r_values)
+{
+  BLI_assert(fcurves.size() == r_values.size());
+  threading::parallel_for(fcurves.index_range(), 64, [&](const IndexRange range) {
+    for (const int i : range) {
+      evaluate_fcurve_times(*fcurves[i], {&evaltime, 1}, r_values.slice(i, 1));
+    }
+  });
+}
+
+}  // namespace blender::bke
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name F-Curve - .blend file API
  * \{ */
@@ -2633,6 +2913,8 @@ void BKE_fcurve_blend_read_data(BlendDataReader *reader, ListBase *fcurves)
     /* rna path */
     BLO_read_data_address(reader, &fcu->rna_path);
 
+    fcu->runtime = nullptr;
+
     /* group */
     BLO_read_data_address(reader, &fcu->grp);
 
@@ -13,7 +13,9 @@
 
 #include "DNA_anim_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_timeit.hh"
 
 namespace blender::bke::tests {
 using namespace blender::animrig;
@@ -121,6 +123,187 @@ TEST(evaluate_fcurve, InterpolationBezier)
   BKE_fcurve_free(fcu);
 }
 
+/** Curve with a keyframe on every frame, using different interpolation modes. */
+static FCurve *testcurve_mixed_interpolation(const int keys_num)
+{
+  FCurve *fcu = BKE_fcurve_create();
+  const KeyframeSettings settings = get_keyframe_settings(false);
+  for (const int i : IndexRange(keys_num)) {
+    insert_vert_fcurve(fcu, {float(i), float((i * 7) % 11)}, settings, INSERTKEY_FAST);
+  }
+  const eBezTriple_Interpolation interpolations[] = {
+      BEZT_IPO_BEZ, BEZT_IPO_BEZ, BEZT_IPO_LIN, BEZT_IPO_CONST, BEZT_IPO_BEZ, BEZT_IPO_ELASTIC};
+  for (const int i : IndexRange(keys_num)) {
+    fcu->bezt[i].ipo = interpolations[i % ARRAY_SIZE(interpolations)];
+  }
+  BKE_fcurve_handles_recalc(fcu);
+  return fcu;
+}
+
+TEST(evaluate_fcurve_times, MatchesEvaluateFCurve)
+{
+  FCurve *fcu = testcurve_mixed_interpolation(50);
+
+  Array<float> times(1000);
+  for (const int i : times.index_range()) {
+    times[i] = -2.0f + float(i) * 0.0537f;
+  }
+  /* Times close to keyframes, see #39207. */
+  times[10] = 3.0f - 0.00008f;
+  times[11] = 3.0f + 0.00008f;
+  Array<float> values(times.size());
+  evaluate_fcurve_times(*fcu, times, values);
+  for (const int i : times.index_range()) {
+    EXPECT_FLOAT_EQ(values[i], evaluate_fcurve(fcu, times[i])) << "time " << times[i];
+  }
+
+  /* Unsorted times. */
+  std::reverse(times.begin(), times.end());
+  evaluate_fcurve_times(*fcu, times, values);
+  for (const int i : times.index_range()) {
+    EXPECT_FLOAT_EQ(values[i], evaluate_fcurve(fcu, times[i])) << "time " << times[i];
+  }
+
+  BKE_fcurve_free(fcu);
+}
+
+TEST(evaluate_fcurve_times, KeysChanged)
+{
+  FCurve *fcu = testcurve_mixed_interpolation(10);
+
+  const Array<float> times = {0.5f, 4.25f, 8.75f};
+  Array<float> values(times.size());
+  evaluate_fcurve_times(*fcu, times, values);
+  EXPECT_FLOAT_EQ(values[1], evaluate_fcurve(fcu, 4.25f));
+
+  fcu->bezt[4].vec[1][1] += 5.0f;
+  BKE_fcurve_handles_recalc(fcu);
+  evaluate_fcurve_times(*fcu, times, values);
+  EXPECT_FLOAT_EQ(values[1], evaluate_fcurve(fcu, 4.25f));
+
+  /* Reallocated keyframes are detected without tagging. */
+  const KeyframeSettings settings = get_keyframe_settings(false);
+  insert_vert_fcurve(fcu, {20.0f, 3.0f}, settings, INSERTKEY_FAST);
+  evaluate_fcurve_times(*fcu, times, values);
+  EXPECT_FLOAT_EQ(values[2], evaluate_fcurve(fcu, 8.75f));
+
+  /* Replacing a key without recalculating the handles. */
+  insert_vert_fcurve(fcu, {9.0f, -4.0f}, settings, INSERTKEY_FAST);
+  evaluate_fcurve_times(*fcu, times, values);
+  EXPECT_FLOAT_EQ(values[2], evaluate_fcurve(fcu, 8.75f));
+
+  /* Keys edited in place, tagged like the RNA update of keyframe properties does. */
+  fcu->bezt[0].vec[2][1] += 2.0f;
+  fcu->bezt[4].ipo = BEZT_IPO_LIN;
+  BKE_fcurves_tag_keys_changed_all();
+  evaluate_fcurve_times(*fcu, times, values);
+  EXPECT_FLOAT_EQ(values[0], evaluate_fcurve(fcu, 0.5f));
+  EXPECT_FLOAT_EQ(values[1], evaluate_fcurve(fcu, 4.25f));
+
+  /* Keys edited in place and tagged explicitly. */
+  fcu->bezt[5].vec[0][1] -= 3.0f;
+  BKE_fcurve_tag_keys_changed(fcu);
+  evaluate_fcurve_times(*fcu, times, values);
+  EXPECT_FLOAT_EQ(values[1], evaluate_fcurve(fcu, 4.25f));
+
+  /* The copy does not share the cache. */
+  FCurve *fcu_copy = BKE_fcurve_copy(fcu);
+  evaluate_fcurve_times(*fcu_copy, times, values);
+  EXPECT_FLOAT_EQ(values[0], evaluate_fcurve(fcu, 0.5f));
+
+  BKE_fcurve_free(fcu_copy);
+  BKE_fcurve_free(fcu);
+}
+
+TEST(evaluate_fcurves, ManyCurves)
+{
+  Array<FCurve *> fcurves(100);
+  for (const int i : fcurves.index_range()) {
+    fcurves[i] = testcurve_mixed_interpolation(i + 1);
+  }
+  /* Curves with modifiers use the regular evaluation. */
+  add_fmodifier(&fcurves[3]->modifiers, FMODIFIER_TYPE_NOISE, fcurves[3]);
+
+  Array<float> values(fcurves.size());
+  for (const float time : {-1.0f, 0.0f, 12.3f, 47.5f, 150.0f}) {
+    evaluate_fcurves(fcurves, time, values);
+    for (const int i : fcurves.index_range()) {
+      EXPECT_FLOAT_EQ(values[i], evaluate_fcurve(fcurves[i], time));
+    }
+  }
+
+  for (FCurve *fcu : fcurves) {
+    BKE_fcurve_free(fcu);
+  }
+}
+
+/**
+ * Set this to 1 to activate the benchmarks. They are disabled by default, because they print
+ * timings.
+ */
+#if 0
+TEST(evaluate_fcurve_times, Benchmark)
+{
+  FCurve *fcu = testcurve_mixed_interpolation(2000);
+  Array<float> times(200000);
+  for (const int i : times.index_range()) {
+    times[i] = float(i) / 100.0f;
+  }
+  Array<float> values(times.size());
+  Array<float> values_expected(times.size());
+
+  for ([[maybe_unused]] const int iteration : IndexRange(3)) {
+    {
+      SCOPED_TIMER("evaluate_fcurve");
+      for (const int i : times.index_range()) {
+        values_expected[i] = evaluate_fcurve(fcu, times[i]);
+      }
+    }
+    {
+      SCOPED_TIMER("evaluate_fcurve_times");
+      evaluate_fcurve_times(*fcu, times, values);
+    }
+  }
+  for (const int i : times.index_range()) {
+    EXPECT_FLOAT_EQ(values[i], values_expected[i]);
+  }
+
+  BKE_fcurve_free(fcu);
+}
+
+TEST(evaluate_fcurves, Benchmark)
+{
+  Array<FCurve *> fcurves(10000);
+  for (const int i : fcurves.index_range()) {
+    fcurves[i] = testcurve_mixed_interpolation(100 + i % 50);
+  }
+  Array<float> values(fcurves.size());
+  Array<float> values_expected(fcurves.size());
+
+  for ([[maybe_unused]] const int iteration : IndexRange(3)) {
+    for (const float time : {10.3f, 50.5f, 99.9f}) {
+      {
+        SCOPED_TIMER("evaluate_fcurve");
+        for (const int i : fcurves.index_range()) {
+          values_expected[i] = evaluate_fcurve(fcurves[i], time);
+        }
+      }
+      {
+        SCOPED_TIMER("evaluate_fcurves");
+        evaluate_fcurves(fcurves, time, values);
+      }
+      for (const int i : fcurves.index_range()) {
+        EXPECT_FLOAT_EQ(values[i], values_expected[i]);
+      }
+    }
+  }
+
+  for (FCurve *fcu : fcurves) {
+    BKE_fcurve_free(fcu);
+  }
+}
+#endif
+
 TEST(evaluate_fcurve, InterpolationBounce)
 {
   FCurve *fcu = BKE_fcurve_create();
@@ -358,9 +358,15 @@ static void mesh_blend_read_data(BlendDataReader *reader, ID *id)
   mesh->runtime = new blender::bke::MeshRuntime();
 
   if (mesh->face_offset_indices) {
-    BLO_read_int32_array(reader, mesh->faces_num + 1, &mesh->face_offset_indices);
-    mesh->runtime->face_offsets_sharing_info = blender::implicit_sharing::info_for_mem_free(
-        mesh->face_offset_indices);
+    mesh->runtime->face_offsets_sharing_info = BLO_read_data_address_shared(
+        reader, reinterpret_cast<void **>(&mesh->face_offset_indices));
+    if (mesh->runtime->face_offsets_sharing_info == nullptr) {
+      if (BLO_read_requires_endian_switch(reader)) {
+        BLI_endian_switch_int32_array(mesh->face_offset_indices, mesh->faces_num + 1);
+      }
+      mesh->runtime->face_offsets_sharing_info = blender::implicit_sharing::info_for_mem_free(
+          mesh->face_offset_indices);
+    }
   }
 
   if (mesh->mselect == nullptr) {
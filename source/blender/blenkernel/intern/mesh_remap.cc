@@ -17,6 +17,7 @@
 #include "BLI_array.hh"
 #include "BLI_astar.h"
 #include "BLI_bit_vector.hh"
+#include "BLI_enumerable_thread_specific.hh"
 #include "BLI_math_geom.h"
 #include "BLI_math_matrix.h"
 #include "BLI_math_solvers.h"
@@ -25,6 +26,7 @@
 #include "BLI_memarena.h"
 #include "BLI_polyfill_2d.h"
 #include "BLI_rand.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_bvhutils.hh"
@@ -324,7 +326,38 @@ void BKE_mesh_remap_free(MeshPairRemap *map)
   map->mem = nullptr;
 }
 
+/**
+ * Items of a map can be defined from multiple threads, as long as every thread uses its own
+ * memory arena. The thread-local arenas are merged into the arena of the map at the end.
+ */
+class MeshRemapThreadArenas : blender::NonCopyable, blender::NonMovable {
+ private:
+  MeshPairRemap *map_;
+  blender::threading::EnumerableThreadSpecific<MemArena *> arenas_;
+
+ public:
+  MeshRemapThreadArenas(MeshPairRemap *map)
+      : map_(map),
+        arenas_([]() { return BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, "mesh_remap_thread"); })
+  {
+  }
+
+  ~MeshRemapThreadArenas()
+  {
+    for (MemArena *mem : arenas_) {
+      BLI_memarena_merge(map_->mem, mem);
+      BLI_memarena_free(mem);
+    }
+  }
+
+  MemArena *local()
+  {
+    return arenas_.local();
+  }
+};
+
 static void mesh_remap_item_define(MeshPairRemap *map,
+                                   MemArena *mem,
                                    const int index,
                                    const float /*hit_dist*/,
                                    const int island,
@@ -333,7 +366,6 @@ static void mesh_remap_item_define(MeshPairRemap *map,
                                    const float *weights_src)
 {
   MeshPairRemapItem *mapit = &map->items[index];
-  MemArena *mem = map->mem;
 
   if (sources_num) {
     mapit->sources_num = sources_num;
@@ -353,6 +385,18 @@ static void mesh_remap_item_define(MeshPairRemap *map,
   mapit->island = island;
 }
 
+static void mesh_remap_item_define(MeshPairRemap *map,
+                                   const int index,
+                                   const float hit_dist,
+                                   const int island,
+                                   const int sources_num,
+                                   const int *indices_src,
+                                   const float *weights_src)
+{
+  mesh_remap_item_define(
+      map, map->mem, index, hit_dist, island, sources_num, indices_src, weights_src);
+}
+
 void BKE_mesh_remap_item_define_invalid(MeshPairRemap *map, const int index)
 {
   mesh_remap_item_define(map, index, FLT_MAX, 0, 0, nullptr, nullptr);
@@ -446,6 +490,9 @@ struct IslandResult {
 /* Will be enough in 99% of cases. */
 #define MREMAP_DEFAULT_BUFSIZE 32
 
+/* Number of destination elements handled by each task when computing a map in parallel. */
+#define MREMAP_GRAIN_SIZE 512
+
 void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
                                          const SpaceTransform *space_transform,
                                          const float max_dist,
@@ -456,96 +503,118 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
                                          Mesh *me_dst,
                                          MeshPairRemap *r_map)
 {
+  using namespace blender;
   const float full_weight = 1.0f;
   const float max_dist_sq = max_dist * max_dist;
-  int i;
 
   BLI_assert(mode & MREMAP_MODE_VERT);
 
   BKE_mesh_remap_init(r_map, numverts_dst);
+  MeshRemapThreadArenas arenas(r_map);
 
   if (mode == MREMAP_MODE_TOPOLOGY) {
     BLI_assert(numverts_dst == me_src->verts_num);
-    for (i = 0; i < numverts_dst; i++) {
-      mesh_remap_item_define(r_map, i, FLT_MAX, 0, 1, &i, &full_weight);
-    }
+    threading::parallel_for(IndexRange(numverts_dst), 4096, [&](const IndexRange range) {
+      MemArena *mem = arenas.local();
+      for (const int64_t vert : range) {
+        const int i = int(vert);
+        mesh_remap_item_define(r_map, mem, i, FLT_MAX, 0, 1, &i, &full_weight);
+      }
+    });
   }
   else {
     BVHTreeFromMesh treedata = {nullptr};
-    BVHTreeNearest nearest = {0};
-    BVHTreeRayHit rayhit = {0};
-    float hit_dist;
-    float tmp_co[3], tmp_no[3];
 
     if (mode == MREMAP_MODE_VERT_NEAREST) {
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
-      nearest.index = -1;
 
-      for (i = 0; i < numverts_dst; i++) {
-        copy_v3_v3(tmp_co, vert_positions_dst[i]);
+      threading::parallel_for(
+          IndexRange(numverts_dst), MREMAP_GRAIN_SIZE, [&](const IndexRange range) {
+            MemArena *mem = arenas.local();
+            BVHTreeNearest nearest = {0};
+            float hit_dist;
+            float tmp_co[3];
+            nearest.index = -1;
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+            for (const int64_t vert : range) {
+              const int i = int(vert);
+              copy_v3_v3(tmp_co, vert_positions_dst[i]);
 
-        if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-        {
-          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &nearest.index, &full_weight);
-        }
-        else {
-          /* No source for this dest vertex! */
-          BKE_mesh_remap_item_define_invalid(r_map, i);
-        }
-      }
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+              }
+
+              if (mesh_remap_bvhtree_query_nearest(
+                      &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                mesh_remap_item_define(
+                    r_map, mem, i, hit_dist, 0, 1, &nearest.index, &full_weight);
+              }
+              else {
+                /* No source for this dest vertex! */
+                BKE_mesh_remap_item_define_invalid(r_map, i);
+              }
+            }
+          });
     }
     else if (ELEM(mode, MREMAP_MODE_VERT_EDGE_NEAREST, MREMAP_MODE_VERT_EDGEINTERP_NEAREST)) {
       const blender::Span<blender::int2> edges_src = me_src->edges();
       const blender::Span<blender::float3> positions_src = me_src->vert_positions();
 
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
-      nearest.index = -1;
 
-      for (i = 0; i < numverts_dst; i++) {
-        copy_v3_v3(tmp_co, vert_positions_dst[i]);
+      threading::parallel_for(
+          IndexRange(numverts_dst), MREMAP_GRAIN_SIZE, [&](const IndexRange range) {
+            MemArena *mem = arenas.local();
+            BVHTreeNearest nearest = {0};
+            float hit_dist;
+            float tmp_co[3];
+            nearest.index = -1;
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+            for (const int64_t vert : range) {
+              const int i = int(vert);
+              copy_v3_v3(tmp_co, vert_positions_dst[i]);
 
-        if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-        {
-          const blender::int2 &edge = edges_src[nearest.index];
-          const float *v1cos = positions_src[edge[0]];
-          const float *v2cos = positions_src[edge[1]];
-
-          if (mode == MREMAP_MODE_VERT_EDGE_NEAREST) {
-            const float dist_v1 = len_squared_v3v3(tmp_co, v1cos);
-            const float dist_v2 = len_squared_v3v3(tmp_co, v2cos);
-            const int index = (dist_v1 > dist_v2) ? edge[1] : edge[0];
-            mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &index, &full_weight);
-          }
-          else if (mode == MREMAP_MODE_VERT_EDGEINTERP_NEAREST) {
-            int indices[2];
-            float weights[2];
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+              }
 
-            indices[0] = edge[0];
-            indices[1] = edge[1];
+              if (mesh_remap_bvhtree_query_nearest(
+                      &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                const blender::int2 &edge = edges_src[nearest.index];
+                const float *v1cos = positions_src[edge[0]];
+                const float *v2cos = positions_src[edge[1]];
+
+                if (mode == MREMAP_MODE_VERT_EDGE_NEAREST) {
+                  const float dist_v1 = len_squared_v3v3(tmp_co, v1cos);
+                  const float dist_v2 = len_squared_v3v3(tmp_co, v2cos);
+                  const int index = (dist_v1 > dist_v2) ? edge[1] : edge[0];
+                  mesh_remap_item_define(r_map, mem, i, hit_dist, 0, 1, &index, &full_weight);
+                }
+                else if (mode == MREMAP_MODE_VERT_EDGEINTERP_NEAREST) {
+                  int indices[2];
+                  float weights[2];
 
-            /* Weight is inverse of point factor here... */
-            weights[0] = line_point_factor_v3(tmp_co, v2cos, v1cos);
-            CLAMP(weights[0], 0.0f, 1.0f);
-            weights[1] = 1.0f - weights[0];
+                  indices[0] = edge[0];
+                  indices[1] = edge[1];
 
-            mesh_remap_item_define(r_map, i, hit_dist, 0, 2, indices, weights);
-          }
-        }
-        else {
-          /* No source for this dest vertex! */
-          BKE_mesh_remap_item_define_invalid(r_map, i);
-        }
-      }
+                  /* Weight is inverse of point factor here... */
+                  weights[0] = line_point_factor_v3(tmp_co, v2cos, v1cos);
+                  CLAMP(weights[0], 0.0f, 1.0f);
+                  weights[1] = 1.0f - weights[0];
+
+                  mesh_remap_item_define(r_map, mem, i, hit_dist, 0, 2, indices, weights);
+                }
+              }
+              else {
+                /* No source for this dest vertex! */
+                BKE_mesh_remap_item_define_invalid(r_map, i);
+              }
+            }
+          });
     }
     else if (ELEM(mode,
                   MREMAP_MODE_VERT_FACE_NEAREST,
@@ -558,108 +627,117 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
       const blender::Span<blender::float3> vert_normals_dst = me_dst->vert_normals();
       const blender::Span<int> tri_faces = me_src->corner_tri_faces();
 
-      size_t tmp_buff_size = MREMAP_DEFAULT_BUFSIZE;
-      float(*vcos)[3] = static_cast<float(*)[3]>(
-          MEM_mallocN(sizeof(*vcos) * tmp_buff_size, __func__));
-      int *indices = static_cast<int *>(MEM_mallocN(sizeof(*indices) * tmp_buff_size, __func__));
-      float *weights = static_cast<float *>(
-          MEM_mallocN(sizeof(*weights) * tmp_buff_size, __func__));
-
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2);
 
-      if (mode == MREMAP_MODE_VERT_POLYINTERP_VNORPROJ) {
-        for (i = 0; i < numverts_dst; i++) {
-          copy_v3_v3(tmp_co, vert_positions_dst[i]);
-          copy_v3_v3(tmp_no, vert_normals_dst[i]);
+      threading::parallel_for(
+          IndexRange(numverts_dst), MREMAP_GRAIN_SIZE, [&](const IndexRange range) {
+            MemArena *mem = arenas.local();
+            BVHTreeNearest nearest = {0};
+            BVHTreeRayHit rayhit = {0};
+            float hit_dist;
+            float tmp_co[3], tmp_no[3];
+            nearest.index = -1;
 
-          /* Convert the vertex to tree coordinates, if needed. */
-          if (space_transform) {
-            BLI_space_transform_apply(space_transform, tmp_co);
-            BLI_space_transform_apply_normal(space_transform, tmp_no);
-          }
+            size_t tmp_buff_size = MREMAP_DEFAULT_BUFSIZE;
+            float(*vcos)[3] = static_cast<float(*)[3]>(
+                MEM_mallocN(sizeof(*vcos) * tmp_buff_size, __func__));
+            int *indices = static_cast<int *>(
+                MEM_mallocN(sizeof(*indices) * tmp_buff_size, __func__));
+            float *weights = static_cast<float *>(
+                MEM_mallocN(sizeof(*weights) * tmp_buff_size, __func__));
 
-          if (mesh_remap_bvhtree_query_raycast(
-                  &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist))
-          {
-            const int face_index = tri_faces[rayhit.index];
-            const int sources_num = mesh_remap_interp_face_data_get(faces_src[face_index],
-                                                                    corner_verts_src,
-                                                                    positions_src,
-                                                                    rayhit.co,
-                                                                    &tmp_buff_size,
-                                                                    &vcos,
-                                                                    false,
-                                                                    &indices,
-                                                                    &weights,
-                                                                    true,
-                                                                    nullptr);
-
-            mesh_remap_item_define(r_map, i, hit_dist, 0, sources_num, indices, weights);
-          }
-          else {
-            /* No source for this dest vertex! */
-            BKE_mesh_remap_item_define_invalid(r_map, i);
-          }
-        }
-      }
-      else {
-        nearest.index = -1;
+            for (const int64_t vert : range) {
+              const int i = int(vert);
+              copy_v3_v3(tmp_co, vert_positions_dst[i]);
 
-        for (i = 0; i < numverts_dst; i++) {
-          copy_v3_v3(tmp_co, vert_positions_dst[i]);
+              if (mode == MREMAP_MODE_VERT_POLYINTERP_VNORPROJ) {
+                copy_v3_v3(tmp_no, vert_normals_dst[i]);
 
-          /* Convert the vertex to tree coordinates, if needed. */
-          if (space_transform) {
-            BLI_space_transform_apply(space_transform, tmp_co);
-          }
+                /* Convert the vertex to tree coordinates, if needed. */
+                if (space_transform) {
+                  BLI_space_transform_apply(space_transform, tmp_co);
+                  BLI_space_transform_apply_normal(space_transform, tmp_no);
+                }
 
-          if (mesh_remap_bvhtree_query_nearest(
-                  &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-          {
-            const int face_index = tri_faces[nearest.index];
-
-            if (mode == MREMAP_MODE_VERT_FACE_NEAREST) {
-              int index;
-              mesh_remap_interp_face_data_get(faces_src[face_index],
-                                              corner_verts_src,
-                                              positions_src,
-                                              nearest.co,
-                                              &tmp_buff_size,
-                                              &vcos,
-                                              false,
-                                              &indices,
-                                              &weights,
-                                              false,
-                                              &index);
+                if (mesh_remap_bvhtree_query_raycast(
+                        &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist))
+                {
+                  const int face_index = tri_faces[rayhit.index];
+                  const int sources_num = mesh_remap_interp_face_data_get(faces_src[face_index],
+                                                                          corner_verts_src,
+                                                                          positions_src,
+                                                                          rayhit.co,
+                                                                          &tmp_buff_size,
+                                                                          &vcos,
+                                                                          false,
+                                                                          &indices,
+                                                                          &weights,
+                                                                          true,
+                                                                          nullptr);
+
+                  mesh_remap_item_define(
+                      r_map, mem, i, hit_dist, 0, sources_num, indices, weights);
+                }
+                else {
+                  /* No source for this dest vertex! */
+                  BKE_mesh_remap_item_define_invalid(r_map, i);
+                }
+                continue;
+              }
 
-              mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &index, &full_weight);
-            }
-            else if (mode == MREMAP_MODE_VERT_POLYINTERP_NEAREST) {
-              const int sources_num = mesh_remap_interp_face_data_get(faces_src[face_index],
-                                                                      corner_verts_src,
-                                                                      positions_src,
-                                                                      nearest.co,
-                                                                      &tmp_buff_size,
-                                                                      &vcos,
-                                                                      false,
-                                                                      &indices,
-                                                                      &weights,
-                                                                      true,
-                                                                      nullptr);
-
-              mesh_remap_item_define(r_map, i, hit_dist, 0, sources_num, indices, weights);
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+              }
+
+              if (mesh_remap_bvhtree_query_nearest(
+                      &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                const int face_index = tri_faces[nearest.index];
+
+                if (mode == MREMAP_MODE_VERT_FACE_NEAREST) {
+                  int index;
+                  mesh_remap_interp_face_data_get(faces_src[face_index],
+                                                  corner_verts_src,
+                                                  positions_src,
+                                                  nearest.co,
+                                                  &tmp_buff_size,
+                                                  &vcos,
+                                                  false,
+                                                  &indices,
+                                                  &weights,
+                                                  false,
+                                                  &index);
+
+                  mesh_remap_item_define(r_map, mem, i, hit_dist, 0, 1, &index, &full_weight);
+                }
+                else if (mode == MREMAP_MODE_VERT_POLYINTERP_NEAREST) {
+                  const int sources_num = mesh_remap_interp_face_data_get(faces_src[face_index],
+                                                                          corner_verts_src,
+                                                                          positions_src,
+                                                                          nearest.co,
+                                                                          &tmp_buff_size,
+                                                                          &vcos,
+                                                                          false,
+                                                                          &indices,
+                                                                          &weights,
+                                                                          true,
+                                                                          nullptr);
+
+                  mesh_remap_item_define(
+                      r_map, mem, i, hit_dist, 0, sources_num, indices, weights);
+                }
+              }
+              else {
+                /* No source for this dest vertex! */
+                BKE_mesh_remap_item_define_invalid(r_map, i);
+              }
             }
-          }
-          else {
-            /* No source for this dest vertex! */
-            BKE_mesh_remap_item_define_invalid(r_map, i);
-          }
-        }
-      }
 
-      MEM_freeN(vcos);
-      MEM_freeN(indices);
-      MEM_freeN(weights);
+            MEM_freeN(vcos);
+            MEM_freeN(indices);
+            MEM_freeN(weights);
+          });
     }
     else {
       CLOG_WARN(&LOG, "Unsupported mesh-to-mesh vertex mapping mode (%d)!", mode);
@@ -690,21 +768,25 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
   BLI_assert(mode & MREMAP_MODE_EDGE);
 
   BKE_mesh_remap_init(r_map, numedges_dst);
+  MeshRemapThreadArenas arenas(r_map);
 
   if (mode == MREMAP_MODE_TOPOLOGY) {
     BLI_assert(numedges_dst == me_src->edges_num);
-    for (i = 0; i < numedges_dst; i++) {
-      mesh_remap_item_define(r_map, i, FLT_MAX, 0, 1, &i, &full_weight);
-    }
+    threading::parallel_for(IndexRange(numedges_dst), 4096, [&](const IndexRange range) {
+      MemArena *mem = arenas.local();
+      for (const int64_t edge : range) {
+        const int index = int(edge);
+        mesh_remap_item_define(r_map, mem, index, FLT_MAX, 0, 1, &index, &full_weight);
+      }
+    });
   }
   else {
     BVHTreeFromMesh treedata = {nullptr};
-    BVHTreeNearest nearest = {0};
-    BVHTreeRayHit rayhit = {0};
-    float hit_dist;
-    float tmp_co[3], tmp_no[3];
 
     if (mode == MREMAP_MODE_EDGE_VERT_NEAREST) {
+      BVHTreeNearest nearest = {0};
+      float hit_dist;
+      float tmp_co[3];
       const int num_verts_src = me_src->verts_num;
       const blender::Span<blender::int2> edges_src = me_src->edges();
       const blender::Span<blender::float3> positions_src = me_src->vert_positions();
@@ -829,28 +911,44 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
     }
     else if (mode == MREMAP_MODE_EDGE_NEAREST) {
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
-      nearest.index = -1;
 
-      for (i = 0; i < numedges_dst; i++) {
-        interp_v3_v3v3(tmp_co,
-                       vert_positions_dst[edges_dst[i][0]],
-                       vert_positions_dst[edges_dst[i][1]],
-                       0.5f);
+      threading::parallel_for(
+          IndexRange(numedges_dst), MREMAP_GRAIN_SIZE, [&](const IndexRange range) {
+            MemArena *mem = arenas.local();
+            BVHTreeNearest nearest = {0};
+            float hit_dist;
+            float tmp_co[3];
+            nearest.index = -1;
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+            for (const int64_t edge : range) {
+              interp_v3_v3v3(tmp_co,
+                             vert_positions_dst[edges_dst[edge][0]],
+                             vert_positions_dst[edges_dst[edge][1]],
+                             0.5f);
 
-        if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-        {
-          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &nearest.index, &full_weight);
-        }
-        else {
-          /* No source for this dest edge! */
-          BKE_mesh_remap_item_define_invalid(r_map, i);
-        }
-      }
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+              }
+
+              if (mesh_remap_bvhtree_query_nearest(
+                      &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                mesh_remap_item_define(r_map,
+                                       mem,
+                                       int(edge),
+                                       hit_dist,
+                                       0,
+                                       1,
+                                       &nearest.index,
+                                       &full_weight);
+              }
+              else {
+                /* No source for this dest edge! */
+                BKE_mesh_remap_item_define_invalid(r_map, int(edge));
+              }
+            }
+          });
     }
     else if (mode == MREMAP_MODE_EDGE_POLY_NEAREST) {
       const blender::Span<blender::int2> edges_src = me_src->edges();
@@ -861,51 +959,64 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
 
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2);
 
-      for (i = 0; i < numedges_dst; i++) {
-        interp_v3_v3v3(tmp_co,
-                       vert_positions_dst[edges_dst[i][0]],
-                       vert_positions_dst[edges_dst[i][1]],
-                       0.5f);
+      threading::parallel_for(
+          IndexRange(numedges_dst), MREMAP_GRAIN_SIZE, [&](const IndexRange range) {
+            MemArena *mem = arenas.local();
+            BVHTreeNearest nearest = {0};
+            float hit_dist;
+            float tmp_co[3];
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+            for (const int64_t edge : range) {
+              interp_v3_v3v3(tmp_co,
+                             vert_positions_dst[edges_dst[edge][0]],
+                             vert_positions_dst[edges_dst[edge][1]],
+                             0.5f);
 
-        if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-        {
-          const int face_index = tri_faces[nearest.index];
-          const blender::IndexRange face_src = faces_src[face_index];
-          const int *corner_edge_src = &corner_edges_src[face_src.start()];
-          int nloops = int(face_src.size());
-          float best_dist_sq = FLT_MAX;
-          int best_eidx_src = -1;
-
-          for (; nloops--; corner_edge_src++) {
-            const blender::int2 &edge_src = edges_src[*corner_edge_src];
-            const float *co1_src = positions_src[edge_src[0]];
-            const float *co2_src = positions_src[edge_src[1]];
-            float co_src[3];
-            float dist_sq;
-
-            interp_v3_v3v3(co_src, co1_src, co2_src, 0.5f);
-            dist_sq = len_squared_v3v3(tmp_co, co_src);
-            if (dist_sq < best_dist_sq) {
-              best_dist_sq = dist_sq;
-              best_eidx_src = *corner_edge_src;
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+              }
+
+              if (mesh_remap_bvhtree_query_nearest(
+                      &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                const int face_index = tri_faces[nearest.index];
+                const blender::IndexRange face_src = faces_src[face_index];
+                const int *corner_edge_src = &corner_edges_src[face_src.start()];
+                int nloops = int(face_src.size());
+                float best_dist_sq = FLT_MAX;
+                int best_eidx_src = -1;
+
+                for (; nloops--; corner_edge_src++) {
+                  const blender::int2 &edge_src = edges_src[*corner_edge_src];
+                  const float *co1_src = positions_src[edge_src[0]];
+                  const float *co2_src = positions_src[edge_src[1]];
+                  float co_src[3];
+                  float dist_sq;
+
+                  interp_v3_v3v3(co_src, co1_src, co2_src, 0.5f);
+                  dist_sq = len_squared_v3v3(tmp_co, co_src);
+                  if (dist_sq < best_dist_sq) {
+                    best_dist_sq = dist_sq;
+                    best_eidx_src = *corner_edge_src;
+                  }
+                }
+                if (best_eidx_src >= 0) {
+                  mesh_remap_item_define(
+                      r_map, mem, int(edge), hit_dist, 0, 1, &best_eidx_src, &full_weight);
+                }
+              }
+              else {
+                /* No source for this dest edge! */
+                BKE_mesh_remap_item_define_invalid(r_map, int(edge));
+              }
             }
-          }
-          if (best_eidx_src >= 0) {
-            mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &best_eidx_src, &full_weight);
-          }
-        }
-        else {
-          /* No source for this dest edge! */
-          BKE_mesh_remap_item_define_invalid(r_map, i);
-        }
-      }
+          });
     }
     else if (mode == MREMAP_MODE_EDGE_EDGEINTERP_VNORPROJ) {
+      BVHTreeRayHit rayhit = {0};
+      float hit_dist;
+      float tmp_co[3], tmp_no[3];
       const int num_rays_min = 5, num_rays_max = 100;
       const int numedges_src = me_src->edges_num;
 
@@ -1230,21 +1341,22 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
   BLI_assert((islands_precision_src >= 0.0f) && (islands_precision_src <= 1.0f));
 
   BKE_mesh_remap_init(r_map, numloops_dst);
+  MeshRemapThreadArenas arenas(r_map);
 
   if (mode == MREMAP_MODE_TOPOLOGY) {
     /* In topology mapping, we assume meshes are identical, islands included! */
     BLI_assert(numloops_dst == me_src->corners_num);
-    for (int i = 0; i < numloops_dst; i++) {
-      mesh_remap_item_define(r_map, i, FLT_MAX, 0, 1, &i, &full_weight);
-    }
+    threading::parallel_for(IndexRange(numloops_dst), 4096, [&](const IndexRange range) {
+      MemArena *mem = arenas.local();
+      for (const int64_t corner : range) {
+        const int i = int(corner);
+        mesh_remap_item_define(r_map, mem, i, FLT_MAX, 0, 1, &i, &full_weight);
+      }
+    });
   }
   else {
     BVHTreeFromMesh *treedata = nullptr;
-    BVHTreeNearest nearest = {0};
-    BVHTreeRayHit rayhit = {0};
     int num_trees = 0;
-    float hit_dist;
-    float tmp_co[3], tmp_no[3];
 
     const bool use_from_vert = (mode & MREMAP_USE_VERT);
 
@@ -1252,7 +1364,6 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
     bool use_islands = false;
 
     BLI_AStarGraph *as_graphdata = nullptr;
-    BLI_AStarSolution as_solution = {0};
     const int isld_steps_src = (islands_precision_src ?
                                     max_ii(int(ASTAR_STEPS_MAX * islands_precision_src + 0.499f),
                                            1) :
@@ -1288,25 +1399,6 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
     blender::Span<blender::int3> corner_tris_src;
     blender::Span<int> tri_faces_src;
 
-    size_t buff_size_interp = MREMAP_DEFAULT_BUFSIZE;
-    float(*vcos_interp)[3] = nullptr;
-    int *indices_interp = nullptr;
-    float *weights_interp = nullptr;
-
-    int tindex, pidx_dst, lidx_dst, plidx_dst, pidx_src, lidx_src, plidx_src;
-
-    IslandResult **islands_res;
-    size_t islands_res_buff_size = MREMAP_DEFAULT_BUFSIZE;
-
-    if (!use_from_vert) {
-      vcos_interp = static_cast<float(*)[3]>(
-          MEM_mallocN(sizeof(*vcos_interp) * buff_size_interp, __func__));
-      indices_interp = static_cast<int *>(
-          MEM_mallocN(sizeof(*indices_interp) * buff_size_interp, __func__));
-      weights_interp = static_cast<float *>(
-          MEM_mallocN(sizeof(*weights_interp) * buff_size_interp, __func__));
-    }
-
     {
       const bool need_lnors_src = (mode & MREMAP_USE_LOOP) && (mode & MREMAP_USE_NORMAL);
       const bool need_lnors_dst = need_lnors_src || (mode & MREMAP_USE_NORPROJ);
@@ -1400,7 +1492,7 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
 
     /* Build our AStar graphs. */
     if (isld_steps_src) {
-      for (tindex = 0; tindex < num_trees; tindex++) {
+      for (int tindex = 0; tindex < num_trees; tindex++) {
         mesh_island_to_astar_graph(use_islands ? &island_store : nullptr,
                                    tindex,
                                    positions_src,
@@ -1418,7 +1510,7 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
       if (use_islands) {
         blender::BitVector<> verts_active(num_verts_src);
 
-        for (tindex = 0; tindex < num_trees; tindex++) {
+        for (int tindex = 0; tindex < num_trees; tindex++) {
           MeshElemMap *isld = island_store.islands[tindex];
           int num_verts_active = 0;
           verts_active.fill(false);
@@ -1445,7 +1537,7 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
         tri_faces_src = me_src->corner_tri_faces();
         blender::BitVector<> corner_tris_active(corner_tris_src.size());
 
-        for (tindex = 0; tindex < num_trees; tindex++) {
+        for (int tindex = 0; tindex < num_trees; tindex++) {
           int corner_tris_num_active = 0;
           corner_tris_active.fill(false);
           for (const int64_t i : corner_tris_src.index_range()) {
@@ -1465,6 +1557,16 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
                                            2,
                                            6);
         }
+
+        if (isld_steps_src) {
+          /* Needed when the path between two source faces crosses an inner cut of an island,
+           * created here already so that it can be shared by all threads. */
+          BKE_mesh_origindex_map_create_corner_tri(&face_to_corner_tri_map_src,
+                                                   &face_to_corner_tri_map_src_buff,
+                                                   faces_src,
+                                                   tri_faces_src.data(),
+                                                   int(tri_faces_src.size()));
+        }
       }
       else {
         BLI_assert(num_trees == 1);
@@ -1472,183 +1574,238 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
       }
     }
 
-    /* And check each dest face! */
-    islands_res = static_cast<IslandResult **>(
-        MEM_mallocN(sizeof(*islands_res) * size_t(num_trees), __func__));
-    for (tindex = 0; tindex < num_trees; tindex++) {
-      islands_res[tindex] = static_cast<IslandResult *>(
-          MEM_mallocN(sizeof(**islands_res) * islands_res_buff_size, __func__));
-    }
     const blender::Span<int> tri_faces = me_src->corner_tri_faces();
 
-    for (pidx_dst = 0; pidx_dst < faces_dst.size(); pidx_dst++) {
-      const blender::IndexRange face_dst = faces_dst[pidx_dst];
-      float pnor_dst[3];
-
-      /* Only in use_from_vert case, we may need faces' centers as fallback
-       * in case we cannot decide which corner to use from normals only. */
-      blender::float3 pcent_dst;
-      bool pcent_dst_valid = false;
+    /* And check each dest face! */
+    threading::parallel_for(faces_dst.index_range(), 256, [&](const IndexRange range) {
+      MemArena *mem = arenas.local();
+      BVHTreeNearest nearest = {0};
+      BVHTreeRayHit rayhit = {0};
+      BLI_AStarSolution as_solution = {0};
+      float hit_dist;
+      float tmp_co[3], tmp_no[3];
+      int tindex, lidx_dst, plidx_dst, pidx_src, lidx_src, plidx_src;
+
+      size_t buff_size_interp = MREMAP_DEFAULT_BUFSIZE;
+      float(*vcos_interp)[3] = nullptr;
+      int *indices_interp = nullptr;
+      float *weights_interp = nullptr;
+
+      if (!use_from_vert) {
+        vcos_interp = static_cast<float(*)[3]>(
+            MEM_mallocN(sizeof(*vcos_interp) * buff_size_interp, __func__));
+        indices_interp = static_cast<int *>(
+            MEM_mallocN(sizeof(*indices_interp) * buff_size_interp, __func__));
+        weights_interp = static_cast<float *>(
+            MEM_mallocN(sizeof(*weights_interp) * buff_size_interp, __func__));
+      }
 
-      if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
-        copy_v3_v3(pnor_dst, face_normals_dst[pidx_dst]);
-        if (space_transform) {
-          BLI_space_transform_apply_normal(space_transform, pnor_dst);
-        }
+      size_t islands_res_buff_size = MREMAP_DEFAULT_BUFSIZE;
+      IslandResult **islands_res = static_cast<IslandResult **>(
+          MEM_mallocN(sizeof(*islands_res) * size_t(num_trees), __func__));
+      for (tindex = 0; tindex < num_trees; tindex++) {
+        islands_res[tindex] = static_cast<IslandResult *>(
+            MEM_mallocN(sizeof(**islands_res) * islands_res_buff_size, __func__));
       }
 
-      if (size_t(face_dst.size()) > islands_res_buff_size) {
-        islands_res_buff_size = size_t(face_dst.size()) + MREMAP_DEFAULT_BUFSIZE;
-        for (tindex = 0; tindex < num_trees; tindex++) {
-          islands_res[tindex] = static_cast<IslandResult *>(
-              MEM_reallocN(islands_res[tindex], sizeof(**islands_res) * islands_res_buff_size));
+      for (const int64_t pidx_dst : range) {
+        const blender::IndexRange face_dst = faces_dst[pidx_dst];
+        float pnor_dst[3];
+
+        /* Only in use_from_vert case, we may need faces' centers as fallback
+         * in case we cannot decide which corner to use from normals only. */
+        blender::float3 pcent_dst;
+        bool pcent_dst_valid = false;
+
+        if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
+          copy_v3_v3(pnor_dst, face_normals_dst[pidx_dst]);
+          if (space_transform) {
+            BLI_space_transform_apply_normal(space_transform, pnor_dst);
+          }
         }
-      }
 
-      for (tindex = 0; tindex < num_trees; tindex++) {
-        BVHTreeFromMesh *tdata = &treedata[tindex];
+        if (size_t(face_dst.size()) > islands_res_buff_size) {
+          islands_res_buff_size = size_t(face_dst.size()) + MREMAP_DEFAULT_BUFSIZE;
+          for (tindex = 0; tindex < num_trees; tindex++) {
+            islands_res[tindex] = static_cast<IslandResult *>(
+                MEM_reallocN(islands_res[tindex], sizeof(**islands_res) * islands_res_buff_size));
+          }
+        }
 
-        for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
-          const int vert_dst = corner_verts_dst[face_dst.start() + plidx_dst];
-          if (use_from_vert) {
-            blender::Span<int> vert_to_refelem_map_src;
+        for (tindex = 0; tindex < num_trees; tindex++) {
+          BVHTreeFromMesh *tdata = &treedata[tindex];
 
-            copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
-            nearest.index = -1;
+          for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
+            const int vert_dst = corner_verts_dst[face_dst.start() + plidx_dst];
+            if (use_from_vert) {
+              blender::Span<int> vert_to_refelem_map_src;
 
-            /* Convert the vertex to tree coordinates, if needed. */
-            if (space_transform) {
-              BLI_space_transform_apply(space_transform, tmp_co);
-            }
+              copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
+              nearest.index = -1;
 
-            if (mesh_remap_bvhtree_query_nearest(tdata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-            {
-              float(*nor_dst)[3];
-              blender::Span<blender::float3> nors_src;
-              float best_nor_dot = -2.0f;
-              float best_sqdist_fallback = FLT_MAX;
-              int best_index_src = -1;
-
-              if (mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) {
-                copy_v3_v3(tmp_no, loop_normals_dst[plidx_dst + face_dst.start()]);
-                if (space_transform) {
-                  BLI_space_transform_apply_normal(space_transform, tmp_no);
-                }
-                nor_dst = &tmp_no;
-                nors_src = loop_normals_src;
-                vert_to_refelem_map_src = vert_to_loop_map_src[nearest.index];
-              }
-              else { /* if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) { */
-                nor_dst = &pnor_dst;
-                nors_src = face_normals_src;
-                vert_to_refelem_map_src = vert_to_face_map_src[nearest.index];
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
               }
 
-              for (const int index_src : vert_to_refelem_map_src) {
-                BLI_assert(index_src != -1);
-                const float dot = dot_v3v3(nors_src[index_src], *nor_dst);
-
-                pidx_src = ((mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
-                                loop_to_face_map_src[index_src] :
-                                index_src);
-                /* WARNING! This is not the *real* lidx_src in case of POLYNOR, we only use it
-                 *          to check we stay on current island (all loops from a given face are
-                 *          on same island!). */
-                lidx_src = ((mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
-                                index_src :
-                                int(faces_src[pidx_src].start()));
-
-                /* A same vert may be at the boundary of several islands! Hence, we have to ensure
-                 * face/loop we are currently considering *belongs* to current island! */
-                if (use_islands && island_store.items_to_islands[lidx_src] != tindex) {
-                  continue;
+              if (mesh_remap_bvhtree_query_nearest(
+                      tdata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                float(*nor_dst)[3];
+                blender::Span<blender::float3> nors_src;
+                float best_nor_dot = -2.0f;
+                float best_sqdist_fallback = FLT_MAX;
+                int best_index_src = -1;
+
+                if (mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) {
+                  copy_v3_v3(tmp_no, loop_normals_dst[plidx_dst + face_dst.start()]);
+                  if (space_transform) {
+                    BLI_space_transform_apply_normal(space_transform, tmp_no);
+                  }
+                  nor_dst = &tmp_no;
+                  nors_src = loop_normals_src;
+                  vert_to_refelem_map_src = vert_to_loop_map_src[nearest.index];
+                }
+                else { /* if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) { */
+                  nor_dst = &pnor_dst;
+                  nors_src = face_normals_src;
+                  vert_to_refelem_map_src = vert_to_face_map_src[nearest.index];
                 }
 
-                if (dot > best_nor_dot - 1e-6f) {
-                  /* We need something as fallback decision in case dest normal matches several
-                   * source normals (see #44522), using distance between faces' centers here. */
-                  float *pcent_src;
-                  float sqdist;
-
-                  if (!pcent_dst_valid) {
-                    pcent_dst = blender::bke::mesh::face_center_calc(
-                        {reinterpret_cast<const blender::float3 *>(vert_positions_dst),
-                         numverts_dst},
-                        blender::Span(corner_verts_dst, numloops_dst).slice(face_dst));
-                    pcent_dst_valid = true;
+                for (const int index_src : vert_to_refelem_map_src) {
+                  BLI_assert(index_src != -1);
+                  const float dot = dot_v3v3(nors_src[index_src], *nor_dst);
+
+                  pidx_src = ((mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
+                                  loop_to_face_map_src[index_src] :
+                                  index_src);
+                  /* WARNING! This is not the *real* lidx_src in case of POLYNOR, we only use it
+                   *          to check we stay on current island (all loops from a given face are
+                   *          on same island!). */
+                  lidx_src = ((mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
+                                  index_src :
+                                  int(faces_src[pidx_src].start()));
+
+                  /* A same vert may be at the boundary of several islands! Hence, we have to
+                   * ensure face/loop we are currently considering *belongs* to current island! */
+                  if (use_islands && island_store.items_to_islands[lidx_src] != tindex) {
+                    continue;
                   }
-                  pcent_src = face_cents_src[pidx_src];
-                  sqdist = len_squared_v3v3(pcent_dst, pcent_src);
 
-                  if ((dot > best_nor_dot + 1e-6f) || (sqdist < best_sqdist_fallback)) {
-                    best_nor_dot = dot;
-                    best_sqdist_fallback = sqdist;
-                    best_index_src = index_src;
+                  if (dot > best_nor_dot - 1e-6f) {
+                    /* We need something as fallback decision in case dest normal matches several
+                     * source normals (see #44522), using distance between faces' centers here. */
+                    float *pcent_src;
+                    float sqdist;
+
+                    if (!pcent_dst_valid) {
+                      pcent_dst = blender::bke::mesh::face_center_calc(
+                          {reinterpret_cast<const blender::float3 *>(vert_positions_dst),
+                           numverts_dst},
+                          blender::Span(corner_verts_dst, numloops_dst).slice(face_dst));
+                      pcent_dst_valid = true;
+                    }
+                    pcent_src = face_cents_src[pidx_src];
+                    sqdist = len_squared_v3v3(pcent_dst, pcent_src);
+
+                    if ((dot > best_nor_dot + 1e-6f) || (sqdist < best_sqdist_fallback)) {
+                      best_nor_dot = dot;
+                      best_sqdist_fallback = sqdist;
+                      best_index_src = index_src;
+                    }
                   }
                 }
-              }
-              if (best_index_src == -1) {
-                /* We found no item to map back from closest vertex... */
-                best_nor_dot = -1.0f;
-                hit_dist = FLT_MAX;
-              }
-              else if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
-                /* Our best_index_src is a face one for now!
-                 * Have to find its loop matching our closest vertex. */
-                const blender::IndexRange face_src = faces_src[best_index_src];
-                for (plidx_src = 0; plidx_src < face_src.size(); plidx_src++) {
-                  const int vert_src = corner_verts_src[face_src.start() + plidx_src];
-                  if (vert_src == nearest.index) {
-                    best_index_src = plidx_src + int(face_src.start());
-                    break;
+                if (best_index_src == -1) {
+                  /* We found no item to map back from closest vertex... */
+                  best_nor_dot = -1.0f;
+                  hit_dist = FLT_MAX;
+                }
+                else if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
+                  /* Our best_index_src is a face one for now!
+                   * Have to find its loop matching our closest vertex. */
+                  const blender::IndexRange face_src = faces_src[best_index_src];
+                  for (plidx_src = 0; plidx_src < face_src.size(); plidx_src++) {
+                    const int vert_src = corner_verts_src[face_src.start() + plidx_src];
+                    if (vert_src == nearest.index) {
+                      best_index_src = plidx_src + int(face_src.start());
+                      break;
+                    }
                   }
                 }
+                best_nor_dot = (best_nor_dot + 1.0f) * 0.5f;
+                islands_res[tindex][plidx_dst].factor = hit_dist ? (best_nor_dot / hit_dist) :
+                                                                   1e18f;
+                islands_res[tindex][plidx_dst].hit_dist = hit_dist;
+                islands_res[tindex][plidx_dst].index_src = best_index_src;
+              }
+              else {
+                /* No source for this dest loop! */
+                islands_res[tindex][plidx_dst].factor = 0.0f;
+                islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
+                islands_res[tindex][plidx_dst].index_src = -1;
               }
-              best_nor_dot = (best_nor_dot + 1.0f) * 0.5f;
-              islands_res[tindex][plidx_dst].factor = hit_dist ? (best_nor_dot / hit_dist) : 1e18f;
-              islands_res[tindex][plidx_dst].hit_dist = hit_dist;
-              islands_res[tindex][plidx_dst].index_src = best_index_src;
-            }
-            else {
-              /* No source for this dest loop! */
-              islands_res[tindex][plidx_dst].factor = 0.0f;
-              islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
-              islands_res[tindex][plidx_dst].index_src = -1;
             }
-          }
-          else if (mode & MREMAP_USE_NORPROJ) {
-            int n = (ray_radius > 0.0f) ? MREMAP_RAYCAST_APPROXIMATE_NR : 1;
-            float w = 1.0f;
+            else if (mode & MREMAP_USE_NORPROJ) {
+              int n = (ray_radius > 0.0f) ? MREMAP_RAYCAST_APPROXIMATE_NR : 1;
+              float w = 1.0f;
 
-            copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
-            copy_v3_v3(tmp_no, loop_normals_dst[plidx_dst + face_dst.start()]);
+              copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
+              copy_v3_v3(tmp_no, loop_normals_dst[plidx_dst + face_dst.start()]);
 
-            /* We do our transform here, since we may do several raycast/nearest queries. */
-            if (space_transform) {
-              BLI_space_transform_apply(space_transform, tmp_co);
-              BLI_space_transform_apply_normal(space_transform, tmp_no);
-            }
+              /* We do our transform here, since we may do several raycast/nearest queries. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+                BLI_space_transform_apply_normal(space_transform, tmp_no);
+              }
 
-            while (n--) {
-              if (mesh_remap_bvhtree_query_raycast(
-                      tdata, &rayhit, tmp_co, tmp_no, ray_radius / w, max_dist, &hit_dist))
-              {
-                islands_res[tindex][plidx_dst].factor = (hit_dist ? (1.0f / hit_dist) : 1e18f) * w;
-                islands_res[tindex][plidx_dst].hit_dist = hit_dist;
-                islands_res[tindex][plidx_dst].index_src = tri_faces[rayhit.index];
-                copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, rayhit.co);
-                break;
+              while (n--) {
+                if (mesh_remap_bvhtree_query_raycast(
+                        tdata, &rayhit, tmp_co, tmp_no, ray_radius / w, max_dist, &hit_dist))
+                {
+                  islands_res[tindex][plidx_dst].factor = (hit_dist ? (1.0f / hit_dist) : 1e18f) *
+                                                          w;
+                  islands_res[tindex][plidx_dst].hit_dist = hit_dist;
+                  islands_res[tindex][plidx_dst].index_src = tri_faces[rayhit.index];
+                  copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, rayhit.co);
+                  break;
+                }
+                /* Next iteration will get bigger radius but smaller weight! */
+                w /= MREMAP_RAYCAST_APPROXIMATE_FAC;
+              }
+              if (n == -1) {
+                /* Fallback to 'nearest' hit here, loops usually comes in 'face group', not good to
+                 * have only part of one dest face's loops to map to source.
+                 * Note that since we give this a null weight, if whole weight for a given face
+                 * is null, it means none of its loop mapped to this source island,
+                 * hence we can skip it later.
+                 */
+                copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
+                nearest.index = -1;
+
+                /* Convert the vertex to tree coordinates, if needed. */
+                if (space_transform) {
+                  BLI_space_transform_apply(space_transform, tmp_co);
+                }
+
+                /* In any case, this fallback nearest hit should have no weight at all
+                 * in 'best island' decision! */
+                islands_res[tindex][plidx_dst].factor = 0.0f;
+
+                if (mesh_remap_bvhtree_query_nearest(
+                        tdata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+                {
+                  islands_res[tindex][plidx_dst].hit_dist = hit_dist;
+                  islands_res[tindex][plidx_dst].index_src = tri_faces[nearest.index];
+                  copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, nearest.co);
+                }
+                else {
+                  /* No source for this dest loop! */
+                  islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
+                  islands_res[tindex][plidx_dst].index_src = -1;
+                }
               }
-              /* Next iteration will get bigger radius but smaller weight! */
-              w /= MREMAP_RAYCAST_APPROXIMATE_FAC;
             }
-            if (n == -1) {
-              /* Fallback to 'nearest' hit here, loops usually comes in 'face group', not good to
-               * have only part of one dest face's loops to map to source.
-               * Note that since we give this a null weight, if whole weight for a given face
-               * is null, it means none of its loop mapped to this source island,
-               * hence we can skip it later.
-               */
+            else { /* Nearest face either to use all its loops/verts or just closest one. */
               copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
               nearest.index = -1;
 
@@ -1657,359 +1814,342 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
                 BLI_space_transform_apply(space_transform, tmp_co);
               }
 
-              /* In any case, this fallback nearest hit should have no weight at all
-               * in 'best island' decision! */
-              islands_res[tindex][plidx_dst].factor = 0.0f;
-
               if (mesh_remap_bvhtree_query_nearest(
                       tdata, &nearest, tmp_co, max_dist_sq, &hit_dist))
               {
+                islands_res[tindex][plidx_dst].factor = hit_dist ? (1.0f / hit_dist) : 1e18f;
                 islands_res[tindex][plidx_dst].hit_dist = hit_dist;
                 islands_res[tindex][plidx_dst].index_src = tri_faces[nearest.index];
                 copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, nearest.co);
               }
               else {
                 /* No source for this dest loop! */
+                islands_res[tindex][plidx_dst].factor = 0.0f;
                 islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
                 islands_res[tindex][plidx_dst].index_src = -1;
               }
             }
           }
-          else { /* Nearest face either to use all its loops/verts or just closest one. */
-            copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
-            nearest.index = -1;
+        }
 
-            /* Convert the vertex to tree coordinates, if needed. */
-            if (space_transform) {
-              BLI_space_transform_apply(space_transform, tmp_co);
-            }
+        /* And now, find best island to use! */
+        /* We have to first select the 'best source island' for given dst face and its loops.
+         * Then, we have to check that face does not 'spread' across some island's limits
+         * (like inner seams for UVs, etc.).
+         * Note we only still partially support that kind of situation here, i.e.
+         * Faces spreading over actual cracks
+         * (like a narrow space without faces on src, splitting a 'tube-like' geometry).
+         * That kind of situation should be relatively rare, though.
+         */
+        /* XXX This block in itself is big and complex enough to be a separate function but...
+         *     it uses a bunch of locale vars.
+         *     Not worth sending all that through parameters (for now at least). */
+        {
+          BLI_AStarGraph *as_graph = nullptr;
+          int *face_island_index_map = nullptr;
+          int pidx_src_prev = -1;
 
-            if (mesh_remap_bvhtree_query_nearest(tdata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-            {
-              islands_res[tindex][plidx_dst].factor = hit_dist ? (1.0f / hit_dist) : 1e18f;
-              islands_res[tindex][plidx_dst].hit_dist = hit_dist;
-              islands_res[tindex][plidx_dst].index_src = tri_faces[nearest.index];
-              copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, nearest.co);
-            }
-            else {
-              /* No source for this dest loop! */
-              islands_res[tindex][plidx_dst].factor = 0.0f;
-              islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
-              islands_res[tindex][plidx_dst].index_src = -1;
-            }
-          }
-        }
-      }
+          MeshElemMap *best_island = nullptr;
+          float best_island_fac = 0.0f;
+          int best_island_index = -1;
 
-      /* And now, find best island to use! */
-      /* We have to first select the 'best source island' for given dst face and its loops.
-       * Then, we have to check that face does not 'spread' across some island's limits
-       * (like inner seams for UVs, etc.).
-       * Note we only still partially support that kind of situation here, i.e.
-       * Faces spreading over actual cracks
-       * (like a narrow space without faces on src, splitting a 'tube-like' geometry).
-       * That kind of situation should be relatively rare, though.
-       */
-      /* XXX This block in itself is big and complex enough to be a separate function but...
-       *     it uses a bunch of locale vars.
-       *     Not worth sending all that through parameters (for now at least). */
-      {
-        BLI_AStarGraph *as_graph = nullptr;
-        int *face_island_index_map = nullptr;
-        int pidx_src_prev = -1;
-
-        MeshElemMap *best_island = nullptr;
-        float best_island_fac = 0.0f;
-        int best_island_index = -1;
+          for (tindex = 0; tindex < num_trees; tindex++) {
+            float island_fac = 0.0f;
 
-        for (tindex = 0; tindex < num_trees; tindex++) {
-          float island_fac = 0.0f;
+            for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
+              island_fac += islands_res[tindex][plidx_dst].factor;
+            }
+            island_fac /= float(face_dst.size());
 
-          for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
-            island_fac += islands_res[tindex][plidx_dst].factor;
+            if (island_fac > best_island_fac) {
+              best_island_fac = island_fac;
+              best_island_index = tindex;
+            }
           }
-          island_fac /= float(face_dst.size());
 
-          if (island_fac > best_island_fac) {
-            best_island_fac = island_fac;
-            best_island_index = tindex;
+          if (best_island_index != -1 && isld_steps_src) {
+            best_island = use_islands ? island_store.islands[best_island_index] : nullptr;
+            as_graph = &as_graphdata[best_island_index];
+            face_island_index_map = (int *)as_graph->custom_data;
+            BLI_astar_solution_init(as_graph, &as_solution, nullptr);
           }
-        }
 
-        if (best_island_index != -1 && isld_steps_src) {
-          best_island = use_islands ? island_store.islands[best_island_index] : nullptr;
-          as_graph = &as_graphdata[best_island_index];
-          face_island_index_map = (int *)as_graph->custom_data;
-          BLI_astar_solution_init(as_graph, &as_solution, nullptr);
-        }
-
-        for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
-          IslandResult *isld_res;
-          lidx_dst = plidx_dst + int(face_dst.start());
+          for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
+            IslandResult *isld_res;
+            lidx_dst = plidx_dst + int(face_dst.start());
 
-          if (best_island_index == -1) {
-            /* No source for any loops of our dest face in any source islands. */
-            BKE_mesh_remap_item_define_invalid(r_map, lidx_dst);
-            continue;
-          }
+            if (best_island_index == -1) {
+              /* No source for any loops of our dest face in any source islands. */
+              BKE_mesh_remap_item_define_invalid(r_map, lidx_dst);
+              continue;
+            }
 
-          as_solution.custom_data = POINTER_FROM_INT(false);
-
-          isld_res = &islands_res[best_island_index][plidx_dst];
-          if (use_from_vert) {
-            /* Indices stored in islands_res are those of loops, one per dest loop. */
-            lidx_src = isld_res->index_src;
-            if (lidx_src >= 0) {
-              pidx_src = loop_to_face_map_src[lidx_src];
-              /* If prev and curr face are the same, no need to do anything more!!! */
-              if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
-                int pidx_isld_src, pidx_isld_src_prev;
-                if (face_island_index_map) {
-                  pidx_isld_src = face_island_index_map[pidx_src];
-                  pidx_isld_src_prev = face_island_index_map[pidx_src_prev];
-                }
-                else {
-                  pidx_isld_src = pidx_src;
-                  pidx_isld_src_prev = pidx_src_prev;
-                }
+            as_solution.custom_data = POINTER_FROM_INT(false);
+
+            isld_res = &islands_res[best_island_index][plidx_dst];
+            if (use_from_vert) {
+              /* Indices stored in islands_res are those of loops, one per dest loop. */
+              lidx_src = isld_res->index_src;
+              if (lidx_src >= 0) {
+                pidx_src = loop_to_face_map_src[lidx_src];
+                /* If prev and curr face are the same, no need to do anything more!!! */
+                if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
+                  int pidx_isld_src, pidx_isld_src_prev;
+                  if (face_island_index_map) {
+                    pidx_isld_src = face_island_index_map[pidx_src];
+                    pidx_isld_src_prev = face_island_index_map[pidx_src_prev];
+                  }
+                  else {
+                    pidx_isld_src = pidx_src;
+                    pidx_isld_src_prev = pidx_src_prev;
+                  }
 
-                BLI_astar_graph_solve(as_graph,
-                                      pidx_isld_src_prev,
-                                      pidx_isld_src,
-                                      mesh_remap_calc_loops_astar_f_cost,
-                                      &as_solution,
-                                      isld_steps_src);
-                if (POINTER_AS_INT(as_solution.custom_data) && (as_solution.steps > 0)) {
-                  /* Find first 'cutting edge' on path, and bring back lidx_src on face just
-                   * before that edge.
-                   * Note we could try to be much smarter, g.g. Storing a whole face's indices,
-                   * and making decision (on which side of cutting edge(s!) to be) on the end,
-                   * but this is one more level of complexity, better to first see if
-                   * simple solution works!
-                   */
-                  int last_valid_pidx_isld_src = -1;
-                  /* Note we go backward here, from dest to src face. */
-                  for (int i = as_solution.steps - 1; i--;) {
-                    BLI_AStarGNLink *as_link = as_solution.prev_links[pidx_isld_src];
-                    const int eidx = POINTER_AS_INT(as_link->custom_data);
-                    pidx_isld_src = as_solution.prev_nodes[pidx_isld_src];
-                    BLI_assert(pidx_isld_src != -1);
-                    if (eidx != -1) {
-                      /* we are 'crossing' a cutting edge. */
-                      last_valid_pidx_isld_src = pidx_isld_src;
+                  BLI_astar_graph_solve(as_graph,
+                                        pidx_isld_src_prev,
+                                        pidx_isld_src,
+                                        mesh_remap_calc_loops_astar_f_cost,
+                                        &as_solution,
+                                        isld_steps_src);
+                  if (POINTER_AS_INT(as_solution.custom_data) && (as_solution.steps > 0)) {
+                    /* Find first 'cutting edge' on path, and bring back lidx_src on face just
+                     * before that edge.
+                     * Note we could try to be much smarter, g.g. Storing a whole face's indices,
+                     * and making decision (on which side of cutting edge(s!) to be) on the end,
+                     * but this is one more level of complexity, better to first see if
+                     * simple solution works!
+                     */
+                    int last_valid_pidx_isld_src = -1;
+                    /* Note we go backward here, from dest to src face. */
+                    for (int i = as_solution.steps - 1; i--;) {
+                      BLI_AStarGNLink *as_link = as_solution.prev_links[pidx_isld_src];
+                      const int eidx = POINTER_AS_INT(as_link->custom_data);
+                      pidx_isld_src = as_solution.prev_nodes[pidx_isld_src];
+                      BLI_assert(pidx_isld_src != -1);
+                      if (eidx != -1) {
+                        /* we are 'crossing' a cutting edge. */
+                        last_valid_pidx_isld_src = pidx_isld_src;
+                      }
                     }
-                  }
-                  if (last_valid_pidx_isld_src != -1) {
-                    /* Find a new valid loop in that new face (nearest one for now).
-                     * Note we could be much more subtle here, again that's for later... */
-                    float best_dist_sq = FLT_MAX;
+                    if (last_valid_pidx_isld_src != -1) {
+                      /* Find a new valid loop in that new face (nearest one for now).
+                       * Note we could be much more subtle here, again that's for later... */
+                      float best_dist_sq = FLT_MAX;
 
-                    copy_v3_v3(tmp_co, vert_positions_dst[corner_verts_dst[lidx_dst]]);
+                      copy_v3_v3(tmp_co, vert_positions_dst[corner_verts_dst[lidx_dst]]);
 
-                    /* We do our transform here,
-                     * since we may do several raycast/nearest queries. */
-                    if (space_transform) {
-                      BLI_space_transform_apply(space_transform, tmp_co);
-                    }
+                      /* We do our transform here,
+                       * since we may do several raycast/nearest queries. */
+                      if (space_transform) {
+                        BLI_space_transform_apply(space_transform, tmp_co);
+                      }
 
-                    pidx_src = (use_islands ? best_island->indices[last_valid_pidx_isld_src] :
-                                              last_valid_pidx_isld_src);
-                    const blender::IndexRange face_src = faces_src[pidx_src];
-                    for (const int64_t corner : face_src) {
-                      const int vert_src = corner_verts_src[corner];
-                      const float dist_sq = len_squared_v3v3(positions_src[vert_src], tmp_co);
-                      if (dist_sq < best_dist_sq) {
-                        best_dist_sq = dist_sq;
-                        lidx_src = int(corner);
+                      pidx_src = (use_islands ? best_island->indices[last_valid_pidx_isld_src] :
+                                                last_valid_pidx_isld_src);
+                      const blender::IndexRange face_src = faces_src[pidx_src];
+                      for (const int64_t corner : face_src) {
+                        const int vert_src = corner_verts_src[corner];
+                        const float dist_sq = len_squared_v3v3(positions_src[vert_src], tmp_co);
+                        if (dist_sq < best_dist_sq) {
+                          best_dist_sq = dist_sq;
+                          lidx_src = int(corner);
+                        }
                       }
                     }
                   }
                 }
+                mesh_remap_item_define(r_map,
+                                       mem,
+                                       lidx_dst,
+                                       isld_res->hit_dist,
+                                       best_island_index,
+                                       1,
+                                       &lidx_src,
+                                       &full_weight);
+                pidx_src_prev = pidx_src;
+              }
+              else {
+                /* No source for this loop in this island. */
+                /* TODO: would probably be better to get a source
+                 * at all cost in best island anyway? */
+                mesh_remap_item_define(
+                    r_map, mem, lidx_dst, FLT_MAX, best_island_index, 0, nullptr, nullptr);
               }
-              mesh_remap_item_define(r_map,
-                                     lidx_dst,
-                                     isld_res->hit_dist,
-                                     best_island_index,
-                                     1,
-                                     &lidx_src,
-                                     &full_weight);
-              pidx_src_prev = pidx_src;
             }
             else {
-              /* No source for this loop in this island. */
-              /* TODO: would probably be better to get a source
-               * at all cost in best island anyway? */
-              mesh_remap_item_define(
-                  r_map, lidx_dst, FLT_MAX, best_island_index, 0, nullptr, nullptr);
-            }
-          }
-          else {
-            /* Else, we use source face, indices stored in islands_res are those of faces. */
-            pidx_src = isld_res->index_src;
-            if (pidx_src >= 0) {
-              float *hit_co = isld_res->hit_point;
-              int best_loop_index_src;
-
-              const blender::IndexRange face_src = faces_src[pidx_src];
-              /* If prev and curr face are the same, no need to do anything more!!! */
-              if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
-                int pidx_isld_src, pidx_isld_src_prev;
-                if (face_island_index_map) {
-                  pidx_isld_src = face_island_index_map[pidx_src];
-                  pidx_isld_src_prev = face_island_index_map[pidx_src_prev];
-                }
-                else {
-                  pidx_isld_src = pidx_src;
-                  pidx_isld_src_prev = pidx_src_prev;
-                }
-
-                BLI_astar_graph_solve(as_graph,
-                                      pidx_isld_src_prev,
-                                      pidx_isld_src,
-                                      mesh_remap_calc_loops_astar_f_cost,
-                                      &as_solution,
-                                      isld_steps_src);
-                if (POINTER_AS_INT(as_solution.custom_data) && (as_solution.steps > 0)) {
-                  /* Find first 'cutting edge' on path, and bring back lidx_src on face just
-                   * before that edge.
-                   * Note we could try to be much smarter: e.g. Storing a whole face's indices,
-                   * and making decision (one which side of cutting edge(s)!) to be on the end,
-                   * but this is one more level of complexity, better to first see if
-                   * simple solution works!
-                   */
-                  int last_valid_pidx_isld_src = -1;
-                  /* Note we go backward here, from dest to src face. */
-                  for (int i = as_solution.steps - 1; i--;) {
-                    BLI_AStarGNLink *as_link = as_solution.prev_links[pidx_isld_src];
-                    int eidx = POINTER_AS_INT(as_link->custom_data);
-
-                    pidx_isld_src = as_solution.prev_nodes[pidx_isld_src];
-                    BLI_assert(pidx_isld_src != -1);
-                    if (eidx != -1) {
-                      /* we are 'crossing' a cutting edge. */
-                      last_valid_pidx_isld_src = pidx_isld_src;
-                    }
+              /* Else, we use source face, indices stored in islands_res are those of faces. */
+              pidx_src = isld_res->index_src;
+              if (pidx_src >= 0) {
+                float *hit_co = isld_res->hit_point;
+                int best_loop_index_src;
+
+                const blender::IndexRange face_src = faces_src[pidx_src];
+                /* If prev and curr face are the same, no need to do anything more!!! */
+                if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
+                  int pidx_isld_src, pidx_isld_src_prev;
+                  if (face_island_index_map) {
+                    pidx_isld_src = face_island_index_map[pidx_src];
+                    pidx_isld_src_prev = face_island_index_map[pidx_src_prev];
+                  }
+                  else {
+                    pidx_isld_src = pidx_src;
+                    pidx_isld_src_prev = pidx_src_prev;
                   }
-                  if (last_valid_pidx_isld_src != -1) {
-                    /* Find a new valid loop in that new face (nearest point on face for now).
-                     * Note we could be much more subtle here, again that's for later... */
-                    float best_dist_sq = FLT_MAX;
-                    int j;
-
-                    const int vert_dst = corner_verts_dst[lidx_dst];
-                    copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
-
-                    /* We do our transform here,
-                     * since we may do several raycast/nearest queries. */
-                    if (space_transform) {
-                      BLI_space_transform_apply(space_transform, tmp_co);
-                    }
-
-                    pidx_src = (use_islands ? best_island->indices[last_valid_pidx_isld_src] :
-                                              last_valid_pidx_isld_src);
 
-                    /* Create that one on demand. */
-                    if (face_to_corner_tri_map_src == nullptr) {
-                      BKE_mesh_origindex_map_create_corner_tri(&face_to_corner_tri_map_src,
-                                                               &face_to_corner_tri_map_src_buff,
-                                                               faces_src,
-                                                               tri_faces_src.data(),
-                                                               int(tri_faces_src.size()));
+                  BLI_astar_graph_solve(as_graph,
+                                        pidx_isld_src_prev,
+                                        pidx_isld_src,
+                                        mesh_remap_calc_loops_astar_f_cost,
+                                        &as_solution,
+                                        isld_steps_src);
+                  if (POINTER_AS_INT(as_solution.custom_data) && (as_solution.steps > 0)) {
+                    /* Find first 'cutting edge' on path, and bring back lidx_src on face just
+                     * before that edge.
+                     * Note we could try to be much smarter: e.g. Storing a whole face's indices,
+                     * and making decision (one which side of cutting edge(s)!) to be on the end,
+                     * but this is one more level of complexity, better to first see if
+                     * simple solution works!
+                     */
+                    int last_valid_pidx_isld_src = -1;
+                    /* Note we go backward here, from dest to src face. */
+                    for (int i = as_solution.steps - 1; i--;) {
+                      BLI_AStarGNLink *as_link = as_solution.prev_links[pidx_isld_src];
+                      int eidx = POINTER_AS_INT(as_link->custom_data);
+
+                      pidx_isld_src = as_solution.prev_nodes[pidx_isld_src];
+                      BLI_assert(pidx_isld_src != -1);
+                      if (eidx != -1) {
+                        /* we are 'crossing' a cutting edge. */
+                        last_valid_pidx_isld_src = pidx_isld_src;
+                      }
                     }
+                    if (last_valid_pidx_isld_src != -1) {
+                      /* Find a new valid loop in that new face (nearest point on face for now).
+                       * Note we could be much more subtle here, again that's for later... */
+                      float best_dist_sq = FLT_MAX;
+                      int j;
+
+                      const int vert_dst = corner_verts_dst[lidx_dst];
+                      copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
+
+                      /* We do our transform here,
+                       * since we may do several raycast/nearest queries. */
+                      if (space_transform) {
+                        BLI_space_transform_apply(space_transform, tmp_co);
+                      }
 
-                    for (j = face_to_corner_tri_map_src[pidx_src].count; j--;) {
-                      float h[3];
-                      const blender::int3 &tri =
-                          corner_tris_src[face_to_corner_tri_map_src[pidx_src].indices[j]];
-                      float dist_sq;
-
-                      closest_on_tri_to_point_v3(h,
-                                                 tmp_co,
-                                                 positions_src[corner_verts_src[tri[0]]],
-                                                 positions_src[corner_verts_src[tri[1]]],
-                                                 positions_src[corner_verts_src[tri[2]]]);
-                      dist_sq = len_squared_v3v3(tmp_co, h);
-                      if (dist_sq < best_dist_sq) {
-                        copy_v3_v3(hit_co, h);
-                        best_dist_sq = dist_sq;
+                      pidx_src = (use_islands ? best_island->indices[last_valid_pidx_isld_src] :
+                                                last_valid_pidx_isld_src);
+
+                      for (j = face_to_corner_tri_map_src[pidx_src].count; j--;) {
+                        float h[3];
+                        const blender::int3 &tri =
+                            corner_tris_src[face_to_corner_tri_map_src[pidx_src].indices[j]];
+                        float dist_sq;
+
+                        closest_on_tri_to_point_v3(h,
+                                                   tmp_co,
+                                                   positions_src[corner_verts_src[tri[0]]],
+                                                   positions_src[corner_verts_src[tri[1]]],
+                                                   positions_src[corner_verts_src[tri[2]]]);
+                        dist_sq = len_squared_v3v3(tmp_co, h);
+                        if (dist_sq < best_dist_sq) {
+                          copy_v3_v3(hit_co, h);
+                          best_dist_sq = dist_sq;
+                        }
                       }
                     }
                   }
                 }
-              }
 
-              if (mode == MREMAP_MODE_LOOP_POLY_NEAREST) {
-                mesh_remap_interp_face_data_get(face_src,
-                                                corner_verts_src,
-                                                positions_src,
-                                                hit_co,
-                                                &buff_size_interp,
-                                                &vcos_interp,
-                                                true,
-                                                &indices_interp,
-                                                &weights_interp,
-                                                false,
-                                                &best_loop_index_src);
+                if (mode == MREMAP_MODE_LOOP_POLY_NEAREST) {
+                  mesh_remap_interp_face_data_get(face_src,
+                                                  corner_verts_src,
+                                                  positions_src,
+                                                  hit_co,
+                                                  &buff_size_interp,
+                                                  &vcos_interp,
+                                                  true,
+                                                  &indices_interp,
+                                                  &weights_interp,
+                                                  false,
+                                                  &best_loop_index_src);
+
+                  mesh_remap_item_define(r_map,
+                                         mem,
+                                         lidx_dst,
+                                         isld_res->hit_dist,
+                                         best_island_index,
+                                         1,
+                                         &best_loop_index_src,
+                                         &full_weight);
+                }
+                else {
+                  const int sources_num = mesh_remap_interp_face_data_get(face_src,
+                                                                          corner_verts_src,
+                                                                          positions_src,
+                                                                          hit_co,
+                                                                          &buff_size_interp,
+                                                                          &vcos_interp,
+                                                                          true,
+                                                                          &indices_interp,
+                                                                          &weights_interp,
+                                                                          true,
+                                                                          nullptr);
+
+                  mesh_remap_item_define(r_map,
+                                         mem,
+                                         lidx_dst,
+                                         isld_res->hit_dist,
+                                         best_island_index,
+                                         sources_num,
+                                         indices_interp,
+                                         weights_interp);
+                }
 
-                mesh_remap_item_define(r_map,
-                                       lidx_dst,
-                                       isld_res->hit_dist,
-                                       best_island_index,
-                                       1,
-                                       &best_loop_index_src,
-                                       &full_weight);
+                pidx_src_prev = pidx_src;
               }
               else {
-                const int sources_num = mesh_remap_interp_face_data_get(face_src,
-                                                                        corner_verts_src,
-                                                                        positions_src,
-                                                                        hit_co,
-                                                                        &buff_size_interp,
-                                                                        &vcos_interp,
-                                                                        true,
-                                                                        &indices_interp,
-                                                                        &weights_interp,
-                                                                        true,
-                                                                        nullptr);
-
-                mesh_remap_item_define(r_map,
-                                       lidx_dst,
-                                       isld_res->hit_dist,
-                                       best_island_index,
-                                       sources_num,
-                                       indices_interp,
-                                       weights_interp);
+                /* No source for this loop in this island. */
+                /* TODO: would probably be better to get a source
+                 * at all cost in best island anyway? */
+                mesh_remap_item_define(
+                    r_map, mem, lidx_dst, FLT_MAX, best_island_index, 0, nullptr, nullptr);
               }
-
-              pidx_src_prev = pidx_src;
-            }
-            else {
-              /* No source for this loop in this island. */
-              /* TODO: would probably be better to get a source
-               * at all cost in best island anyway? */
-              mesh_remap_item_define(
-                  r_map, lidx_dst, FLT_MAX, best_island_index, 0, nullptr, nullptr);
             }
           }
+
+          BLI_astar_solution_clear(&as_solution);
         }
+      }
 
-        BLI_astar_solution_clear(&as_solution);
+      for (tindex = 0; tindex < num_trees; tindex++) {
+        MEM_freeN(islands_res[tindex]);
       }
-    }
+      MEM_freeN(islands_res);
+      if (isld_steps_src) {
+        BLI_astar_solution_free(&as_solution);
+      }
+      if (vcos_interp) {
+        MEM_freeN(vcos_interp);
+      }
+      if (indices_interp) {
+        MEM_freeN(indices_interp);
+      }
+      if (weights_interp) {
+        MEM_freeN(weights_interp);
+      }
+    });
 
-    for (tindex = 0; tindex < num_trees; tindex++) {
-      MEM_freeN(islands_res[tindex]);
+    for (int tindex = 0; tindex < num_trees; tindex++) {
       free_bvhtree_from_mesh(&treedata[tindex]);
       if (isld_steps_src) {
         BLI_astar_graph_free(&as_graphdata[tindex]);
       }
     }
-    MEM_freeN(islands_res);
     BKE_mesh_loop_islands_free(&island_store);
     MEM_freeN(treedata);
     if (isld_steps_src) {
       MEM_freeN(as_graphdata);
-      BLI_astar_solution_free(&as_solution);
     }
 
     if (face_to_corner_tri_map_src) {
@@ -2018,15 +2158,6 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
     if (face_to_corner_tri_map_src_buff) {
       MEM_freeN(face_to_corner_tri_map_src_buff);
     }
-    if (vcos_interp) {
-      MEM_freeN(vcos_interp);
-    }
-    if (indices_interp) {
-      MEM_freeN(indices_interp);
-    }
-    if (weights_interp) {
-      MEM_freeN(weights_interp);
-    }
   }
 }
 
@@ -2042,10 +2173,10 @@ void BKE_mesh_remap_calc_faces_from_mesh(const int mode,
                                          const Mesh *me_src,
                                          MeshPairRemap *r_map)
 {
+  using namespace blender;
   const float full_weight = 1.0f;
   const float max_dist_sq = max_dist * max_dist;
   blender::Span<blender::float3> face_normals_dst;
-  blender::float3 tmp_co, tmp_no;
 
   BLI_assert(mode & MREMAP_MODE_POLY);
 
@@ -2054,79 +2185,104 @@ void BKE_mesh_remap_calc_faces_from_mesh(const int mode,
   }
 
   BKE_mesh_remap_init(r_map, int(faces_dst.size()));
+  MeshRemapThreadArenas arenas(r_map);
 
   if (mode == MREMAP_MODE_TOPOLOGY) {
     BLI_assert(faces_dst.size() == me_src->faces_num);
-    for (const int64_t i : faces_dst.index_range()) {
-      const int index = int(i);
-      mesh_remap_item_define(r_map, int(i), FLT_MAX, 0, 1, &index, &full_weight);
-    }
+    threading::parallel_for(faces_dst.index_range(), 4096, [&](const IndexRange range) {
+      MemArena *mem = arenas.local();
+      for (const int64_t i : range) {
+        const int index = int(i);
+        mesh_remap_item_define(r_map, mem, int(i), FLT_MAX, 0, 1, &index, &full_weight);
+      }
+    });
   }
   else {
     BVHTreeFromMesh treedata = {nullptr};
-    BVHTreeNearest nearest = {0};
-    BVHTreeRayHit rayhit = {0};
-    float hit_dist;
     const blender::Span<int> tri_faces = me_src->corner_tri_faces();
 
     BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2);
 
     if (mode == MREMAP_MODE_POLY_NEAREST) {
-      nearest.index = -1;
+      threading::parallel_for(
+          faces_dst.index_range(), MREMAP_GRAIN_SIZE, [&](const IndexRange range) {
+            MemArena *mem = arenas.local();
+            BVHTreeNearest nearest = {0};
+            float hit_dist;
+            blender::float3 tmp_co;
+            nearest.index = -1;
 
-      for (const int64_t i : faces_dst.index_range()) {
-        const blender::IndexRange face = faces_dst[i];
-        tmp_co = blender::bke::mesh::face_center_calc(
-            {reinterpret_cast<const blender::float3 *>(vert_positions_dst), numverts_dst},
-            {&corner_verts_dst[face.start()], face.size()});
+            for (const int64_t i : range) {
+              const blender::IndexRange face = faces_dst[i];
+              tmp_co = blender::bke::mesh::face_center_calc(
+                  {reinterpret_cast<const blender::float3 *>(vert_positions_dst), numverts_dst},
+                  {&corner_verts_dst[face.start()], face.size()});
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+              }
 
-        if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-        {
-          const int face_index = tri_faces[nearest.index];
-          mesh_remap_item_define(r_map, int(i), hit_dist, 0, 1, &face_index, &full_weight);
-        }
-        else {
-          /* No source for this dest face! */
-          BKE_mesh_remap_item_define_invalid(r_map, int(i));
-        }
-      }
+              if (mesh_remap_bvhtree_query_nearest(
+                      &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                const int face_index = tri_faces[nearest.index];
+                mesh_remap_item_define(
+                    r_map, mem, int(i), hit_dist, 0, 1, &face_index, &full_weight);
+              }
+              else {
+                /* No source for this dest face! */
+                BKE_mesh_remap_item_define_invalid(r_map, int(i));
+              }
+            }
+          });
     }
     else if (mode == MREMAP_MODE_POLY_NOR) {
-      for (const int64_t i : faces_dst.index_range()) {
-        const blender::IndexRange face = faces_dst[i];
+      threading::parallel_for(
+          faces_dst.index_range(), MREMAP_GRAIN_SIZE, [&](const IndexRange range) {
+            MemArena *mem = arenas.local();
+            BVHTreeRayHit rayhit = {0};
+            float hit_dist;
+            blender::float3 tmp_co, tmp_no;
 
-        tmp_co = blender::bke::mesh::face_center_calc(
-            {reinterpret_cast<const blender::float3 *>(vert_positions_dst), numverts_dst},
-            {&corner_verts_dst[face.start()], face.size()});
-        copy_v3_v3(tmp_no, face_normals_dst[i]);
+            for (const int64_t i : range) {
+              const blender::IndexRange face = faces_dst[i];
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-          BLI_space_transform_apply_normal(space_transform, tmp_no);
-        }
+              tmp_co = blender::bke::mesh::face_center_calc(
+                  {reinterpret_cast<const blender::float3 *>(vert_positions_dst), numverts_dst},
+                  {&corner_verts_dst[face.start()], face.size()});
+              copy_v3_v3(tmp_no, face_normals_dst[i]);
 
-        if (mesh_remap_bvhtree_query_raycast(
-                &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist))
-        {
-          const int face_index = tri_faces[rayhit.index];
-          mesh_remap_item_define(r_map, int(i), hit_dist, 0, 1, &face_index, &full_weight);
-        }
-        else {
-          /* No source for this dest face! */
-          BKE_mesh_remap_item_define_invalid(r_map, int(i));
-        }
-      }
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+                BLI_space_transform_apply_normal(space_transform, tmp_no);
+              }
+
+              if (mesh_remap_bvhtree_query_raycast(
+                      &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist))
+              {
+                const int face_index = tri_faces[rayhit.index];
+                mesh_remap_item_define(
+                    r_map, mem, int(i), hit_dist, 0, 1, &face_index, &full_weight);
+              }
+              else {
+                /* No source for this dest face! */
+                BKE_mesh_remap_item_define_invalid(r_map, int(i));
+              }
+            }
+          });
     }
     else if (mode == MREMAP_MODE_POLY_POLYINTERP_PNORPROJ) {
+      BVHTreeRayHit rayhit = {0};
+      float hit_dist;
+      blender::float3 tmp_co, tmp_no;
+
       /* We cast our rays randomly, with a pseudo-even distribution
        * (since we spread across tessellated triangles,
-       * with additional weighting based on each triangle's relative area). */
+       * with additional weighting based on each triangle's relative area).
+       * This is kept single-threaded, so that the random sequence, and thus the mapping,
+       * does not depend on the number of threads. */
       RNG *rng = BLI_rng_new(0);
 
       const size_t numfaces_src = size_t(me_src->faces_num);
@@ -2318,5 +2474,6 @@ void BKE_mesh_remap_calc_faces_from_mesh(const int mode,
 #undef MREMAP_RAYCAST_TRI_SAMPLES_MIN
 #undef MREMAP_RAYCAST_TRI_SAMPLES_MAX
 #undef MREMAP_DEFAULT_BUFSIZE
+#undef MREMAP_GRAIN_SIZE
 
 /** \} */
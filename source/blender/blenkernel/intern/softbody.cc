@@ -23,6 +23,8 @@
  * </pre>
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
@@ -42,13 +44,15 @@
 #include "DNA_scene_types.h"
 
 #include "BLI_ghash.h"
+#include "BLI_kdopbvh.h"
 #include "BLI_listbase.h"
 #include "BLI_math_geom.h"
 #include "BLI_math_matrix.h"
 #include "BLI_math_vector.h"
-#include "BLI_threads.h"
+#include "BLI_task.hh"
 #include "BLI_time.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_collection.h"
 #include "BKE_collision.h"
@@ -61,7 +65,6 @@
 #include "BKE_mesh.hh"
 #include "BKE_modifier.hh"
 #include "BKE_pointcache.h"
-#include "BKE_scene.h"
 #include "BKE_softbody.h"
 
 #include "DEG_depsgraph.hh"
@@ -111,21 +114,6 @@ typedef struct SBScratch {
   ReferenceState Ref;
 } SBScratch;
 
-typedef struct SB_thread_context {
-  Scene *scene;
-  Object *ob;
-  float forcetime;
-  float timenow;
-  int ifirst;
-  int ilast;
-  ListBase *effectors;
-  int do_deflector;
-  float fieldfactor;
-  float windfactor;
-  int nr;
-  int tot;
-} SB_thread_context;
-
 #define MID_PRESERVE 1
 
 #define SOFTGOALSNAP 0.999f
@@ -263,11 +251,91 @@ typedef struct ccd_Mesh {
   const blender::int3 *vert_tris;
   int safety;
   ccdf_minmax *mima;
+  /* Tree of the `mima` boxes, rebuilt every step and shared by all collision queries. */
+  BVHTree *bvhtree;
   /* Axis Aligned Bounding Box AABB */
   float bbmin[3];
   float bbmax[3];
 } ccd_Mesh;
 
+/* Elements handled by one task when only updating the state of points or springs. */
+#define SB_STATE_GRAIN_SIZE 1024
+/* Elements handled by one task when computing forces and collisions. */
+#define SB_FORCES_GRAIN_SIZE 128
+
+/** Indices found by a BVH tree query, sorted to keep the order of a loop over all elements. */
+using BVHQueryResult = blender::Vector<int, 64>;
+
+typedef struct BVHBoxQuery {
+  float min[3], max[3];
+  BVHQueryResult *r_indices;
+} BVHBoxQuery;
+
+static bool bvh_box_query_overlap(const BVHTreeAxisRange *bounds, const BVHBoxQuery *query)
+{
+  return !((query->max[0] < bounds[0].min) || (query->min[0] > bounds[0].max) ||
+           (query->max[1] < bounds[1].min) || (query->min[1] > bounds[1].max) ||
+           (query->max[2] < bounds[2].min) || (query->min[2] > bounds[2].max));
+}
+
+static bool bvh_box_query_parent_cb(const BVHTreeAxisRange *bounds, void *userdata)
+{
+  return bvh_box_query_overlap(bounds, static_cast<const BVHBoxQuery *>(userdata));
+}
+
+static bool bvh_box_query_leaf_cb(const BVHTreeAxisRange * /*bounds*/,
+                                  int index,
+                                  void *userdata)
+{
+  /* The leaf bounds have been tested like a parent already. */
+  BVHBoxQuery *query = static_cast<BVHBoxQuery *>(userdata);
+  query->r_indices->append(index);
+  return true;
+}
+
+static bool bvh_box_query_order_cb(const BVHTreeAxisRange * /*bounds*/,
+                                   char /*axis*/,
+                                   void * /*userdata*/)
+{
+  return true;
+}
+
+/**
+ * Find the leaves of an axis aligned tree that overlap the box. Leaves are inflated by the tree
+ * epsilon, so callers still do their exact test. The result is sorted by index, so that forces
+ * are accumulated in the same order as when looping over all elements.
+ */
+static void bvh_box_query(BVHTree *tree,
+                          const float min[3],
+                          const float max[3],
+                          BVHQueryResult &r_indices)
+{
+  BVHBoxQuery query;
+  copy_v3_v3(query.min, min);
+  copy_v3_v3(query.max, max);
+  query.r_indices = &r_indices;
+  r_indices.clear();
+  BLI_bvhtree_walk_dfs(
+      tree, bvh_box_query_parent_cb, bvh_box_query_leaf_cb, bvh_box_query_order_cb, &query);
+  std::sort(r_indices.begin(), r_indices.end());
+}
+
+/** Build the tree of the triangle bounds, the leaves contain the `mima` boxes. */
+static void ccd_mesh_build_bvhtree(ccd_Mesh *pccd_M)
+{
+  if (pccd_M->bvhtree) {
+    BLI_bvhtree_free(pccd_M->bvhtree);
+  }
+  pccd_M->bvhtree = BLI_bvhtree_new(pccd_M->tri_num, 0.0f, 4, 6);
+  for (int i = 0; i < pccd_M->tri_num; i++) {
+    const ccdf_minmax *mima = &pccd_M->mima[i];
+    const float co[2][3] = {{mima->minx, mima->miny, mima->minz},
+                            {mima->maxx, mima->maxy, mima->maxz}};
+    BLI_bvhtree_insert(pccd_M->bvhtree, i, co[0], 2);
+  }
+  BLI_bvhtree_balance(pccd_M->bvhtree);
+}
+
 static ccd_Mesh *ccd_mesh_make(Object *ob)
 {
   CollisionModifierData *cmd;
@@ -293,6 +361,7 @@ static ccd_Mesh *ccd_mesh_make(Object *ob)
   pccd_M->bbmin[0] = pccd_M->bbmin[1] = pccd_M->bbmin[2] = 1e30f;
   pccd_M->bbmax[0] = pccd_M->bbmax[1] = pccd_M->bbmax[2] = -1e30f;
   pccd_M->vert_positions_prev = nullptr;
+  pccd_M->bvhtree = nullptr;
 
   /* Blow it up with force-field ranges. */
   hull = max_ff(ob->pd->pdef_sbift, ob->pd->pdef_sboft);
@@ -353,6 +422,8 @@ static ccd_Mesh *ccd_mesh_make(Object *ob)
     mima->maxz = max_ff(mima->maxz, v[2] + hull);
   }
 
+  ccd_mesh_build_bvhtree(pccd_M);
+
   return pccd_M;
 }
 static void ccd_mesh_update(Object *ob, ccd_Mesh *pccd_M)
@@ -472,6 +543,8 @@ static void ccd_mesh_update(Object *ob, ccd_Mesh *pccd_M)
     mima->maxy = max_ff(mima->maxy, v[1] + hull);
     mima->maxz = max_ff(mima->maxz, v[2] + hull);
   }
+
+  ccd_mesh_build_bvhtree(pccd_M);
 }
 
 static void ccd_mesh_free(ccd_Mesh *ccdm)
@@ -484,6 +557,7 @@ static void ccd_mesh_free(ccd_Mesh *ccdm)
       MEM_freeN((void *)ccdm->vert_positions_prev);
     }
     MEM_freeN(ccdm->mima);
+    BLI_bvhtree_free(ccdm->bvhtree);
     MEM_freeN(ccdm);
   }
 }
@@ -1139,9 +1213,10 @@ static int sb_detect_face_collisionCached(const float face_v1[3],
   Object *ob;
   GHash *hash;
   GHashIterator *ihash;
+  BVHQueryResult tris;
   float nv1[3], nv2[3], nv3[3], edge1[3], edge2[3], d_nvect[3], aabbmin[3], aabbmax[3];
   float t, tune = 10.0f;
-  int a, deflected = 0;
+  int deflected = 0;
 
   aabbmin[0] = min_fff(face_v1[0], face_v2[0], face_v3[0]);
   aabbmin[1] = min_fff(face_v1[1], face_v2[1], face_v3[1]);
@@ -1162,14 +1237,10 @@ static int sb_detect_face_collisionCached(const float face_v1[3],
         const float(*vert_positions)[3] = nullptr;
         const float(*vert_positions_prev)[3] = nullptr;
         const blender::int3 *vt = nullptr;
-        const ccdf_minmax *mima = nullptr;
 
         if (ccdm) {
           vert_positions = ccdm->vert_positions;
-          vt = ccdm->vert_tris;
           vert_positions_prev = ccdm->vert_positions_prev;
-          mima = ccdm->mima;
-          a = ccdm->tri_num;
 
           if ((aabbmax[0] < ccdm->bbmin[0]) || (aabbmax[1] < ccdm->bbmin[1]) ||
               (aabbmax[2] < ccdm->bbmin[2]) || (aabbmin[0] > ccdm->bbmax[0]) ||
@@ -1188,15 +1259,16 @@ static int sb_detect_face_collisionCached(const float face_v1[3],
         }
 
         /* Use mesh. */
-        while (a--) {
+        bvh_box_query(ccdm->bvhtree, aabbmin, aabbmax, tris);
+        for (const int tri : tris) {
+          const ccdf_minmax *mima = &ccdm->mima[tri];
           if ((aabbmax[0] < mima->minx) || (aabbmin[0] > mima->maxx) ||
               (aabbmax[1] < mima->miny) || (aabbmin[1] > mima->maxy) ||
               (aabbmax[2] < mima->minz) || (aabbmin[2] > mima->maxz))
           {
-            mima++;
-            vt++;
             continue;
           }
+          vt = &ccdm->vert_tris[tri];
 
           if (vert_positions) {
 
@@ -1229,9 +1301,7 @@ static int sb_detect_face_collisionCached(const float face_v1[3],
             *damp = tune * ob->pd->pdef_sbdamp;
             deflected = 2;
           }
-          mima++;
-          vt++;
-        } /* while a */
+        }
       }   /* if (ob->pd && ob->pd->deflect) */
       BLI_ghashIterator_step(ihash);
     }
@@ -1240,71 +1310,94 @@ static int sb_detect_face_collisionCached(const float face_v1[3],
   return deflected;
 }
 
+/** Collision of one body face, applied to its points after all faces have been tested. */
+typedef struct BodyFaceCollision {
+  float feedback[3];
+  float damp;
+} BodyFaceCollision;
+
 static void scan_for_ext_face_forces(Object *ob, float timenow)
 {
   SoftBody *sb = ob->soft;
   BodyFace *bf;
   int a;
-  float damp = 0.0f, choke = 1.0f;
+  float choke = 1.0f;
   float tune = -10.0f;
-  float feedback[3];
 
   if (sb && sb->scratch->bodyface_num) {
+    const int bodyface_num = sb->scratch->bodyface_num;
+    BodyFaceCollision *collisions = static_cast<BodyFaceCollision *>(
+        MEM_malloc_arrayN(bodyface_num, sizeof(BodyFaceCollision), "BodyFaceCollision"));
+
+    /* The detection only reads the points, so the faces can be tested in parallel. */
+    blender::threading::parallel_for(
+        blender::IndexRange(bodyface_num),
+        SB_FORCES_GRAIN_SIZE,
+        [&](const blender::IndexRange range) {
+          for (const int i : range) {
+            BodyFace *bf = &sb->scratch->bodyface[i];
+            BodyFaceCollision *collision = &collisions[i];
+            bf->ext_force[0] = bf->ext_force[1] = bf->ext_force[2] = 0.0f;
+            collision->damp = 0.0f;
+            /*+++edges intruding. */
+            bf->flag &= ~BFF_INTERSECT;
+            zero_v3(collision->feedback);
+            if (sb_detect_face_collisionCached(sb->bpoint[bf->v1].pos,
+                                               sb->bpoint[bf->v2].pos,
+                                               sb->bpoint[bf->v3].pos,
+                                               &collision->damp,
+                                               collision->feedback,
+                                               ob,
+                                               timenow))
+            {
+              bf->flag |= BFF_INTERSECT;
+              continue;
+            }
+            /*---edges intruding. */
+
+            /*+++ close vertices. */
+            bf->flag &= ~BFF_CLOSEVERT;
+            zero_v3(collision->feedback);
+            if (sb_detect_face_pointCached(sb->bpoint[bf->v1].pos,
+                                           sb->bpoint[bf->v2].pos,
+                                           sb->bpoint[bf->v3].pos,
+                                           &collision->damp,
+                                           collision->feedback,
+                                           ob,
+                                           timenow))
+            {
+              bf->flag |= BFF_CLOSEVERT;
+            }
+            /*--- close vertices. */
+          }
+        });
 
+    /* Faces share points, so the forces are added in face order. The intrusion force is weaker
+     * once a face has been tested for close vertices. */
     bf = sb->scratch->bodyface;
-    for (a = 0; a < sb->scratch->bodyface_num; a++, bf++) {
-      bf->ext_force[0] = bf->ext_force[1] = bf->ext_force[2] = 0.0f;
-      /*+++edges intruding. */
-      bf->flag &= ~BFF_INTERSECT;
-      zero_v3(feedback);
-      if (sb_detect_face_collisionCached(sb->bpoint[bf->v1].pos,
-                                         sb->bpoint[bf->v2].pos,
-                                         sb->bpoint[bf->v3].pos,
-                                         &damp,
-                                         feedback,
-                                         ob,
-                                         timenow))
-      {
-        madd_v3_v3fl(sb->bpoint[bf->v1].force, feedback, tune);
-        madd_v3_v3fl(sb->bpoint[bf->v2].force, feedback, tune);
-        madd_v3_v3fl(sb->bpoint[bf->v3].force, feedback, tune);
-        //              madd_v3_v3fl(bf->ext_force, feedback, tune);
-        bf->flag |= BFF_INTERSECT;
-        choke = min_ff(max_ff(damp, choke), 1.0f);
-      }
-      /*---edges intruding. */
-
-      /*+++ close vertices. */
+    for (a = 0; a < bodyface_num; a++, bf++) {
+      const BodyFaceCollision *collision = &collisions[a];
       if ((bf->flag & BFF_INTERSECT) == 0) {
-        bf->flag &= ~BFF_CLOSEVERT;
         tune = -1.0f;
-        zero_v3(feedback);
-        if (sb_detect_face_pointCached(sb->bpoint[bf->v1].pos,
-                                       sb->bpoint[bf->v2].pos,
-                                       sb->bpoint[bf->v3].pos,
-                                       &damp,
-                                       feedback,
-                                       ob,
-                                       timenow))
-        {
-          madd_v3_v3fl(sb->bpoint[bf->v1].force, feedback, tune);
-          madd_v3_v3fl(sb->bpoint[bf->v2].force, feedback, tune);
-          madd_v3_v3fl(sb->bpoint[bf->v3].force, feedback, tune);
-          //                  madd_v3_v3fl(bf->ext_force, feedback, tune);
-          bf->flag |= BFF_CLOSEVERT;
-          choke = min_ff(max_ff(damp, choke), 1.0f);
+        if ((bf->flag & BFF_CLOSEVERT) == 0) {
+          continue;
         }
       }
-      /*--- close vertices. */
+      madd_v3_v3fl(sb->bpoint[bf->v1].force, collision->feedback, tune);
+      madd_v3_v3fl(sb->bpoint[bf->v2].force, collision->feedback, tune);
+      madd_v3_v3fl(sb->bpoint[bf->v3].force, collision->feedback, tune);
+      choke = min_ff(max_ff(collision->damp, choke), 1.0f);
     }
     bf = sb->scratch->bodyface;
-    for (a = 0; a < sb->scratch->bodyface_num; a++, bf++) {
+    for (a = 0; a < bodyface_num; a++, bf++) {
       if ((bf->flag & BFF_INTERSECT) || (bf->flag & BFF_CLOSEVERT)) {
         sb->bpoint[bf->v1].choke2 = max_ff(sb->bpoint[bf->v1].choke2, choke);
         sb->bpoint[bf->v2].choke2 = max_ff(sb->bpoint[bf->v2].choke2, choke);
         sb->bpoint[bf->v3].choke2 = max_ff(sb->bpoint[bf->v3].choke2, choke);
       }
     }
+
+    MEM_freeN(collisions);
   }
 }
 
@@ -1322,9 +1415,10 @@ static int sb_detect_edge_collisionCached(const float edge_v1[3],
   Object *ob;
   GHash *hash;
   GHashIterator *ihash;
+  BVHQueryResult tris;
   float nv1[3], nv2[3], nv3[3], edge1[3], edge2[3], d_nvect[3], aabbmin[3], aabbmax[3];
   float t, el;
-  int a, deflected = 0;
+  int deflected = 0;
 
   minmax_v3v3_v3(aabbmin, aabbmax, edge_v1);
   minmax_v3v3_v3(aabbmin, aabbmax, edge_v2);
@@ -1343,14 +1437,10 @@ static int sb_detect_edge_collisionCached(const float edge_v1[3],
         const float(*vert_positions)[3] = nullptr;
         const float(*vert_positions_prev)[3] = nullptr;
         const blender::int3 *vt = nullptr;
-        const ccdf_minmax *mima = nullptr;
 
         if (ccdm) {
           vert_positions = ccdm->vert_positions;
           vert_positions_prev = ccdm->vert_positions_prev;
-          vt = ccdm->vert_tris;
-          mima = ccdm->mima;
-          a = ccdm->tri_num;
 
           if ((aabbmax[0] < ccdm->bbmin[0]) || (aabbmax[1] < ccdm->bbmin[1]) ||
               (aabbmax[2] < ccdm->bbmin[2]) || (aabbmin[0] > ccdm->bbmax[0]) ||
@@ -1369,15 +1459,16 @@ static int sb_detect_edge_collisionCached(const float edge_v1[3],
         }
 
         /* Use mesh. */
-        while (a--) {
+        bvh_box_query(ccdm->bvhtree, aabbmin, aabbmax, tris);
+        for (const int tri : tris) {
+          const ccdf_minmax *mima = &ccdm->mima[tri];
           if ((aabbmax[0] < mima->minx) || (aabbmin[0] > mima->maxx) ||
               (aabbmax[1] < mima->miny) || (aabbmin[1] > mima->maxy) ||
               (aabbmax[2] < mima->minz) || (aabbmin[2] > mima->maxz))
           {
-            mima++;
-            vt++;
             continue;
           }
+          vt = &ccdm->vert_tris[tri];
 
           if (vert_positions) {
 
@@ -1415,10 +1506,7 @@ static int sb_detect_edge_collisionCached(const float edge_v1[3],
             *damp = ob->pd->pdef_sbdamp;
             deflected = 2;
           }
-
-          mima++;
-          vt++;
-        } /* while a */
+        }
       }   /* if (ob->pd && ob->pd->deflect) */
       BLI_ghashIterator_step(ihash);
     }
@@ -1502,14 +1590,6 @@ static void _scan_for_ext_spring_forces(
   }
 }
 
-static void *exec_scan_for_ext_spring_forces(void *data)
-{
-  SB_thread_context *pctx = (SB_thread_context *)data;
-  _scan_for_ext_spring_forces(
-      pctx->scene, pctx->ob, pctx->timenow, pctx->ifirst, pctx->ilast, pctx->effectors);
-  return nullptr;
-}
-
 static void sb_sfesf_threads_run(Depsgraph *depsgraph,
                                  Scene *scene,
                                  Object *ob,
@@ -1518,62 +1598,16 @@ static void sb_sfesf_threads_run(Depsgraph *depsgraph,
                                  int *ptr_to_break_func(void))
 {
   UNUSED_VARS(ptr_to_break_func);
-  ListBase threads;
-  SB_thread_context *sb_threads;
-  int i, totthread, left, dec;
-
-  /* wild guess .. may increase with better thread management 'above'
-   * or even be UI option sb->spawn_cf_threads_nopts */
-  int lowsprings = 100;
-
   ListBase *effectors = BKE_effectors_create(
       depsgraph, ob, nullptr, ob->soft->effector_weights, false);
 
-  /* figure the number of threads while preventing pretty pointless threading overhead */
-  totthread = BKE_scene_num_threads(scene);
-  /* What if we got zillions of CPUs running but less to spread. */
-  while ((totsprings / totthread < lowsprings) && (totthread > 1)) {
-    totthread--;
-  }
-
-  sb_threads = static_cast<SB_thread_context *>(
-      MEM_callocN(sizeof(SB_thread_context) * totthread, "SBSpringsThread"));
-  left = totsprings;
-  dec = totsprings / totthread + 1;
-  for (i = 0; i < totthread; i++) {
-    sb_threads[i].scene = scene;
-    sb_threads[i].ob = ob;
-    sb_threads[i].forcetime = 0.0; /* not used here */
-    sb_threads[i].timenow = timenow;
-    sb_threads[i].ilast = left;
-    left = left - dec;
-    if (left > 0) {
-      sb_threads[i].ifirst = left;
-    }
-    else {
-      sb_threads[i].ifirst = 0;
-    }
-    sb_threads[i].effectors = effectors;
-    sb_threads[i].do_deflector = false; /* not used here */
-    sb_threads[i].fieldfactor = 0.0f;   /* not used here */
-    sb_threads[i].windfactor = 0.0f;    /* not used here */
-    sb_threads[i].nr = i;
-    sb_threads[i].tot = totthread;
-  }
-  if (totthread > 1) {
-    BLI_threadpool_init(&threads, exec_scan_for_ext_spring_forces, totthread);
-
-    for (i = 0; i < totthread; i++) {
-      BLI_threadpool_insert(&threads, &sb_threads[i]);
-    }
-
-    BLI_threadpool_end(&threads);
-  }
-  else {
-    exec_scan_for_ext_spring_forces(&sb_threads[0]);
-  }
-  /* clean up */
-  MEM_freeN(sb_threads);
+  blender::threading::parallel_for(
+      blender::IndexRange(totsprings),
+      SB_FORCES_GRAIN_SIZE,
+      [&](const blender::IndexRange range) {
+        _scan_for_ext_spring_forces(
+            scene, ob, timenow, range.first(), range.one_after_last(), effectors);
+      });
 
   BKE_effectors_free(effectors);
 }
@@ -1623,12 +1657,13 @@ static int sb_detect_vertex_collisionCached(float opco[3],
   Object *ob = nullptr;
   GHash *hash;
   GHashIterator *ihash;
+  BVHQueryResult tris;
   float nv1[3], nv2[3], nv3[3], edge1[3], edge2[3], d_nvect[3], dv1[3], ve[3],
       avel[3] = {0.0, 0.0, 0.0}, vv1[3], vv2[3], vv3[3], coledge[3] = {0.0f, 0.0f, 0.0f},
       mindistedge = 1000.0f, outerforceaccu[3], innerforceaccu[3], facedist,
       /* n_mag, */ /* UNUSED */ force_mag_norm, minx, miny, minz, maxx, maxy, maxz,
       innerfacethickness = -0.5f, outerfacethickness = 0.2f, ee = 5.0f, ff = 0.1f, fa = 1;
-  int a, deflected = 0, cavel = 0, ci = 0;
+  int deflected = 0, cavel = 0, ci = 0;
   /* init */
   *intrusion = 0.0f;
   hash = vertexowner->soft->scratch->colliderhash;
@@ -1646,14 +1681,10 @@ static int sb_detect_vertex_collisionCached(float opco[3],
         const float(*vert_positions)[3] = nullptr;
         const float(*vert_positions_prev)[3] = nullptr;
         const blender::int3 *vt = nullptr;
-        const ccdf_minmax *mima = nullptr;
 
         if (ccdm) {
           vert_positions = ccdm->vert_positions;
           vert_positions_prev = ccdm->vert_positions_prev;
-          vt = ccdm->vert_tris;
-          mima = ccdm->mima;
-          a = ccdm->tri_num;
 
           minx = ccdm->bbmin[0];
           miny = ccdm->bbmin[1];
@@ -1687,14 +1718,15 @@ static int sb_detect_vertex_collisionCached(float opco[3],
         fa = 1.0f / fa;
         avel[0] = avel[1] = avel[2] = 0.0f;
         /* Use mesh. */
-        while (a--) {
+        bvh_box_query(ccdm->bvhtree, opco, opco, tris);
+        for (const int tri : tris) {
+          const ccdf_minmax *mima = &ccdm->mima[tri];
           if ((opco[0] < mima->minx) || (opco[0] > mima->maxx) || (opco[1] < mima->miny) ||
               (opco[1] > mima->maxy) || (opco[2] < mima->minz) || (opco[2] > mima->maxz))
           {
-            mima++;
-            vt++;
             continue;
           }
+          vt = &ccdm->vert_tris[tri];
 
           if (vert_positions) {
 
@@ -1762,10 +1794,7 @@ static int sb_detect_vertex_collisionCached(float opco[3],
               ci++;
             }
           }
-
-          mima++;
-          vt++;
-        } /* while a */
+        }
       }   /* if (ob->pd && ob->pd->deflect) */
       BLI_ghashIterator_step(ihash);
     }
@@ -1959,9 +1988,12 @@ static int _softbody_calc_forces_slice_in_a_thread(Scene *scene,
                                                    ListBase *effectors,
                                                    int do_deflector,
                                                    float fieldfactor,
-                                                   float windfactor)
+                                                   float windfactor,
+                                                   BVHTree *ball_tree,
+                                                   std::atomic<bool> *r_do_fuzzy)
 {
   UNUSED_VARS(ptr_to_break_func);
+  BVHQueryResult balls;
   float iks;
   int bb, do_selfcollision, do_springcollision, do_aero;
   int number_of_points_here = ilast - ifirst;
@@ -1995,7 +2027,7 @@ static int _softbody_calc_forces_slice_in_a_thread(Scene *scene,
   for (bb = number_of_points_here; bb > 0; bb--, bp++) {
     /* clear forces  accumulator */
     bp->force[0] = bp->force[1] = bp->force[2] = 0.0;
-    /* naive ball self collision */
+    /* ball self collision, with candidates from the tree of all balls */
     /* needs to be done if goal snaps or not */
     if (do_selfcollision) {
       int attached;
@@ -2006,10 +2038,18 @@ static int _softbody_calc_forces_slice_in_a_thread(Scene *scene,
       float distance;
       float compare;
       float bstune = sb->ballstiff;
+      float ball_min[3], ball_max[3];
+
+      for (c = 0; c < 3; c++) {
+        ball_min[c] = bp->pos[c] - bp->colball;
+        ball_max[c] = bp->pos[c] + bp->colball;
+      }
+      bvh_box_query(ball_tree, ball_min, ball_max, balls);
 
       /* Running in a slice we must not assume anything done with obp
        * neither alter the data of obp. */
-      for (c = sb->totpoint, obp = sb->bpoint; c > 0; c--, obp++) {
+      for (const int ball : balls) {
+        obp = &sb->bpoint[ball];
         compare = (obp->colball + bp->colball);
         sub_v3_v3v3(def, bp->pos, obp->pos);
         /* rather check the AABBoxes before ever calculating the real distance */
@@ -2042,7 +2082,7 @@ static int _softbody_calc_forces_slice_in_a_thread(Scene *scene,
         }
       }
     }
-    /* naive ball self collision done */
+    /* ball self collision done */
 
     if (_final_goal(ob, bp) < SOFTGOALSNAP) { /* omit this bp when it snaps */
       float auxvect[3];
@@ -2135,7 +2175,7 @@ static int _softbody_calc_forces_slice_in_a_thread(Scene *scene,
 
         if (sb_deflect_face(ob, bp->pos, facenormal, defforce, &cf, timenow, vel, &intrusion)) {
           if (intrusion < 0.0f) {
-            sb->scratch->flag |= SBF_DOFUZZY;
+            *r_do_fuzzy = true;
             bp->loc_flag |= SBF_DOFUZZY;
             bp->choke = sb->choke * 0.01f;
           }
@@ -2173,21 +2213,31 @@ static int _softbody_calc_forces_slice_in_a_thread(Scene *scene,
   return 0; /* Done fine. */
 }
 
-static void *exec_softbody_calc_forces(void *data)
+/**
+ * Build the tree of the collision balls of all points, shared by the self collision of all
+ * points. The leaves are padded because the exact test in the slices rounds differently.
+ */
+static BVHTree *sb_ball_tree_create(const SoftBody *sb)
 {
-  SB_thread_context *pctx = (SB_thread_context *)data;
-  _softbody_calc_forces_slice_in_a_thread(pctx->scene,
-                                          pctx->ob,
-                                          pctx->forcetime,
-                                          pctx->timenow,
-                                          pctx->ifirst,
-                                          pctx->ilast,
-                                          nullptr,
-                                          pctx->effectors,
-                                          pctx->do_deflector,
-                                          pctx->fieldfactor,
-                                          pctx->windfactor);
-  return nullptr;
+  const BodyPoint *bp;
+  float scale = 0.0f;
+  int a;
+
+  for (a = 0, bp = sb->bpoint; a < sb->totpoint; a++, bp++) {
+    scale = max_ff(scale,
+                   max_fff(fabsf(bp->pos[0]), fabsf(bp->pos[1]), fabsf(bp->pos[2])) +
+                       fabsf(bp->colball));
+  }
+
+  BVHTree *tree = BLI_bvhtree_new(sb->totpoint, scale * 1e-5f, 4, 6);
+  for (a = 0, bp = sb->bpoint; a < sb->totpoint; a++, bp++) {
+    const float co[2][3] = {
+        {bp->pos[0] - bp->colball, bp->pos[1] - bp->colball, bp->pos[2] - bp->colball},
+        {bp->pos[0] + bp->colball, bp->pos[1] + bp->colball, bp->pos[2] + bp->colball}};
+    BLI_bvhtree_insert(tree, a, co[0], 2);
+  }
+  BLI_bvhtree_balance(tree);
+  return tree;
 }
 
 static void sb_cf_threads_run(Scene *scene,
@@ -2202,62 +2252,37 @@ static void sb_cf_threads_run(Scene *scene,
                               float windfactor)
 {
   UNUSED_VARS(ptr_to_break_func);
-  ListBase threads;
-  SB_thread_context *sb_threads;
-  int i, totthread, left, dec;
-
-  /* wild guess .. may increase with better thread management 'above'
-   * or even be UI option sb->spawn_cf_threads_nopts. */
-  int lowpoints = 100;
-
-  /* figure the number of threads while preventing pretty pointless threading overhead */
-  totthread = BKE_scene_num_threads(scene);
-  /* What if we got zillions of CPUs running but less to spread. */
-  while ((totpoint / totthread < lowpoints) && (totthread > 1)) {
-    totthread--;
-  }
-
-  // printf("sb_cf_threads_run spawning %d threads\n", totthread);
-
-  sb_threads = static_cast<SB_thread_context *>(
-      MEM_callocN(sizeof(SB_thread_context) * totthread, "SBThread"));
-  left = totpoint;
-  dec = totpoint / totthread + 1;
-  for (i = 0; i < totthread; i++) {
-    sb_threads[i].scene = scene;
-    sb_threads[i].ob = ob;
-    sb_threads[i].forcetime = forcetime;
-    sb_threads[i].timenow = timenow;
-    sb_threads[i].ilast = left;
-    left = left - dec;
-    if (left > 0) {
-      sb_threads[i].ifirst = left;
-    }
-    else {
-      sb_threads[i].ifirst = 0;
-    }
-    sb_threads[i].effectors = effectors;
-    sb_threads[i].do_deflector = do_deflector;
-    sb_threads[i].fieldfactor = fieldfactor;
-    sb_threads[i].windfactor = windfactor;
-    sb_threads[i].nr = i;
-    sb_threads[i].tot = totthread;
-  }
+  SoftBody *sb = ob->soft;
+  BVHTree *ball_tree = nullptr;
+  std::atomic<bool> do_fuzzy = false;
 
-  if (totthread > 1) {
-    BLI_threadpool_init(&threads, exec_softbody_calc_forces, totthread);
+  if ((ob->softflag & OB_SB_EDGES) && (sb->bspring) && (ob->softflag & OB_SB_SELF)) {
+    ball_tree = sb_ball_tree_create(sb);
+  }
 
-    for (i = 0; i < totthread; i++) {
-      BLI_threadpool_insert(&threads, &sb_threads[i]);
-    }
+  blender::threading::parallel_for(
+      blender::IndexRange(totpoint), SB_FORCES_GRAIN_SIZE, [&](const blender::IndexRange range) {
+        _softbody_calc_forces_slice_in_a_thread(scene,
+                                                ob,
+                                                forcetime,
+                                                timenow,
+                                                range.first(),
+                                                range.one_after_last(),
+                                                nullptr,
+                                                effectors,
+                                                do_deflector,
+                                                fieldfactor,
+                                                windfactor,
+                                                ball_tree,
+                                                &do_fuzzy);
+      });
 
-    BLI_threadpool_end(&threads);
+  if (do_fuzzy) {
+    sb->scratch->flag |= SBF_DOFUZZY;
   }
-  else {
-    exec_softbody_calc_forces(&sb_threads[0]);
+  if (ball_tree) {
+    BLI_bvhtree_free(ball_tree);
   }
-  /* clean up */
-  MEM_freeN(sb_threads);
 }
 
 static void softbody_calc_forces(
@@ -2320,160 +2345,200 @@ static void softbody_calc_forces(
   BKE_effectors_free(effectors);
 }
 
-static void softbody_apply_forces(Object *ob, float forcetime, int mode, float *err, int mid_flags)
-{
-  /* time evolution */
-  /* actually does an explicit euler step mode == 0 */
-  /* or heun ~ 2nd order runge-kutta steps, mode 1, 2 */
-  SoftBody *sb = ob->soft; /* is supposed to be there */
-  BodyPoint *bp;
-  float dx[3] = {0}, dv[3], aabbmin[3], aabbmax[3], cm[3] = {0.0f, 0.0f, 0.0f};
-  float timeovermass /*, freezeloc=0.00001f, freezeforce=0.00000000001f*/;
-  float maxerrpos = 0.0f, maxerrvel = 0.0f;
-  int a, fuzzy = 0;
-
-  forcetime *= sb_time_scale(ob);
+/** Statistics of all points gathered while applying the forces. */
+typedef struct SBApplyForcesStats {
+  float aabbmin[3], aabbmax[3];
+  float maxerrpos, maxerrvel;
+  bool fuzzy;
+} SBApplyForcesStats;
 
-  aabbmin[0] = aabbmin[1] = aabbmin[2] = 1e20f;
-  aabbmax[0] = aabbmax[1] = aabbmax[2] = -1e20f;
+static void softbody_apply_forces_point(Object *ob,
+                                        BodyPoint *bp,
+                                        float forcetime,
+                                        int mode,
+                                        int mid_flags,
+                                        SBApplyForcesStats *stats)
+{
+  float dx[3], dv[3];
+  float timeovermass;
 
-  /* old one with homogeneous masses */
+  /* Now we have individual masses. */
   /* claim a minimum mass for vertex */
-#if 0
-  if (sb->nodemass > 0.009999f) {
-    timeovermass = forcetime / sb->nodemass;
+  if (_final_mass(ob, bp) > 0.009999f) {
+    timeovermass = forcetime / _final_mass(ob, bp);
   }
   else {
     timeovermass = forcetime / 0.009999f;
   }
-#endif
 
-  for (a = sb->totpoint, bp = sb->bpoint; a > 0; a--, bp++) {
-    /* Now we have individual masses. */
-    /* claim a minimum mass for vertex */
-    if (_final_mass(ob, bp) > 0.009999f) {
-      timeovermass = forcetime / _final_mass(ob, bp);
+  if (_final_goal(ob, bp) < SOFTGOALSNAP) {
+    /* this makes t~ = t */
+    if (mid_flags & MID_PRESERVE) {
+      copy_v3_v3(dx, bp->vec);
+    }
+
+    /**
+     * So here is:
+     * <pre>
+     * (v)' = a(cceleration) =
+     *     sum(F_springs)/m + gravitation + some friction forces + more forces.
+     * </pre>
+     *
+     * The ( ... )' operator denotes derivate respective time.
+     *
+     * The euler step for velocity then becomes:
+     * <pre>
+     * v(t + dt) = v(t) + a(t) * dt
+     * </pre>
+     */
+    mul_v3_fl(bp->force, timeovermass); /* individual mass of node here */
+    /* some nasty if's to have heun in here too */
+    copy_v3_v3(dv, bp->force);
+
+    if (mode == 1) {
+      copy_v3_v3(bp->prevvec, bp->vec);
+      copy_v3_v3(bp->prevdv, dv);
+    }
+
+    if (mode == 2) {
+      /* be optimistic and execute step */
+      bp->vec[0] = bp->prevvec[0] + 0.5f * (dv[0] + bp->prevdv[0]);
+      bp->vec[1] = bp->prevvec[1] + 0.5f * (dv[1] + bp->prevdv[1]);
+      bp->vec[2] = bp->prevvec[2] + 0.5f * (dv[2] + bp->prevdv[2]);
+      /* compare euler to heun to estimate error for step sizing */
+      stats->maxerrvel = max_ff(stats->maxerrvel, fabsf(dv[0] - bp->prevdv[0]));
+      stats->maxerrvel = max_ff(stats->maxerrvel, fabsf(dv[1] - bp->prevdv[1]));
+      stats->maxerrvel = max_ff(stats->maxerrvel, fabsf(dv[2] - bp->prevdv[2]));
     }
     else {
-      timeovermass = forcetime / 0.009999f;
+      add_v3_v3(bp->vec, bp->force);
     }
 
-    if (_final_goal(ob, bp) < SOFTGOALSNAP) {
-      /* this makes t~ = t */
-      if (mid_flags & MID_PRESERVE) {
-        copy_v3_v3(dx, bp->vec);
-      }
+    /* This makes `t~ = t+dt`. */
+    if (!(mid_flags & MID_PRESERVE)) {
+      copy_v3_v3(dx, bp->vec);
+    }
 
-      /**
-       * So here is:
-       * <pre>
-       * (v)' = a(cceleration) =
-       *     sum(F_springs)/m + gravitation + some friction forces + more forces.
-       * </pre>
-       *
-       * The ( ... )' operator denotes derivate respective time.
-       *
-       * The euler step for velocity then becomes:
-       * <pre>
-       * v(t + dt) = v(t) + a(t) * dt
-       * </pre>
-       */
-      mul_v3_fl(bp->force, timeovermass); /* individual mass of node here */
-      /* some nasty if's to have heun in here too */
-      copy_v3_v3(dv, bp->force);
-
-      if (mode == 1) {
-        copy_v3_v3(bp->prevvec, bp->vec);
-        copy_v3_v3(bp->prevdv, dv);
-      }
+    /* So here is: `(x)'= v(elocity)`.
+     * The euler step for location then becomes:
+     * `x(t + dt) = x(t) + v(t~) * dt` */
+    mul_v3_fl(dx, forcetime);
 
-      if (mode == 2) {
-        /* be optimistic and execute step */
-        bp->vec[0] = bp->prevvec[0] + 0.5f * (dv[0] + bp->prevdv[0]);
-        bp->vec[1] = bp->prevvec[1] + 0.5f * (dv[1] + bp->prevdv[1]);
-        bp->vec[2] = bp->prevvec[2] + 0.5f * (dv[2] + bp->prevdv[2]);
-        /* compare euler to heun to estimate error for step sizing */
-        maxerrvel = max_ff(maxerrvel, fabsf(dv[0] - bp->prevdv[0]));
-        maxerrvel = max_ff(maxerrvel, fabsf(dv[1] - bp->prevdv[1]));
-        maxerrvel = max_ff(maxerrvel, fabsf(dv[2] - bp->prevdv[2]));
+    /* the freezer coming sooner or later */
+#if 0
+    if ((dot_v3v3(dx, dx) < freezeloc) && (dot_v3v3(bp->force, bp->force) < freezeforce)) {
+      bp->frozen /= 2;
+    }
+    else {
+      bp->frozen = min_ff(bp->frozen * 1.05f, 1.0f);
+    }
+    mul_v3_fl(dx, bp->frozen);
+#endif
+    /* again some nasty if's to have heun in here too */
+    if (mode == 1) {
+      copy_v3_v3(bp->prevpos, bp->pos);
+      copy_v3_v3(bp->prevdx, dx);
+    }
+
+    if (mode == 2) {
+      bp->pos[0] = bp->prevpos[0] + 0.5f * (dx[0] + bp->prevdx[0]);
+      bp->pos[1] = bp->prevpos[1] + 0.5f * (dx[1] + bp->prevdx[1]);
+      bp->pos[2] = bp->prevpos[2] + 0.5f * (dx[2] + bp->prevdx[2]);
+      stats->maxerrpos = max_ff(stats->maxerrpos, fabsf(dx[0] - bp->prevdx[0]));
+      stats->maxerrpos = max_ff(stats->maxerrpos, fabsf(dx[1] - bp->prevdx[1]));
+      stats->maxerrpos = max_ff(stats->maxerrpos, fabsf(dx[2] - bp->prevdx[2]));
+
+      /* bp->choke is set when we need to pull a vertex or edge out of the collider.
+       * the collider object signals to get out by pushing hard. on the other hand
+       * we don't want to end up in deep space so we add some <viscosity>
+       * to balance that out */
+      if (bp->choke2 > 0.0f) {
+        mul_v3_fl(bp->vec, (1.0f - bp->choke2));
       }
-      else {
-        add_v3_v3(bp->vec, bp->force);
+      if (bp->choke > 0.0f) {
+        mul_v3_fl(bp->vec, (1.0f - bp->choke));
       }
+    }
+    else {
+      add_v3_v3(bp->pos, dx);
+    }
+  } /*snap*/
+  /* so while we are looping BPs anyway do statistics on the fly */
+  minmax_v3v3_v3(stats->aabbmin, stats->aabbmax, bp->pos);
+  if (bp->loc_flag & SBF_DOFUZZY) {
+    stats->fuzzy = true;
+  }
+}
 
-      /* This makes `t~ = t+dt`. */
-      if (!(mid_flags & MID_PRESERVE)) {
-        copy_v3_v3(dx, bp->vec);
-      }
+static void softbody_apply_forces(Object *ob, float forcetime, int mode, float *err, int mid_flags)
+{
+  /* time evolution */
+  /* actually does an explicit euler step mode == 0 */
+  /* or heun ~ 2nd order runge-kutta steps, mode 1, 2 */
+  SoftBody *sb = ob->soft; /* is supposed to be there */
+  float cm[3] = {0.0f, 0.0f, 0.0f};
+  /* float freezeloc=0.00001f, freezeforce=0.00000000001f; */
+  SBApplyForcesStats stats_init;
+
+  forcetime *= sb_time_scale(ob);
 
-      /* So here is: `(x)'= v(elocity)`.
-       * The euler step for location then becomes:
-       * `x(t + dt) = x(t) + v(t~) * dt` */
-      mul_v3_fl(dx, forcetime);
+  stats_init.aabbmin[0] = stats_init.aabbmin[1] = stats_init.aabbmin[2] = 1e20f;
+  stats_init.aabbmax[0] = stats_init.aabbmax[1] = stats_init.aabbmax[2] = -1e20f;
+  stats_init.maxerrpos = 0.0f;
+  stats_init.maxerrvel = 0.0f;
+  stats_init.fuzzy = false;
 
-      /* the freezer coming sooner or later */
+  /* old one with homogeneous masses */
+  /* claim a minimum mass for vertex */
 #if 0
-      if ((dot_v3v3(dx, dx) < freezeloc) && (dot_v3v3(bp->force, bp->force) < freezeforce)) {
-        bp->frozen /= 2;
-      }
-      else {
-        bp->frozen = min_ff(bp->frozen * 1.05f, 1.0f);
-      }
-      mul_v3_fl(dx, bp->frozen);
+  if (sb->nodemass > 0.009999f) {
+    timeovermass = forcetime / sb->nodemass;
+  }
+  else {
+    timeovermass = forcetime / 0.009999f;
+  }
 #endif
-      /* again some nasty if's to have heun in here too */
-      if (mode == 1) {
-        copy_v3_v3(bp->prevpos, bp->pos);
-        copy_v3_v3(bp->prevdx, dx);
-      }
 
-      if (mode == 2) {
-        bp->pos[0] = bp->prevpos[0] + 0.5f * (dx[0] + bp->prevdx[0]);
-        bp->pos[1] = bp->prevpos[1] + 0.5f * (dx[1] + bp->prevdx[1]);
-        bp->pos[2] = bp->prevpos[2] + 0.5f * (dx[2] + bp->prevdx[2]);
-        maxerrpos = max_ff(maxerrpos, fabsf(dx[0] - bp->prevdx[0]));
-        maxerrpos = max_ff(maxerrpos, fabsf(dx[1] - bp->prevdx[1]));
-        maxerrpos = max_ff(maxerrpos, fabsf(dx[2] - bp->prevdx[2]));
-
-        /* bp->choke is set when we need to pull a vertex or edge out of the collider.
-         * the collider object signals to get out by pushing hard. on the other hand
-         * we don't want to end up in deep space so we add some <viscosity>
-         * to balance that out */
-        if (bp->choke2 > 0.0f) {
-          mul_v3_fl(bp->vec, (1.0f - bp->choke2));
+  /* The points are independent, the statistics are reduced exactly in any order. */
+  const SBApplyForcesStats stats = blender::threading::parallel_reduce(
+      blender::IndexRange(sb->totpoint),
+      SB_STATE_GRAIN_SIZE,
+      stats_init,
+      [&](const blender::IndexRange range, SBApplyForcesStats stats) {
+        for (const int a : range) {
+          softbody_apply_forces_point(ob, &sb->bpoint[a], forcetime, mode, mid_flags, &stats);
         }
-        if (bp->choke > 0.0f) {
-          mul_v3_fl(bp->vec, (1.0f - bp->choke));
+        return stats;
+      },
+      [](const SBApplyForcesStats &a, const SBApplyForcesStats &b) {
+        SBApplyForcesStats stats;
+        for (int i = 0; i < 3; i++) {
+          stats.aabbmin[i] = min_ff(a.aabbmin[i], b.aabbmin[i]);
+          stats.aabbmax[i] = max_ff(a.aabbmax[i], b.aabbmax[i]);
         }
-      }
-      else {
-        add_v3_v3(bp->pos, dx);
-      }
-    } /*snap*/
-    /* so while we are looping BPs anyway do statistics on the fly */
-    minmax_v3v3_v3(aabbmin, aabbmax, bp->pos);
-    if (bp->loc_flag & SBF_DOFUZZY) {
-      fuzzy = 1;
-    }
-  } /*for*/
+        stats.maxerrpos = max_ff(a.maxerrpos, b.maxerrpos);
+        stats.maxerrvel = max_ff(a.maxerrvel, b.maxerrvel);
+        stats.fuzzy = a.fuzzy || b.fuzzy;
+        return stats;
+      });
 
   if (sb->totpoint) {
     mul_v3_fl(cm, 1.0f / sb->totpoint);
   }
   if (sb->scratch) {
-    copy_v3_v3(sb->scratch->aabbmin, aabbmin);
-    copy_v3_v3(sb->scratch->aabbmax, aabbmax);
+    copy_v3_v3(sb->scratch->aabbmin, stats.aabbmin);
+    copy_v3_v3(sb->scratch->aabbmax, stats.aabbmax);
   }
 
   if (err) { /* so step size will be controlled by biggest difference in slope */
     if (sb->solverflags & SBSO_OLDERR) {
-      *err = max_ff(maxerrpos, maxerrvel);
+      *err = max_ff(stats.maxerrpos, stats.maxerrvel);
     }
     else {
-      *err = maxerrpos;
+      *err = stats.maxerrpos;
     }
-    // printf("EP %f EV %f\n", maxerrpos, maxerrvel);
-    if (fuzzy) {
+    // printf("EP %f EV %f\n", stats.maxerrpos, stats.maxerrvel);
+    if (stats.fuzzy) {
       *err /= sb->fuzzyness;
     }
   }
@@ -2483,13 +2548,17 @@ static void softbody_apply_forces(Object *ob, float forcetime, int mode, float *
 static void softbody_restore_prev_step(Object *ob)
 {
   SoftBody *sb = ob->soft; /* is supposed to be there. */
-  BodyPoint *bp;
-  int a;
 
-  for (a = sb->totpoint, bp = sb->bpoint; a > 0; a--, bp++) {
-    copy_v3_v3(bp->vec, bp->prevvec);
-    copy_v3_v3(bp->pos, bp->prevpos);
-  }
+  blender::threading::parallel_for(
+      blender::IndexRange(sb->totpoint),
+      SB_STATE_GRAIN_SIZE,
+      [&](const blender::IndexRange range) {
+        for (const int a : range) {
+          BodyPoint *bp = &sb->bpoint[a];
+          copy_v3_v3(bp->vec, bp->prevvec);
+          copy_v3_v3(bp->pos, bp->prevpos);
+        }
+      });
 }
 
 #if 0
@@ -2575,37 +2644,42 @@ static void softbody_swap_state(Object *ob, float *ppos, float *pvel)
 static void softbody_apply_goalsnap(Object *ob)
 {
   SoftBody *sb = ob->soft; /* is supposed to be there */
-  BodyPoint *bp;
-  int a;
 
-  for (a = sb->totpoint, bp = sb->bpoint; a > 0; a--, bp++) {
-    if (_final_goal(ob, bp) >= SOFTGOALSNAP) {
-      copy_v3_v3(bp->prevpos, bp->pos);
-      copy_v3_v3(bp->pos, bp->origT);
-    }
-  }
+  blender::threading::parallel_for(
+      blender::IndexRange(sb->totpoint),
+      SB_STATE_GRAIN_SIZE,
+      [&](const blender::IndexRange range) {
+        for (const int a : range) {
+          BodyPoint *bp = &sb->bpoint[a];
+          if (_final_goal(ob, bp) >= SOFTGOALSNAP) {
+            copy_v3_v3(bp->prevpos, bp->pos);
+            copy_v3_v3(bp->pos, bp->origT);
+          }
+        }
+      });
 }
 
 static void apply_spring_memory(Object *ob)
 {
   SoftBody *sb = ob->soft;
-  BodySpring *bs;
-  BodyPoint *bp1, *bp2;
-  int a;
-  float b, l, r;
 
   if (sb && sb->totspring) {
-    b = sb->plastic;
-    for (a = 0; a < sb->totspring; a++) {
-      bs = &sb->bspring[a];
-      bp1 = &sb->bpoint[bs->v1];
-      bp2 = &sb->bpoint[bs->v2];
-      l = len_v3v3(bp1->pos, bp2->pos);
-      r = bs->len / l;
-      if ((r > 1.05f) || (r < 0.95f)) {
-        bs->len = ((100.0f - b) * bs->len + b * l) / 100.0f;
-      }
-    }
+    const float b = sb->plastic;
+    blender::threading::parallel_for(
+        blender::IndexRange(sb->totspring),
+        SB_STATE_GRAIN_SIZE,
+        [&](const blender::IndexRange range) {
+          for (const int a : range) {
+            BodySpring *bs = &sb->bspring[a];
+            const BodyPoint *bp1 = &sb->bpoint[bs->v1];
+            const BodyPoint *bp2 = &sb->bpoint[bs->v2];
+            const float l = len_v3v3(bp1->pos, bp2->pos);
+            const float r = bs->len / l;
+            if ((r > 1.05f) || (r < 0.95f)) {
+              bs->len = ((100.0f - b) * bs->len + b * l) / 100.0f;
+            }
+          }
+        });
   }
 }
 
@@ -2613,22 +2687,24 @@ static void apply_spring_memory(Object *ob)
 static void interpolate_exciter(Object *ob, int timescale, int time)
 {
   SoftBody *sb = ob->soft;
-  BodyPoint *bp;
-  float f;
-  int a;
-
-  f = float(time) / float(timescale);
-
-  for (a = sb->totpoint, bp = sb->bpoint; a > 0; a--, bp++) {
-    bp->origT[0] = bp->origS[0] + f * (bp->origE[0] - bp->origS[0]);
-    bp->origT[1] = bp->origS[1] + f * (bp->origE[1] - bp->origS[1]);
-    bp->origT[2] = bp->origS[2] + f * (bp->origE[2] - bp->origS[2]);
-    if (_final_goal(ob, bp) >= SOFTGOALSNAP) {
-      bp->vec[0] = bp->origE[0] - bp->origS[0];
-      bp->vec[1] = bp->origE[1] - bp->origS[1];
-      bp->vec[2] = bp->origE[2] - bp->origS[2];
-    }
-  }
+  const float f = float(time) / float(timescale);
+
+  blender::threading::parallel_for(
+      blender::IndexRange(sb->totpoint),
+      SB_STATE_GRAIN_SIZE,
+      [&](const blender::IndexRange range) {
+        for (const int a : range) {
+          BodyPoint *bp = &sb->bpoint[a];
+          bp->origT[0] = bp->origS[0] + f * (bp->origE[0] - bp->origS[0]);
+          bp->origT[1] = bp->origS[1] + f * (bp->origE[1] - bp->origS[1]);
+          bp->origT[2] = bp->origS[2] + f * (bp->origE[2] - bp->origS[2]);
+          if (_final_goal(ob, bp) >= SOFTGOALSNAP) {
+            bp->vec[0] = bp->origE[0] - bp->origS[0];
+            bp->vec[1] = bp->origE[1] - bp->origS[1];
+            bp->vec[2] = bp->origE[2] - bp->origS[2];
+          }
+        }
+      });
 }
 
 /* ************ converters ********** */
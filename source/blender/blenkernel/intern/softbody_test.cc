@@ -0,0 +1,155 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "BKE_appdir.h"
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_lattice.hh"
+#include "BKE_layer.h"
+#include "BKE_main.hh"
+#include "BKE_object.hh"
+#include "BKE_scene.h"
+#include "BKE_softbody.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_timeit.hh"
+
+#include "DEG_depsgraph.hh"
+
+#include "DNA_curve_types.h"
+#include "DNA_lattice_types.h"
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+#include "DNA_pointcache_types.h"
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+
+#ifdef WITH_TBB
+#  include <tbb/task_arena.h>
+#endif
+
+#define DO_PERF_TESTS 0
+
+namespace blender::bke::tests {
+
+class softbody : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    BKE_appdir_init();
+    IMB_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    IMB_exit();
+    BKE_appdir_exit();
+    CLG_exit();
+  }
+};
+
+/**
+ * Step a soft body lattice with `size^3` points, with goal, edge springs and self collision, for
+ * the given number of frames. Returns the positions of all points after every frame.
+ */
+static Array<float3> softbody_lattice_step(const int size, const int frames)
+{
+  Main *bmain = BKE_main_new();
+  G.main = bmain;
+  Scene *scene = BKE_scene_add(bmain, "SCSoftBody");
+  ViewLayer *view_layer = BKE_view_layer_default_view(scene);
+
+  Lattice *lt = BKE_lattice_add(bmain, "LTSoftBody");
+  Object *ob = BKE_object_add_only_object(bmain, OB_LATTICE, "OBSoftBody");
+  ob->data = lt;
+  BKE_lattice_resize(lt, size, size, size, nullptr);
+  unit_m4(ob->object_to_world);
+  unit_m4(ob->world_to_object);
+  ob->soft = sbNew();
+  ob->softflag |= OB_SB_GOAL | OB_SB_EDGES | OB_SB_SELF;
+
+  Depsgraph *depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+  DEG_make_active(depsgraph);
+
+  const int verts_num = lt->pntsu * lt->pntsv * lt->pntsw;
+  Array<float3> vert_coords(verts_num);
+  Array<float3> result(verts_num * frames);
+
+  const int start_frame = ob->soft->shared->pointcache->startframe;
+  for (const int i : IndexRange(frames)) {
+    /* The lattice points are the rest positions of the goal. */
+    for (const int vert : IndexRange(verts_num)) {
+      vert_coords[vert] = float3(lt->def[vert].vec);
+    }
+    sbObjectStep(depsgraph,
+                 scene,
+                 ob,
+                 float(start_frame + i),
+                 reinterpret_cast<float(*)[3]>(vert_coords.data()),
+                 verts_num);
+    result.as_mutable_span().slice(i * verts_num, verts_num).copy_from(vert_coords);
+  }
+  EXPECT_EQ(ob->soft->totpoint, verts_num);
+  EXPECT_EQ(ob->soft->last_frame, start_frame + frames - 1);
+
+  DEG_graph_free(depsgraph);
+  BKE_main_free(bmain);
+  G.main = nullptr;
+  return result;
+}
+
+template<typename Fn> static void run_with_threads(const int threads_num, const Fn &fn)
+{
+#ifdef WITH_TBB
+  tbb::task_arena arena(threads_num);
+  arena.execute(fn);
+#else
+  UNUSED_VARS(threads_num);
+  fn();
+#endif
+}
+
+/**
+ * Points and springs are processed in parallel, but the forces have to be accumulated in the same
+ * order as by the serial loops. So the result has to be exactly the same for any number of
+ * threads.
+ */
+TEST_F(softbody, lattice_steps_match_serial)
+{
+  /* Enough points and springs to be split into several tasks. */
+  const int size = 8;
+  const int frames = 5;
+  Array<float3> serial;
+  run_with_threads(1, [&]() { serial = softbody_lattice_step(size, frames); });
+
+  /* Gravity has to move the points, otherwise the comparison would be trivial. */
+  const int verts_num = size * size * size;
+  EXPECT_NE(serial.as_span().take_back(verts_num), serial.as_span().take_front(verts_num));
+
+  for (const int threads_num : {2, 3, 8}) {
+    Array<float3> parallel;
+    run_with_threads(threads_num, [&]() { parallel = softbody_lattice_step(size, frames); });
+    ASSERT_EQ(serial.size(), parallel.size());
+    EXPECT_EQ_ARRAY(serial.data(), parallel.data(), serial.size());
+  }
+}
+
+#if DO_PERF_TESTS
+TEST_F(softbody, lattice_37x37x37_performance)
+{
+  /* About 50k points. */
+  SCOPED_TIMER(__func__);
+  softbody_lattice_step(37, 10);
+}
+#endif
+
+}  // namespace blender::bke::tests
@@ -16,6 +16,7 @@
 #include "BLI_listbase.h"
 #include "BLI_string.h"
 #include "BLI_sys_types.h"
+#include "BLI_time.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -144,10 +145,19 @@ static void undosys_id_ref_resolve(void *user_data, UndoRefID *id_ref)
 static bool undosys_step_encode(bContext *C, Main *bmain, UndoStack *ustack, UndoStep *us)
 {
   CLOG_INFO(&LOG, 2, "addr=%p, name='%s', type='%s'", us, us->name, us->type->name);
+  const double time_start = BLI_check_seconds_timer();
   UNDO_NESTED_CHECK_BEGIN;
   bool ok = us->type->step_encode(C, bmain, us);
   UNDO_NESTED_CHECK_END;
   if (ok) {
+    CLOG_INFO(&LOG,
+              1,
+              "encoded name='%s', type='%s' in %.3f ms, data_size=%zu",
+              us->name,
+              us->type->name,
+              (BLI_check_seconds_timer() - time_start) * 1000.0,
+              us->data_size);
+
     if (us->type->step_foreach_ID_ref != nullptr) {
       /* Don't use from context yet because sometimes context is fake and
        * not all members are filled in. */
@@ -88,6 +88,10 @@ enum {
   /* calculate IsectRayPrecalc data */
   BVH_RAYCAST_WATERTIGHT = (1 << 0),
 };
+enum {
+  /* Split nodes using the surface area heuristic, slower to build but faster to ray-cast. */
+  BVH_BALANCE_SAH = (1 << 0),
+};
 #define BVH_RAYCAST_DEFAULT (BVH_RAYCAST_WATERTIGHT)
 #define BVH_RAYCAST_DIST_MAX (FLT_MAX / 2.0f)
 
@@ -157,6 +161,12 @@ void BLI_bvhtree_free(BVHTree *tree);
  */
 void BLI_bvhtree_insert(BVHTree *tree, int index, const float co[3], int numpoints);
 void BLI_bvhtree_balance(BVHTree *tree);
+/**
+ * Same as #BLI_bvhtree_balance, with options to choose how the tree is built (`BVH_BALANCE_*`).
+ *
+ * \note #BVH_BALANCE_SAH trees are recommended when many ray-casts are done on the same tree.
+ */
+void BLI_bvhtree_balance_ex(BVHTree *tree, int flag);
 
 /**
  * Update: first update points/nodes, then call update_tree to refit the bounding volumes.
@@ -266,6 +276,23 @@ int BLI_bvhtree_ray_cast(const BVHTree *tree,
                          BVHTree_RayCastCallback callback,
                          void *userdata);
 
+/**
+ * Cast \a rays_num rays at once, like calling #BLI_bvhtree_ray_cast_ex for every ray.
+ * Consecutive rays are traversed together, so this is most efficient for coherent rays
+ * (e.g. neighboring pixels or vertices).
+ *
+ * \param hits: Initialized by the caller like the `hit` argument of #BLI_bvhtree_ray_cast_ex
+ * (at least `index` and `dist`), receives the result of every ray.
+ * \note The rays are cast from multiple threads, \a callback must be thread-safe.
+ */
+void BLI_bvhtree_ray_cast_batch(const BVHTree *tree,
+                                const BVHTreeRay *rays,
+                                BVHTreeRayHit *hits,
+                                int rays_num,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag);
+
 /**
  * Calls the callback for every ray intersection
  *
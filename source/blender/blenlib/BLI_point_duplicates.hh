@@ -0,0 +1,38 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ */
+
+#include "BLI_index_mask.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
+
+namespace blender {
+
+/**
+ * Find the points in \a mask that are within \a merge_distance of each other.
+ *
+ * This gives the same result as #BLI_kdtree_3d_calc_duplicates_fast with `use_index_order`
+ * enabled, but finds the candidates with a uniform grid and multiple threads. Points are first
+ * grouped with an #AtomicDisjointSet, the order dependent merging only has to be done
+ * sequentially within each group of connected points.
+ *
+ * \param duplicates: An array with the size of \a positions, values initialized to -1 are
+ * candidates to be merged. Setting the index to its own position prevents it from being
+ * touched, although it can still be used as a target. For every merged point, the index of the
+ * point it is merged into is written.
+ * \return The number of newly merged points.
+ *
+ * \note Merging is always a single step (target indices won't be marked for merging).
+ */
+int calc_duplicate_points(Span<float3> positions,
+                          const IndexMask &mask,
+                          float merge_distance,
+                          MutableSpan<int> duplicates);
+
+}  // namespace blender
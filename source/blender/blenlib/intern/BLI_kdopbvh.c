@@ -29,6 +29,7 @@
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_math_geom.h"
+#include "BLI_simd.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
@@ -856,6 +857,315 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name SAH Builder
+ *
+ * Alternative to #non_recursive_bvh_div_nodes that splits nodes using a binned
+ * surface area heuristic (SAH) instead of the median along the largest axis.
+ * Building is slower, but the resulting trees are much better suited for ray-casts
+ * on meshes with an uneven distribution of primitives.
+ *
+ * The bounds of the first 3 axes of the k-DOP are used as proxy box for the heuristic.
+ * Nodes of trees with more than 2 children are built by splitting the group
+ * with most leafs until there is one group per child.
+ *
+ * Every subtree with `n` leafs owns `n - 1` consecutive branch slots, so subtrees can
+ * be built in parallel without synchronization, unused slots are skipped afterwards.
+ * \{ */
+
+/* Number of buckets used to evaluate the split costs. */
+#define BVH_SAH_BINS 16
+
+/* Subtrees with at least this many leafs are built in a separate task. */
+#define BVH_SAH_TASK_LEAF_THRESHOLD 4096
+
+typedef struct BVHSAHBuildData {
+  const BVHTree *tree;
+  BVHNode *branches;
+  TaskPool *pool;
+} BVHSAHBuildData;
+
+typedef struct BVHSAHBuildTask {
+  BVHNode *node;
+  int begin, end;
+  int slot;
+} BVHSAHBuildTask;
+
+typedef struct BVHSAHBin {
+  float min[3], max[3];
+  int leafs_num;
+} BVHSAHBin;
+
+static void sah_bin_init(BVHSAHBin *bin)
+{
+  copy_v3_fl(bin->min, FLT_MAX);
+  copy_v3_fl(bin->max, -FLT_MAX);
+  bin->leafs_num = 0;
+}
+
+static void sah_bin_add_bv(BVHSAHBin *bin, const float *bv)
+{
+  for (int i = 0; i < 3; i++) {
+    bin->min[i] = min_ff(bin->min[i], bv[2 * i]);
+    bin->max[i] = max_ff(bin->max[i], bv[2 * i + 1]);
+  }
+  bin->leafs_num++;
+}
+
+static void sah_bin_add_bin(BVHSAHBin *bin, const BVHSAHBin *other)
+{
+  for (int i = 0; i < 3; i++) {
+    bin->min[i] = min_ff(bin->min[i], other->min[i]);
+    bin->max[i] = max_ff(bin->max[i], other->max[i]);
+  }
+  bin->leafs_num += other->leafs_num;
+}
+
+/** Half of the surface area of the bin bounds, multiplied by the number of leafs. */
+static float sah_bin_cost(const BVHSAHBin *bin)
+{
+  if (bin->leafs_num == 0) {
+    return 0.0f;
+  }
+  float size[3];
+  sub_v3_v3v3(size, bin->max, bin->min);
+  return (size[0] * size[1] + size[1] * size[2] + size[2] * size[0]) * (float)bin->leafs_num;
+}
+
+BLI_INLINE float sah_centroid(const float *bv, const int axis)
+{
+  return (bv[2 * axis] + bv[2 * axis + 1]) * 0.5f;
+}
+
+BLI_INLINE int sah_bin_index(const float centroid, const float centroid_min, const float scale)
+{
+  const int bin = (int)((centroid - centroid_min) * scale);
+  return min_ii(bin, BVH_SAH_BINS - 1);
+}
+
+/**
+ * Reorder `leafs[begin, end)` in two groups with the lowest SAH cost.
+ *
+ * \return The index of the first leaf of the second group, the split axis is written to
+ * \a r_axis. Falls back to splitting in the middle when all centroids coincide.
+ */
+static int sah_split(const BVHTree *tree, BVHNode **leafs, int begin, int end, char *r_axis)
+{
+  const int leafs_num = end - begin;
+  const int axis_offset = 2 * tree->start_axis;
+
+  float centroid_min[3], centroid_max[3];
+  INIT_MINMAX(centroid_min, centroid_max);
+  for (int j = begin; j < end; j++) {
+    const float *bv = leafs[j]->bv + axis_offset;
+    for (int i = 0; i < 3; i++) {
+      const float centroid = sah_centroid(bv, i);
+      centroid_min[i] = min_ff(centroid_min[i], centroid);
+      centroid_max[i] = max_ff(centroid_max[i], centroid);
+    }
+  }
+
+  float best_cost = FLT_MAX;
+  int best_axis = -1;
+  int best_bin = 0;
+
+  for (int axis = 0; axis < 3; axis++) {
+    const float extent = centroid_max[axis] - centroid_min[axis];
+    if (!(extent > 0.0f)) {
+      continue;
+    }
+    const float scale = (float)BVH_SAH_BINS / extent;
+
+    BVHSAHBin bins[BVH_SAH_BINS];
+    for (int b = 0; b < BVH_SAH_BINS; b++) {
+      sah_bin_init(&bins[b]);
+    }
+    for (int j = begin; j < end; j++) {
+      const float *bv = leafs[j]->bv + axis_offset;
+      sah_bin_add_bv(&bins[sah_bin_index(sah_centroid(bv, axis), centroid_min[axis], scale)], bv);
+    }
+
+    /* Sweep from both sides, `right_cost[b]` is the cost of the bins `[b, BVH_SAH_BINS)`. */
+    float right_cost[BVH_SAH_BINS];
+    BVHSAHBin accum;
+    sah_bin_init(&accum);
+    for (int b = BVH_SAH_BINS - 1; b > 0; b--) {
+      sah_bin_add_bin(&accum, &bins[b]);
+      right_cost[b] = sah_bin_cost(&accum);
+    }
+    sah_bin_init(&accum);
+    for (int b = 0; b < BVH_SAH_BINS - 1; b++) {
+      sah_bin_add_bin(&accum, &bins[b]);
+      if (accum.leafs_num == 0 || accum.leafs_num == leafs_num) {
+        continue;
+      }
+      const float cost = sah_bin_cost(&accum) + right_cost[b + 1];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = b;
+      }
+    }
+  }
+
+  if (best_axis == -1) {
+    *r_axis = 0;
+    return begin + leafs_num / 2;
+  }
+
+  /* Partition using the same binning, both sides are known to be non-empty. */
+  const float scale = (float)BVH_SAH_BINS / (centroid_max[best_axis] - centroid_min[best_axis]);
+  int i = begin;
+  int j = end - 1;
+  while (i <= j) {
+    const float centroid = sah_centroid(leafs[i]->bv + axis_offset, best_axis);
+    if (sah_bin_index(centroid, centroid_min[best_axis], scale) <= best_bin) {
+      i++;
+    }
+    else {
+      SWAP(BVHNode *, leafs[i], leafs[j]);
+      j--;
+    }
+  }
+
+  *r_axis = (char)best_axis;
+  return i;
+}
+
+static void sah_build_node(
+    BVHSAHBuildData *data, BVHNode *node, const int begin, const int end, const int slot);
+
+static void sah_build_task_cb(TaskPool *__restrict pool, void *taskdata)
+{
+  BVHSAHBuildData *data = BLI_task_pool_user_data(pool);
+  const BVHSAHBuildTask *task = taskdata;
+  sah_build_node(data, task->node, task->begin, task->end, task->slot);
+}
+
+/**
+ * Build the subtree of `node` (stored in branch \a slot) from the leafs `[begin, end)`,
+ * there must be at least 2 leafs.
+ */
+static void sah_build_node(
+    BVHSAHBuildData *data, BVHNode *node, const int begin, const int end, const int slot)
+{
+  const BVHTree *tree = data->tree;
+  BVHNode **leafs = tree->nodes;
+
+  /* Group `g` contains the leafs `[group_bounds[g], group_bounds[g + 1])`. */
+  int group_bounds[MAX_TREETYPE + 1];
+  int groups_num = 1;
+  group_bounds[0] = begin;
+  group_bounds[1] = end;
+  char main_axis = 0;
+
+  while (groups_num < tree->tree_type) {
+    int largest = 0;
+    for (int g = 1; g < groups_num; g++) {
+      if (group_bounds[g + 1] - group_bounds[g] >
+          group_bounds[largest + 1] - group_bounds[largest])
+      {
+        largest = g;
+      }
+    }
+    if (group_bounds[largest + 1] - group_bounds[largest] < 2) {
+      break;
+    }
+
+    char axis;
+    const int mid = sah_split(
+        tree, leafs, group_bounds[largest], group_bounds[largest + 1], &axis);
+    if (groups_num == 1) {
+      main_axis = axis;
+    }
+    memmove(&group_bounds[largest + 2],
+            &group_bounds[largest + 1],
+            sizeof(*group_bounds) * (size_t)(groups_num - largest));
+    group_bounds[largest + 1] = mid;
+    groups_num++;
+  }
+
+  refit_kdop_hull(tree, node, begin, end);
+  node->main_axis = main_axis;
+  node->node_num = (char)groups_num;
+
+  int child_slot = slot + 1;
+  for (int g = 0; g < tree->tree_type; g++) {
+    if (g >= groups_num) {
+      node->children[g] = NULL;
+      continue;
+    }
+
+    const int child_begin = group_bounds[g];
+    const int child_end = group_bounds[g + 1];
+    const int child_leafs_num = child_end - child_begin;
+    BVHNode *child = (child_leafs_num == 1) ? leafs[child_begin] : &data->branches[child_slot];
+    node->children[g] = child;
+    child->parent = node;
+
+    if (child_leafs_num == 1) {
+      continue;
+    }
+
+    if (data->pool && child_leafs_num >= BVH_SAH_TASK_LEAF_THRESHOLD) {
+      BVHSAHBuildTask *task = MEM_mallocN(sizeof(*task), __func__);
+      task->node = child;
+      task->begin = child_begin;
+      task->end = child_end;
+      task->slot = child_slot;
+      BLI_task_pool_push(data->pool, sah_build_task_cb, task, true, NULL);
+    }
+    else {
+      sah_build_node(data, child, child_begin, child_end, child_slot);
+    }
+    child_slot += child_leafs_num - 1;
+  }
+}
+
+/**
+ * Build the tree using #sah_build_node, using the `leaf_num - 1` branches
+ * directly after the leafs. The tree must have at least 2 leafs.
+ */
+static void sah_build_tree(BVHTree *tree)
+{
+  const int leafs_num = tree->leaf_num;
+  const int branches_num = leafs_num - 1;
+  BVHNode *branches = tree->nodearray + leafs_num;
+
+  for (int i = 0; i < branches_num; i++) {
+    branches[i].node_num = 0;
+  }
+
+  BVHSAHBuildData data = {
+      .tree = tree,
+      .branches = branches,
+      .pool = NULL,
+  };
+
+  BVHNode *root = &branches[0];
+  root->parent = NULL;
+
+  if (leafs_num > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+    data.pool = BLI_task_pool_create(&data, TASK_PRIORITY_HIGH);
+    sah_build_node(&data, root, 0, leafs_num, 0);
+    BLI_task_pool_work_and_wait(data.pool);
+    BLI_task_pool_free(data.pool);
+  }
+  else {
+    sah_build_node(&data, root, 0, leafs_num, 0);
+  }
+
+  /* Link the used branches (the root always comes first) to the nodes array. */
+  tree->branch_num = 0;
+  for (int i = 0; i < branches_num; i++) {
+    if (branches[i].node_num != 0) {
+      tree->nodes[leafs_num + tree->branch_num++] = &branches[i];
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
@@ -943,6 +1253,23 @@ void BLI_bvhtree_free(BVHTree *tree)
   }
 }
 
+static void bvhtree_balance_finish(BVHTree *tree)
+{
+#ifdef USE_SKIP_LINKS
+  build_skip_links(tree, tree->nodes[tree->leaf_num], NULL, NULL);
+#endif
+
+#ifdef USE_VERIFY_TREE
+  bvhtree_verify(tree);
+#endif
+
+#ifdef USE_PRINT_TREE
+  bvhtree_info(tree);
+#endif
+
+  UNUSED_VARS(tree);
+}
+
 void BLI_bvhtree_balance(BVHTree *tree)
 {
   BVHNode **leafs_array = tree->nodes;
@@ -962,17 +1289,51 @@ void BLI_bvhtree_balance(BVHTree *tree)
     tree->nodes[tree->leaf_num + i] = &tree->nodearray[tree->leaf_num + i];
   }
 
-#ifdef USE_SKIP_LINKS
-  build_skip_links(tree, tree->nodes[tree->leaf_num], NULL, NULL);
-#endif
+  bvhtree_balance_finish(tree);
+}
 
-#ifdef USE_VERIFY_TREE
-  bvhtree_verify(tree);
-#endif
+/**
+ * Grow the node arrays so they can hold at least \a nodes_num nodes.
+ * Only valid before balancing, when the leafs are still stored in insertion order.
+ */
+static void bvhtree_ensure_nodes_num(BVHTree *tree, const int nodes_num)
+{
+  const int nodes_num_prev = (int)(MEM_allocN_len(tree->nodearray) / sizeof(*tree->nodearray));
+  if (nodes_num <= nodes_num_prev) {
+    return;
+  }
 
-#ifdef USE_PRINT_TREE
-  bvhtree_info(tree);
-#endif
+  const size_t len = (size_t)nodes_num;
+  tree->nodes = MEM_recallocN(tree->nodes, sizeof(*tree->nodes) * len);
+  tree->nodebv = MEM_recallocN(tree->nodebv, sizeof(*tree->nodebv) * (size_t)tree->axis * len);
+  tree->nodechild = MEM_recallocN(tree->nodechild,
+                                  sizeof(*tree->nodechild) * (size_t)tree->tree_type * len);
+  tree->nodearray = MEM_recallocN(tree->nodearray, sizeof(*tree->nodearray) * len);
+
+  for (int i = 0; i < nodes_num; i++) {
+    tree->nodearray[i].bv = &tree->nodebv[i * tree->axis];
+    tree->nodearray[i].children = &tree->nodechild[i * tree->tree_type];
+  }
+  for (int i = 0; i < tree->leaf_num; i++) {
+    tree->nodes[i] = &tree->nodearray[i];
+  }
+}
+
+void BLI_bvhtree_balance_ex(BVHTree *tree, const int flag)
+{
+  /* Trees with a single leaf need a special branch, the default build handles that case. */
+  if (!(flag & BVH_BALANCE_SAH) || tree->leaf_num < 2) {
+    BLI_bvhtree_balance(tree);
+    return;
+  }
+
+  /* This function should only be called once. */
+  BLI_assert(tree->branch_num == 0);
+
+  bvhtree_ensure_nodes_num(tree, 2 * tree->leaf_num - 1);
+  sah_build_tree(tree);
+
+  bvhtree_balance_finish(tree);
 }
 
 static void bvhtree_node_inflate(const BVHTree *tree, BVHNode *node, const float dist)
@@ -2119,6 +2480,227 @@ void BLI_bvhtree_ray_cast_all(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_ray_cast_batch
+ *
+ * Rays are traversed in packets of #BVH_RAY_PACKET_SIZE, testing the bounding volume of a node
+ * against all rays of the packet at once. This only pays off for coherent rays
+ * (similar origins and directions), as the packet visits the union of the nodes of its rays.
+ *
+ * \{ */
+
+#define BVH_RAY_PACKET_SIZE 4
+
+/* Minimum number of packets per task. */
+#define BVH_RAY_BATCH_GRAIN 64
+
+typedef struct BVHRayPacket {
+  BVHRayCastData data[BVH_RAY_PACKET_SIZE];
+
+  /* Ray data of all lanes in SoA layout for the bounding volume tests. */
+  float origin[3][BVH_RAY_PACKET_SIZE];
+  float idot_axis[3][BVH_RAY_PACKET_SIZE];
+  float radius[BVH_RAY_PACKET_SIZE];
+  /* Copy of `data[i].hit.dist`. */
+  float dist[BVH_RAY_PACKET_SIZE];
+} BVHRayPacket;
+
+typedef struct BVHRayCastBatchData {
+  const BVHTree *tree;
+  const BVHTreeRay *rays;
+  BVHTreeRayHit *hits;
+  int rays_num;
+
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+  int flag;
+} BVHRayCastBatchData;
+
+/**
+ * Slab test of the x, y and z axes of \a bv against all rays of the packet.
+ *
+ * \return The bit-mask of the lanes in \a mask that hit the bounding volume closer than their
+ * current hit, with the distances written to \a r_dist.
+ */
+static int ray_packet_nearest_hit(const BVHRayPacket *packet,
+                                  const float bv[6],
+                                  const int mask,
+                                  float r_dist[BVH_RAY_PACKET_SIZE])
+{
+#if BLI_HAVE_SSE2
+  const __m128 radius = _mm_loadu_ps(packet->radius);
+  const __m128 dist = _mm_loadu_ps(packet->dist);
+  __m128 low = _mm_setzero_ps();
+  __m128 upper = dist;
+
+  for (int i = 0; i < 3; i++) {
+    const __m128 origin = _mm_loadu_ps(packet->origin[i]);
+    const __m128 idot = _mm_loadu_ps(packet->idot_axis[i]);
+    const __m128 bv_min = _mm_sub_ps(_mm_set1_ps(bv[2 * i]), radius);
+    const __m128 bv_max = _mm_add_ps(_mm_set1_ps(bv[2 * i + 1]), radius);
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(bv_min, origin), idot);
+    const __m128 t2 = _mm_mul_ps(_mm_sub_ps(bv_max, origin), idot);
+    low = _mm_max_ps(low, _mm_min_ps(t1, t2));
+    upper = _mm_min_ps(upper, _mm_max_ps(t1, t2));
+  }
+
+  _mm_storeu_ps(r_dist, low);
+  const __m128 hit = _mm_and_ps(_mm_cmple_ps(low, upper), _mm_cmplt_ps(low, dist));
+  return mask & _mm_movemask_ps(hit);
+#else
+  int hit_mask = 0;
+  for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+    float low = 0.0f, upper = packet->dist[lane];
+    for (int i = 0; i < 3; i++) {
+      const float bv_min = bv[2 * i] - packet->radius[lane];
+      const float bv_max = bv[2 * i + 1] + packet->radius[lane];
+      const float t1 = (bv_min - packet->origin[i][lane]) * packet->idot_axis[i][lane];
+      const float t2 = (bv_max - packet->origin[i][lane]) * packet->idot_axis[i][lane];
+      low = max_ff(low, min_ff(t1, t2));
+      upper = min_ff(upper, max_ff(t1, t2));
+    }
+    r_dist[lane] = low;
+    if (low <= upper && low < packet->dist[lane]) {
+      hit_mask |= 1 << lane;
+    }
+  }
+  return mask & hit_mask;
+#endif
+}
+
+static void dfs_raycast_packet(BVHRayPacket *packet, const BVHNode *node, int mask)
+{
+  float dist[BVH_RAY_PACKET_SIZE];
+  mask = ray_packet_nearest_hit(packet, node->bv, mask, dist);
+  if (mask == 0) {
+    return;
+  }
+
+  if (node->node_num == 0) {
+    for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+      if (!(mask & (1 << lane))) {
+        continue;
+      }
+      BVHRayCastData *data = &packet->data[lane];
+      if (data->callback) {
+        data->callback(data->userdata, node->index, &data->ray, &data->hit);
+      }
+      else {
+        data->hit.index = node->index;
+        data->hit.dist = dist[lane];
+        madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist[lane]);
+      }
+      packet->dist[lane] = data->hit.dist;
+    }
+  }
+  else {
+    /* Pick the loop direction from the first active ray,
+     * the rays of a packet are expected to point in similar directions. */
+    int lane = 0;
+    while (!(mask & (1 << lane))) {
+      lane++;
+    }
+    if (packet->data[lane].ray_dot_axis[node->main_axis] > 0.0f) {
+      for (int i = 0; i != node->node_num; i++) {
+        dfs_raycast_packet(packet, node->children[i], mask);
+      }
+    }
+    else {
+      for (int i = node->node_num - 1; i >= 0; i--) {
+        dfs_raycast_packet(packet, node->children[i], mask);
+      }
+    }
+  }
+}
+
+static void bvhtree_ray_cast_batch_task_cb(void *__restrict userdata,
+                                           const int packet_index,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHRayCastBatchData *batch = userdata;
+  const BVHNode *root = batch->tree->nodes[batch->tree->leaf_num];
+  const int ray_start = packet_index * BVH_RAY_PACKET_SIZE;
+
+  BVHRayPacket packet;
+  int mask = 0;
+
+  for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+    const int ray_index = ray_start + lane;
+    if (ray_index >= batch->rays_num) {
+      /* Unused lanes never hit anything. */
+      for (int i = 0; i < 3; i++) {
+        packet.origin[i][lane] = 0.0f;
+        packet.idot_axis[i][lane] = 0.0f;
+      }
+      packet.radius[lane] = 0.0f;
+      packet.dist[lane] = -1.0f;
+      continue;
+    }
+
+    const BVHTreeRay *ray = &batch->rays[ray_index];
+    BVHRayCastData *data = &packet.data[lane];
+
+    BLI_ASSERT_UNIT_V3(ray->direction);
+
+    data->tree = batch->tree;
+    data->callback = batch->callback;
+    data->userdata = batch->userdata;
+    copy_v3_v3(data->ray.origin, ray->origin);
+    copy_v3_v3(data->ray.direction, ray->direction);
+    data->ray.radius = ray->radius;
+
+    bvhtree_ray_cast_data_precalc(data, batch->flag);
+
+    memcpy(&data->hit, &batch->hits[ray_index], sizeof(data->hit));
+
+    for (int i = 0; i < 3; i++) {
+      packet.origin[i][lane] = ray->origin[i];
+      packet.idot_axis[i][lane] = data->idot_axis[i];
+    }
+    packet.radius[lane] = ray->radius;
+    packet.dist[lane] = data->hit.dist;
+    mask |= 1 << lane;
+  }
+
+  if (root) {
+    dfs_raycast_packet(&packet, root, mask);
+  }
+
+  for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+    if (mask & (1 << lane)) {
+      memcpy(&batch->hits[ray_start + lane], &packet.data[lane].hit, sizeof(BVHTreeRayHit));
+    }
+  }
+}
+
+void BLI_bvhtree_ray_cast_batch(const BVHTree *tree,
+                                const BVHTreeRay *rays,
+                                BVHTreeRayHit *hits,
+                                const int rays_num,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                const int flag)
+{
+  BVHRayCastBatchData data = {
+      .tree = tree,
+      .rays = rays,
+      .hits = hits,
+      .rays_num = rays_num,
+      .callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+  };
+
+  const int packets_num = (rays_num + BVH_RAY_PACKET_SIZE - 1) / BVH_RAY_PACKET_SIZE;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = BVH_RAY_BATCH_GRAIN;
+  BLI_task_parallel_range(0, packets_num, &data, bvhtree_ray_cast_batch_task_cb, &settings);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
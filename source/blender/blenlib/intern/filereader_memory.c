@@ -20,6 +20,8 @@ typedef struct {
 
   const char *data;
   BLI_mmap_file *mmap;
+  /** When false, the mapping is owned by the caller and not freed on close. */
+  bool owns_mmap;
   size_t length;
 } MemoryReader;
 
@@ -106,7 +108,9 @@ static int64_t memory_read_mmap(FileReader *reader, void *buffer, size_t size)
 static void memory_close_mmap(FileReader *reader)
 {
   MemoryReader *mem = (MemoryReader *)reader;
-  BLI_mmap_free(mem->mmap);
+  if (mem->owns_mmap) {
+    BLI_mmap_free(mem->mmap);
+  }
   MEM_freeN(mem);
 }
 
@@ -117,6 +121,13 @@ FileReader *BLI_filereader_new_mmap(int filedes)
     return NULL;
   }
 
+  FileReader *reader = BLI_filereader_new_mmap_from_file(mmap);
+  ((MemoryReader *)reader)->owns_mmap = true;
+  return reader;
+}
+
+FileReader *BLI_filereader_new_mmap_from_file(BLI_mmap_file *mmap)
+{
   MemoryReader *mem = MEM_callocN(sizeof(MemoryReader), __func__);
 
   mem->mmap = mmap;
@@ -13,10 +13,39 @@
 #include "BLI_endian_switch.h"
 #include "BLI_filereader.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
-typedef struct {
+#include "atomic_ops.h"
+
+struct ZstdReader;
+
+/**
+ * A run of consecutive frames of the seekable format, decompressed in one go.
+ *
+ * Frames are independent, so all frames of a window are decompressed in parallel on the
+ * task scheduler. Since both compressed and uncompressed frames are stored back to back,
+ * a window only needs a single buffer for each.
+ */
+typedef struct ZstdFrameWindow {
+  struct ZstdReader *zstd;
+
+  /** First frame in the window, -1 when the window is empty. */
+  int first_frame;
+  int frames_num;
+
+  char *compressed_data;
+  char *uncompressed_data;
+
+  /** Decompression tasks, only set while the window is still being decompressed. */
+  TaskPool *task_pool;
+  /** Set by any of the tasks when decompressing its frame failed. */
+  uint8_t failed;
+} ZstdFrameWindow;
+
+typedef struct ZstdReader {
   FileReader reader;
 
   FileReader *base;
@@ -30,8 +59,12 @@ typedef struct {
     size_t *compressed_ofs;
     size_t *uncompressed_ofs;
 
-    char *cached_content;
-    int cached_frame;
+    /** Number of frames decompressed at once when reading sequentially. */
+    int window_frames_num;
+    /** Window containing the frame that is currently being read from. */
+    ZstdFrameWindow current;
+    /** Window following #current, decompressed in the background while #current is read. */
+    ZstdFrameWindow readahead;
   } seek;
 } ZstdReader;
 
@@ -127,7 +160,12 @@ static bool zstd_read_seek_table(ZstdReader *zstd)
     return false;
   }
 
-  zstd->seek.cached_frame = -1;
+  /* Two windows are alive while reading sequentially, give every thread a frame in each. */
+  zstd->seek.window_frames_num = clamp_i(BLI_system_thread_count(), 2, 64);
+  zstd->seek.current.zstd = zstd;
+  zstd->seek.current.first_frame = -1;
+  zstd->seek.readahead.zstd = zstd;
+  zstd->seek.readahead.first_frame = -1;
 
   return true;
 }
@@ -155,42 +193,149 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
-/* Ensure that the currently loaded frame is the correct one. */
-static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+static void zstd_window_decompress_frame_task(TaskPool *__restrict pool, void *taskdata)
+{
+  ZstdFrameWindow *window = BLI_task_pool_user_data(pool);
+  const ZstdReader *zstd = window->zstd;
+  const int frame = window->first_frame + POINTER_AS_INT(taskdata);
+
+  const size_t *compressed_ofs = zstd->seek.compressed_ofs;
+  const size_t *uncompressed_ofs = zstd->seek.uncompressed_ofs;
+  const size_t compressed_size = compressed_ofs[frame + 1] - compressed_ofs[frame];
+  const size_t uncompressed_size = uncompressed_ofs[frame + 1] - uncompressed_ofs[frame];
+
+  const char *src = window->compressed_data +
+                    (compressed_ofs[frame] - compressed_ofs[window->first_frame]);
+  char *dst = window->uncompressed_data +
+              (uncompressed_ofs[frame] - uncompressed_ofs[window->first_frame]);
+
+  /* The context of the reader is only used on the main thread, use a temporary one here. */
+  size_t res = ZSTD_decompress(dst, uncompressed_size, src, compressed_size);
+  if (ZSTD_isError(res) || res < uncompressed_size) {
+    atomic_fetch_and_or_uint8(&window->failed, 1);
+  }
+}
+
+static void zstd_window_free(ZstdFrameWindow *window)
 {
-  if (zstd->seek.cached_frame == frame) {
-    /* Cached frame matches, so just return it. */
-    return zstd->seek.cached_content;
+  if (window->task_pool) {
+    BLI_task_pool_cancel(window->task_pool);
+    BLI_task_pool_free(window->task_pool);
+    window->task_pool = NULL;
   }
+  MEM_SAFE_FREE(window->compressed_data);
+  MEM_SAFE_FREE(window->uncompressed_data);
+  window->first_frame = -1;
+  window->frames_num = 0;
+  window->failed = 0;
+}
+
+/**
+ * Read the compressed data of `frames_num` frames starting at `first_frame` and start
+ * decompressing them. The base reader is only accessed here, so this has to be called
+ * from the thread that owns the reader.
+ */
+static bool zstd_window_start(ZstdFrameWindow *window, int first_frame, int frames_num)
+{
+  ZstdReader *zstd = window->zstd;
+  BLI_assert(window->first_frame == -1);
 
-  /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
-  MEM_SAFE_FREE(zstd->seek.cached_content);
+  frames_num = min_ii(frames_num, zstd->seek.frames_num - first_frame);
+  if (frames_num <= 0) {
+    return false;
+  }
 
-  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
-  size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
-                             zstd->seek.uncompressed_ofs[frame];
+  const size_t compressed_start = zstd->seek.compressed_ofs[first_frame];
+  const size_t compressed_size = zstd->seek.compressed_ofs[first_frame + frames_num] -
+                                 compressed_start;
+  const size_t uncompressed_size = zstd->seek.uncompressed_ofs[first_frame + frames_num] -
+                                   zstd->seek.uncompressed_ofs[first_frame];
 
-  char *uncompressed_data = MEM_mallocN(uncompressed_size, __func__);
-  char *compressed_data = MEM_mallocN(compressed_size, __func__);
-  if (zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
-      zstd->base->read(zstd->base, compressed_data, compressed_size) < compressed_size)
+  window->compressed_data = MEM_mallocN(compressed_size, __func__);
+  if (zstd->base->seek(zstd->base, compressed_start, SEEK_SET) < 0 ||
+      zstd->base->read(zstd->base, window->compressed_data, compressed_size) < compressed_size)
   {
-    MEM_freeN(compressed_data);
-    MEM_freeN(uncompressed_data);
-    return NULL;
+    MEM_SAFE_FREE(window->compressed_data);
+    return false;
   }
+  window->uncompressed_data = MEM_mallocN(uncompressed_size, __func__);
+  window->first_frame = first_frame;
+  window->frames_num = frames_num;
+  window->failed = 0;
 
-  size_t res = ZSTD_decompressDCtx(
-      zstd->ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
-  MEM_freeN(compressed_data);
-  if (ZSTD_isError(res) || res < uncompressed_size) {
-    MEM_freeN(uncompressed_data);
-    return NULL;
+  window->task_pool = BLI_task_pool_create(window, TASK_PRIORITY_HIGH);
+  for (int i = 0; i < frames_num; i++) {
+    BLI_task_pool_push(
+        window->task_pool, zstd_window_decompress_frame_task, POINTER_FROM_INT(i), false, NULL);
   }
+  return true;
+}
+
+/** Wait until all frames of the window are decompressed, helping with the remaining work. */
+static bool zstd_window_finish(ZstdFrameWindow *window)
+{
+  if (window->task_pool) {
+    BLI_task_pool_work_and_wait(window->task_pool);
+    BLI_task_pool_free(window->task_pool);
+    window->task_pool = NULL;
+    MEM_SAFE_FREE(window->compressed_data);
+  }
+  return window->failed == 0;
+}
 
-  zstd->seek.cached_frame = frame;
-  zstd->seek.cached_content = uncompressed_data;
-  return uncompressed_data;
+BLI_INLINE bool zstd_window_contains(const ZstdFrameWindow *window, int frame)
+{
+  return window->first_frame != -1 && frame >= window->first_frame &&
+         frame < window->first_frame + window->frames_num;
+}
+
+/**
+ * Ensure that the frame is decompressed and return its data.
+ *
+ * Sequential reading (which is how #BHead blocks are parsed) decompresses a whole window of
+ * frames in parallel, and keeps decompressing the next window in the background while the
+ * current one is being read. Random access only decompresses the requested frame.
+ */
+static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
+{
+  ZstdFrameWindow *current = &zstd->seek.current;
+  ZstdFrameWindow *readahead = &zstd->seek.readahead;
+
+  if (!zstd_window_contains(current, frame)) {
+    const bool is_sequential = (current->first_frame == -1) ?
+                                   (frame == 0) :
+                                   (frame == current->first_frame + current->frames_num);
+    zstd_window_free(current);
+
+    if (zstd_window_contains(readahead, frame)) {
+      /* Take over the window that was decompressed in the background. The tasks reference the
+       * window by address, so they have to be finished before it can be moved. */
+      zstd_window_finish(readahead);
+      SWAP(ZstdFrameWindow, *current, *readahead);
+    }
+    else {
+      zstd_window_free(readahead);
+      const int frames_num = is_sequential ? zstd->seek.window_frames_num : 1;
+      if (!zstd_window_start(current, frame, frames_num)) {
+        return NULL;
+      }
+    }
+
+    if (!zstd_window_finish(current)) {
+      zstd_window_free(current);
+      zstd_window_free(readahead);
+      return NULL;
+    }
+
+    if (is_sequential && readahead->first_frame == -1) {
+      /* Failing here is not an error yet, the frames are read again when they are needed. */
+      zstd_window_start(
+          readahead, current->first_frame + current->frames_num, zstd->seek.window_frames_num);
+    }
+  }
+
+  return current->uncompressed_data +
+         (zstd->seek.uncompressed_ofs[frame] - zstd->seek.uncompressed_ofs[current->first_frame]);
 }
 
 static int64_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
@@ -283,10 +428,8 @@ static void zstd_close(FileReader *reader)
   if (zstd->reader.seek) {
     MEM_freeN(zstd->seek.uncompressed_ofs);
     MEM_freeN(zstd->seek.compressed_ofs);
-    /* When an error has occurred this may be NULL, see: #99744. */
-    if (zstd->seek.cached_content) {
-      MEM_freeN(zstd->seek.cached_content);
-    }
+    zstd_window_free(&zstd->seek.current);
+    zstd_window_free(&zstd->seek.readahead);
   }
   else {
     MEM_freeN((void *)zstd->in_buf.src);
@@ -11,6 +11,7 @@
 #include "BLI_kdtree_impl.h"
 #include "BLI_math_base.h"
 #include "BLI_strict_flags.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include <string.h>
@@ -55,6 +56,11 @@ struct KDTree {
  */
 #define KD_NODE_ROOT_IS_INIT ((uint)-2)
 
+/** Balance sub-trees with at least this many nodes in a separate task. */
+#define KD_BALANCE_TASK_MIN 8192
+/** Minimum number of queries handled by one thread in batched searches. */
+#define KD_BATCH_QUERY_GRAIN 1024
+
 /* -------------------------------------------------------------------- */
 /** \name Local Math API
  * \{ */
@@ -138,20 +144,25 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * The index of the root node of a sub-tree, which is the median of its nodes after balancing.
+ */
+static uint kdtree_balance_root(const uint nodes_len, const uint ofs)
 {
-  KDTreeNode *node;
-  float co;
-  uint left, right, median, i, j;
-
-  if (nodes_len <= 0) {
+  if (nodes_len == 0) {
     return KD_NODE_UNSET;
   }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
+  return nodes_len / 2 + ofs;
+}
+
+/**
+ * Quick-sort style partitioning, so that the median (along \a axis) ends up in the middle.
+ */
+static uint kdtree_partition_median(KDTreeNode *nodes, const uint nodes_len, const uint axis)
+{
+  float co;
+  uint left, right, median, i, j;
 
-  /* Quick-sort style sorting around median. */
   left = 0;
   right = nodes_len - 1;
   median = nodes_len / 2;
@@ -183,14 +194,67 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  return median;
+}
+
+typedef struct KDTreeBalanceTask {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+} KDTreeBalanceTask;
+
+static uint kdtree_balance(
+    KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs, TaskPool *pool);
+
+static void kdtree_balance_task_fn(TaskPool *__restrict pool, void *taskdata)
+{
+  const KDTreeBalanceTask *task = taskdata;
+  kdtree_balance(task->nodes, task->nodes_len, task->axis, task->ofs, pool);
+}
+
+/**
+ * \param pool: When not null, large sub-trees are balanced in separate tasks of this pool.
+ * Sub-trees are stored in disjoint ranges of \a nodes, so they can be balanced independently.
+ */
+static uint kdtree_balance(
+    KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs, TaskPool *pool)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
+  median = kdtree_partition_median(nodes, nodes_len, axis);
+
   /* Set node and sort sub-nodes. */
   node = &nodes[median];
   node->d = axis;
   axis = (axis + 1) % KD_DIMS;
-  node->left = kdtree_balance(nodes, median, axis, ofs);
-  node->right = kdtree_balance(
-      nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
 
+  const uint right_len = nodes_len - (median + 1);
+  if (pool != NULL && right_len >= KD_BALANCE_TASK_MIN) {
+    /* The root of the sub-tree is known before it is balanced. */
+    KDTreeBalanceTask *task = MEM_mallocN(sizeof(*task), __func__);
+    task->nodes = nodes + median + 1;
+    task->nodes_len = right_len;
+    task->axis = axis;
+    task->ofs = (median + 1) + ofs;
+    node->right = kdtree_balance_root(right_len, task->ofs);
+    BLI_task_pool_push(pool, kdtree_balance_task_fn, task, true, NULL);
+  }
+  else {
+    node->right = kdtree_balance(nodes + median + 1, right_len, axis, (median + 1) + ofs, NULL);
+  }
+  node->left = kdtree_balance(
+      nodes, median, axis, ofs, median >= KD_BALANCE_TASK_MIN ? pool : NULL);
+
+  BLI_assert(node->left == kdtree_balance_root(median, ofs));
   return median + ofs;
 }
 
@@ -203,7 +267,15 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len >= KD_BALANCE_TASK_MIN * 2) {
+    TaskPool *pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0, pool);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0, NULL);
+  }
 
 #ifndef NDEBUG
   tree->is_balanced = true;
@@ -224,11 +296,16 @@ static uint *realloc_nodes(uint *stack, uint *stack_len_capacity, const bool is_
 }
 
 /**
- * Find nearest returns index, and -1 if no node is found.
+ * \param hint_node: A node that is likely close to \a co (e.g. the result of the previous query
+ * for a nearby point). Its distance is used as initial bound, which allows skipping more of the
+ * tree. The result is the same as without a hint, except for ties between equally distant nodes.
+ * \param r_node: The index of the found node in the tree, to be used as hint for the next query.
  */
-int BLI_kdtree_nd_(find_nearest)(const KDTree *tree,
-                                 const float co[KD_DIMS],
-                                 KDTreeNearest *r_nearest)
+static int kdtree_find_nearest_ex(const KDTree *tree,
+                                  const float co[KD_DIMS],
+                                  const uint hint_node,
+                                  KDTreeNearest *r_nearest,
+                                  uint *r_node)
 {
   const KDTreeNode *nodes = tree->nodes;
   const KDTreeNode *root, *min_node;
@@ -251,6 +328,15 @@ int BLI_kdtree_nd_(find_nearest)(const KDTree *tree,
   min_node = root;
   min_dist = len_squared_vnvn(root->co, co);
 
+  if (hint_node != tree->root) {
+    const KDTreeNode *hint = &nodes[hint_node];
+    cur_dist = len_squared_vnvn(hint->co, co);
+    if (cur_dist < min_dist) {
+      min_dist = cur_dist;
+      min_node = hint;
+    }
+  }
+
   if (co[root->d] < root->co[root->d]) {
     if (root->right != KD_NODE_UNSET) {
       stack[cur++] = root->right;
@@ -317,6 +403,9 @@ int BLI_kdtree_nd_(find_nearest)(const KDTree *tree,
     r_nearest->dist = sqrtf(min_dist);
     copy_vn_vn(r_nearest->co, min_node->co);
   }
+  if (r_node) {
+    *r_node = (uint)(min_node - nodes);
+  }
 
   if (stack != stack_default) {
     MEM_freeN(stack);
@@ -325,6 +414,75 @@ int BLI_kdtree_nd_(find_nearest)(const KDTree *tree,
   return min_node->index;
 }
 
+/**
+ * Find nearest returns index, and -1 if no node is found.
+ */
+int BLI_kdtree_nd_(find_nearest)(const KDTree *tree,
+                                 const float co[KD_DIMS],
+                                 KDTreeNearest *r_nearest)
+{
+  return kdtree_find_nearest_ex(tree, co, tree->root, r_nearest, NULL);
+}
+
+typedef struct KDTreeBatchQueryData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  KDTreeNearest *r_nearest;
+} KDTreeBatchQueryData;
+
+typedef struct KDTreeBatchQueryTLS {
+  /** Node found by the previous query on this thread. */
+  uint hint_node;
+} KDTreeBatchQueryTLS;
+
+static void kdtree_find_nearest_batch_fn(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict tls)
+{
+  const KDTreeBatchQueryData *data = userdata;
+  KDTreeBatchQueryTLS *query_tls = tls->userdata_chunk;
+  kdtree_find_nearest_ex(
+      data->tree, data->co[i], query_tls->hint_node, &data->r_nearest[i], &query_tls->hint_node);
+}
+
+/**
+ * Find the nearest node for every point in \a co and store the result in \a r_nearest, which
+ * must have space for \a co_len items. This is multi-threaded, and consecutive queries that
+ * run on the same thread use the previous result to skip parts of the tree. So it is most
+ * efficient when nearby points are stored next to each other in \a co, which is usually the case
+ * for mesh and curve data.
+ *
+ * When the tree is empty, the index of all results is -1.
+ */
+void BLI_kdtree_nd_(find_nearest_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        const uint co_len,
+                                        KDTreeNearest *r_nearest)
+{
+  if (UNLIKELY(tree->root == KD_NODE_UNSET)) {
+    for (uint i = 0; i < co_len; i++) {
+      memset(&r_nearest[i], 0, sizeof(*r_nearest));
+      r_nearest[i].index = -1;
+    }
+    return;
+  }
+
+  KDTreeBatchQueryData data;
+  data.tree = tree;
+  data.co = co;
+  data.r_nearest = r_nearest;
+
+  KDTreeBatchQueryTLS tls;
+  tls.hint_node = tree->root;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = KD_BATCH_QUERY_GRAIN;
+  settings.userdata_chunk = &tls;
+  settings.userdata_chunk_size = sizeof(tls);
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_find_nearest_batch_fn, &settings);
+}
+
 /**
  * A version of #BLI_kdtree_3d_find_nearest which runs a callback
  * to filter out values.
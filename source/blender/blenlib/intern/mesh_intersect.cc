@@ -10,6 +10,7 @@
 #ifdef WITH_GMP
 
 #  include <algorithm>
+#  include <atomic>
 #  include <fstream>
 #  include <iostream>
 #  include <memory>
@@ -331,7 +332,8 @@ class IMeshArena::IMeshArenaImpl : NonCopyable, NonMovable {
 
   /* Use these to allocate ids when Verts and Faces are allocated. */
   int next_vert_id_ = 0;
-  int next_face_id_ = 0;
+  /* Faces are constructed outside of the lock. */
+  std::atomic<int> next_face_id_ = 0;
 
   /* Need a lock when multi-threading to protect allocation of new elements. */
 #  ifdef USE_SPINLOCK
@@ -1156,9 +1158,9 @@ static inline mpq3 tti_interp(
 /**
  * Return +1, 0, -1 as a + ad is above, on, or below the oriented plane containing a, b, c in CCW
  * order. This is the same as -oriented(a, b, c, a + ad), but uses fewer arithmetic operations.
- * TODO: change arguments to `const Vert *` and use floating filters.
  * The ba, ca, n, and dotbuf arguments are used as temporaries; declaring them
  * in the caller can avoid many allocations and frees of mpq3 and mpq_class structures.
+ * Use #filter_tti_above first, to avoid the exact calculation in most cases.
  */
 static inline int tti_above(const mpq3 &a,
                             const mpq3 &b,
@@ -1181,6 +1183,43 @@ static inline int tti_above(const mpq3 &a,
   return sgn(math::dot_with_buffer(ad, n, dotbuf));
 }
 
+/**
+ * Index of `dot(d - a, cross(b - a, c - a))` when the inputs have index 1,
+ * see #supremum_dot_cross.
+ */
+constexpr int index_tti_above = 11;
+
+/**
+ * Floating point filter for #tti_above, where `ad = d - a`.
+ * The answer is 1 or -1 if the sign is certain, and 0 if the exact calculation is needed.
+ */
+static inline int filter_tti_above(const double3 &a,
+                                   const double3 &b,
+                                   const double3 &c,
+                                   const double3 &d)
+{
+  const double3 ba = b - a;
+  const double3 ca = c - a;
+  const double3 ad = d - a;
+  const double det = math::dot(ad, math::cross(ba, ca));
+  if (det == 0.0) {
+    return 0;
+  }
+  const double3 abs_a = math::abs(a);
+  const double3 abs_ba = math::abs(b) + abs_a;
+  const double3 abs_ca = math::abs(c) + abs_a;
+  const double3 abs_ad = math::abs(d) + abs_a;
+  const double3 abs_n(abs_ba.y * abs_ca.z + abs_ba.z * abs_ca.y,
+                      abs_ba.z * abs_ca.x + abs_ba.x * abs_ca.z,
+                      abs_ba.x * abs_ca.y + abs_ba.y * abs_ca.x);
+  const double supremum = math::dot(abs_ad, abs_n);
+  const double err_bound = supremum * index_tti_above * DBL_EPSILON;
+  if (fabs(det) > err_bound) {
+    return det > 0 ? 1 : -1;
+  }
+  return 0;
+}
+
 /**
  * Given that triangles (p1, q1, r1) and (p2, q2, r2) are in canonical order,
  * use the classification chart in the Guigue and Devillers paper to find out
@@ -1194,16 +1233,22 @@ static inline int tti_above(const mpq3 &a,
  *   of the plane and at least one of q1 and r1 are off the plane.
  * Similarly for p2, q2, r2 with respect to the first triangle's plane.
  */
-static ITT_value itt_canon2(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon2(const Vert *vp1,
+                            const Vert *vq1,
+                            const Vert *vr1,
+                            const Vert *vp2,
+                            const Vert *vq2,
+                            const Vert *vr2,
                             const mpq3 &n1,
                             const mpq3 &n2)
 {
   constexpr int dbg_level = 0;
+  const mpq3 &p1 = vp1->co_exact;
+  const mpq3 &q1 = vq1->co_exact;
+  const mpq3 &r1 = vr1->co_exact;
+  const mpq3 &p2 = vp2->co_exact;
+  const mpq3 &q2 = vq2->co_exact;
+  const mpq3 &r2 = vr2->co_exact;
   if (dbg_level > 0) {
     std::cout << "\ntri_tri_intersect_canon:\n";
     std::cout << "p1=" << p1 << " q1=" << q1 << " r1=" << r1 << "\n";
@@ -1219,17 +1264,28 @@ static ITT_value itt_canon2(const mpq3 &p1,
     std::cout << "n1=(" << n1[0].get_d() << "," << n1[1].get_d() << "," << n1[2].get_d() << ")\n";
     std::cout << "n2=(" << n2[0].get_d() << "," << n2[1].get_d() << "," << n2[2].get_d() << ")\n";
   }
-  mpq3 p1p2 = p2 - p1;
   mpq3 intersect_1;
   mpq3 intersect_2;
   mpq3 buf[4];
+  /* Only computed when the floating point filter fails. */
+  std::optional<mpq3> p1p2;
+  auto tti_above_p2 = [&](const Vert *b, const Vert *c) {
+    const int filtered = filter_tti_above(vp1->co, b->co, c->co, vp2->co);
+    if (filtered != 0) {
+      return filtered;
+    }
+    if (!p1p2) {
+      p1p2 = p2 - p1;
+    }
+    return tti_above(p1, b->co_exact, c->co_exact, *p1p2, buf[0], buf[1], buf[2], buf[3]);
+  };
   bool no_overlap = false;
   /* Top test in classification tree. */
-  if (tti_above(p1, q1, r2, p1p2, buf[0], buf[1], buf[2], buf[3]) > 0) {
+  if (tti_above_p2(vq1, vr2) > 0) {
     /* Middle right test in classification tree. */
-    if (tti_above(p1, r1, r2, p1p2, buf[0], buf[1], buf[2], buf[3]) <= 0) {
+    if (tti_above_p2(vr1, vr2) <= 0) {
       /* Bottom right test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) > 0) {
+      if (tti_above_p2(vr1, vq2) > 0) {
         /* Overlap is [k [i l] j]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i l] j]\n";
@@ -1258,7 +1314,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
   }
   else {
     /* Middle left test in classification tree. */
-    if (tti_above(p1, q1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) < 0) {
+    if (tti_above_p2(vq1, vq2) < 0) {
       /* No overlap: [i j] [k l]. */
       if (dbg_level > 0) {
         std::cout << "no overlap: [i j] [k l]\n";
@@ -1267,7 +1323,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
     }
     else {
       /* Bottom left test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) >= 0) {
+      if (tti_above_p2(vr1, vq2) >= 0) {
         /* Overlap is [k [i j] l]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i j] l]\n";
@@ -1304,12 +1360,12 @@ static ITT_value itt_canon2(const mpq3 &p1,
 
 /* Helper function for intersect_tri_tri. Arguments have been canonicalized for triangle 1. */
 
-static ITT_value itt_canon1(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon1(const Vert *p1,
+                            const Vert *q1,
+                            const Vert *r1,
+                            const Vert *p2,
+                            const Vert *q2,
+                            const Vert *r2,
                             const mpq3 &n1,
                             const mpq3 &n2,
                             int sp2,
@@ -1511,49 +1567,49 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   ITT_value ans;
   if (sp1 > 0) {
     if (sq1 > 0) {
-      ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else if (sr1 > 0) {
-      ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
   }
   else if (sp1 < 0) {
     if (sq1 < 0) {
-      ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else if (sr1 < 0) {
-      ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
   }
   else {
     if (sq1 < 0) {
       if (sr1 >= 0) {
-        ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else if (sq1 > 0) {
       if (sr1 > 0) {
-        ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else {
       if (sr1 > 0) {
-        ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
       else if (sr1 < 0) {
-        ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
         if (dbg_level > 0) {
@@ -2647,32 +2703,36 @@ static void calc_cluster_tris(Array<IMesh> &tri_subdivided,
                               const Array<CDT_data> &cluster_subdivided,
                               IMeshArena *arena)
 {
-  for (int c : clinfo.index_range()) {
-    const CoplanarCluster &cl = clinfo.cluster(c);
-    const CDT_data &cd = cluster_subdivided[c];
-    /* Each triangle in cluster c should be an input triangle in cd.input_faces.
-     * (See prepare_cdt_input_for_cluster.)
-     * So accumulate a Vector of Face* for each input face by going through the
-     * output faces and making a Face for each input face that it is part of.
-     * (The Boolean algorithm wants duplicates if a given output triangle is part
-     * of more than one input triangle.)
-     */
-    int n_cluster_tris = cl.tot_tri();
-    const CDT_result<mpq_class> &cdt_out = cd.cdt_out;
-    BLI_assert(cd.input_face.size() == n_cluster_tris);
-    Array<Vector<Face *>> face_vec(n_cluster_tris);
-    for (int cdt_out_t : cdt_out.face.index_range()) {
-      for (int cdt_in_t : cdt_out.face_orig[cdt_out_t]) {
-        Face *f = cdt_tri_as_imesh_face(cdt_out_t, cdt_in_t, cd, tm, arena);
-        face_vec[cdt_in_t].append(f);
+  /* Every cluster writes to the subdivided triangles of its own input triangles only, and the
+   * arena is thread-safe. */
+  threading::parallel_for(clinfo.index_range(), 1, [&](IndexRange range) {
+    for (int c : range) {
+      const CoplanarCluster &cl = clinfo.cluster(c);
+      const CDT_data &cd = cluster_subdivided[c];
+      /* Each triangle in cluster c should be an input triangle in cd.input_faces.
+       * (See prepare_cdt_input_for_cluster.)
+       * So accumulate a Vector of Face* for each input face by going through the
+       * output faces and making a Face for each input face that it is part of.
+       * (The Boolean algorithm wants duplicates if a given output triangle is part
+       * of more than one input triangle.)
+       */
+      int n_cluster_tris = cl.tot_tri();
+      const CDT_result<mpq_class> &cdt_out = cd.cdt_out;
+      BLI_assert(cd.input_face.size() == n_cluster_tris);
+      Array<Vector<Face *>> face_vec(n_cluster_tris);
+      for (int cdt_out_t : cdt_out.face.index_range()) {
+        for (int cdt_in_t : cdt_out.face_orig[cdt_out_t]) {
+          Face *f = cdt_tri_as_imesh_face(cdt_out_t, cdt_in_t, cd, tm, arena);
+          face_vec[cdt_in_t].append(f);
+        }
+      }
+      for (int cdt_in_t : cd.input_face.index_range()) {
+        int tm_t = cd.input_face[cdt_in_t];
+        BLI_assert(tri_subdivided[tm_t].face_size() == 0);
+        tri_subdivided[tm_t] = IMesh(face_vec[cdt_in_t]);
       }
     }
-    for (int cdt_in_t : cd.input_face.index_range()) {
-      int tm_t = cd.input_face[cdt_in_t];
-      BLI_assert(tri_subdivided[tm_t].face_size() == 0);
-      tri_subdivided[tm_t] = IMesh(face_vec[cdt_in_t]);
-    }
-  }
+  });
 }
 
 static CDT_data calc_cluster_subdivided(const CoplanarClusterInfo &clinfo,
@@ -3026,10 +3086,14 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
   std::cout << "subdivided non-cluster tris found, time = " << subdivided_tris_time - itt_time
             << "\n";
 #  endif
+  /* Clusters are independent of each other, so they can be triangulated in parallel. */
   Array<CDT_data> cluster_subdivided(clinfo.tot_cluster());
-  for (int c : clinfo.index_range()) {
-    cluster_subdivided[c] = calc_cluster_subdivided(clinfo, c, *tm_clean, tri_ov, itt_map, arena);
-  }
+  threading::parallel_for(clinfo.index_range(), 1, [&](IndexRange range) {
+    for (int c : range) {
+      cluster_subdivided[c] = calc_cluster_subdivided(
+          clinfo, c, *tm_clean, tri_ov, itt_map, arena);
+    }
+  });
 #  ifdef PERFDEBUG
   double cluster_subdivide_time = BLI_check_seconds_timer();
   std::cout << "subdivided clusters found, time = "
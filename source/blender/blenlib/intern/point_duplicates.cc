@@ -0,0 +1,255 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "BLI_array.hh"
+#include "BLI_array_utils.hh"
+#include "BLI_atomic_disjoint_set.hh"
+#include "BLI_bounds.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_offset_indices.hh"
+#include "BLI_point_duplicates.hh"
+#include "BLI_sort.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+namespace blender {
+
+/* Number of bits used for every axis in the cell keys. */
+static constexpr int cell_bits = 21;
+static constexpr int64_t cell_max = (int64_t(1) << cell_bits) - 1;
+
+/**
+ * The points sorted by the cell of a uniform grid they are in, with cells at least as large as
+ * the merge distance. All points within the merge distance are in the 27 neighboring cells.
+ */
+struct PointGrid {
+  double3 min;
+  double inv_cell_size;
+  /** Cell key of every sorted point. */
+  Array<uint64_t> keys;
+  /** Positions of the sorted points. */
+  Array<float3> positions;
+};
+
+static int3 grid_cell(const PointGrid &grid, const float3 &position)
+{
+  const double3 cell = (double3(position) - grid.min) * grid.inv_cell_size;
+  return int3(math::clamp(cell, 0.0, double(cell_max)));
+}
+
+static uint64_t grid_cell_key(const int3 &cell)
+{
+  return (uint64_t(cell.x) << (2 * cell_bits)) | (uint64_t(cell.y) << cell_bits) |
+         uint64_t(cell.z);
+}
+
+/**
+ * Find the first key that is not less than \a key, starting at \a start.
+ * Uses an exponential search because the result is usually close to the start.
+ */
+static int64_t find_lower_bound_from(const Span<uint64_t> keys,
+                                     const int64_t start,
+                                     const uint64_t key)
+{
+  int64_t low = start;
+  int64_t high = start;
+  int64_t step = 1;
+  while (high < keys.size() && keys[high] < key) {
+    low = high + 1;
+    high += step;
+    step *= 2;
+  }
+  high = std::min(high, keys.size());
+  return std::lower_bound(keys.begin() + low, keys.begin() + high, key) - keys.begin();
+}
+
+/** Search start positions for the 9 rows of neighbor cells. */
+using RowStarts = std::array<int64_t, 9>;
+
+/**
+ * Call \a fn with the sorted index of every point in the cells around \a cell. The z axis uses
+ * the lowest bits of the keys, so every row of 3 cells is a single range of keys.
+ *
+ * \param row_starts: Where to start searching every row, updated with the found positions.
+ * When cells are processed in increasing key order, the searches only have to skip a few points.
+ */
+template<typename Fn>
+static void foreach_point_in_neighbor_cells(const PointGrid &grid,
+                                            const int3 &cell,
+                                            RowStarts &row_starts,
+                                            const Fn &fn)
+{
+  const Span<uint64_t> keys = grid.keys;
+  const int z_min = std::max(cell.z - 1, 0);
+  const int z_max = std::min<int>(cell.z + 1, cell_max);
+  int row = 0;
+  for (int x = cell.x - 1; x <= cell.x + 1; x++) {
+    for (int y = cell.y - 1; y <= cell.y + 1; y++, row++) {
+      if (x < 0 || x > cell_max || y < 0 || y > cell_max) {
+        continue;
+      }
+      const uint64_t key_min = grid_cell_key(int3(x, y, z_min));
+      const uint64_t key_max = grid_cell_key(int3(x, y, z_max));
+      int64_t i = find_lower_bound_from(keys, row_starts[row], key_min);
+      row_starts[row] = i;
+      for (; i < keys.size() && keys[i] <= key_max; i++) {
+        fn(int(i));
+      }
+    }
+  }
+}
+
+int calc_duplicate_points(const Span<float3> positions,
+                          const IndexMask &mask,
+                          const float merge_distance,
+                          MutableSpan<int> duplicates)
+{
+  BLI_assert(positions.size() == duplicates.size());
+  const int points_num = int(mask.size());
+  if (points_num == 0) {
+    return 0;
+  }
+  const float merge_distance_sq = merge_distance * merge_distance;
+
+  /* Build the grid. The cells are slightly larger than the merge distance to account for
+   * precision issues, and large enough to fit the keys when the distance is very small. */
+  PointGrid grid;
+  const Bounds<float3> bounds = *bounds::min_max(mask, positions);
+  const float max_extent = math::reduce_max(bounds.max - bounds.min);
+  const double cell_size = std::max({double(merge_distance) * (1.0 + 1e-4),
+                                     double(max_extent) / double(cell_max / 2),
+                                     double(FLT_MIN)});
+  grid.min = double3(bounds.min);
+  grid.inv_cell_size = 1.0 / cell_size;
+
+  Array<int> indices(points_num);
+  mask.to_indices<int>(indices);
+
+  Array<uint64_t> point_keys(points_num);
+  threading::parallel_for(IndexRange(points_num), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      point_keys[i] = grid_cell_key(grid_cell(grid, positions[indices[i]]));
+    }
+  });
+
+  /* Indices into the mask of the sorted points. Points in the same cell stay in index order. */
+  Array<int> order(points_num);
+  array_utils::fill_index_range<int>(order);
+  parallel_sort(order.begin(), order.end(), [&](const int a, const int b) {
+    return point_keys[a] < point_keys[b] || (point_keys[a] == point_keys[b] && a < b);
+  });
+
+  grid.keys.reinitialize(points_num);
+  grid.positions.reinitialize(points_num);
+  threading::parallel_for(IndexRange(points_num), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      grid.keys[i] = point_keys[order[i]];
+      grid.positions[i] = positions[indices[order[i]]];
+    }
+  });
+  point_keys = {};
+
+  /* Join all points that are closer than the merge distance. Merging depends on the order of the
+   * points, but only points in the same group influence each other. */
+  AtomicDisjointSet groups(points_num);
+  Array<bool> has_neighbors(points_num);
+  threading::parallel_for(IndexRange(points_num), 1024, [&](const IndexRange range) {
+    RowStarts row_starts;
+    row_starts.fill(0);
+    for (const int i : range) {
+      const float3 &position = grid.positions[i];
+      bool found = false;
+      const int3 cell = grid_cell(grid, position);
+      foreach_point_in_neighbor_cells(grid, cell, row_starts, [&](const int other) {
+        if (other != i &&
+            math::distance_squared(grid.positions[other], position) <= merge_distance_sq)
+        {
+          found = true;
+          if (other > i) {
+            groups.join(i, other);
+          }
+        }
+      });
+      has_neighbors[i] = found;
+    }
+  });
+
+  /* Gather the points of every group of more than one point, in index order. */
+  IndexMaskMemory memory;
+  const IndexMask grouped_mask = IndexMask::from_bools(has_neighbors, memory);
+  if (grouped_mask.is_empty()) {
+    return 0;
+  }
+  Array<int> grouped(grouped_mask.size());
+  grouped_mask.to_indices<int>(grouped);
+
+  Array<int> roots(points_num);
+  threading::parallel_for(grouped.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : grouped.as_span().slice(range)) {
+      roots[i] = groups.find_root(i);
+    }
+  });
+  parallel_sort(grouped.begin(), grouped.end(), [&](const int a, const int b) {
+    return roots[a] < roots[b] || (roots[a] == roots[b] && order[a] < order[b]);
+  });
+
+  Vector<int> group_offsets_data;
+  for (const int i : grouped.index_range()) {
+    if (i == 0 || roots[grouped[i]] != roots[grouped[i - 1]]) {
+      group_offsets_data.append(i);
+    }
+  }
+  group_offsets_data.append(grouped.size());
+  const OffsetIndices<int> group_offsets(group_offsets_data);
+
+  /* Merge every point into the first point (in index order) that is not merged yet. */
+  return threading::parallel_reduce(
+      group_offsets.index_range(),
+      256,
+      0,
+      [&](const IndexRange range, int found) {
+        for (const int group : range) {
+          for (const int i : grouped.as_span().slice(group_offsets[group])) {
+            const int index = indices[order[i]];
+            if (!ELEM(duplicates[index], -1, index)) {
+              continue;
+            }
+            const float3 &position = grid.positions[i];
+            const int3 cell = grid_cell(grid, position);
+            bool found_any = false;
+            RowStarts row_starts;
+            row_starts.fill(0);
+            foreach_point_in_neighbor_cells(grid, cell, row_starts, [&](const int other) {
+              /* Check the distance first, other points may belong to a different group. */
+              if (other == i ||
+                  math::distance_squared(grid.positions[other], position) > merge_distance_sq)
+              {
+                return;
+              }
+              const int other_index = indices[order[other]];
+              if (duplicates[other_index] == -1) {
+                duplicates[other_index] = index;
+                found_any = true;
+                found++;
+              }
+            });
+            if (found_any) {
+              /* Prevent chains of duplicates. */
+              duplicates[index] = index;
+            }
+          }
+        }
+        return found;
+      },
+      std::plus<int>());
+}
+
+}  // namespace blender
@@ -4,12 +4,13 @@
 
 #include "testing/testing.h"
 
-/* TODO: ray intersection, overlap ... etc. */
+/* TODO: overlap ... etc. */
 
 #include "MEM_guardedalloc.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_kdopbvh.h"
+#include "BLI_math_geom.h"
 #include "BLI_math_vector.h"
 #include "BLI_rand.h"
 
@@ -134,3 +135,110 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/* -------------------------------------------------------------------- */
+/* Ray-cast Tests */
+
+struct RayCastTriangles {
+  float (*verts)[3];
+  int tris_num;
+};
+
+static void raycast_triangle_callback(void *userdata,
+                                      int index,
+                                      const BVHTreeRay *ray,
+                                      BVHTreeRayHit *hit)
+{
+  const RayCastTriangles *data = static_cast<const RayCastTriangles *>(userdata);
+  const float(*tri)[3] = &data->verts[index * 3];
+  float dist;
+  if (isect_ray_tri_v3(ray->origin, ray->direction, tri[0], tri[1], tri[2], &dist, nullptr) &&
+      dist < hit->dist)
+  {
+    hit->index = index;
+    hit->dist = dist;
+  }
+}
+
+static void ray_cast_test(int tris_num, int rays_num, char tree_type, int balance_flag)
+{
+  RNG *rng = BLI_rng_new(tris_num);
+  RayCastTriangles data;
+  data.tris_num = tris_num;
+  data.verts = static_cast<float(*)[3]>(MEM_mallocN(sizeof(float[3]) * tris_num * 3, __func__));
+
+  BVHTree *tree = BLI_bvhtree_new(tris_num, 0.0f, tree_type, 6);
+  for (int i = 0; i < tris_num; i++) {
+    float center[3];
+    rng_v3_round(center, 3, rng, 1000, 1.0f);
+    for (int j = 0; j < 3; j++) {
+      float offset[3];
+      rng_v3_round(offset, 3, rng, 1000, 0.05f);
+      add_v3_v3v3(data.verts[i * 3 + j], center, offset);
+    }
+    BLI_bvhtree_insert(tree, i, data.verts[i * 3], 3);
+  }
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+
+  BVHTreeRay *rays = static_cast<BVHTreeRay *>(MEM_calloc_arrayN(rays_num, sizeof(*rays), __func__));
+  BVHTreeRayHit *hits = static_cast<BVHTreeRayHit *>(
+      MEM_malloc_arrayN(rays_num, sizeof(*hits), __func__));
+  for (int i = 0; i < rays_num; i++) {
+    rng_v3_round(rays[i].origin, 3, rng, 1000, 1.5f);
+    BLI_rng_get_float_unit_v3(rng, rays[i].direction);
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+
+  BLI_bvhtree_ray_cast_batch(
+      tree, rays, hits, rays_num, raycast_triangle_callback, &data, BVH_RAYCAST_DEFAULT);
+
+  for (int i = 0; i < rays_num; i++) {
+    /* Brute force reference. */
+    BVHTreeRayHit expected;
+    expected.index = -1;
+    expected.dist = BVH_RAYCAST_DIST_MAX;
+    for (int j = 0; j < tris_num; j++) {
+      raycast_triangle_callback(&data, j, &rays[i], &expected);
+    }
+
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(
+        tree, rays[i].origin, rays[i].direction, 0.0f, &hit, raycast_triangle_callback, &data);
+
+    EXPECT_EQ(hit.index, expected.index);
+    EXPECT_EQ(hits[i].index, expected.index);
+    EXPECT_FLOAT_EQ(hits[i].dist, expected.dist);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(data.verts);
+  MEM_freeN(rays);
+  MEM_freeN(hits);
+}
+
+TEST(kdopbvh, RayCast_Median)
+{
+  ray_cast_test(2000, 500, 2, 0);
+}
+TEST(kdopbvh, RayCast_SAH_Binary)
+{
+  ray_cast_test(2000, 500, 2, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, RayCast_SAH_Quad)
+{
+  ray_cast_test(2000, 500, 4, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, RayCast_SAH_Octree)
+{
+  ray_cast_test(10000, 500, 8, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, RayCast_SAH_Small)
+{
+  ray_cast_test(1, 10, 4, BVH_BALANCE_SAH);
+  ray_cast_test(2, 10, 4, BVH_BALANCE_SAH);
+  ray_cast_test(7, 10, 2, BVH_BALANCE_SAH);
+}
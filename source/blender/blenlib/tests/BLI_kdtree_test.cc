@@ -5,8 +5,13 @@
 #include "testing/testing.h"
 
 #include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
 
+#include <array>
+#include <cfloat>
 #include <cmath>
+#include <vector>
 
 /* -------------------------------------------------------------------- */
 /* Tests */
@@ -54,6 +59,61 @@ static void deduplicate_test()
   }
 }
 
+static int find_nearest_brute_force(const std::vector<std::array<float, 3>> &points,
+                                    const float co[3],
+                                    float *r_dist_sq)
+{
+  int nearest = -1;
+  float min_dist_sq = FLT_MAX;
+  for (int i = 0; i < int(points.size()); i++) {
+    const float dist_sq = len_squared_v3v3(points[i].data(), co);
+    if (dist_sq < min_dist_sq) {
+      min_dist_sq = dist_sq;
+      nearest = i;
+    }
+  }
+  *r_dist_sq = min_dist_sq;
+  return nearest;
+}
+
+/**
+ * Compare batched queries with a brute force search. Large trees are balanced in multiple tasks.
+ */
+static void find_nearest_batch_test(const int tree_size)
+{
+  RNG *rng = BLI_rng_new(tree_size);
+  std::vector<std::array<float, 3>> points(tree_size);
+  KDTree_3d *tree = BLI_kdtree_3d_new(tree_size);
+  for (int i = 0; i < tree_size; i++) {
+    BLI_rng_get_float_unit_v3(rng, points[i].data());
+    BLI_kdtree_3d_insert(tree, i, points[i].data());
+  }
+  BLI_kdtree_3d_balance(tree);
+
+  const int queries_num = 4000;
+  std::vector<std::array<float, 3>> queries(queries_num);
+  for (int i = 0; i < queries_num; i++) {
+    /* Nearby queries are stored next to each other, like for typical geometry. */
+    const float t = float(i) / queries_num;
+    queries[i] = {std::cos(t * 20.0f), std::sin(t * 20.0f), t * 2.0f - 1.0f};
+  }
+  std::vector<KDTreeNearest_3d> nearest(queries_num);
+  BLI_kdtree_3d_find_nearest_batch(
+      tree, reinterpret_cast<const float(*)[3]>(queries.data()), queries_num, nearest.data());
+
+  for (int i = 0; i < queries_num; i++) {
+    float expected_dist_sq;
+    const int expected = find_nearest_brute_force(points, queries[i].data(), &expected_dist_sq);
+    EXPECT_FLOAT_EQ(nearest[i].dist, std::sqrt(expected_dist_sq));
+    EXPECT_FLOAT_EQ(len_squared_v3v3(points[nearest[i].index].data(), queries[i].data()),
+                    expected_dist_sq);
+    EXPECT_EQ(BLI_kdtree_3d_find_nearest(tree, queries[i].data(), nullptr), expected);
+  }
+
+  BLI_kdtree_3d_free(tree);
+  BLI_rng_free(rng);
+}
+
 TEST(kdtree, Standard)
 {
   standard_test();
@@ -63,3 +123,20 @@ TEST(kdtree, Deduplicate)
 {
   deduplicate_test();
 }
+
+TEST(kdtree, FindNearestBatch)
+{
+  find_nearest_batch_test(1000);
+  find_nearest_batch_test(100000);
+}
+
+TEST(kdtree, FindNearestBatchEmpty)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(0);
+  BLI_kdtree_3d_balance(tree);
+  const float co[1][3] = {{1.0f, 2.0f, 3.0f}};
+  KDTreeNearest_3d nearest;
+  BLI_kdtree_3d_find_nearest_batch(tree, co, 1, &nearest);
+  EXPECT_EQ(nearest.index, -1);
+  BLI_kdtree_3d_free(tree);
+}
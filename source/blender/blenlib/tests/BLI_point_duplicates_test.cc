@@ -0,0 +1,124 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdtree.h"
+#include "BLI_point_duplicates.hh"
+#include "BLI_rand.hh"
+
+namespace blender::tests {
+
+/**
+ * Random points with many clusters of nearby points, so that there are chains of points that
+ * are within the merge distance of each other.
+ */
+static Array<float3> random_clustered_points(const int points_num, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> positions(points_num);
+  for (const int i : positions.index_range()) {
+    const float3 cluster = float3(rng.get_int32(50), rng.get_int32(50), rng.get_int32(50));
+    positions[i] = cluster * 0.1f + rng.get_unit_float3() * rng.get_float() * 0.02f;
+  }
+  return positions;
+}
+
+static Array<int> calc_duplicates_kdtree(const Span<float3> positions,
+                                         const IndexMask &mask,
+                                         const float merge_distance,
+                                         Array<int> duplicates)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(mask.size());
+  mask.foreach_index([&](const int i) { BLI_kdtree_3d_insert(tree, i, positions[i]); });
+  BLI_kdtree_3d_balance(tree);
+  BLI_kdtree_3d_calc_duplicates_fast(tree, merge_distance, true, duplicates.data());
+  BLI_kdtree_3d_free(tree);
+  return duplicates;
+}
+
+static void test_same_as_kdtree(const int points_num,
+                                const float merge_distance,
+                                const bool use_selection,
+                                const bool use_preset)
+{
+  const Array<float3> positions = random_clustered_points(points_num, points_num);
+
+  IndexMaskMemory memory;
+  const IndexMask mask = use_selection ?
+                             IndexMask::from_predicate(positions.index_range(),
+                                                       GrainSize(1024),
+                                                       memory,
+                                                       [](const int i) { return i % 3 != 0; }) :
+                             IndexMask(points_num);
+
+  /* Points that are only allowed as merge target. */
+  Array<int> duplicates(points_num, -1);
+  if (use_preset) {
+    for (int i = 0; i < points_num; i += 7) {
+      duplicates[i] = i;
+    }
+  }
+
+  const Array<int> expected = calc_duplicates_kdtree(positions, mask, merge_distance, duplicates);
+  const int found = calc_duplicate_points(positions, mask, merge_distance, duplicates);
+
+  int expected_found = 0;
+  for (const int i : expected.index_range()) {
+    if (!ELEM(expected[i], -1, i)) {
+      expected_found++;
+    }
+  }
+  EXPECT_GT(expected_found, 0);
+  EXPECT_EQ(found, expected_found);
+  EXPECT_EQ_ARRAY(expected.data(), duplicates.data(), points_num);
+}
+
+TEST(point_duplicates, Empty)
+{
+  Array<int> duplicates;
+  EXPECT_EQ(calc_duplicate_points({}, IndexMask(), 0.1f, duplicates), 0);
+}
+
+TEST(point_duplicates, Coincident)
+{
+  const Array<float3> positions = {float3(1, 2, 3), float3(0, 0, 0), float3(1, 2, 3)};
+  Array<int> duplicates(3, -1);
+  EXPECT_EQ(calc_duplicate_points(positions, positions.index_range(), 0.0f, duplicates), 1);
+  EXPECT_EQ(duplicates[0], 0);
+  EXPECT_EQ(duplicates[1], -1);
+  EXPECT_EQ(duplicates[2], 0);
+}
+
+TEST(point_duplicates, Chain)
+{
+  /* Only direct neighbors of a merge target are merged. */
+  const Array<float3> positions = {float3(0, 0, 0), float3(1, 0, 0), float3(2, 0, 0)};
+  Array<int> duplicates(3, -1);
+  EXPECT_EQ(calc_duplicate_points(positions, positions.index_range(), 1.5f, duplicates), 1);
+  EXPECT_EQ(duplicates[0], 0);
+  EXPECT_EQ(duplicates[1], 0);
+  EXPECT_EQ(duplicates[2], -1);
+}
+
+TEST(point_duplicates, SameAsKDTree)
+{
+  test_same_as_kdtree(1000, 0.01f, false, false);
+  test_same_as_kdtree(10000, 0.005f, false, false);
+  test_same_as_kdtree(100000, 0.003f, false, false);
+}
+
+TEST(point_duplicates, SameAsKDTreeSelection)
+{
+  test_same_as_kdtree(10000, 0.01f, true, false);
+}
+
+TEST(point_duplicates, SameAsKDTreePreset)
+{
+  test_same_as_kdtree(10000, 0.01f, false, true);
+  test_same_as_kdtree(10000, 0.01f, true, true);
+}
+
+}  // namespace blender::tests
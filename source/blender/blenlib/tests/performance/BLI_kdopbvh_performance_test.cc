@@ -0,0 +1,263 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdopbvh.h"
+#include "BLI_math_geom.h"
+#include "BLI_task.h"
+#include "BLI_time_utildefines.h"
+#include "BLI_utildefines.h"
+
+#include <cmath>
+
+/* Run the longest tests! */
+// #define KDOPBVH_RUN_BIG
+
+struct HeightFieldMesh {
+  float (*verts)[3];
+  int (*tris)[3];
+  int tris_num;
+};
+
+/**
+ * A height-field of `(grid_size - 1)^2 * 2` triangles. The grid is denser
+ * around the center, to have a less uniform distribution than a regular grid.
+ */
+static HeightFieldMesh heightfield_mesh_create(const int grid_size)
+{
+  HeightFieldMesh mesh;
+  mesh.verts = static_cast<float(*)[3]>(
+      MEM_malloc_arrayN(size_t(grid_size) * size_t(grid_size), sizeof(float[3]), __func__));
+  mesh.tris_num = (grid_size - 1) * (grid_size - 1) * 2;
+  mesh.tris = static_cast<int(*)[3]>(MEM_malloc_arrayN(mesh.tris_num, sizeof(int[3]), __func__));
+
+  for (int y = 0; y < grid_size; y++) {
+    for (int x = 0; x < grid_size; x++) {
+      const float u = float(x) / float(grid_size - 1) * 2.0f - 1.0f;
+      const float v = float(y) / float(grid_size - 1) * 2.0f - 1.0f;
+      float *co = mesh.verts[y * grid_size + x];
+      co[0] = u * u * u;
+      co[1] = v * v * v;
+      co[2] = sinf(co[0] * 20.0f) * cosf(co[1] * 20.0f) * 0.05f;
+    }
+  }
+
+  int tri = 0;
+  for (int y = 0; y < grid_size - 1; y++) {
+    for (int x = 0; x < grid_size - 1; x++) {
+      const int v = y * grid_size + x;
+      mesh.tris[tri][0] = v;
+      mesh.tris[tri][1] = v + 1;
+      mesh.tris[tri][2] = v + grid_size + 1;
+      tri++;
+      mesh.tris[tri][0] = v;
+      mesh.tris[tri][1] = v + grid_size + 1;
+      mesh.tris[tri][2] = v + grid_size;
+      tri++;
+    }
+  }
+  return mesh;
+}
+
+static void heightfield_mesh_free(HeightFieldMesh &mesh)
+{
+  MEM_freeN(mesh.verts);
+  MEM_freeN(mesh.tris);
+}
+
+static BVHTree *heightfield_bvhtree_create(const HeightFieldMesh &mesh, const int balance_flag)
+{
+  BVHTree *tree = BLI_bvhtree_new(mesh.tris_num, 0.0f, 4, 6);
+  for (int i = 0; i < mesh.tris_num; i++) {
+    float co[3][3];
+    for (int j = 0; j < 3; j++) {
+      copy_v3_v3(co[j], mesh.verts[mesh.tris[i][j]]);
+    }
+    BLI_bvhtree_insert(tree, i, co[0], 3);
+  }
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+  return tree;
+}
+
+static void heightfield_raycast_callback(void *userdata,
+                                         int index,
+                                         const BVHTreeRay *ray,
+                                         BVHTreeRayHit *hit)
+{
+  const HeightFieldMesh *mesh = static_cast<const HeightFieldMesh *>(userdata);
+  const int *tri = mesh->tris[index];
+  float dist;
+  if (isect_ray_tri_watertight_v3(ray->origin,
+                                  ray->isect_precalc,
+                                  mesh->verts[tri[0]],
+                                  mesh->verts[tri[1]],
+                                  mesh->verts[tri[2]],
+                                  &dist,
+                                  nullptr) &&
+      dist < hit->dist)
+  {
+    hit->index = index;
+    hit->dist = dist;
+  }
+}
+
+struct RayCastData {
+  const BVHTree *tree;
+  const HeightFieldMesh *mesh;
+  const BVHTreeRay *rays;
+  BVHTreeRayHit *hits;
+};
+
+static void raycast_single_cb(void *__restrict userdata,
+                              const int i,
+                              const TaskParallelTLS *__restrict /*tls*/)
+{
+  const RayCastData *data = static_cast<const RayCastData *>(userdata);
+  BLI_bvhtree_ray_cast_ex(data->tree,
+                          data->rays[i].origin,
+                          data->rays[i].direction,
+                          0.0f,
+                          &data->hits[i],
+                          heightfield_raycast_callback,
+                          const_cast<HeightFieldMesh *>(data->mesh),
+                          BVH_RAYCAST_WATERTIGHT);
+}
+
+static void hits_init(BVHTreeRayHit *hits, const int rays_num)
+{
+  for (int i = 0; i < rays_num; i++) {
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+}
+
+/* The found index may differ for rays hitting the shared edge of two triangles. */
+static void hits_expect_eq(const BVHTreeRayHit *hits,
+                           const BVHTreeRayHit *expected,
+                           const int rays_num)
+{
+  for (int i = 0; i < rays_num; i++) {
+    EXPECT_EQ(hits[i].dist, expected[i].dist);
+  }
+}
+
+static void kdopbvh_raycast_tests(const char *id, const int grid_size, const int rays_grid_size)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  HeightFieldMesh mesh = heightfield_mesh_create(grid_size);
+  printf("%d triangles\n", mesh.tris_num);
+
+  /* Slightly tilted rays cast from above, ordered like the pixels of an image. */
+  const int rays_num = rays_grid_size * rays_grid_size;
+  BVHTreeRay *rays = static_cast<BVHTreeRay *>(
+      MEM_calloc_arrayN(rays_num, sizeof(BVHTreeRay), __func__));
+  for (int y = 0; y < rays_grid_size; y++) {
+    for (int x = 0; x < rays_grid_size; x++) {
+      BVHTreeRay *ray = &rays[y * rays_grid_size + x];
+      ray->origin[0] = float(x) / float(rays_grid_size) * 2.0f - 1.0f;
+      ray->origin[1] = float(y) / float(rays_grid_size) * 2.0f - 1.0f;
+      ray->origin[2] = 1.0f;
+      ray->direction[0] = 0.1f;
+      ray->direction[1] = 0.2f;
+      ray->direction[2] = -1.0f;
+      normalize_v3(ray->direction);
+    }
+  }
+
+  BVHTreeRayHit *expected = static_cast<BVHTreeRayHit *>(
+      MEM_malloc_arrayN(rays_num, sizeof(BVHTreeRayHit), __func__));
+  BVHTreeRayHit *hits = static_cast<BVHTreeRayHit *>(
+      MEM_malloc_arrayN(rays_num, sizeof(BVHTreeRayHit), __func__));
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  BVHTree *tree_median;
+  {
+    TIMEIT_START(kdopbvh_balance);
+    tree_median = heightfield_bvhtree_create(mesh, 0);
+    TIMEIT_END(kdopbvh_balance);
+  }
+  {
+    hits_init(expected, rays_num);
+    RayCastData data = {tree_median, &mesh, rays, expected};
+    TIMEIT_START(kdopbvh_ray_cast);
+    BLI_task_parallel_range(0, rays_num, &data, raycast_single_cb, &settings);
+    TIMEIT_END(kdopbvh_ray_cast);
+  }
+
+  BVHTree *tree_sah;
+  {
+    TIMEIT_START(kdopbvh_balance_sah);
+    tree_sah = heightfield_bvhtree_create(mesh, BVH_BALANCE_SAH);
+    TIMEIT_END(kdopbvh_balance_sah);
+  }
+  {
+    hits_init(hits, rays_num);
+    RayCastData data = {tree_sah, &mesh, rays, hits};
+    TIMEIT_START(kdopbvh_ray_cast_sah);
+    BLI_task_parallel_range(0, rays_num, &data, raycast_single_cb, &settings);
+    TIMEIT_END(kdopbvh_ray_cast_sah);
+  }
+  hits_expect_eq(hits, expected, rays_num);
+
+  {
+    hits_init(hits, rays_num);
+    TIMEIT_START(kdopbvh_ray_cast_batch);
+    BLI_bvhtree_ray_cast_batch(tree_median,
+                               rays,
+                               hits,
+                               rays_num,
+                               heightfield_raycast_callback,
+                               &mesh,
+                               BVH_RAYCAST_WATERTIGHT);
+    TIMEIT_END(kdopbvh_ray_cast_batch);
+  }
+  hits_expect_eq(hits, expected, rays_num);
+
+  {
+    hits_init(hits, rays_num);
+    TIMEIT_START(kdopbvh_ray_cast_batch_sah);
+    BLI_bvhtree_ray_cast_batch(tree_sah,
+                               rays,
+                               hits,
+                               rays_num,
+                               heightfield_raycast_callback,
+                               &mesh,
+                               BVH_RAYCAST_WATERTIGHT);
+    TIMEIT_END(kdopbvh_ray_cast_batch_sah);
+  }
+  hits_expect_eq(hits, expected, rays_num);
+
+  BLI_bvhtree_free(tree_median);
+  BLI_bvhtree_free(tree_sah);
+  MEM_freeN(hits);
+  MEM_freeN(expected);
+  MEM_freeN(rays);
+  heightfield_mesh_free(mesh);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdopbvh, RayCast500kTriangles)
+{
+  kdopbvh_raycast_tests("KDOPBVH - 500k triangles", 501, 1000);
+}
+
+TEST(kdopbvh, RayCast5MTriangles)
+{
+  kdopbvh_raycast_tests("KDOPBVH - 5M triangles", 1582, 1000);
+}
+
+#ifdef KDOPBVH_RUN_BIG
+TEST(kdopbvh, RayCast20MTriangles)
+{
+  kdopbvh_raycast_tests("KDOPBVH - 20M triangles", 3163, 2000);
+}
+#endif
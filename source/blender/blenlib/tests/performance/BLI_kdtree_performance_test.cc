@@ -0,0 +1,106 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdtree.h"
+#include "BLI_rand.h"
+#include "BLI_time_utildefines.h"
+#include "BLI_utildefines.h"
+
+#include <cmath>
+
+/* Run the longest tests! */
+// #define KDTREE_RUN_BIG
+
+static void kdtree_3d_tests(const char *id, const uint count, const uint queries_num)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  RNG *rng = BLI_rng_new(0);
+  float(*points)[3] = static_cast<float(*)[3]>(
+      MEM_mallocN(sizeof(*points) * count, "kdtree test points"));
+  for (uint i = 0; i < count; i++) {
+    for (int j = 0; j < 3; j++) {
+      points[i][j] = BLI_rng_get_float(rng) * 2.0f - 1.0f;
+    }
+  }
+  /* Query points along a curve, so that consecutive queries are close to each other. */
+  float(*queries)[3] = static_cast<float(*)[3]>(
+      MEM_mallocN(sizeof(*queries) * queries_num, "kdtree test queries"));
+  for (uint i = 0; i < queries_num; i++) {
+    const float t = float(i) / float(queries_num);
+    queries[i][0] = cosf(t * 100.0f) * 0.9f;
+    queries[i][1] = sinf(t * 100.0f) * 0.9f;
+    queries[i][2] = t * 2.0f - 1.0f;
+  }
+
+  KDTree_3d *tree = BLI_kdtree_3d_new(count);
+  for (uint i = 0; i < count; i++) {
+    BLI_kdtree_3d_insert(tree, int(i), points[i]);
+  }
+
+  {
+    TIMEIT_START(kdtree_balance);
+
+    BLI_kdtree_3d_balance(tree);
+
+    TIMEIT_END(kdtree_balance);
+  }
+
+  KDTreeNearest_3d *expected = static_cast<KDTreeNearest_3d *>(
+      MEM_mallocN(sizeof(KDTreeNearest_3d) * queries_num, __func__));
+  {
+    TIMEIT_START(kdtree_find_nearest);
+
+    for (uint i = 0; i < queries_num; i++) {
+      BLI_kdtree_3d_find_nearest(tree, queries[i], &expected[i]);
+    }
+
+    TIMEIT_END(kdtree_find_nearest);
+  }
+
+  KDTreeNearest_3d *nearest = static_cast<KDTreeNearest_3d *>(
+      MEM_mallocN(sizeof(KDTreeNearest_3d) * queries_num, __func__));
+  {
+    TIMEIT_START(kdtree_find_nearest_batch);
+
+    BLI_kdtree_3d_find_nearest_batch(tree, queries, queries_num, nearest);
+
+    TIMEIT_END(kdtree_find_nearest_batch);
+  }
+
+  /* The found index may differ for equally distant points. */
+  for (uint i = 0; i < queries_num; i++) {
+    EXPECT_EQ(nearest[i].dist, expected[i].dist);
+  }
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(nearest);
+  MEM_freeN(expected);
+  MEM_freeN(queries);
+  MEM_freeN(points);
+  BLI_rng_free(rng);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdtree, Points100000)
+{
+  kdtree_3d_tests("KDTree 3D - 100000 points", 100000, 100000);
+}
+
+TEST(kdtree, Points1000000)
+{
+  kdtree_3d_tests("KDTree 3D - 1000000 points", 1000000, 1000000);
+}
+
+#ifdef KDTREE_RUN_BIG
+TEST(kdtree, Points10000000)
+{
+  kdtree_3d_tests("KDTree 3D - 10000000 points", 10000000, 10000000);
+}
+#endif
@@ -39,6 +39,9 @@ struct BlendLibReader;
 struct BlendWriter;
 struct LibraryIDLinkCallbackData;
 struct Main;
+namespace blender {
+class ImplicitSharingInfo;
+}
 
 /* -------------------------------------------------------------------- */
 /** \name Blend Write API
@@ -224,6 +227,24 @@ void *BLO_read_get_new_packed_address(BlendDataReader *reader, const void *old_a
 #define BLO_read_packed_address(reader, ptr_p) \
   *((void **)ptr_p) = BLO_read_get_new_packed_address((reader), *(ptr_p))
 
+/**
+ * Same as #BLO_read_data_address, but the data may be referenced directly in the memory-mapped
+ * file instead of being copied (see #G_FLAG_READFILE_MMAP_SHARING). In that case the returned
+ * sharing info owns the data and has to be used to release it, writing to it is still allowed
+ * because the mapping is copied on write. When null is returned, the data is a regular
+ * allocation owned by the caller.
+ *
+ * Only use this for plain data arrays that don't contain pointers.
+ */
+const blender::ImplicitSharingInfo *BLO_read_data_address_shared(BlendDataReader *reader,
+                                                                 void **ptr_p);
+/**
+ * Whether the data owned by \a sharing_info is referenced in a memory-mapped file by
+ * #BLO_read_data_address_shared. Such data is not a guarded allocation, so e.g.
+ * #MEM_allocN_len and #MEM_dupallocN can't be used on it.
+ */
+bool BLO_read_data_is_mapped(const blender::ImplicitSharingInfo *sharing_info);
+
 using BlendReadListFn = void (*)(BlendDataReader *reader, void *data);
 /**
  * Updates all `->prev` and `->next` pointers of the list elements.
@@ -30,6 +30,9 @@ struct MemFileChunk {
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** Hash of the ID this chunk belongs to, only set on the first chunk of an ID written with
+   * change tracking (see #BLO_memfile_id_reuse). Zero when unknown. */
+  uint64_t id_hash;
 };
 
 struct MemFile {
@@ -42,8 +45,14 @@ struct MemFileWriteData {
   MemFile *reference_memfile;
 
   uint current_id_session_uuid;
+  /** Hash to store in the next added chunk, see #MemFileChunk.id_hash. */
+  uint64_t current_id_hash;
   MemFileChunk *reference_current_chunk;
 
+  /** Statistics for debug output. */
+  int id_written_num;
+  int id_reused_num;
+
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   blender::Map<uint, MemFileChunk *> id_session_uuid_mapping;
 };
@@ -72,6 +81,13 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 void BLO_memfile_write_finalize(MemFileWriteData *mem_data);
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size);
+/**
+ * Reuse all the chunks of an ID from the reference memfile without writing it again, when the
+ * reference chunks were written for the same \a id_hash.
+ *
+ * \return true if the ID chunks were added to the written memfile.
+ */
+bool BLO_memfile_id_reuse(MemFileWriteData *mem_data, uint id_session_uuid, uint64_t id_hash);
 
 /* exports */
 
@@ -42,6 +42,11 @@ struct BlendFileWriteParams {
   /** On write, restore paths after editing them (see #BLO_WRITE_PATH_REMAP_RELATIVE). */
   uint use_save_as_copy : 1;
   uint use_userdef : 1;
+  /**
+   * Serialize independent IDs on multiple threads. The written file is identical to the one
+   * written serially, but a batch of IDs is kept in memory until it is written.
+   */
+  uint use_parallel_write : 1;
   const BlendThumbnail *thumb;
 };
 
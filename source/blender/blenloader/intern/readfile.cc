@@ -51,12 +51,16 @@
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
 #include "BLI_ghash.h"
+#include "BLI_implicit_sharing.hh"
 #include "BLI_linklist.h"
 #include "BLI_map.hh"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_time.h"
+#include "BLI_vector.hh"
 
 #include "BLT_translation.h"
 
@@ -242,6 +246,13 @@ struct NewAddress {
 
   /** `nr` is "user count" for data, and ID code for libdata. */
   int nr;
+
+  /**
+   * When not zero, the data is not a separate allocation but points into
+   * #FileData.mapped_file. It's copied when it's requested through the regular API, see
+   * #BLO_read_data_address_shared.
+   */
+  int mapped_len = 0;
 };
 
 struct OldNewMap {
@@ -305,7 +316,7 @@ static void oldnewmap_clear(OldNewMap *onm)
 {
   /* Free unused data. */
   for (NewAddress &new_addr : onm->map.values()) {
-    if (new_addr.nr == 0) {
+    if (new_addr.nr == 0 && new_addr.mapped_len == 0) {
       MEM_freeN(new_addr.newp);
     }
   }
@@ -319,6 +330,101 @@ static void oldnewmap_free(OldNewMap *onm)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Memory-Mapped Data Sharing
+ *
+ * With #G_FLAG_READFILE_MMAP_SHARING, large data blocks of uncompressed files are not copied
+ * into new allocations when reading. Instead the data-map references them directly in the
+ * memory-mapped file, and code that can handle implicitly shared arrays takes them over with
+ * #BLO_read_data_address_shared. All other users get a copy on first access.
+ *
+ * The file is mapped copy-on-write, so the data stays mutable like regular data, and the pages
+ * that are never written to are shared between all processes that opened the same file.
+ * \{ */
+
+/** Data blocks smaller than this are always copied, referencing them isn't worth it. */
+#define MAPPED_DATA_MIN_SIZE (64 * 1024)
+
+struct MappedBlendFile {
+  BLI_mmap_file *mmap;
+  /** The #FileData reading the file and every #MappedDataSharingInfo referencing data in it. */
+  std::atomic<int> users;
+};
+
+static MappedBlendFile *mapped_file_open(const int filedes)
+{
+  BLI_mmap_file *mmap = BLI_mmap_open_copy_on_write(filedes);
+  if (mmap == nullptr) {
+    return nullptr;
+  }
+  MappedBlendFile *mapped_file = MEM_new<MappedBlendFile>(__func__);
+  mapped_file->mmap = mmap;
+  mapped_file->users = 1;
+  return mapped_file;
+}
+
+static void mapped_file_remove_user(MappedBlendFile *mapped_file)
+{
+  if (mapped_file->users.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    BLI_mmap_free(mapped_file->mmap);
+    MEM_delete(mapped_file);
+  }
+}
+
+/** Keeps the mapping alive while an array referencing data in it is used. */
+class MappedDataSharingInfo : public blender::ImplicitSharingInfo {
+ private:
+  MappedBlendFile *mapped_file_;
+
+ public:
+  MappedDataSharingInfo(MappedBlendFile *mapped_file) : mapped_file_(mapped_file)
+  {
+    mapped_file_->users.fetch_add(1, std::memory_order_relaxed);
+  }
+
+ private:
+  void delete_self_with_data() override
+  {
+    mapped_file_remove_user(mapped_file_);
+    MEM_delete(this);
+  }
+};
+
+/**
+ * Get a pointer to the data of a #BHead in the mapped file, when it can be used directly.
+ * Data is only referenced when it doesn't need any conversion and is sufficiently large.
+ */
+static void *mapped_file_bhead_data(FileData *fd, BHead *bhead)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  if (fd->mapped_file == nullptr) {
+    return nullptr;
+  }
+  if (bhead->len < MAPPED_DATA_MIN_SIZE || (fd->flags & FD_FLAGS_SWITCH_ENDIAN) ||
+      fd->compflags[bhead->SDNAnr] != SDNA_CMP_EQUAL)
+  {
+    return nullptr;
+  }
+  const BHeadN *bheadn = BHEADN_FROM_BHEAD(bhead);
+  if (bheadn->has_data) {
+    return nullptr;
+  }
+  char *data = static_cast<char *>(BLI_mmap_get_pointer(fd->mapped_file->mmap)) +
+               bheadn->file_offset;
+  /* Data arrays in files are not necessarily aligned to more than 4 bytes. Shared arrays may
+   * contain any plain type, so only reference data that is suitably aligned for all of them. */
+  if ((uintptr_t(data) & 7) != 0) {
+    return nullptr;
+  }
+  return data;
+#else
+  UNUSED_VARS(fd, bhead);
+  return nullptr;
+#endif
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Helper Functions
  * \{ */
@@ -1184,10 +1290,20 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   /* Rewind the file after reading the header. */
   rawfile->seek(rawfile, 0, SEEK_SET);
 
+  MappedBlendFile *mapped_file = nullptr;
+
   /* Check if we have a regular file. */
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    /* Try opening the file with memory-mapped IO. */
-    file = BLI_filereader_new_mmap(filedes);
+    if (G.f & G_FLAG_READFILE_MMAP_SHARING) {
+      mapped_file = mapped_file_open(filedes);
+      if (mapped_file != nullptr) {
+        file = BLI_filereader_new_mmap_from_file(mapped_file->mmap);
+      }
+    }
+    if (file == nullptr) {
+      /* Try opening the file with memory-mapped IO. */
+      file = BLI_filereader_new_mmap(filedes);
+    }
     if (file == nullptr) {
       /* `mmap` failed, so just keep using `rawfile`. */
       file = rawfile;
@@ -1218,6 +1334,7 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   FileData *fd = filedata_new(reports);
   fd->file = file;
+  fd->mapped_file = mapped_file;
 
   return fd;
 }
@@ -1331,6 +1448,9 @@ void blo_filedata_free(FileData *fd)
     }
 #endif
     fd->file->close(fd->file);
+    if (fd->mapped_file) {
+      mapped_file_remove_user(fd->mapped_file);
+    }
 
     if (fd->filesdna) {
       DNA_sdna_free(fd->filesdna);
@@ -1428,15 +1548,43 @@ short BLO_version_from_file(const char *filepath)
 /** \name Old/New Pointer Map
  * \{ */
 
+/**
+ * Data referenced in the mapped file is copied for users that expect a regular allocation.
+ * Afterwards the copy is used by all later lookups.
+ */
+static void datamap_ensure_allocated(FileData *fd, const void *adr)
+{
+  NewAddress *entry = fd->datamap->map.lookup_ptr(adr);
+  if (entry == nullptr || entry->mapped_len == 0) {
+    return;
+  }
+  BLI_mmap_file *mmap = fd->mapped_file->mmap;
+  const size_t offset = size_t(static_cast<char *>(entry->newp) -
+                               static_cast<char *>(BLI_mmap_get_pointer(mmap)));
+  void *data = MEM_mallocN(size_t(entry->mapped_len), "mapped data copy");
+  if (!BLI_mmap_read(mmap, data, offset, size_t(entry->mapped_len))) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+    memset(data, 0, size_t(entry->mapped_len));
+  }
+  entry->newp = data;
+  entry->mapped_len = 0;
+}
+
 /* Only direct data-blocks. */
 static void *newdataadr(FileData *fd, const void *adr)
 {
+  if (fd->mapped_file) {
+    datamap_ensure_allocated(fd, adr);
+  }
   return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
 /* Only direct data-blocks. */
 static void *newdataadr_no_us(FileData *fd, const void *adr)
 {
+  if (fd->mapped_file) {
+    datamap_ensure_allocated(fd, adr);
+  }
   return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
 }
 
@@ -1452,7 +1600,7 @@ static void *newpackedadr(FileData *fd, const void *adr)
     return oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
   }
 
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return newdataadr(fd, adr);
 }
 
 /* only lib data */
@@ -2557,8 +2705,12 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
     }
 #endif
 
-    void *data = read_struct(fd, bhead, allocname);
-    if (data) {
+    if (void *mapped_data = mapped_file_bhead_data(fd, bhead)) {
+      if (bhead->old) {
+        fd->datamap->map.add_overwrite(bhead->old, NewAddress{mapped_data, 0, bhead->len});
+      }
+    }
+    else if (void *data = read_struct(fd, bhead, allocname)) {
       oldnewmap_insert(fd->datamap, bhead->old, data, 0);
     }
 
@@ -3309,10 +3461,67 @@ static int lib_link_cb(LibraryIDLinkCallbackData *cb_data)
   return IDWALK_RET_NOP;
 }
 
+static int lib_link_id_walk_flag(const FileData *fd)
+{
+  /* Not all original pointer values can be considered as valid.
+   * Handling of DNA deprecated data should never be needed in undo case. */
+  return IDWALK_NO_ORIG_POINTERS_ACCESS | IDWALK_INCLUDE_UI |
+         ((fd->flags & FD_FLAGS_IS_MEMFILE) ? 0 : IDWALK_DO_DEPRECATED_POINTERS);
+}
+
+/**
+ * ID types whose #IDTypeInfo.foreach_id callback only accesses data owned by the ID itself, so
+ * that their ID pointers can be remapped from multiple threads at once.
+ */
+static bool lib_link_id_type_supports_parallel(const short id_code)
+{
+  return ELEM(id_code,
+              ID_ME,
+              ID_CV,
+              ID_PT,
+              ID_VO,
+              ID_MB,
+              ID_LT,
+              ID_CU_LEGACY,
+              ID_MA,
+              ID_TE,
+              ID_LA,
+              ID_CA,
+              ID_AC);
+}
+
+/**
+ * Remap the ID pointers of all IDs of types supporting it in parallel. Only the lookups in the
+ * (read-only at this point) `libmap` are shared between threads. The rest of the lib-linking,
+ * which may access other IDs, is still done in order by #lib_link_all.
+ */
+static void lib_link_ids_parallel(BlendLibReader *reader, Main *bmain)
+{
+  using namespace blender;
+
+  Vector<ID *> ids;
+  ID *id;
+  FOREACH_MAIN_ID_BEGIN (bmain, id) {
+    if ((id->tag & LIB_TAG_NEED_LINK) != 0 && lib_link_id_type_supports_parallel(GS(id->name))) {
+      ids.append(id);
+    }
+  }
+  FOREACH_MAIN_ID_END;
+
+  const int flag = lib_link_id_walk_flag(reader->fd);
+  threading::parallel_for(ids.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      BKE_library_foreach_ID_link(nullptr, ids[i], lib_link_cb, reader, flag);
+    }
+  });
+}
+
 static void lib_link_all(FileData *fd, Main *bmain)
 {
   BlendLibReader reader = {fd, bmain};
 
+  lib_link_ids_parallel(&reader, bmain);
+
   ID *id;
   FOREACH_MAIN_ID_BEGIN (bmain, id) {
     const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
@@ -3339,11 +3548,10 @@ static void lib_link_all(FileData *fd, Main *bmain)
     }
 
     if ((id->tag & LIB_TAG_NEED_LINK) != 0) {
-      /* Not all original pointer values can be considered as valid.
-       * Handling of DNA deprecated data should never be needed in undo case. */
-      const int flag = IDWALK_NO_ORIG_POINTERS_ACCESS | IDWALK_INCLUDE_UI |
-                       ((fd->flags & FD_FLAGS_IS_MEMFILE) ? 0 : IDWALK_DO_DEPRECATED_POINTERS);
-      BKE_library_foreach_ID_link(nullptr, id, lib_link_cb, &reader, flag);
+      /* Already done by #lib_link_ids_parallel otherwise. */
+      if (!lib_link_id_type_supports_parallel(GS(id->name))) {
+        BKE_library_foreach_ID_link(nullptr, id, lib_link_cb, &reader, lib_link_id_walk_flag(fd));
+      }
 
       after_liblink_id_process(&reader, id);
 
@@ -4840,6 +5048,27 @@ void *BLO_read_get_new_data_address(BlendDataReader *reader, const void *old_add
   return newdataadr(reader->fd, old_address);
 }
 
+const blender::ImplicitSharingInfo *BLO_read_data_address_shared(BlendDataReader *reader,
+                                                                 void **ptr_p)
+{
+  FileData *fd = reader->fd;
+  if (fd->mapped_file != nullptr) {
+    NewAddress *entry = fd->datamap->map.lookup_ptr(*ptr_p);
+    if (entry != nullptr && entry->mapped_len != 0) {
+      entry->nr++;
+      *ptr_p = entry->newp;
+      return MEM_new<MappedDataSharingInfo>(__func__, fd->mapped_file);
+    }
+  }
+  *ptr_p = newdataadr(fd, *ptr_p);
+  return nullptr;
+}
+
+bool BLO_read_data_is_mapped(const blender::ImplicitSharingInfo *sharing_info)
+{
+  return dynamic_cast<const MappedDataSharingInfo *>(sharing_info) != nullptr;
+}
+
 void *BLO_read_get_new_data_address_no_us(BlendDataReader *reader, const void *old_address)
 {
   return newdataadr_no_us(reader->fd, old_address);
@@ -22,6 +22,7 @@
 
 #include "BLO_readfile.h"
 
+struct BLI_mmap_file;
 struct BlendFileData;
 struct BlendFileReadParams;
 struct BlendFileReadReport;
@@ -33,6 +34,7 @@ struct Key;
 struct Main;
 struct MemFile;
 struct Object;
+struct MappedBlendFile;
 struct OldNewMap;
 struct ReportList;
 struct UserDef;
@@ -60,6 +62,11 @@ struct FileData {
   bool is_eof;
 
   FileReader *file;
+  /**
+   * The memory-mapped file when data arrays can be referenced in it directly instead of being
+   * copied, see #G_FLAG_READFILE_MMAP_SHARING and #BLO_read_data_address_shared.
+   */
+  MappedBlendFile *mapped_file;
 
   /** Whether we are undoing (< 0) or redoing (> 0), used to choose which 'unchanged' flag to use
    * to detect unchanged data from memfile. */
@@ -133,6 +133,8 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
   curchunk->is_identical_future = true;
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
+  curchunk->id_hash = mem_data->current_id_hash;
+  mem_data->current_id_hash = 0;
   BLI_addtail(&memfile->chunks, curchunk);
 
   /* we compare compchunk with buf */
@@ -157,6 +159,39 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   }
 }
 
+bool BLO_memfile_id_reuse(MemFileWriteData *mem_data, uint id_session_uuid, uint64_t id_hash)
+{
+  if (id_hash == 0) {
+    return false;
+  }
+  MemFileChunk *ref_chunk = mem_data->id_session_uuid_mapping.lookup_default(id_session_uuid,
+                                                                             nullptr);
+  if (ref_chunk == nullptr || ref_chunk->id_hash != id_hash) {
+    return false;
+  }
+
+  /* Share the buffers of all the contiguous chunks of that ID, like #BLO_memfile_chunk_add does
+   * for identical chunks. */
+  MemFile *memfile = mem_data->written_memfile;
+  for (; ref_chunk != nullptr && ref_chunk->id_session_uuid == id_session_uuid;
+       ref_chunk = static_cast<MemFileChunk *>(ref_chunk->next))
+  {
+    MemFileChunk *curchunk = static_cast<MemFileChunk *>(
+        MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk"));
+    curchunk->buf = ref_chunk->buf;
+    curchunk->size = ref_chunk->size;
+    curchunk->is_identical = true;
+    curchunk->is_identical_future = true;
+    curchunk->id_session_uuid = id_session_uuid;
+    curchunk->id_hash = ref_chunk->id_hash;
+    BLI_addtail(&memfile->chunks, curchunk);
+
+    ref_chunk->is_identical_future = true;
+  }
+  mem_data->reference_current_chunk = ref_chunk;
+  return true;
+}
+
 Main *BLO_memfile_main_get(MemFile *memfile, Main *bmain, Scene **r_scene)
 {
   Main *bmain_undo = nullptr;
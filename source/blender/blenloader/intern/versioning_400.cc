@@ -534,9 +534,9 @@ static void version_vertex_weight_edit_preserve_threshold_exclusivity(Main *bmai
 
 static void version_mesh_crease_generic(Main &bmain)
 {
-  LISTBASE_FOREACH (Mesh *, mesh, &bmain.meshes) {
-    BKE_mesh_legacy_crease_to_generic(mesh);
-  }
+  version_foreach_id_parallel(bmain.meshes, [](ID &id) {
+    BKE_mesh_legacy_crease_to_generic(reinterpret_cast<Mesh *>(&id));
+  });
 
   LISTBASE_FOREACH (bNodeTree *, ntree, &bmain.nodetrees) {
     if (ntree->type == NTREE_GEOMETRY) {
@@ -1853,16 +1853,16 @@ static void versioning_grease_pencil_stroke_radii_scaling(GreasePencil *grease_p
 void blo_do_versions_400(FileData *fd, Library * /*lib*/, Main *bmain)
 {
   if (!MAIN_VERSION_FILE_ATLEAST(bmain, 400, 1)) {
-    LISTBASE_FOREACH (Mesh *, mesh, &bmain->meshes) {
-      version_mesh_legacy_to_struct_of_array_format(*mesh);
-    }
+    version_foreach_id_parallel(bmain->meshes, [](ID &id) {
+      version_mesh_legacy_to_struct_of_array_format(reinterpret_cast<Mesh &>(id));
+    });
     version_movieclips_legacy_camera_object(bmain);
   }
 
   if (!MAIN_VERSION_FILE_ATLEAST(bmain, 400, 2)) {
-    LISTBASE_FOREACH (Mesh *, mesh, &bmain->meshes) {
-      BKE_mesh_legacy_bevel_weight_to_generic(mesh);
-    }
+    version_foreach_id_parallel(bmain->meshes, [](ID &id) {
+      BKE_mesh_legacy_bevel_weight_to_generic(reinterpret_cast<Mesh *>(&id));
+    });
   }
 
   /* 400 4 did not require any do_version here. */
@@ -1892,9 +1892,7 @@ void blo_do_versions_400(FileData *fd, Library * /*lib*/, Main *bmain)
   }
 
   if (!MAIN_VERSION_FILE_ATLEAST(bmain, 400, 7)) {
-    LISTBASE_FOREACH (Mesh *, mesh, &bmain->meshes) {
-      version_mesh_crease_generic(*bmain);
-    }
+    version_mesh_crease_generic(*bmain);
   }
 
   if (!MAIN_VERSION_FILE_ATLEAST(bmain, 400, 8)) {
@@ -2676,7 +2674,7 @@ void blo_do_versions_400(FileData *fd, Library * /*lib*/, Main *bmain)
   /* Always run this versioning; meshes are written with the legacy format which always needs to
    * be converted to the new format on file load. Can be moved to a subversion check in a larger
    * breaking release. */
-  LISTBASE_FOREACH (Mesh *, mesh, &bmain->meshes) {
-    blender::bke::mesh_sculpt_mask_to_generic(*mesh);
-  }
+  version_foreach_id_parallel(bmain->meshes, [](ID &id) {
+    blender::bke::mesh_sculpt_mask_to_generic(reinterpret_cast<Mesh &>(id));
+  });
 }
@@ -49,6 +49,15 @@ ARegion *do_versions_ensure_region(ListBase *regionbase,
  */
 ID *do_versions_rename_id(Main *bmain, short id_type, const char *name_src, const char *name_dst);
 
+/**
+ * Call \a fn for every ID in \a lb, in parallel.
+ *
+ * Only use this for versioning code that is thread-safe: it may only modify the ID it is called
+ * for and data owned by it, must not access #Main or other IDs, and must not create or delete IDs.
+ * Typically used for converting large geometry data of each mesh or curves data-block.
+ */
+void version_foreach_id_parallel(ListBase &lb, FunctionRef<void(ID &id)> fn);
+
 bool version_node_socket_is_used(bNodeSocket *sock);
 
 void version_node_socket_name(bNodeTree *ntree,
@@ -85,17 +85,22 @@
 #include "DNA_fileglobal_types.h"
 #include "DNA_genfile.h"
 #include "DNA_key_types.h"
+#include "DNA_scene_types.h"
 #include "DNA_sdna_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_link_utils.h"
 #include "BLI_linklist.h"
 #include "BLI_math_base.h"
 #include "BLI_mempool.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
 
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
@@ -393,6 +398,15 @@ bool ZstdWriteWrap::write(const void *buf, size_t buf_len)
 /** \name Write Data Type & Functions
  * \{ */
 
+/**
+ * Output of an ID serialized on its own: the bytes and the sizes of every #mywrite call, so that
+ * replaying it through #mywrite produces exactly the same output as writing the ID directly.
+ */
+struct WriteRecord {
+  blender::Vector<uchar> data;
+  blender::Vector<size_t> sizes;
+};
+
 struct WriteData {
   const SDNA *sdna;
 
@@ -421,6 +435,9 @@ struct WriteData {
   /** When true, write to #WriteData.current, could also call 'is_undo'. */
   bool use_memfile;
 
+  /** When set, all writes are recorded here instead of being written out. */
+  WriteRecord *record;
+
   /**
    * Wrap writing, so we can use zstd or
    * other compression types later, see: G_FILE_COMPRESS
@@ -456,6 +473,16 @@ static WriteData *writedata_new(WriteWrap *ww)
   return wd;
 }
 
+static WriteData *writedata_new_record(WriteRecord *record)
+{
+  WriteData *wd = MEM_new<WriteData>(__func__);
+
+  wd->sdna = DNA_sdna_current_get();
+  wd->record = record;
+
+  return wd;
+}
+
 static void writedata_do_write(WriteData *wd, const void *mem, size_t memlen)
 {
   if ((wd == nullptr) || wd->error || (mem == nullptr) || memlen < 1) {
@@ -524,6 +551,12 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
     return;
   }
 
+  if (wd->record != nullptr) {
+    wd->record->data.extend(blender::Span(static_cast<const uchar *>(adr), int64_t(len)));
+    wd->record->sizes.append(len);
+    return;
+  }
+
 #ifdef USE_WRITE_DATA_LEN
   wd->write_len += len;
 #endif
@@ -562,6 +595,16 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
   }
 }
 
+/** Write the output of an ID serialized separately, see #WriteRecord. */
+static void mywrite_record(WriteData *wd, const WriteRecord &record)
+{
+  const uchar *data = record.data.data();
+  for (const size_t len : record.sizes) {
+    mywrite(wd, data, len);
+    data += len;
+  }
+}
+
 /**
  * BeGiN initializer for mywrite
  * \param ww: File write wrapper.
@@ -648,6 +691,7 @@ static void mywrite_id_end(WriteData *wd, ID * /*id*/)
      * specific ID changed or not. */
     mywrite_flush(wd);
     wd->mem.current_id_session_uuid = MAIN_ID_SESSION_UUID_UNSET;
+    wd->mem.current_id_hash = 0;
   }
 }
 
@@ -1166,6 +1210,51 @@ static void id_buffer_init_from_id(BLO_Write_IDBuffer *id_buffer, ID *id, const
   temp_id->py_instance = nullptr;
 }
 
+/**
+ * Hash of the ID struct (and its embedded IDs) as it is about to be written for undo, used to
+ * skip writing unchanged IDs when #UserDef_Experimental.use_undo_id_change_tracking is enabled.
+ *
+ * Only the ID structs are hashed, so this is cheap compared to writing the ID. Changes to the rest
+ * of the ID data are detected through the depsgraph update tags accumulated since the previous
+ * undo push, see \a r_is_tagged. Must be called after #id_buffer_init_from_id.
+ */
+static uint64_t write_undo_id_hash(const BLO_Write_IDBuffer *id_buffer, ID *id, bool *r_is_tagged)
+{
+  const uchar *data = reinterpret_cast<const uchar *>(id_buffer->temp_id);
+  const size_t size = id_buffer->id_type->struct_size;
+  uint32_t hash_a = BLI_hash_mm2(data, size, 0);
+  uint32_t hash_b = BLI_hash_mm2(data, size, 0x9e3779b9);
+  bool is_tagged = id->recalc_up_to_undo_push != 0;
+
+  ID *embedded_ids[2] = {nullptr, nullptr};
+  size_t embedded_sizes[2] = {0, 0};
+  if (bNodeTree *ntree = ntreeFromID(id)) {
+    embedded_ids[0] = &ntree->id;
+    embedded_sizes[0] = sizeof(bNodeTree);
+  }
+  if (GS(id->name) == ID_SCE) {
+    if (Collection *master_collection = reinterpret_cast<Scene *>(id)->master_collection) {
+      embedded_ids[1] = &master_collection->id;
+      embedded_sizes[1] = sizeof(Collection);
+    }
+  }
+  for (int i = 0; i < 2; i++) {
+    const ID *embedded_id = embedded_ids[i];
+    if (embedded_id == nullptr) {
+      continue;
+    }
+    /* Embedded IDs have no undo push of their own, their tags are only cleared when an undo step
+     * is loaded. Until then the owner is always written again. */
+    is_tagged |= embedded_id->recalc_after_undo_push != 0;
+    hash_a = BLI_hash_mm2(reinterpret_cast<const uchar *>(embedded_id), embedded_sizes[i], hash_a);
+  }
+
+  *r_is_tagged = is_tagged;
+  const uint64_t hash = (uint64_t(hash_a) << 32) | uint64_t(hash_b);
+  /* Zero means unknown hash. */
+  return hash != 0 ? hash : 1;
+}
+
 /* Helper callback for checking linked IDs used by given ID (assumed local), to ensure directly
  * linked data is tagged accordingly. */
 static int write_id_direct_linked_data_process_cb(LibraryIDLinkCallbackData *cb_data)
@@ -1194,6 +1283,61 @@ static int write_id_direct_linked_data_process_cb(LibraryIDLinkCallbackData *cb_
   return IDWALK_RET_NOP;
 }
 
+/**
+ * ID types whose `blend_write` callback only reads the ID it writes (and its own data), so that
+ * multiple IDs can be serialized at the same time. Other types are always written from the
+ * main thread.
+ */
+static bool write_id_type_supports_parallel_write(const IDTypeInfo *id_type)
+{
+  return ELEM(id_type->id_code,
+              ID_ME,
+              ID_CV,
+              ID_PT,
+              ID_VO,
+              ID_MB,
+              ID_LT,
+              ID_CU_LEGACY,
+              ID_MA,
+              ID_TE,
+              ID_LA,
+              ID_CA,
+              ID_AC);
+}
+
+/**
+ * Serialize \a ids in parallel, each into its own #WriteRecord, then write the records in order
+ * so the output is identical to writing the IDs one after the other.
+ */
+static void write_ids_parallel(WriteData *wd, blender::Span<ID *> ids)
+{
+  using namespace blender;
+  if (ids.is_empty()) {
+    return;
+  }
+
+  Array<WriteRecord> records(ids.size());
+  threading::parallel_for(ids.index_range(), 1, [&](const IndexRange range) {
+    BLO_Write_IDBuffer *id_buffer = BLO_write_allocate_id_buffer();
+    for (const int64_t i : range) {
+      ID *id = ids[i];
+      const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
+      id_buffer_init_for_id_type(id_buffer, id_type);
+      id_buffer_init_from_id(id_buffer, id, false);
+
+      WriteData *record_wd = writedata_new_record(&records[i]);
+      BlendWriter writer = {record_wd};
+      id_type->blend_write(&writer, static_cast<ID *>(id_buffer->temp_id), id);
+      writedata_free(record_wd);
+    }
+    BLO_write_destroy_id_buffer(&id_buffer);
+  });
+
+  for (const WriteRecord &record : records) {
+    mywrite_record(wd, record);
+  }
+}
+
 /**
  * When #MemFile arguments are non-null, this is a file-safe to memory.
  *
@@ -1206,6 +1350,7 @@ static bool write_file_handle(Main *mainvar,
                               MemFile *current,
                               int write_flags,
                               bool use_userdef,
+                              bool use_parallel_write,
                               const BlendThumbnail *thumb)
 {
   BHead bhead;
@@ -1274,6 +1419,12 @@ static bool write_file_handle(Main *mainvar,
   OverrideLibraryStorage *override_storage = wd->use_memfile ?
                                                  nullptr :
                                                  BKE_lib_override_library_operations_store_init();
+  const bool use_id_change_tracking = wd->use_memfile &&
+                                      USER_EXPERIMENTAL_TEST(&U, use_undo_id_change_tracking);
+  use_parallel_write = use_parallel_write && !wd->use_memfile && BLI_system_thread_count() > 1;
+  /* Bound the memory used by the recorded IDs, see #write_ids_parallel. */
+  const int64_t parallel_write_batch_size = BLI_system_thread_count();
+  blender::Vector<ID *> ids_parallel;
 
   /* This outer loop allows to save first data-blocks from real mainvar,
    * then the temp ones from override process,
@@ -1341,6 +1492,20 @@ static bool write_file_handle(Main *mainvar,
               bmain, id, write_id_direct_linked_data_process_cb, nullptr, IDWALK_READONLY);
         }
 
+        if (use_parallel_write && !do_override && id_type->blend_write != nullptr &&
+            write_id_type_supports_parallel_write(id_type))
+        {
+          ids_parallel.append(id);
+          if (ids_parallel.size() >= parallel_write_batch_size) {
+            write_ids_parallel(wd, ids_parallel);
+            ids_parallel.clear();
+          }
+          continue;
+        }
+        /* Keep the order of IDs written in parallel and serially. */
+        write_ids_parallel(wd, ids_parallel);
+        ids_parallel.clear();
+
         if (do_override) {
           BKE_lib_override_library_operations_store_start(bmain, override_storage, id);
         }
@@ -1349,6 +1514,20 @@ static bool write_file_handle(Main *mainvar,
 
         id_buffer_init_from_id(id_buffer, id, wd->use_memfile);
 
+        if (use_id_change_tracking) {
+          /* Decide before serializing the ID: untagged IDs with an unchanged ID struct share the
+           * chunks of the previous undo step and are not written at all. */
+          bool is_tagged;
+          const uint64_t id_hash = write_undo_id_hash(id_buffer, id, &is_tagged);
+          if (!is_tagged && BLO_memfile_id_reuse(&wd->mem, id->session_uuid, id_hash)) {
+            wd->mem.id_reused_num++;
+            mywrite_id_end(wd, id);
+            continue;
+          }
+          wd->mem.current_id_hash = id_hash;
+          wd->mem.id_written_num++;
+        }
+
         if (id_type->blend_write != nullptr) {
           id_type->blend_write(&writer, static_cast<ID *>(id_buffer->temp_id), id);
         }
@@ -1360,6 +1539,9 @@ static bool write_file_handle(Main *mainvar,
         mywrite_id_end(wd, id);
       }
 
+      write_ids_parallel(wd, ids_parallel);
+      ids_parallel.clear();
+
       mywrite_flush(wd);
     }
   } while ((bmain != override_storage) && (bmain = override_storage));
@@ -1394,6 +1576,14 @@ static bool write_file_handle(Main *mainvar,
 
   blo_join_main(&mainlist);
 
+  if (use_id_change_tracking) {
+    CLOG_INFO(&LOG,
+              1,
+              "Undo step: %d IDs written, %d unchanged IDs reused",
+              wd->mem.id_written_num,
+              wd->mem.id_reused_num);
+  }
+
   return mywrite_end(wd);
 }
 
@@ -1598,8 +1788,14 @@ static bool BLO_write_file_impl(Main *mainvar,
   }
 
   /* Actual file writing. */
-  const bool err = write_file_handle(
-      mainvar, &ww, nullptr, nullptr, write_flags, use_userdef, thumb);
+  const bool err = write_file_handle(mainvar,
+                                     &ww,
+                                     nullptr,
+                                     nullptr,
+                                     write_flags,
+                                     use_userdef,
+                                     params->use_parallel_write,
+                                     thumb);
 
   ww.close();
 
@@ -1661,7 +1857,7 @@ bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int w
   bool use_userdef = false;
 
   const bool err = write_file_handle(
-      mainvar, nullptr, compare, current, write_flags, use_userdef, nullptr);
+      mainvar, nullptr, compare, current, write_flags, use_userdef, false, nullptr);
 
   return (err == 0);
 }
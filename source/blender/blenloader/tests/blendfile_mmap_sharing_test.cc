@@ -0,0 +1,103 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "blendfile_loading_base_test.h"
+
+#include <string>
+
+#include "BKE_appdir.h"
+#include "BKE_DerivedMesh.hh"
+#include "BKE_cdderivedmesh.h"
+#include "BKE_global.h"
+#include "BKE_lib_id.hh"
+#include "BKE_main.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+#include "BKE_mesh_runtime.hh"
+
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+
+#include "BLO_read_write.hh"
+#include "BLO_readfile.h"
+#include "BLO_writefile.hh"
+
+#include "DNA_mesh_types.h"
+
+class BlendfileMmapSharingTest : public BlendfileLoadingBaseTest {
+ protected:
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    BKE_tempdir_init("");
+    G.f |= G_FLAG_READFILE_MMAP_SHARING;
+  }
+
+  void TearDown() override
+  {
+    G.f &= ~G_FLAG_READFILE_MMAP_SHARING;
+    BlendfileLoadingBaseTest::TearDown();
+    BKE_tempdir_session_purge();
+  }
+};
+
+/**
+ * A strip of quads, large enough for the face offsets and the other arrays to be referenced in
+ * the mapped file instead of being copied.
+ */
+static Mesh *create_quad_strip_mesh(Main *bmain, const int faces_num)
+{
+  using namespace blender;
+  Mesh *mesh = static_cast<Mesh *>(BKE_id_new(bmain, ID_ME, "Strip"));
+  Mesh *mesh_src = BKE_mesh_new_nomain((faces_num + 1) * 2, 0, faces_num, faces_num * 4);
+  MutableSpan<float3> positions = mesh_src->vert_positions_for_write();
+  for (const int i : IndexRange(faces_num + 1)) {
+    positions[i * 2] = float3(float(i), 0.0f, 0.0f);
+    positions[i * 2 + 1] = float3(float(i), 1.0f, 0.0f);
+  }
+  MutableSpan<int> face_offsets = mesh_src->face_offsets_for_write();
+  MutableSpan<int> corner_verts = mesh_src->corner_verts_for_write();
+  for (const int i : IndexRange(faces_num)) {
+    face_offsets[i] = i * 4;
+    corner_verts[i * 4 + 0] = i * 2;
+    corner_verts[i * 4 + 1] = (i + 1) * 2;
+    corner_verts[i * 4 + 2] = (i + 1) * 2 + 1;
+    corner_verts[i * 4 + 3] = i * 2 + 1;
+  }
+  face_offsets.last() = faces_num * 4;
+  bke::mesh_calc_edges(*mesh_src, false, false);
+  BKE_mesh_nomain_to_mesh(mesh_src, mesh, nullptr);
+  return mesh;
+}
+
+TEST_F(BlendfileMmapSharingTest, ValidateAndConvertMappedMesh)
+{
+  const int faces_num = 40000;
+  const std::string filepath = std::string(BKE_tempdir_session()) + SEP_STR + "mapped.blend";
+  {
+    Main *bmain = BKE_main_new();
+    STRNCPY(bmain->filepath, filepath.c_str());
+    create_quad_strip_mesh(bmain, faces_num);
+    BlendFileWriteParams params{};
+    ASSERT_TRUE(BLO_write_file(bmain, filepath.c_str(), 0, &params, nullptr));
+    BKE_main_free(bmain);
+  }
+
+  BlendFileReadReport bf_reports = {};
+  bfile = BLO_read_from_file(filepath.c_str(), BLO_READ_SKIP_NONE, &bf_reports);
+  ASSERT_NE(bfile, nullptr);
+  Mesh *mesh = static_cast<Mesh *>(bfile->main->meshes.first);
+  ASSERT_NE(mesh, nullptr);
+  ASSERT_EQ(mesh->faces_num, faces_num);
+
+  /* The arrays have to be referenced in the mapping, otherwise this tests nothing. */
+  EXPECT_TRUE(BLO_read_data_is_mapped(mesh->runtime->face_offsets_sharing_info));
+
+  /* Validation checks the allocation size of guarded allocations only. */
+  EXPECT_FALSE(BKE_mesh_validate(mesh, false, true));
+
+  /* Derived meshes copy the face offsets, which must not rely on an allocation header. */
+  DerivedMesh *dm = CDDM_from_mesh(mesh);
+  EXPECT_EQ_ARRAY(mesh->face_offset_indices, dm->face_offsets, faces_num + 1);
+  dm->release(dm);
+}
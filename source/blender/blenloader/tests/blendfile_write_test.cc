@@ -0,0 +1,94 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "blendfile_loading_base_test.h"
+
+#include <string>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_lib_id.hh"
+#include "BKE_main.hh"
+#include "BKE_mesh.hh"
+#include "BKE_object.hh"
+#include "BKE_scene.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+
+#include "BLO_writefile.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+
+class BlendfileWriteTest : public BlendfileLoadingBaseTest {
+ protected:
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    BKE_tempdir_init("");
+  }
+
+  void TearDown() override
+  {
+    BlendfileLoadingBaseTest::TearDown();
+    BKE_tempdir_session_purge();
+  }
+
+  static std::string temp_filepath(const char *filename)
+  {
+    return std::string(BKE_tempdir_session()) + SEP_STR + filename;
+  }
+
+  static std::string write_file(Main *bmain, const char *filename, const bool use_parallel_write)
+  {
+    const std::string filepath = temp_filepath(filename);
+    BlendFileWriteParams params{};
+    params.use_parallel_write = use_parallel_write;
+    EXPECT_TRUE(BLO_write_file(bmain, filepath.c_str(), 0, &params, nullptr));
+
+    size_t size = 0;
+    void *data = BLI_file_read_binary_as_mem(filepath.c_str(), 0, &size);
+    EXPECT_NE(data, nullptr);
+    std::string contents(static_cast<const char *>(data), size);
+    MEM_SAFE_FREE(data);
+    return contents;
+  }
+};
+
+/** Many meshes with some data and objects using them, so that IDs are written in batches. */
+static Main *create_main()
+{
+  Main *bmain = BKE_main_new();
+  STRNCPY(bmain->filepath, "parallel_write_test.blend");
+  BKE_scene_add(bmain, "Scene");
+  for (const int i : blender::IndexRange(64)) {
+    char name[MAX_ID_NAME - 2];
+    SNPRINTF(name, "Mesh%d", i);
+    Mesh *mesh = static_cast<Mesh *>(BKE_id_new(bmain, ID_ME, name));
+    Mesh *mesh_src = BKE_mesh_new_nomain(100 + i * 10, 0, 0, 0);
+    blender::MutableSpan<blender::float3> positions = mesh_src->vert_positions_for_write();
+    for (const int vert : positions.index_range()) {
+      positions[vert] = blender::float3(float(vert), float(i), sinf(float(vert * i)));
+    }
+    BKE_mesh_nomain_to_mesh(mesh_src, mesh, nullptr);
+
+    Object *ob = BKE_object_add_only_object(bmain, OB_MESH, name);
+    ob->data = mesh;
+    id_us_plus(&mesh->id);
+  }
+  return bmain;
+}
+
+TEST_F(BlendfileWriteTest, ParallelWriteMatchesSerial)
+{
+  Main *bmain = create_main();
+  const std::string serial = write_file(bmain, "serial.blend", false);
+  const std::string parallel = write_file(bmain, "parallel.blend", true);
+  EXPECT_FALSE(serial.empty());
+  EXPECT_EQ(serial.size(), parallel.size());
+  EXPECT_TRUE(serial == parallel);
+  BKE_main_free(bmain);
+}
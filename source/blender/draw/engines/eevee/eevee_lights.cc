@@ -13,8 +13,12 @@
 
 #include "DEG_depsgraph_query.hh"
 
+#include "CLG_log.h"
+
 #include "eevee_private.h"
 
+static CLG_LogRef LOG = {"eevee.lights"};
+
 void eevee_light_matrix_get(const EEVEE_Light *evli, float r_mat[4][4])
 {
   copy_v3_v3(r_mat[0], evli->rightvec);
@@ -207,6 +211,7 @@ void EEVEE_lights_cache_init(EEVEE_ViewLayerData *sldata, EEVEE_Data *vedata)
 {
   EEVEE_LightsInfo *linfo = sldata->lights;
   linfo->num_light = 0;
+  linfo->num_light_group_list = 0;
 
   EEVEE_shadows_cache_init(sldata, vedata);
 }
@@ -263,5 +268,59 @@ void EEVEE_lights_cache_finish(EEVEE_ViewLayerData *sldata, EEVEE_Data *vedata)
     }
   }
 
+  linfo->light_group_culled_num = 0;
+  for (int i = 0; i < linfo->num_light_group_list; i++) {
+    EEVEE_LightGroupList *list = &linfo->light_group_lists[i];
+    linfo->light_group_culled_num += EEVEE_lights_group_cull_mask_build(
+        linfo->light_data, linfo->num_light, list->light_group_bits, list->cull_mask);
+  }
+  CLOG_INFO(&LOG,
+            2,
+            "%d light group lists, %d lights skipped",
+            linfo->num_light_group_list,
+            linfo->light_group_culled_num);
+
   GPU_uniformbuf_update(sldata->light_ubo, &linfo->light_data);
 }
+
+/* The shader reads the cull mask as a single `ivec4` push constant. */
+BLI_STATIC_ASSERT(MAX_LIGHT / 32 == 4, "Light cull mask must fit in an ivec4");
+
+int EEVEE_lights_group_cull_mask_build(const EEVEE_Light *lights,
+                                       int lights_num,
+                                       const int light_group_bits[4],
+                                       int r_cull_mask[MAX_LIGHT / 32])
+{
+  memset(r_cull_mask, 0, sizeof(int) * (MAX_LIGHT / 32));
+  int culled_num = 0;
+  for (int i = 0; i < lights_num; i++) {
+    const int *bits = lights[i].light_group_bits;
+    /* Same test as #light_attenuation() in the shader. */
+    if ((bits[0] & light_group_bits[0]) == 0 && (bits[1] & light_group_bits[1]) == 0 &&
+        (bits[2] & light_group_bits[2]) == 0 && (bits[3] & light_group_bits[3]) == 0)
+    {
+      r_cull_mask[i / 32] |= int(1u << (i % 32));
+      culled_num++;
+    }
+  }
+  return culled_num;
+}
+
+const int *EEVEE_lights_group_cull_mask_get(EEVEE_LightsInfo *linfo,
+                                            const int light_group_bits[4])
+{
+  for (int i = 0; i < linfo->num_light_group_list; i++) {
+    EEVEE_LightGroupList *list = &linfo->light_group_lists[i];
+    if (memcmp(list->light_group_bits, light_group_bits, sizeof(list->light_group_bits)) == 0) {
+      return list->cull_mask;
+    }
+  }
+  if (linfo->num_light_group_list >= MAX_LIGHT_GROUP_LISTS) {
+    /* Iterate over all lights, the shader still tests the light groups. */
+    return linfo->light_group_no_cull_mask;
+  }
+  EEVEE_LightGroupList *list = &linfo->light_group_lists[linfo->num_light_group_list++];
+  copy_v4_v4_int(list->light_group_bits, light_group_bits);
+  memset(list->cull_mask, 0, sizeof(list->cull_mask));
+  return list->cull_mask;
+}
@@ -103,6 +103,14 @@ void EEVEE_material_bind_resources(DRWShadingGroup *shgrp,
     DRW_shgroup_uniform_texture_ref(shgrp, "shadowCascadeTexture", &sldata->shadow_cascade_pool);
     DRW_shgroup_uniform_texture_ref(shgrp, "shadowCubeIDTexture", &sldata->shadow_cube_id_pool);
     DRW_shgroup_uniform_texture_ref(shgrp, "shadowCascadeIDTexture", &sldata->shadow_cascade_id_pool);
+
+    /* Skip the lights that don't belong to any of the material light groups. */
+    int light_groups[4];
+    GPU_material_light_group_bits_get(gpumat, light_groups);
+    DRW_shgroup_uniform_ivec4(shgrp,
+                              "light_cull_mask_in",
+                              EEVEE_lights_group_cull_mask_get(sldata->lights, light_groups),
+                              1);
   }
   if (use_diffuse || use_glossy || use_refract || use_ao) {
     DRW_shgroup_uniform_texture_ref(shgrp, "maxzBuffer", &vedata->txl->maxzbuffer);
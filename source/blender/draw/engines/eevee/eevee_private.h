@@ -501,6 +501,20 @@ typedef struct EEVEE_ShadowCasterBuffer {
   uint count;
 } EEVEE_ShadowCasterBuffer;
 
+/* ************ LIGHT GROUP LISTS ************* */
+/** Number of distinct material light group masks that get their own light list per frame. */
+#define MAX_LIGHT_GROUP_LISTS 64
+
+/**
+ * Lights relevant to one material light group mask, stored as a bitmap over #light_data
+ * (one bit per light, set for lights the shader can skip). Uploaded as a push constant so the
+ * shader iterates only over the remaining lights.
+ */
+typedef struct EEVEE_LightGroupList {
+  int light_group_bits[4];
+  int cull_mask[MAX_LIGHT / 32];
+} EEVEE_LightGroupList;
+
 /* ************ LIGHT DATA ************* */
 typedef struct EEVEE_LightsInfo {
   int num_light, cache_num_light;
@@ -529,6 +543,13 @@ typedef struct EEVEE_LightsInfo {
   struct {
     float min[3], max[3];
   } shcaster_aabb;
+  /* Per material light group light lists. Rebuilt every time the cache is populated. */
+  EEVEE_LightGroupList light_group_lists[MAX_LIGHT_GROUP_LISTS];
+  int num_light_group_list;
+  /* Cull mask used when there are too many distinct light group masks. Always zero. */
+  int light_group_no_cull_mask[MAX_LIGHT / 32];
+  /* Sum of the lights skipped by every light group list during the last cache finish. */
+  int light_group_culled_num;
 } EEVEE_LightsInfo;
 
 /* ************ PROBE DATA ************* */
@@ -1138,6 +1159,21 @@ void eevee_light_matrix_get(const EEVEE_Light *evli, float r_mat[4][4]);
 void EEVEE_lights_cache_init(EEVEE_ViewLayerData *sldata, EEVEE_Data *vedata);
 void EEVEE_lights_cache_add(EEVEE_ViewLayerData *sldata, struct Object *ob);
 void EEVEE_lights_cache_finish(EEVEE_ViewLayerData *sldata, EEVEE_Data *vedata);
+/**
+ * Return the light cull mask to bind as `light_cull_mask_in` for materials using the given light
+ * groups. The returned array is filled by #EEVEE_lights_cache_finish and stays valid until the
+ * next cache init.
+ */
+const int *EEVEE_lights_group_cull_mask_get(EEVEE_LightsInfo *linfo,
+                                            const int light_group_bits[4]);
+/**
+ * Build the cull mask of a light group list: set the bit of every light not listening to any of
+ * the groups in \a light_group_bits. Return the number of culled lights.
+ */
+int EEVEE_lights_group_cull_mask_build(const EEVEE_Light *lights,
+                                       int lights_num,
+                                       const int light_group_bits[4],
+                                       int r_cull_mask[MAX_LIGHT / 32]);
 
 /* `eevee_shadows.cc` */
 
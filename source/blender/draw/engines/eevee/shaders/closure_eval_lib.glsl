@@ -100,12 +100,13 @@
         CLOSURE_META_SUBROUTINE_DATA(planar_eval, planar, t0, t1, t2, t3); \
       } \
 \
-      for (int i = 0; i < laNumLight && i < MAX_LIGHT; i++) { \
+      LIGHT_FOREACH_BEGIN (i, lightCullMask) { \
         ClosureLightData light = closure_light_eval_init(cl_common, i); \
         if (light.vis > 1e-8) { \
           CLOSURE_META_SUBROUTINE_DATA(light_eval, light, t0, t1, t2, t3); \
         } \
       } \
+      LIGHT_FOREACH_END \
 \
       CLOSURE_META_SUBROUTINE(eval_end, t0, t1, t2, t3); \
     }
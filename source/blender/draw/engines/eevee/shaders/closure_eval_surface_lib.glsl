@@ -398,6 +398,16 @@ float calc_self_shadows_only(LightData ld, vec3 P, vec4 l_vector)
   return vis;
 }
 
+void calc_shader_info_ex(vec3 position,
+                         vec3 normal,
+                         ivec4 light_groups,
+                         ivec4 light_group_shadows,
+                         ivec4 light_cull_mask,
+                         out vec4 half_light,
+                         out float shadows,
+                         out float self_shadows,
+                         out vec4 ambient);
+
 /* Use default (Material) light groups */
 void calc_shader_info(vec3 position,
                       vec3 normal,
@@ -406,14 +416,16 @@ void calc_shader_info(vec3 position,
                       out float self_shadows,
                       out vec4 ambient)
 {
-  calc_shader_info(position,
-                   normal,
-                   lightGroups,
-                   lightGroupShadows,
-                   half_light,
-                   shadows,
-                   self_shadows,
-                   ambient);
+  /* The material light groups match the ones the cull mask was built for. */
+  calc_shader_info_ex(position,
+                      normal,
+                      lightGroups,
+                      lightGroupShadows,
+                      lightCullMask,
+                      half_light,
+                      shadows,
+                      self_shadows,
+                      ambient);
 }
 
 /* Use custom (Per-Node) light groups */
@@ -425,6 +437,27 @@ void calc_shader_info(vec3 position,
                       out float shadows,
                       out float self_shadows,
                       out vec4 ambient)
+{
+  calc_shader_info_ex(position,
+                      normal,
+                      light_groups,
+                      light_group_shadows,
+                      ivec4(0),
+                      half_light,
+                      shadows,
+                      self_shadows,
+                      ambient);
+}
+
+void calc_shader_info_ex(vec3 position,
+                         vec3 normal,
+                         ivec4 light_groups,
+                         ivec4 light_group_shadows,
+                         ivec4 light_cull_mask,
+                         out vec4 half_light,
+                         out float shadows,
+                         out float self_shadows,
+                         out vec4 ambient)
 {
   ClosureEvalCommon cl_common = closure_Common_eval_init(CLOSURE_INPUT_COMMON_DEFAULT);
   cl_common.P = position;
@@ -437,7 +470,7 @@ void calc_shader_info(vec3 position,
   float light_accum = 0.0;
   half_light = vec4(0.0);
 
-  for (int i = 0; i < laNumLight && i < MAX_LIGHT; i++) {
+  LIGHT_FOREACH_BEGIN (i, light_cull_mask) {
     ClosureLightData light = closure_light_eval_init(cl_common, i);
     LightData ld = light.data;
     if ((ld.light_group_bits.x & light_groups.x) == 0 &&
@@ -460,6 +493,7 @@ void calc_shader_info(vec3 position,
     float radiance = light_diffuse(light.data, n_n, cl_common.V, light.L);
     half_light += vec4(light.data.l_color * light.data.l_diff * radiance, 0.0);
   }
+  LIGHT_FOREACH_END
 
   shadows = (1.0 - (shadow_accum / max(light_accum, 1.0)));
   self_shadows = (1.0 - (self_shadow_accum / max(light_accum, 1.0)));
@@ -59,6 +59,7 @@ GPU_SHADER_CREATE_INFO(eevee_legacy_lights_lib)
     .uniform_buf(6, "LightBlock", "light_block", Frequency::PASS)
     .push_constant(Type::IVEC4, "light_groups_in")
     .push_constant(Type::IVEC4, "light_group_shadows_in")
+    .push_constant(Type::IVEC4, "light_cull_mask_in")
     .sampler(8, ImageType::SHADOW_2D_ARRAY, "shadowCubeTexture")
     .sampler(9, ImageType::SHADOW_2D_ARRAY, "shadowCascadeTexture")
     /* GooEngine: Use slots 15,16 as others are already taken. */
@@ -234,6 +234,7 @@ BLI_STATIC_ASSERT_ALIGN(SSSProfileBlock, 16)
 #    define planarClipPlane common_block._planarClipPlane
 #    define lightGroups light_groups_in
 #    define lightGroupShadows light_group_shadows_in
+#    define lightCullMask light_cull_mask_in
 
 /* ProbeBlock */
 #    define probes_data probe_block._probes_data
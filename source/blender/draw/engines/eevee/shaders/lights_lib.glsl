@@ -82,6 +82,31 @@ uniform depth2DArrayShadow shadowCascadeTexture;
 
 /** \} */
 
+/* ---------------------------------------------------------------------- */
+/** \name Light Iteration
+ * \{ */
+
+/**
+ * Iterate over the lights whose bit is not set in \a _cull_mask (one bit per light, see
+ * #EEVEE_lights_group_cull_mask_get). Lights outside of the material light groups are skipped
+ * without loading their data.
+ */
+#define LIGHT_FOREACH_BEGIN(_i, _cull_mask) \
+  for (int _word = 0; _word < 4 && _word * 32 < laNumLight; _word++) { \
+    uint _bits = ~uint(_cull_mask[_word]); \
+    while (_bits != 0u) { \
+      int _i = _word * 32 + findLSB(_bits); \
+      _bits &= _bits - 1u; \
+      if (_i >= laNumLight) { \
+        break; \
+      }
+
+#define LIGHT_FOREACH_END \
+  } \
+  }
+
+/** \} */
+
 /* ---------------------------------------------------------------------- */
 /** \name Shadow Functions
  * \{ */
@@ -0,0 +1,74 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "engines/eevee/eevee_private.h"
+
+namespace blender::draw {
+
+static void light_group_bits_set(EEVEE_Light &light, int word, int bits)
+{
+  for (int i = 0; i < 4; i++) {
+    light.light_group_bits[i] = (i == word) ? bits : 0;
+  }
+}
+
+TEST(eevee_legacy, light_group_cull_mask_build)
+{
+  EEVEE_Light lights[MAX_LIGHT] = {};
+  const int lights_num = 70;
+  for (int i = 0; i < lights_num; i++) {
+    /* Alternate lights between the first group and the last one. */
+    light_group_bits_set(lights[i], (i % 2) ? 3 : 0, 1);
+  }
+
+  int cull_mask[MAX_LIGHT / 32];
+  const int first_group[4] = {1, 0, 0, 0};
+  EXPECT_EQ(EEVEE_lights_group_cull_mask_build(lights, lights_num, first_group, cull_mask), 35);
+  /* Odd lights are culled, bits past the light count stay cleared. */
+  EXPECT_EQ(cull_mask[0], int(0xAAAAAAAAu));
+  EXPECT_EQ(cull_mask[1], int(0xAAAAAAAAu));
+  EXPECT_EQ(cull_mask[2], 0x2A);
+  EXPECT_EQ(cull_mask[3], 0);
+
+  const int all_groups[4] = {-1, -1, -1, -1};
+  EXPECT_EQ(EEVEE_lights_group_cull_mask_build(lights, lights_num, all_groups, cull_mask), 0);
+  EXPECT_EQ(cull_mask[0], 0);
+  EXPECT_EQ(cull_mask[2], 0);
+
+  const int unused_group[4] = {2, 0, 0, 0};
+  EXPECT_EQ(EEVEE_lights_group_cull_mask_build(lights, lights_num, unused_group, cull_mask),
+            lights_num);
+  EXPECT_EQ(cull_mask[1], -1);
+  EXPECT_EQ(cull_mask[2], 0x3F);
+}
+
+TEST(eevee_legacy, light_group_cull_mask_get)
+{
+  EEVEE_LightsInfo *linfo = MEM_cnew<EEVEE_LightsInfo>(__func__);
+
+  const int group_a[4] = {1, 0, 0, 0};
+  const int group_b[4] = {0, 0, 0, 4};
+  const int *mask_a = EEVEE_lights_group_cull_mask_get(linfo, group_a);
+  const int *mask_b = EEVEE_lights_group_cull_mask_get(linfo, group_b);
+  EXPECT_NE(mask_a, mask_b);
+  /* Materials sharing the same light groups share the same list. */
+  EXPECT_EQ(EEVEE_lights_group_cull_mask_get(linfo, group_a), mask_a);
+  EXPECT_EQ(linfo->num_light_group_list, 2);
+
+  /* Once all lists are used, fall back to iterating every light. */
+  for (int i = 0; linfo->num_light_group_list < MAX_LIGHT_GROUP_LISTS; i++) {
+    const int group[4] = {0, i + 1, 0, 0};
+    EEVEE_lights_group_cull_mask_get(linfo, group);
+  }
+  const int group_c[4] = {0, 0, 8, 0};
+  EXPECT_EQ(EEVEE_lights_group_cull_mask_get(linfo, group_c), linfo->light_group_no_cull_mask);
+
+  MEM_freeN(linfo);
+}
+
+}  // namespace blender::draw
@@ -359,6 +359,10 @@ void ANIM_animdata_update(bAnimContext *ac, ListBase *anim_data)
 
       if (ale->update & ANIM_UPDATE_DEPS) {
         ale->update &= ~ANIM_UPDATE_DEPS;
+        if (fcu) {
+          /* Keys may have been edited in place without recalculating the handles. */
+          BKE_fcurve_tag_keys_changed(fcu);
+        }
         ANIM_list_elem_update(ac->bmain, ac->scene, ale);
       }
     }
@@ -228,6 +228,7 @@ struct NodeBakeRequest {
   int frame_start;
   int frame_end;
   std::unique_ptr<bake::BlobSharing> blob_sharing;
+  bake::BlobWriteSettings blob_write_settings;
 };
 
 struct BakeGeometryNodesJob {
@@ -330,6 +331,7 @@ static void bake_geometry_nodes_startjob(void *customdata, wmJobWorkerStatus *wo
       BLI_file_ensure_parent_dir_exists(blob_path);
       fstream blob_file{blob_path, std::ios::out | std::ios::binary};
       bake::DiskBlobWriter blob_writer{blob_file_name, blob_file, 0};
+      blob_writer.settings = request.blob_write_settings;
       fstream meta_file{meta_path, std::ios::out};
       bake::serialize_bake(frame_cache.state, blob_writer, *request.blob_sharing, meta_file);
     }
@@ -446,6 +448,16 @@ static int start_bake_job(bContext *C,
   return OPERATOR_RUNNING_MODAL;
 }
 
+static bake::BlobWriteSettings get_blob_write_settings(const NodesModifierBake &bake)
+{
+  bake::BlobWriteSettings settings;
+  settings.use_compression = bake.flag & NODES_MODIFIER_BAKE_COMPRESS;
+  /* Delta encoding only reduces the size of the data when it is compressed as well. */
+  settings.use_delta_positions = settings.use_compression &&
+                                 (bake.flag & NODES_MODIFIER_BAKE_DELTA_POSITIONS);
+  return settings;
+}
+
 static Vector<NodeBakeRequest> collect_simulations_to_bake(Main &bmain,
                                                            Scene &scene,
                                                            const Span<Object *> objects)
@@ -481,6 +493,9 @@ static Vector<NodeBakeRequest> collect_simulations_to_bake(Main &bmain,
         request.bake_id = id;
         request.node_type = node->type;
         request.blob_sharing = std::make_unique<bake::BlobSharing>();
+        if (const NodesModifierBake *bake = nmd->find_bake(id)) {
+          request.blob_write_settings = get_blob_write_settings(*bake);
+        }
         std::optional<bake::BakePath> path = bake::get_node_bake_path(bmain, *object, *nmd, id);
         if (!path) {
           continue;
@@ -826,6 +841,7 @@ static Vector<NodeBakeRequest> bake_single_node_gather_bake_request(bContext *C,
   if (!bake) {
     return {};
   }
+  request.blob_write_settings = get_blob_write_settings(*bake);
   const std::optional<bake::BakePath> bake_path = bake::get_node_bake_path(
       *bmain, *object, nmd, bake_id);
   if (!bake_path.has_value()) {
@@ -377,6 +377,8 @@ void ED_undosys_stack_memfile_id_changed_tag(UndoStack *ustack, ID *id)
   LISTBASE_FOREACH (MemFileChunk *, mem_chunk, &memfile->chunks) {
     if (mem_chunk->id_session_uuid == id->session_uuid) {
       mem_chunk->is_identical_future = false;
+      /* The ID changed outside of depsgraph tagging, it must be written again on next push. */
+      mem_chunk->id_hash = 0;
       break;
     }
   }
@@ -11,6 +11,10 @@
  * another #Graph again).
  */
 
+#include <atomic>
+#include <memory>
+
+#include "BLI_array.hh"
 #include "BLI_vector.hh"
 #include "BLI_vector_set.hh"
 
@@ -106,6 +110,20 @@ class GraphExecutor : public LazyFunction {
    */
   const NodeExecuteWrapper *node_execute_wrapper_;
 
+  /**
+   * Number of function nodes on the longest path from every node to the graph outputs (indexed by
+   * #Node::index_in_graph). When multiple nodes are scheduled, the ones on the critical path are
+   * started first, so that the work that depends on them can start as early as possible.
+   */
+  Array<int> node_critical_path_lengths_;
+  /**
+   * Moving average of the execution time of every node in nanoseconds, zero when the node has not
+   * been executed yet. This is used to decide when it is worth to distribute work over multiple
+   * threads. Since the executor is reused for multiple evaluations, the estimates become better
+   * over time. The values are only a heuristic, so relaxed atomics are good enough.
+   */
+  std::unique_ptr<std::atomic<int64_t>[]> node_cost_estimates_;
+
   /**
    * When a graph is executed, various things have to be allocated (e.g. the state of all nodes).
    * Instead of doing many small allocations, a single bigger allocation is done. This struct
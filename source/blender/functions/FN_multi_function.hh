@@ -42,8 +42,11 @@ namespace blender::fn::multi_function {
 class MultiFunction : NonCopyable, NonMovable {
  private:
   const Signature *signature_ref_ = nullptr;
+  /** See #uid. */
+  uint64_t uid_;
 
  public:
+  MultiFunction();
   virtual ~MultiFunction() {}
 
   /**
@@ -92,6 +95,16 @@ class MultiFunction : NonCopyable, NonMovable {
 
   virtual std::string debug_name() const;
 
+  /**
+   * Identifier that is unique for every multi-function that has been constructed during the
+   * lifetime of the process. Unlike the address of the function, it is never reused after the
+   * function has been freed, so it can be used in keys of caches that may outlive the function.
+   */
+  uint64_t uid() const
+  {
+    return uid_;
+  }
+
   const Signature &signature() const
   {
     BLI_assert(signature_ref_ != nullptr);
@@ -138,6 +151,16 @@ class MultiFunction : NonCopyable, NonMovable {
   virtual ExecutionHints get_execution_hints() const;
 };
 
+/**
+ * Add the parameters in the given range of #full_params to #r_sliced_params, so that index zero
+ * in the sliced parameters corresponds to the start of the range. Vector parameters are not
+ * supported.
+ */
+void add_sliced_parameters(const Signature &signature,
+                           Params &full_params,
+                           IndexRange slice_range,
+                           ParamsBuilder &r_sliced_params);
+
 inline ParamsBuilder::ParamsBuilder(const MultiFunction &fn, const IndexMask *mask)
     : ParamsBuilder(fn.signature(), *mask)
 {
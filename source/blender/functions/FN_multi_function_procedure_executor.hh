@@ -17,9 +17,20 @@ class ProcedureExecutor : public MultiFunction {
  private:
   Signature signature_;
   const Procedure &procedure_;
+  /**
+   * Number of indices that are processed at once when executing the procedure in chunks, or zero
+   * if the full mask is always processed at once. See #ProcedureExecutor::call.
+   */
+  int64_t chunk_size_ = 0;
 
  public:
-  ProcedureExecutor(const Procedure &procedure);
+  /**
+   * \param use_chunked_execution: Split large masks into chunks that are small enough for the
+   * intermediate buffers of the procedure to stay in the CPU cache. The entire procedure is
+   * executed for one chunk before the next chunk is processed, instead of every instruction
+   * streaming over the full mask.
+   */
+  ProcedureExecutor(const Procedure &procedure, bool use_chunked_execution = true);
 
   void call(const IndexMask &mask, Params params, Context context) const override;
 
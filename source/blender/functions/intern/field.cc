@@ -2,7 +2,10 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include <mutex>
+
 #include "BLI_array_utils.hh"
+#include "BLI_hash.hh"
 #include "BLI_map.hh"
 #include "BLI_multi_value_map.hh"
 #include "BLI_set.hh"
@@ -34,6 +37,11 @@ struct FieldTreeInfo {
    * the tree is constructed. This set contains every different input only once.
    */
   VectorSet<std::reference_wrapper<const FieldInput>> deduplicated_field_inputs;
+  /**
+   * All constants in the field tree. They are passed into the procedure as parameters, so that
+   * the procedure does not depend on their values and can be reused for other constants.
+   */
+  VectorSet<const FieldConstant *> field_constants;
 };
 
 /**
@@ -72,7 +80,8 @@ static FieldTreeInfo preprocess_field_tree(Span<GFieldRef> entry_fields)
         break;
       }
       case FieldNodeType::Constant: {
-        /* Nothing to do. */
+        const FieldConstant &field_constant = static_cast<const FieldConstant &>(field_node);
+        field_tree_info.field_constants.add(&field_constant);
         break;
       }
     }
@@ -144,7 +153,6 @@ static Set<GFieldRef> find_varying_fields(const FieldTreeInfo &field_tree_info,
  * Builds the #procedure so that it computes the fields.
  */
 static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
-                                                      ResourceScope &scope,
                                                       const FieldTreeInfo &field_tree_info,
                                                       Span<GFieldRef> output_fields)
 {
@@ -158,6 +166,11 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
         mf::DataType::ForSingle(field_input.cpp_type()), field_input.debug_name());
     variable_by_field.add_new({field_input, 0}, &variable);
   }
+  for (const FieldConstant *field_constant : field_tree_info.field_constants) {
+    mf::Variable &variable = builder.add_input_parameter(
+        mf::DataType::ForSingle(field_constant->type()), "Constant");
+    variable_by_field.add_new({*field_constant, 0}, &variable);
+  }
 
   /* Utility struct that is used to do proper depth first search traversal of the tree below. */
   struct FieldWithIndex {
@@ -236,11 +249,7 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
           break;
         }
         case FieldNodeType::Constant: {
-          const FieldConstant &constant_node = static_cast<const FieldConstant &>(field_node);
-          const mf::MultiFunction &fn = procedure.construct_function<mf::CustomMF_GenericConstant>(
-              constant_node.type(), constant_node.value().get(), false);
-          mf::Variable &new_variable = *builder.add_call<1>(fn)[0];
-          variable_by_field.add_new(field, &new_variable);
+          /* Field constants should already be handled above. */
           break;
         }
       }
@@ -254,7 +263,7 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
     if (!already_output_variables.add(variable)) {
       /* One variable can be output at most once. To output the same value twice, we have to make
        * a copy first. */
-      const mf::MultiFunction &copy_fn = scope.construct<mf::CustomMF_GenericCopy>(
+      const mf::MultiFunction &copy_fn = procedure.construct_function<mf::CustomMF_GenericCopy>(
           variable->data_type());
       variable = builder.add_call<1>(copy_fn, {variable})[0];
     }
@@ -278,6 +287,204 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
   BLI_assert(procedure.validate());
 }
 
+/**
+ * Describes everything that #build_multi_function_procedure_for_fields depends on, without
+ * referencing the field nodes themselves. Two field trees with the same key result in identical
+ * procedures, even if they have been built separately (which is common, because node trees
+ * rebuild their fields on every evaluation).
+ *
+ * Multi-functions are identified by their #mf::MultiFunction::uid, which is never reused. A
+ * cached procedure that references a function which has been freed in the mean time can therefore
+ * never be found again and is just evicted eventually.
+ */
+struct FieldProcedureKey {
+  Vector<uint64_t> data;
+  uint64_t hash_value = 0;
+
+  uint64_t hash() const
+  {
+    return hash_value;
+  }
+
+  friend bool operator==(const FieldProcedureKey &a, const FieldProcedureKey &b)
+  {
+    return a.hash_value == b.hash_value && a.data.as_span() == b.data.as_span();
+  }
+};
+
+/**
+ * Traverses the field tree in the same order as #build_multi_function_procedure_for_fields and
+ * records the structure of the resulting procedure.
+ */
+static FieldProcedureKey build_field_procedure_key(const FieldTreeInfo &field_tree_info,
+                                                   Span<GFieldRef> output_fields)
+{
+  FieldProcedureKey key;
+  Vector<uint64_t> &data = key.data;
+  /* Every field that becomes a variable in the procedure gets an index in order of creation. */
+  Map<GFieldRef, int> index_by_field;
+
+  data.append(field_tree_info.deduplicated_field_inputs.size());
+  for (const FieldInput &field_input : field_tree_info.deduplicated_field_inputs) {
+    data.append(uint64_t(&field_input.cpp_type()));
+    index_by_field.add_new({field_input, 0}, index_by_field.size());
+  }
+  data.append(field_tree_info.field_constants.size());
+  for (const FieldConstant *field_constant : field_tree_info.field_constants) {
+    data.append(uint64_t(&field_constant->type()));
+    index_by_field.add_new({*field_constant, 0}, index_by_field.size());
+  }
+
+  struct FieldWithIndex {
+    GFieldRef field;
+    int current_input_index = 0;
+  };
+
+  for (GFieldRef field : output_fields) {
+    Stack<FieldWithIndex> fields_to_check;
+    fields_to_check.push({field, 0});
+    while (!fields_to_check.is_empty()) {
+      FieldWithIndex &field_with_index = fields_to_check.peek();
+      const GFieldRef &field = field_with_index.field;
+      if (index_by_field.contains(field)) {
+        fields_to_check.pop();
+        continue;
+      }
+      if (field.node().node_type() != FieldNodeType::Operation) {
+        /* Inputs and constants are handled above. */
+        BLI_assert_unreachable();
+        fields_to_check.pop();
+        continue;
+      }
+      const FieldOperation &operation_node = static_cast<const FieldOperation &>(field.node());
+      const Span<GField> operation_inputs = operation_node.inputs();
+      if (field_with_index.current_input_index < operation_inputs.size()) {
+        fields_to_check.push({operation_inputs[field_with_index.current_input_index]});
+        field_with_index.current_input_index++;
+        continue;
+      }
+      const mf::MultiFunction &multi_function = operation_node.multi_function();
+      data.append(multi_function.uid());
+      for (const GField &input_field : operation_inputs) {
+        data.append(index_by_field.lookup(input_field));
+      }
+      int output_index = 0;
+      for (const int param_index : multi_function.param_indices()) {
+        if (multi_function.param_type(param_index).interface_type() != mf::ParamType::Output) {
+          continue;
+        }
+        const GFieldRef output_field{operation_node, output_index};
+        output_index++;
+        const bool output_is_ignored =
+            field_tree_info.field_users.lookup(output_field).is_empty() &&
+            !output_fields.contains(output_field);
+        if (output_is_ignored) {
+          data.append(uint64_t(-1));
+        }
+        else {
+          const int index = index_by_field.size();
+          index_by_field.add_new(output_field, index);
+          data.append(index);
+        }
+      }
+    }
+  }
+
+  data.append(output_fields.size());
+  for (const GFieldRef &field : output_fields) {
+    data.append(index_by_field.lookup(field));
+  }
+
+  key.hash_value = get_default_hash(data.size());
+  for (const uint64_t value : data) {
+    key.hash_value = get_default_hash_2(key.hash_value, value);
+  }
+  return key;
+}
+
+/** A procedure together with its executor, built once and shared by all evaluations. */
+struct CachedFieldProcedure : NonCopyable, NonMovable {
+  mf::Procedure procedure;
+  std::unique_ptr<mf::ProcedureExecutor> executor;
+};
+
+/**
+ * Global cache of procedures built for field evaluation. Building and validating the procedure
+ * has a significant cost for field trees that are evaluated on small domains (e.g. for every
+ * instance or every curve), and node trees typically evaluate the same field trees over and over
+ * again. The cache is bounded, the least recently used entries are removed when it is full.
+ */
+class FieldProcedureCache {
+ private:
+  struct Entry {
+    std::shared_ptr<const CachedFieldProcedure> procedure;
+    uint64_t last_use = 0;
+  };
+
+  static constexpr int max_entries = 256;
+
+  std::mutex mutex_;
+  Map<FieldProcedureKey, Entry> entries_;
+  uint64_t use_counter_ = 0;
+
+ public:
+  std::shared_ptr<const CachedFieldProcedure> lookup(const FieldProcedureKey &key)
+  {
+    std::lock_guard lock{mutex_};
+    Entry *entry = entries_.lookup_ptr(key);
+    if (entry == nullptr) {
+      return {};
+    }
+    entry->last_use = ++use_counter_;
+    return entry->procedure;
+  }
+
+  void add(FieldProcedureKey key, std::shared_ptr<const CachedFieldProcedure> procedure)
+  {
+    std::lock_guard lock{mutex_};
+    if (entries_.size() >= max_entries && !entries_.contains(key)) {
+      /* Remove the least recently used entry. Procedures that are in use are kept alive by their
+       * users. */
+      const FieldProcedureKey *oldest_key = nullptr;
+      uint64_t oldest_use = UINT64_MAX;
+      for (const auto item : entries_.items()) {
+        if (item.value.last_use < oldest_use) {
+          oldest_use = item.value.last_use;
+          oldest_key = &item.key;
+        }
+      }
+      entries_.remove(*oldest_key);
+    }
+    entries_.add_overwrite(std::move(key), {std::move(procedure), ++use_counter_});
+  }
+};
+
+static FieldProcedureCache &get_field_procedure_cache()
+{
+  static FieldProcedureCache cache;
+  return cache;
+}
+
+/**
+ * Get a procedure that computes the given output fields, either from the cache or by building a
+ * new one.
+ */
+static std::shared_ptr<const CachedFieldProcedure> get_procedure_for_fields(
+    const FieldTreeInfo &field_tree_info, Span<GFieldRef> output_fields)
+{
+  FieldProcedureCache &cache = get_field_procedure_cache();
+  FieldProcedureKey key = build_field_procedure_key(field_tree_info, output_fields);
+  if (std::shared_ptr<const CachedFieldProcedure> procedure = cache.lookup(key)) {
+    return procedure;
+  }
+  auto new_procedure = std::make_shared<CachedFieldProcedure>();
+  build_multi_function_procedure_for_fields(
+      new_procedure->procedure, field_tree_info, output_fields);
+  new_procedure->executor = std::make_unique<mf::ProcedureExecutor>(new_procedure->procedure);
+  cache.add(std::move(key), new_procedure);
+  return new_procedure;
+}
+
 Vector<GVArray> evaluate_fields(ResourceScope &scope,
                                 Span<GFieldRef> fields_to_evaluate,
                                 const IndexMask &mask,
@@ -315,6 +522,12 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
   /* Get inputs that will be passed into the field when evaluated. */
   Vector<GVArray> field_context_inputs = get_field_context_inputs(
       scope, mask, context, field_tree_info.deduplicated_field_inputs);
+  /* Constants are passed into the procedures like inputs. */
+  Vector<GVArray> field_constant_inputs;
+  for (const FieldConstant *field_constant : field_tree_info.field_constants) {
+    field_constant_inputs.append(
+        GVArray::ForSingleRef(field_constant->type(), array_size, field_constant->value().get()));
+  }
 
   /* Finish fields that don't need any processing directly. */
   for (const int out_index : fields_to_evaluate.index_range()) {
@@ -367,11 +580,10 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
 
   /* Evaluate varying fields if necessary. */
   if (!varying_fields_to_evaluate.is_empty()) {
-    /* Build the procedure for those fields. */
-    mf::Procedure procedure;
-    build_multi_function_procedure_for_fields(
-        procedure, scope, field_tree_info, varying_fields_to_evaluate);
-    mf::ProcedureExecutor procedure_executor{procedure};
+    /* Get the procedure for those fields. */
+    const std::shared_ptr<const CachedFieldProcedure> procedure = get_procedure_for_fields(
+        field_tree_info, varying_fields_to_evaluate);
+    const mf::ProcedureExecutor &procedure_executor = *procedure->executor;
 
     mf::ParamsBuilder mf_params{procedure_executor, &mask};
     mf::ContextBuilder mf_context;
@@ -380,6 +592,9 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
     for (const GVArray &varray : field_context_inputs) {
       mf_params.add_readonly_single_input(varray);
     }
+    for (const GVArray &varray : field_constant_inputs) {
+      mf_params.add_readonly_single_input(varray);
+    }
 
     for (const int i : varying_fields_to_evaluate.index_range()) {
       const GFieldRef &field = varying_fields_to_evaluate[i];
@@ -419,11 +634,10 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
 
   /* Evaluate constant fields if necessary. */
   if (!constant_fields_to_evaluate.is_empty()) {
-    /* Build the procedure for those fields. */
-    mf::Procedure procedure;
-    build_multi_function_procedure_for_fields(
-        procedure, scope, field_tree_info, constant_fields_to_evaluate);
-    mf::ProcedureExecutor procedure_executor{procedure};
+    /* Get the procedure for those fields. */
+    const std::shared_ptr<const CachedFieldProcedure> procedure = get_procedure_for_fields(
+        field_tree_info, constant_fields_to_evaluate);
+    const mf::ProcedureExecutor &procedure_executor = *procedure->executor;
     const IndexMask mask(1);
     mf::ParamsBuilder mf_params{procedure_executor, &mask};
     mf::ContextBuilder mf_context;
@@ -432,6 +646,9 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
     for (const GVArray &varray : field_context_inputs) {
       mf_params.add_readonly_single_input(varray);
     }
+    for (const GVArray &varray : field_constant_inputs) {
+      mf_params.add_readonly_single_input(varray);
+    }
 
     for (const int i : constant_fields_to_evaluate.index_range()) {
       const GFieldRef &field = constant_fields_to_evaluate[i];
@@ -39,8 +39,17 @@
  * When all tasks are completed, the executor gives back control to the caller which may later
  * provide new inputs to the graph which in turn leads to new nodes being scheduled and the process
  * starts again.
+ *
+ * Scheduled nodes are kept in a per-task list and are executed inline by the thread that
+ * scheduled them. Work is only split off into a new task when the estimated cost of the scheduled
+ * nodes (based on the execution times measured in previous evaluations) is large enough to be
+ * worth the threading overhead. Nodes that are scheduled by the same notification (e.g. all
+ * targets of a computed output) are added to the task in one batch. In multi-threaded mode, the
+ * executor prefers nodes on the critical path of the graph, because other threads may be waiting
+ * for their results.
  */
 
+#include <chrono>
 #include <mutex>
 #include <sstream>
 
@@ -207,6 +216,12 @@ struct LockedNode {
    */
   Vector<const OutputSocket *> delayed_required_outputs;
   Vector<const OutputSocket *> delayed_unused_outputs;
+  /**
+   * The node itself if it has been scheduled while it was locked. It is added to the scheduled
+   * nodes of the current task once the node is unlocked, so that the task mutex is never locked
+   * while a node is locked.
+   */
+  std::optional<bool> delayed_schedule_is_priority;
 
   LockedNode(const Node &node, NodeState &node_state) : node(node), node_state(node_state) {}
 };
@@ -219,31 +234,90 @@ class GraphExecutorLFParams;
  * one thread at the same time.
  */
 struct ScheduledNodes {
+ public:
+  struct Item {
+    const FunctionNode *node;
+    /** See #GraphExecutor::node_critical_path_lengths_. */
+    int critical_path_length;
+    /** Estimated execution time in nanoseconds. */
+    int64_t cost;
+  };
+
  private:
   /** Use two stacks of scheduled nodes for different priorities. */
-  Vector<const FunctionNode *> priority_;
-  Vector<const FunctionNode *> normal_;
+  Vector<Item> priority_;
+  Vector<Item> normal_;
+  /** Sum of the estimated costs of all scheduled nodes. */
+  int64_t cost_ = 0;
+
+  /**
+   * Number of nodes at the top of the normal stack that are considered when looking for the node
+   * on the critical path. Only looking at the most recently scheduled nodes keeps the depth-first
+   * order mostly intact, which is good for cache and memory usage.
+   */
+  static constexpr int64_t critical_path_window = 16;
 
  public:
-  void schedule(const FunctionNode &node, const bool is_priority)
+  ScheduledNodes() = default;
+
+  ScheduledNodes(ScheduledNodes &&other) noexcept
+      : priority_(std::move(other.priority_)),
+        normal_(std::move(other.normal_)),
+        cost_(std::exchange(other.cost_, 0))
+  {
+  }
+
+  ScheduledNodes &operator=(ScheduledNodes &&other) noexcept
+  {
+    return move_assign_container(*this, std::move(other));
+  }
+
+  void schedule(const Item &item, const bool is_priority)
   {
     if (is_priority) {
-      this->priority_.append(&node);
+      this->priority_.append(item);
     }
     else {
-      this->normal_.append(&node);
+      this->normal_.append(item);
     }
+    cost_ += item.cost;
+  }
+
+  /**
+   * Move all nodes from the other group to this one.
+   */
+  void schedule_all(ScheduledNodes &&other)
+  {
+    priority_.extend(other.priority_);
+    normal_.extend(other.normal_);
+    cost_ += std::exchange(other.cost_, 0);
+    other.priority_.clear();
+    other.normal_.clear();
   }
 
-  const FunctionNode *pop_next_node()
+  /**
+   * \param prefer_critical_path: Execute nodes whose results are needed for a long chain of other
+   * nodes first. This is only useful when multiple threads are used, because otherwise the total
+   * amount of work stays the same.
+   */
+  const FunctionNode *pop_next_node(const bool prefer_critical_path)
   {
     if (!this->priority_.is_empty()) {
-      return this->priority_.pop_last();
+      return this->pop_item(priority_, priority_.size() - 1);
     }
-    if (!this->normal_.is_empty()) {
-      return this->normal_.pop_last();
+    if (this->normal_.is_empty()) {
+      return nullptr;
     }
-    return nullptr;
+    int64_t best_index = normal_.size() - 1;
+    if (prefer_critical_path) {
+      const int64_t window_start = std::max<int64_t>(0, normal_.size() - critical_path_window);
+      for (int64_t i = normal_.size() - 2; i >= window_start; i--) {
+        if (normal_[i].critical_path_length > normal_[best_index].critical_path_length) {
+          best_index = i;
+        }
+      }
+    }
+    return this->pop_item(normal_, best_index);
   }
 
   bool is_empty() const
@@ -256,6 +330,11 @@ struct ScheduledNodes {
     return priority_.size() + normal_.size();
   }
 
+  int64_t cost() const
+  {
+    return cost_;
+  }
+
   /**
    * Split up the scheduled nodes into two groups that can be worked on in parallel.
    */
@@ -268,6 +347,29 @@ struct ScheduledNodes {
     other.normal_.extend(normal_.as_span().drop_front(normal_split));
     priority_.resize(priority_split);
     normal_.resize(normal_split);
+    cost_ = 0;
+    other.cost_ = 0;
+    for (const Item &item : priority_) {
+      cost_ += item.cost;
+    }
+    for (const Item &item : normal_) {
+      cost_ += item.cost;
+    }
+    for (const Item &item : other.priority_) {
+      other.cost_ += item.cost;
+    }
+    for (const Item &item : other.normal_) {
+      other.cost_ += item.cost;
+    }
+  }
+
+ private:
+  const FunctionNode *pop_item(Vector<Item> &items, const int64_t index)
+  {
+    const Item item = items[index];
+    items.remove(index);
+    cost_ -= item.cost;
+    return item.node;
   }
 };
 
@@ -289,6 +391,14 @@ struct CurrentTask {
 
 class Executor {
  private:
+  /** Assumed execution time of nodes that have not been executed before, in nanoseconds. */
+  static constexpr int64_t default_cost = 1000;
+  /**
+   * Scheduled nodes are only split up into a separate task if they are expected to take longer
+   * than this in total (in nanoseconds).
+   */
+  static constexpr int64_t min_split_cost = 128 * default_cost;
+
   const GraphExecutor &self_;
   /**
    * Remembers which inputs have been loaded from the caller already, to avoid loading them twice.
@@ -628,7 +738,7 @@ class Executor {
       NodeState &node_state = *node_states_[node->index_in_graph()];
       this->with_locked_node(
           *node, node_state, current_task, local_data, [&](LockedNode &locked_node) {
-            this->schedule_node(locked_node, current_task, false);
+            this->schedule_node(locked_node, false);
           });
     }
   }
@@ -700,7 +810,7 @@ class Executor {
             return;
           }
           output_state.usage = ValueUsage::Used;
-          this->schedule_node(locked_node, current_task, false);
+          this->schedule_node(locked_node, false);
         });
   }
 
@@ -728,28 +838,21 @@ class Executor {
               else {
                 /* Schedule as priority node. This allows freeing up memory earlier which results
                  * in better memory reuse and less copy-on-write copies caused by shared data. */
-                this->schedule_node(locked_node, current_task, true);
+                this->schedule_node(locked_node, true);
               }
             }
           }
         });
   }
 
-  void schedule_node(LockedNode &locked_node, CurrentTask &current_task, const bool is_priority)
+  void schedule_node(LockedNode &locked_node, const bool is_priority)
   {
     BLI_assert(locked_node.node.is_function());
     switch (locked_node.node_state.schedule_state) {
       case NodeScheduleState::NotScheduled: {
         locked_node.node_state.schedule_state = NodeScheduleState::Scheduled;
-        const FunctionNode &node = static_cast<const FunctionNode &>(locked_node.node);
-        if (this->use_multi_threading()) {
-          std::lock_guard lock{current_task.mutex};
-          current_task.scheduled_nodes.schedule(node, is_priority);
-        }
-        else {
-          current_task.scheduled_nodes.schedule(node, is_priority);
-        }
-        current_task.has_scheduled_nodes.store(true, std::memory_order_relaxed);
+        /* The node is added to the current task once it is unlocked again. */
+        locked_node.delayed_schedule_is_priority = is_priority;
         break;
       }
       case NodeScheduleState::Scheduled: {
@@ -765,11 +868,52 @@ class Executor {
     }
   }
 
+  ScheduledNodes::Item get_schedule_item(const FunctionNode &node) const
+  {
+    const int node_index = node.index_in_graph();
+    const int64_t cost = self_.node_cost_estimates_[node_index].load(std::memory_order_relaxed);
+    return {&node, self_.node_critical_path_lengths_[node_index], cost > 0 ? cost : default_cost};
+  }
+
+  void add_to_current_task(CurrentTask &current_task,
+                           const ScheduledNodes::Item &item,
+                           const bool is_priority)
+  {
+    if (this->use_multi_threading()) {
+      std::lock_guard lock{current_task.mutex};
+      current_task.scheduled_nodes.schedule(item, is_priority);
+    }
+    else {
+      current_task.scheduled_nodes.schedule(item, is_priority);
+    }
+    current_task.has_scheduled_nodes.store(true, std::memory_order_relaxed);
+  }
+
+  void add_to_current_task(CurrentTask &current_task, ScheduledNodes &&scheduled_nodes)
+  {
+    if (scheduled_nodes.is_empty()) {
+      return;
+    }
+    if (this->use_multi_threading()) {
+      std::lock_guard lock{current_task.mutex};
+      current_task.scheduled_nodes.schedule_all(std::move(scheduled_nodes));
+    }
+    else {
+      current_task.scheduled_nodes.schedule_all(std::move(scheduled_nodes));
+    }
+    current_task.has_scheduled_nodes.store(true, std::memory_order_relaxed);
+  }
+
+  /**
+   * \param schedule_batch: If provided, the node is added to this batch instead of the current
+   * task when it is scheduled. This allows scheduling many nodes while locking the task only once.
+   */
   void with_locked_node(const Node &node,
                         NodeState &node_state,
                         CurrentTask &current_task,
                         const LocalData &local_data,
-                        const FunctionRef<void(LockedNode &)> f)
+                        const FunctionRef<void(LockedNode &)> f,
+                        ScheduledNodes *schedule_batch = nullptr)
   {
     BLI_assert(&node_state == node_states_[node.index_in_graph()]);
 
@@ -782,6 +926,18 @@ class Executor {
       f(locked_node);
     }
 
+    if (locked_node.delayed_schedule_is_priority.has_value()) {
+      const ScheduledNodes::Item item = this->get_schedule_item(
+          static_cast<const FunctionNode &>(node));
+      const bool is_priority = *locked_node.delayed_schedule_is_priority;
+      if (schedule_batch) {
+        schedule_batch->schedule(item, is_priority);
+      }
+      else {
+        this->add_to_current_task(current_task, item, is_priority);
+      }
+    }
+
     this->send_output_required_notifications(
         locked_node.delayed_required_outputs, current_task, local_data);
     this->send_output_unused_notifications(
@@ -808,15 +964,20 @@ class Executor {
 
   void run_task(CurrentTask &current_task, const LocalData &local_data)
   {
-    while (const FunctionNode *node = current_task.scheduled_nodes.pop_next_node()) {
+    while (const FunctionNode *node = current_task.scheduled_nodes.pop_next_node(
+               this->use_multi_threading()))
+    {
       if (current_task.scheduled_nodes.is_empty()) {
         current_task.has_scheduled_nodes.store(false, std::memory_order_relaxed);
       }
       this->run_node_task(*node, current_task, local_data);
 
-      /* If there are many nodes scheduled at the same time, it's beneficial to let multiple
-       * threads work on those. */
-      if (current_task.scheduled_nodes.nodes_num() > 128) {
+      /* If the scheduled nodes take long enough to compute, it's beneficial to let multiple
+       * threads work on those. Cheap nodes are executed inline, because distributing them would
+       * cost more than it gains. */
+      if (current_task.scheduled_nodes.nodes_num() >= 2 &&
+          current_task.scheduled_nodes.cost() > min_split_cost)
+      {
         if (this->try_enable_multi_threading()) {
           std::unique_ptr<ScheduledNodes> split_nodes = std::make_unique<ScheduledNodes>();
           current_task.scheduled_nodes.split_into(*split_nodes);
@@ -937,7 +1098,7 @@ class Executor {
                                             NodeScheduleState::RunningAndRescheduled;
           node_state.schedule_state = NodeScheduleState::NotScheduled;
           if (reschedule_requested && !node_state.node_has_finished) {
-            this->schedule_node(locked_node, current_task, false);
+            this->schedule_node(locked_node, false);
           }
         });
   }
@@ -1121,6 +1282,9 @@ class Executor {
       self_.logger_->log_socket_value(from_socket, value_to_forward, local_context);
     }
 
+    /* Nodes that become ready are collected and added to the current task at once. */
+    ScheduledNodes ready_nodes;
+
     const Span<const InputSocket *> targets = from_socket.targets();
     for (const InputSocket *target_socket : targets) {
       const Node &target_node = target_socket->node();
@@ -1162,32 +1326,36 @@ class Executor {
         continue;
       }
       this->with_locked_node(
-          target_node, node_state, current_task, local_data, [&](LockedNode &locked_node) {
+          target_node,
+          node_state,
+          current_task,
+          local_data,
+          [&](LockedNode &locked_node) {
             if (input_state.usage == ValueUsage::Unused) {
               return;
             }
             if (is_last_target) {
               /* No need to make a copy if this is the last target. */
-              this->forward_value_to_input(
-                  locked_node, input_state, value_to_forward, current_task);
+              this->forward_value_to_input(locked_node, input_state, value_to_forward);
               value_to_forward = {};
             }
             else {
               void *buffer = local_data.allocator->allocate(type.size(), type.alignment());
               type.copy_construct(value_to_forward.get(), buffer);
-              this->forward_value_to_input(locked_node, input_state, {type, buffer}, current_task);
+              this->forward_value_to_input(locked_node, input_state, {type, buffer});
             }
-          });
+          },
+          &ready_nodes);
     }
     if (value_to_forward.get() != nullptr) {
       value_to_forward.destruct();
     }
+    this->add_to_current_task(current_task, std::move(ready_nodes));
   }
 
   void forward_value_to_input(LockedNode &locked_node,
                               InputState &input_state,
-                              GMutablePointer value,
-                              CurrentTask &current_task)
+                              GMutablePointer value)
   {
     NodeState &node_state = locked_node.node_state;
 
@@ -1202,7 +1370,7 @@ class Executor {
                                                  .function()
                                                  .allow_missing_requested_inputs()))
       {
-        this->schedule_node(locked_node, current_task, false);
+        this->schedule_node(locked_node, false);
       }
     }
   }
@@ -1243,6 +1411,14 @@ class Executor {
     return true;
   }
 
+  void update_cost_estimate(const FunctionNode &node, const int64_t duration)
+  {
+    std::atomic<int64_t> &estimate = self_.node_cost_estimates_[node.index_in_graph()];
+    const int64_t old_estimate = estimate.load(std::memory_order_relaxed);
+    const int64_t new_estimate = old_estimate == 0 ? duration : (old_estimate * 3 + duration) / 4;
+    estimate.store(std::max<int64_t>(new_estimate, 1), std::memory_order_relaxed);
+  }
+
   void ensure_thread_locals()
   {
 #ifdef FN_LAZY_FUNCTION_DEBUG_THREADS
@@ -1448,18 +1624,72 @@ inline void Executor::execute_node(const FunctionNode &node,
   };
 
   lazy_threading::HintReceiver blocking_hint_receiver{blocking_hint_fn};
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
   if (self_.node_execute_wrapper_) {
     self_.node_execute_wrapper_->execute_node(node, node_params, fn_context);
   }
   else {
     fn.execute(node_params, fn_context);
   }
+  const std::chrono::steady_clock::time_point end_time = std::chrono::steady_clock::now();
+  this->update_cost_estimate(node, (end_time - start_time).count());
 
   if (self_.logger_ != nullptr) {
     self_.logger_->log_after_node_execute(node, node_params, fn_context);
   }
 }
 
+/**
+ * Find the number of function nodes on the longest path from every node to the graph outputs.
+ * Links that would close a cycle are ignored.
+ */
+static Array<int> compute_critical_path_lengths(const Graph &graph)
+{
+  const Span<const Node *> nodes = graph.nodes();
+  Array<int> lengths(nodes.size(), -1);
+  /* Nodes on the current path of the depth-first search. */
+  Array<bool> in_progress(nodes.size(), false);
+  /* Use an explicit stack, because graphs can be very deep. */
+  Vector<const Node *> stack;
+  for (const Node *start_node : nodes) {
+    stack.append(start_node);
+    while (!stack.is_empty()) {
+      const Node &node = *stack.last();
+      const int node_index = node.index_in_graph();
+      if (lengths[node_index] != -1) {
+        /* The node was added to the stack more than once. */
+        stack.pop_last();
+        continue;
+      }
+      in_progress[node_index] = true;
+      bool has_unprocessed_target = false;
+      int max_target_length = 0;
+      for (const OutputSocket *output_socket : node.outputs()) {
+        for (const InputSocket *target_socket : output_socket->targets()) {
+          const Node &target_node = target_socket->node();
+          const int target_index = target_node.index_in_graph();
+          if (in_progress[target_index]) {
+            continue;
+          }
+          if (lengths[target_index] == -1) {
+            stack.append(&target_node);
+            has_unprocessed_target = true;
+            continue;
+          }
+          max_target_length = std::max(max_target_length, lengths[target_index]);
+        }
+      }
+      if (has_unprocessed_target) {
+        continue;
+      }
+      lengths[node_index] = max_target_length + (node.is_function() ? 1 : 0);
+      in_progress[node_index] = false;
+      stack.pop_last();
+    }
+  }
+  return lengths;
+}
+
 GraphExecutor::GraphExecutor(const Graph &graph,
                              Vector<const GraphInputSocket *> graph_inputs,
                              Vector<const GraphOutputSocket *> graph_outputs,
@@ -1515,6 +1745,12 @@ GraphExecutor::GraphExecutor(const Graph &graph,
   }
 
   init_buffer_info_.total_size = offset;
+
+  node_critical_path_lengths_ = compute_critical_path_lengths(graph_);
+  node_cost_estimates_ = std::make_unique<std::atomic<int64_t>[]>(nodes.size());
+  for (const int i : nodes.index_range()) {
+    node_cost_estimates_[i].store(0, std::memory_order_relaxed);
+  }
 }
 
 void GraphExecutor::execute_impl(Params &params, const Context &context) const
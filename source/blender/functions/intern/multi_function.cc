@@ -4,6 +4,8 @@
 
 #include "FN_multi_function.hh"
 
+#include <atomic>
+
 #include "BLI_task.hh"
 #include "BLI_threads.h"
 
@@ -11,6 +13,12 @@ namespace blender::fn::multi_function {
 
 using ExecutionHints = MultiFunction::ExecutionHints;
 
+MultiFunction::MultiFunction()
+{
+  static std::atomic<uint64_t> next_uid = 0;
+  uid_ = next_uid.fetch_add(1, std::memory_order_relaxed);
+}
+
 ExecutionHints MultiFunction::execution_hints() const
 {
   return this->get_execution_hints();
@@ -65,10 +73,10 @@ static int64_t compute_alignment(const int64_t grain_size)
   return 32;
 }
 
-static void add_sliced_parameters(const Signature &signature,
-                                  Params &full_params,
-                                  const IndexRange slice_range,
-                                  ParamsBuilder &r_sliced_params)
+void add_sliced_parameters(const Signature &signature,
+                           Params &full_params,
+                           const IndexRange slice_range,
+                           ParamsBuilder &r_sliced_params)
 {
   for (const int param_index : signature.params.index_range()) {
     const ParamType &param_type = signature.params[param_index].type;
@@ -4,19 +4,65 @@
 
 #include "FN_multi_function_procedure_executor.hh"
 
+#include "BLI_math_base.h"
+#include "BLI_set.hh"
 #include "BLI_stack.hh"
 
 namespace blender::fn::multi_function {
 
-ProcedureExecutor::ProcedureExecutor(const Procedure &procedure) : procedure_(procedure)
+/**
+ * Find a chunk size so that the buffers for all intermediate variables of one chunk fit into the
+ * L2 cache of a typical CPU. Only approximate, because not all variables are alive at the same
+ * time and some are not stored as spans.
+ */
+static int64_t compute_chunk_size(const Procedure &procedure)
+{
+  const int64_t target_chunk_bytes = 256 * 1024;
+  const int64_t min_chunk_size = 512;
+  const int64_t max_chunk_size = 16384;
+
+  Set<const Variable *> param_variables;
+  for (const ConstParameter &param : procedure.params()) {
+    param_variables.add(param.variable);
+  }
+  int64_t bytes_per_index = 0;
+  for (const Variable *variable : procedure.variables()) {
+    if (param_variables.contains(variable)) {
+      /* Parameters are stored in memory provided by the caller. */
+      continue;
+    }
+    const DataType data_type = variable->data_type();
+    if (data_type.is_single()) {
+      bytes_per_index += data_type.single_type().size();
+    }
+    else {
+      /* Rough estimate for vectors which have a variable size. */
+      bytes_per_index += 4 * data_type.vector_base_type().size();
+    }
+  }
+  if (bytes_per_index == 0) {
+    return max_chunk_size;
+  }
+  return std::clamp(target_chunk_bytes / bytes_per_index, min_chunk_size, max_chunk_size);
+}
+
+ProcedureExecutor::ProcedureExecutor(const Procedure &procedure, const bool use_chunked_execution)
+    : procedure_(procedure)
 {
   SignatureBuilder builder("Procedure Executor", signature_);
 
+  bool has_vector_params = false;
   for (const ConstParameter &param : procedure.params()) {
     builder.add("Parameter", ParamType(param.type, param.variable->data_type()));
+    has_vector_params |= param.variable->data_type().is_vector();
   }
 
   this->set_signature(&signature_);
+
+  /* Vector parameters can't be sliced. */
+  if (use_chunked_execution && !has_vector_params) {
+    chunk_size_ = compute_chunk_size(procedure);
+  }
 }
 
 using IndicesSplitVectors = std::array<Vector<int64_t>, 2>;
@@ -129,6 +175,12 @@ class ValueAllocator : NonCopyable, NonMovable {
   /** All buffers in the free-lists below have been allocated with this allocator. */
   LinearAllocator<> &linear_allocator_;
 
+  /**
+   * Span buffers are allocated with at least this many elements. This allows reusing buffers
+   * when the same allocator is used for multiple masks of different sizes.
+   */
+  int64_t min_span_size_ = 0;
+
   /**
    * Use stacks so that the most recently used buffers are reused first. This improves cache
    * efficiency.
@@ -151,6 +203,14 @@ class ValueAllocator : NonCopyable, NonMovable {
  public:
   ValueAllocator(LinearAllocator<> &linear_allocator) : linear_allocator_(linear_allocator) {}
 
+  void set_min_span_size(const int64_t size)
+  {
+    /* Buffers that have been allocated before may be too small. */
+    BLI_assert(small_span_buffers_free_list_.is_empty());
+    BLI_assert(span_buffers_free_lists_.is_empty());
+    min_span_size_ = size;
+  }
+
   VariableValue_GVArray *obtain_GVArray(const GVArray &varray)
   {
     return this->obtain<VariableValue_GVArray>(varray);
@@ -166,8 +226,10 @@ class ValueAllocator : NonCopyable, NonMovable {
     return this->obtain<VariableValue_Span>(buffer, false);
   }
 
-  VariableValue_Span *obtain_Span(const CPPType &type, int size)
+  VariableValue_Span *obtain_Span(const CPPType &type, int64_t size)
   {
+    BLI_assert(min_span_size_ == 0 || size <= min_span_size_);
+    size = std::max(size, min_span_size_);
     void *buffer = nullptr;
 
     const int64_t element_size = type.size();
@@ -813,17 +875,17 @@ class VariableState : NonCopyable, NonMovable {
 /** Keeps track of the states of all variables during evaluation. */
 class VariableStates {
  private:
-  ValueAllocator value_allocator_;
+  ValueAllocator &value_allocator_;
   const Procedure &procedure_;
   /** The state of every variable, indexed by #Variable::index_in_procedure(). */
   Array<VariableState> variable_states_;
   const IndexMask &full_mask_;
 
  public:
-  VariableStates(LinearAllocator<> &linear_allocator,
+  VariableStates(ValueAllocator &value_allocator,
                  const Procedure &procedure,
                  const IndexMask &full_mask)
-      : value_allocator_(linear_allocator),
+      : value_allocator_(value_allocator),
         procedure_(procedure),
         variable_states_(procedure.variables().size()),
         full_mask_(full_mask)
@@ -1157,19 +1219,18 @@ class InstructionScheduler {
   }
 };
 
-void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context context) const
+static void execute_procedure(const ProcedureExecutor &fn,
+                              const Procedure &procedure,
+                              const IndexMask &full_mask,
+                              Params params,
+                              Context context,
+                              ValueAllocator &value_allocator)
 {
-  BLI_assert(procedure_.validate());
-
-  AlignedBuffer<512, 64> local_buffer;
-  LinearAllocator<> linear_allocator;
-  linear_allocator.provide_buffer(local_buffer);
-
-  VariableStates variable_states{linear_allocator, procedure_, full_mask};
-  variable_states.add_initial_variable_states(*this, procedure_, params);
+  VariableStates variable_states{value_allocator, procedure, full_mask};
+  variable_states.add_initial_variable_states(fn, procedure, params);
 
   InstructionScheduler scheduler;
-  scheduler.add_referenced_indices(*procedure_.entry(), full_mask);
+  scheduler.add_referenced_indices(*procedure.entry(), full_mask);
 
   /* Loop until all indices got to a return instruction. */
   while (!scheduler.is_done()) {
@@ -1218,9 +1279,9 @@ void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context
     }
   }
 
-  for (const int param_index : this->param_indices()) {
-    const ParamType param_type = this->param_type(param_index);
-    const Variable *variable = procedure_.params()[param_index].variable;
+  for (const int param_index : fn.param_indices()) {
+    const ParamType param_type = fn.param_type(param_index);
+    const Variable *variable = procedure.params()[param_index].variable;
     VariableState &variable_state = variable_states.get_variable_state(*variable);
     switch (param_type.interface_type()) {
       case ParamType::Input: {
@@ -1241,6 +1302,53 @@ void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context
   }
 }
 
+void ProcedureExecutor::call(const IndexMask &full_mask, Params params, Context context) const
+{
+  BLI_assert(procedure_.validate());
+
+  AlignedBuffer<512, 64> local_buffer;
+  LinearAllocator<> linear_allocator;
+  linear_allocator.provide_buffer(local_buffer);
+  ValueAllocator value_allocator{linear_allocator};
+
+  if (chunk_size_ == 0 || full_mask.size() <= chunk_size_ * 2) {
+    execute_procedure(*this, procedure_, full_mask, params, context, value_allocator);
+    return;
+  }
+
+  /* Execute the whole procedure for one chunk after the other. The intermediate buffers are
+   * reused for every chunk, so they are likely still in the cache when the next instruction
+   * accesses them. */
+  const int64_t chunks_num = divide_ceil_ul(full_mask.size(), chunk_size_);
+  auto get_chunk = [&](const int64_t chunk_i) {
+    const int64_t start = chunk_i * chunk_size_;
+    return IndexRange(start, std::min(chunk_size_, full_mask.size() - start));
+  };
+  auto get_chunk_array_range = [&](const IndexRange chunk) {
+    const int64_t first = full_mask[chunk.first()];
+    return IndexRange(first, full_mask[chunk.last()] - first + 1);
+  };
+
+  /* Buffers are reused between chunks, so they have to be large enough for all of them. This is
+   * only different from the chunk size if the mask is not a range. */
+  int64_t max_array_size = 0;
+  for (const int64_t chunk_i : IndexRange(chunks_num)) {
+    max_array_size = std::max(max_array_size, get_chunk_array_range(get_chunk(chunk_i)).size());
+  }
+  value_allocator.set_min_span_size(max_array_size);
+
+  for (const int64_t chunk_i : IndexRange(chunks_num)) {
+    const IndexRange chunk = get_chunk(chunk_i);
+    const IndexRange array_range = get_chunk_array_range(chunk);
+
+    IndexMaskMemory memory;
+    const IndexMask chunk_mask = full_mask.slice_and_offset(chunk, -array_range.start(), memory);
+    ParamsBuilder chunk_params{*this, &chunk_mask};
+    add_sliced_parameters(signature_, params, array_range, chunk_params);
+    execute_procedure(*this, procedure_, chunk_mask, chunk_params, context, value_allocator);
+  }
+}
+
 MultiFunction::ExecutionHints ProcedureExecutor::get_execution_hints() const
 {
   ExecutionHints hints;
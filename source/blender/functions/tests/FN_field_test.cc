@@ -281,4 +281,24 @@ TEST(field, IgnoredOutput)
   EXPECT_EQ(results.get(3), 5);
 }
 
+TEST(field, RebuiltTreeWithDifferentConstants)
+{
+  /* The procedure built for the first tree is reused for the second one, which has the same
+   * structure. The constants must not be baked into the procedure. */
+  auto add_fn = mf::build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+  for (const int value : {3, 7}) {
+    GField index_field{std::make_shared<IndexFieldInput>()};
+    GField output_field{
+        FieldOperation::Create(add_fn, {index_field, make_constant_field<int>(value)}), 0};
+
+    Array<int> result(4);
+    FieldContext context;
+    FieldEvaluator evaluator{context, 4};
+    evaluator.add_with_destination(output_field, result.as_mutable_span());
+    evaluator.evaluate();
+    EXPECT_EQ(result[0], value);
+    EXPECT_EQ(result[3], value + 3);
+  }
+}
+
 }  // namespace blender::fn::tests
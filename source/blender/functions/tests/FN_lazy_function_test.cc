@@ -8,6 +8,7 @@
 #include "FN_lazy_function_graph.hh"
 #include "FN_lazy_function_graph_executor.hh"
 
+#include "BLI_array_utils.hh"
 #include "BLI_task.h"
 #include "BLI_timeit.hh"
 
@@ -179,4 +180,145 @@ TEST(lazy_function, GraphWithCycle)
   EXPECT_EQ(result, 10 * 2 * 5);
 }
 
+/**
+ * Add a balanced tree of add nodes that computes the sum of all the given sockets.
+ */
+static OutputSocket &add_sum_tree(Graph &graph,
+                                  const LazyFunction &add_fn,
+                                  Vector<OutputSocket *> sockets)
+{
+  while (sockets.size() > 1) {
+    Vector<OutputSocket *> new_sockets;
+    for (int64_t i = 0; i + 1 < sockets.size(); i += 2) {
+      FunctionNode &node = graph.add_function(add_fn);
+      graph.add_link(*sockets[i], node.input(0));
+      graph.add_link(*sockets[i + 1], node.input(1));
+      new_sockets.append(&node.output(0));
+    }
+    if (sockets.size() % 2 == 1) {
+      new_sockets.append(sockets.last());
+    }
+    sockets = std::move(new_sockets);
+  }
+  return *sockets[0];
+}
+
+/** Graph with a node for every value that adds it to the input, and a sum of all their results. */
+static void build_wide_graph(Graph &graph, const LazyFunction &add_fn, const Span<int> values)
+{
+  GraphInputSocket &input_socket = graph.add_input(CPPType::get<int>());
+  GraphOutputSocket &output_socket = graph.add_output(CPPType::get<int>());
+
+  Vector<OutputSocket *> sockets;
+  for (const int &value : values) {
+    FunctionNode &node = graph.add_function(add_fn);
+    graph.add_link(input_socket, node.input(0));
+    node.input(1).set_default_value(&value);
+    sockets.append(&node.output(0));
+  }
+  graph.add_link(add_sum_tree(graph, add_fn, std::move(sockets)), output_socket);
+  graph.update_node_indices();
+}
+
+/** Graph with a chain of nodes that each add the value to the input. */
+static void build_deep_graph(Graph &graph,
+                             const LazyFunction &add_fn,
+                             const int nodes_num,
+                             const int &value)
+{
+  GraphInputSocket &input_socket = graph.add_input(CPPType::get<int>());
+  GraphOutputSocket &output_socket = graph.add_output(CPPType::get<int>());
+
+  OutputSocket *socket = &input_socket;
+  for ([[maybe_unused]] const int i : IndexRange(nodes_num)) {
+    FunctionNode &node = graph.add_function(add_fn);
+    graph.add_link(*socket, node.input(0));
+    node.input(1).set_default_value(&value);
+    socket = &node.output(0);
+  }
+  graph.add_link(*socket, output_socket);
+  graph.update_node_indices();
+}
+
+static int execute_graph(const GraphExecutor &executor_fn, const int input)
+{
+  int result = 0;
+  execute_lazy_function_eagerly(
+      executor_fn, nullptr, nullptr, std::make_tuple(input), std::make_tuple(&result));
+  return result;
+}
+
+TEST(lazy_function, WideGraph)
+{
+  BLI_task_scheduler_init();
+  const AddLazyFunction add_fn;
+  const int nodes_num = 10000;
+  Array<int> values(nodes_num);
+  array_utils::fill_index_range<int>(values);
+
+  Graph graph;
+  build_wide_graph(graph, add_fn, values);
+  GraphExecutor executor_fn{
+      graph, {graph.graph_inputs()[0]}, {graph.graph_outputs()[0]}, nullptr, nullptr, nullptr};
+  /* Execute multiple times, because the executor learns how expensive the nodes are. */
+  for ([[maybe_unused]] const int iteration : IndexRange(3)) {
+    EXPECT_EQ(execute_graph(executor_fn, 3), nodes_num * 3 + nodes_num * (nodes_num - 1) / 2);
+  }
+}
+
+TEST(lazy_function, DeepGraph)
+{
+  BLI_task_scheduler_init();
+  const AddLazyFunction add_fn;
+  const int nodes_num = 10000;
+  const int value_1 = 1;
+
+  Graph graph;
+  build_deep_graph(graph, add_fn, nodes_num, value_1);
+  GraphExecutor executor_fn{
+      graph, {graph.graph_inputs()[0]}, {graph.graph_outputs()[0]}, nullptr, nullptr, nullptr};
+  for ([[maybe_unused]] const int iteration : IndexRange(3)) {
+    EXPECT_EQ(execute_graph(executor_fn, 5), 5 + nodes_num);
+  }
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it prints timings
+ * to compare different scheduling strategies of the graph executor.
+ */
+#if 0
+TEST(lazy_function_benchmark, WideGraph)
+{
+  BLI_task_scheduler_init();
+  const AddLazyFunction add_fn;
+  Array<int> values(100000);
+  array_utils::fill_index_range<int>(values);
+
+  Graph graph;
+  build_wide_graph(graph, add_fn, values);
+  GraphExecutor executor_fn{
+      graph, {graph.graph_inputs()[0]}, {graph.graph_outputs()[0]}, nullptr, nullptr, nullptr};
+  for ([[maybe_unused]] const int iteration : IndexRange(5)) {
+    SCOPED_TIMER("Wide graph");
+    execute_graph(executor_fn, 3);
+  }
+}
+
+TEST(lazy_function_benchmark, DeepGraph)
+{
+  BLI_task_scheduler_init();
+  const AddLazyFunction add_fn;
+  const int value_1 = 1;
+
+  Graph graph;
+  build_deep_graph(graph, add_fn, 100000, value_1);
+  GraphExecutor executor_fn{
+      graph, {graph.graph_inputs()[0]}, {graph.graph_outputs()[0]}, nullptr, nullptr, nullptr};
+  for ([[maybe_unused]] const int iteration : IndexRange(5)) {
+    SCOPED_TIMER("Deep graph");
+    execute_graph(executor_fn, 5);
+  }
+}
+#endif
+
 }  // namespace blender::fn::lazy_function::tests
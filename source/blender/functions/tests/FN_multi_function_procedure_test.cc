@@ -4,6 +4,8 @@
 
 #include "testing/testing.h"
 
+#include "BLI_timeit.hh"
+
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_procedure_builder.hh"
 #include "FN_multi_function_procedure_executor.hh"
@@ -423,4 +425,115 @@ TEST(multi_function_procedure, OutputBufferReplaced)
   EXPECT_EQ(output[2], output_value);
 }
 
+/**
+ * math_chain(float a, float b, float *out) {
+ *   float c = a * b;
+ *   float d = c + a;
+ *   out = d * d;
+ * }
+ */
+static void build_math_chain_procedure(Procedure &procedure)
+{
+  static auto mul_fn = build::SI2_SO<float, float, float>("mul",
+                                                          [](float a, float b) { return a * b; });
+  static auto add_fn = build::SI2_SO<float, float, float>("add",
+                                                          [](float a, float b) { return a + b; });
+
+  ProcedureBuilder builder{procedure};
+  Variable *var_a = &builder.add_single_input_parameter<float>();
+  Variable *var_b = &builder.add_single_input_parameter<float>();
+  auto [var_c] = builder.add_call<1>(mul_fn, {var_a, var_b});
+  builder.add_destruct(*var_b);
+  auto [var_d] = builder.add_call<1>(add_fn, {var_c, var_a});
+  builder.add_destruct({var_a, var_c});
+  auto [var_out] = builder.add_call<1>(mul_fn, {var_d, var_d});
+  builder.add_destruct(*var_d);
+  builder.add_return();
+  builder.add_output_parameter(*var_out);
+}
+
+static void call_math_chain(const ProcedureExecutor &procedure_fn,
+                            const IndexMask &mask,
+                            const Span<float> a,
+                            const Span<float> b,
+                            MutableSpan<float> result)
+{
+  ParamsBuilder params{procedure_fn, &mask};
+  params.add_readonly_single_input(a);
+  params.add_readonly_single_input(b);
+  params.add_uninitialized_single_output(result);
+  ContextBuilder context;
+  procedure_fn.call(mask, params, context);
+}
+
+TEST(multi_function_procedure, ChunkedExecution)
+{
+  Procedure procedure;
+  build_math_chain_procedure(procedure);
+  EXPECT_TRUE(procedure.validate());
+
+  ProcedureExecutor chunked_fn{procedure, true};
+  ProcedureExecutor full_fn{procedure, false};
+
+  const int size = 100000;
+  Array<float> a(size);
+  Array<float> b(size);
+  for (const int i : IndexRange(size)) {
+    a[i] = float(i % 100) * 0.25f;
+    b[i] = float(i % 7) - 3.0f;
+  }
+
+  IndexMaskMemory memory;
+  /* Use a mask with a gap and varying density so that the chunks span index ranges of different
+   * sizes. */
+  const IndexMask mask = IndexMask::from_predicate(
+      IndexRange(size), GrainSize(4096), memory, [](const int64_t i) {
+        return (i < 20000 && i % 3 == 0) || (i >= 50000 && i % 5 != 0);
+      });
+
+  Array<float> chunked_result(size, -1.0f);
+  Array<float> full_result(size, -1.0f);
+  call_math_chain(chunked_fn, mask, a, b, chunked_result);
+  call_math_chain(full_fn, mask, a, b, full_result);
+
+  for (const int i : IndexRange(size)) {
+    EXPECT_EQ(chunked_result[i], full_result[i]);
+  }
+  EXPECT_EQ(chunked_result[1], -1.0f);
+  EXPECT_EQ(chunked_result[3], (a[3] * b[3] + a[3]) * (a[3] * b[3] + a[3]));
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it takes a while.
+ */
+#if 0
+TEST(multi_function_procedure, ChunkedExecutionBenchmark)
+{
+  Procedure procedure;
+  build_math_chain_procedure(procedure);
+  const int size = 10'000'000;
+  Array<float> a(size, 0.5f);
+  Array<float> b(size, 2.0f);
+  Array<float> result(size);
+  const IndexMask mask(size);
+
+  /* Inputs and output are accessed once, everything else should stay in the cache. */
+  const double min_bytes = double(size) * sizeof(float) * 3;
+
+  for (const bool use_chunks : {false, true}) {
+    ProcedureExecutor procedure_fn{procedure, use_chunks};
+    for ([[maybe_unused]] const int iteration : IndexRange(5)) {
+      const timeit::TimePoint start = timeit::Clock::now();
+      call_math_chain(procedure_fn, mask, a, b, result);
+      const timeit::Nanoseconds duration = timeit::Clock::now() - start;
+      const double seconds = std::chrono::duration<double>(duration).count();
+      std::cout << (use_chunks ? "Chunked: " : "Full:    ") << seconds * 1000.0 << " ms, "
+                << min_bytes / seconds / 1e9 << " GB/s\n";
+    }
+  }
+  /* Print a value to avoid some compiler optimizations. */
+  std::cout << "Result: " << result[size / 2] << "\n";
+}
+#endif
+
 }  // namespace blender::fn::multi_function::tests
@@ -4,10 +4,37 @@
 
 #pragma once
 
+#include <memory>
+
+#include "BLI_utility_mixins.hh"
+
 #include "BKE_geometry_set.hh"
 
 namespace blender::geometry {
 
+struct RealizeMeshCache;
+
+/**
+ * Keeps data from a previous #realize_instances call, so that the next call only has to copy the
+ * instances that changed in the mean time. This is useful when the same instances are realized
+ * repeatedly (e.g. on every frame) and only a few of them are modified every time.
+ *
+ * Currently only meshes are updated incrementally. Other geometry types are always realized
+ * completely.
+ */
+class RealizeInstancesCache : NonCopyable, NonMovable {
+ public:
+  std::unique_ptr<RealizeMeshCache> mesh;
+
+  /** Number of realized mesh instances in the last call. */
+  int mesh_instances_num = 0;
+  /** Number of mesh instances that had to be copied in the last call. */
+  int updated_mesh_instances_num = 0;
+
+  RealizeInstancesCache();
+  ~RealizeInstancesCache();
+};
+
 struct RealizeInstancesOptions {
   /**
    * The default is to generate new ids for every element (when there was any id attribute in the
@@ -23,6 +50,13 @@ struct RealizeInstancesOptions {
   bool realize_instance_attributes = true;
 
   bke::AnonymousAttributePropagationInfo propagation_info;
+
+  /**
+   * Optional cache that is used to update the result of a previous call incrementally. Instances
+   * are only copied again when their source geometry, transform or instance attributes changed.
+   * The realized geometry stays shared with the cache, so modifying it later on requires a copy.
+   */
+  RealizeInstancesCache *cache = nullptr;
 };
 
 /**
@@ -12,6 +12,7 @@
 #include "BLI_listbase.h"
 #include "BLI_math_matrix.hh"
 #include "BLI_math_rotation.hh"
+#include "BLI_multi_value_map.hh"
 #include "BLI_noise.hh"
 #include "BLI_task.hh"
 
@@ -344,6 +345,10 @@ static void copy_generic_attributes_to_result(
           const bke::AttrDomain domain = ordered_attributes.kinds[attribute_index].domain;
           const IndexRange element_slice = range_fn(domain);
 
+          if (!dst_attribute_writers[attribute_index]) {
+            /* The attribute is unchanged in an updated result. */
+            continue;
+          }
           GMutableSpan dst_span = dst_attribute_writers[attribute_index].span.slice(element_slice);
           if (src_attributes[attribute_index].has_value()) {
             threaded_copy(*src_attributes[attribute_index], dst_span);
@@ -1022,37 +1027,50 @@ static void execute_realize_mesh_task(const RealizeInstancesOptions &options,
   const IndexRange dst_face_range(task.start_indices.face, src_faces.size());
   const IndexRange dst_loop_range(task.start_indices.loop, src_corner_verts.size());
 
-  MutableSpan<float3> dst_positions = all_dst_positions.slice(dst_vert_range);
-  MutableSpan<int2> dst_edges = all_dst_edges.slice(dst_edge_range);
-  MutableSpan<int> dst_face_offsets = all_dst_face_offsets.slice(dst_face_range);
-  MutableSpan<int> dst_corner_verts = all_dst_corner_verts.slice(dst_loop_range);
-  MutableSpan<int> dst_corner_edges = all_dst_corner_edges.slice(dst_loop_range);
-
-  threading::parallel_for(src_positions.index_range(), 1024, [&](const IndexRange vert_range) {
-    for (const int i : vert_range) {
-      dst_positions[i] = math::transform_point(task.transform, src_positions[i]);
-    }
-  });
-  threading::parallel_for(src_edges.index_range(), 1024, [&](const IndexRange edge_range) {
-    for (const int i : edge_range) {
-      dst_edges[i] = src_edges[i] + task.start_indices.vertex;
-    }
-  });
-  threading::parallel_for(src_corner_verts.index_range(), 1024, [&](const IndexRange loop_range) {
-    for (const int i : loop_range) {
-      dst_corner_verts[i] = src_corner_verts[i] + task.start_indices.vertex;
-    }
-  });
-  threading::parallel_for(src_corner_edges.index_range(), 1024, [&](const IndexRange loop_range) {
-    for (const int i : loop_range) {
-      dst_corner_edges[i] = src_corner_edges[i] + task.start_indices.edge;
-    }
-  });
-  threading::parallel_for(src_faces.index_range(), 1024, [&](const IndexRange face_range) {
-    for (const int i : face_range) {
-      dst_face_offsets[i] = src_faces[i].start() + task.start_indices.loop;
-    }
-  });
+  /* Outputs are empty when an updated result is unchanged there and they don't have to be
+   * written. */
+  if (!all_dst_positions.is_empty()) {
+    MutableSpan<float3> dst_positions = all_dst_positions.slice(dst_vert_range);
+    threading::parallel_for(src_positions.index_range(), 1024, [&](const IndexRange vert_range) {
+      for (const int i : vert_range) {
+        dst_positions[i] = math::transform_point(task.transform, src_positions[i]);
+      }
+    });
+  }
+  if (!all_dst_edges.is_empty()) {
+    MutableSpan<int2> dst_edges = all_dst_edges.slice(dst_edge_range);
+    threading::parallel_for(src_edges.index_range(), 1024, [&](const IndexRange edge_range) {
+      for (const int i : edge_range) {
+        dst_edges[i] = src_edges[i] + task.start_indices.vertex;
+      }
+    });
+  }
+  if (!all_dst_corner_verts.is_empty()) {
+    MutableSpan<int> dst_corner_verts = all_dst_corner_verts.slice(dst_loop_range);
+    threading::parallel_for(
+        src_corner_verts.index_range(), 1024, [&](const IndexRange loop_range) {
+          for (const int i : loop_range) {
+            dst_corner_verts[i] = src_corner_verts[i] + task.start_indices.vertex;
+          }
+        });
+  }
+  if (!all_dst_corner_edges.is_empty()) {
+    MutableSpan<int> dst_corner_edges = all_dst_corner_edges.slice(dst_loop_range);
+    threading::parallel_for(
+        src_corner_edges.index_range(), 1024, [&](const IndexRange loop_range) {
+          for (const int i : loop_range) {
+            dst_corner_edges[i] = src_corner_edges[i] + task.start_indices.edge;
+          }
+        });
+  }
+  if (!all_dst_face_offsets.is_empty()) {
+    MutableSpan<int> dst_face_offsets = all_dst_face_offsets.slice(dst_face_range);
+    threading::parallel_for(src_faces.index_range(), 1024, [&](const IndexRange face_range) {
+      for (const int i : face_range) {
+        dst_face_offsets[i] = src_faces[i].start() + task.start_indices.loop;
+      }
+    });
+  }
   if (!all_dst_material_indices.is_empty()) {
     const Span<int> material_index_map = mesh_info.material_index_map;
     MutableSpan<int> dst_material_indices = all_dst_material_indices.slice(dst_face_range);
@@ -1108,6 +1126,310 @@ static void execute_realize_mesh_task(const RealizeInstancesOptions &options,
       dst_attribute_writers);
 }
 
+/**
+ * Identifies the data of a source mesh. The key keeps the data arrays of the mesh alive, so they
+ * can't be modified in place or be replaced by other arrays at the same address while the key
+ * exists. Meshes with equal keys therefore contain the same data.
+ */
+struct MeshSourceKey {
+  struct Layer {
+    int type;
+    std::string name;
+    ImplicitSharingPtr<ImplicitSharingInfo> sharing_info;
+
+    BLI_STRUCT_EQUALITY_OPERATORS_3(Layer, type, name, sharing_info)
+  };
+
+  int verts_num = 0;
+  int edges_num = 0;
+  int faces_num = 0;
+  int corners_num = 0;
+  ImplicitSharingPtr<ImplicitSharingInfo> face_offsets;
+  Vector<Layer> layers;
+  Vector<Material *> materials;
+  /** False when some of the data is not shared and can't be identified. Such keys never match. */
+  bool is_valid = true;
+
+  uint64_t hash() const
+  {
+    uint64_t hash = get_default_hash_4(verts_num, edges_num, faces_num, corners_num);
+    for (const Layer &layer : layers) {
+      hash = hash * 33 ^ layer.sharing_info.hash();
+    }
+    return hash;
+  }
+
+  friend bool operator==(const MeshSourceKey &a, const MeshSourceKey &b)
+  {
+    if (!a.is_valid || !b.is_valid) {
+      return false;
+    }
+    return a.verts_num == b.verts_num && a.edges_num == b.edges_num &&
+           a.faces_num == b.faces_num && a.corners_num == b.corners_num &&
+           a.face_offsets == b.face_offsets && a.layers == b.layers &&
+           a.materials == b.materials;
+  }
+};
+
+/** Everything that affects the output of a single #RealizeMeshTask. */
+struct RealizeMeshTaskKey {
+  MeshElementStartIndices start_indices;
+  /** Index into #RealizeMeshCache::sources. */
+  int source_index;
+  float4x4 transform;
+  uint32_t id;
+};
+
+struct RealizeMeshCache {
+  /** Keeps the realized mesh alive, so that it can be updated in the next call. */
+  bke::GeometrySet result;
+
+  /** Settings that affect the whole mesh. They have to match to reuse the result. */
+  bool keep_original_ids = false;
+  bool create_id_attribute = false;
+  bool create_material_index_attribute = false;
+  Vector<std::string> attribute_names;
+  Vector<AttributeKind> attribute_kinds;
+  Vector<Material *> materials;
+
+  /** Ordered by #AllMeshesInfo.order. */
+  Array<MeshSourceKey> sources;
+  Array<RealizeMeshTaskKey> tasks;
+  /**
+   * The attribute fallback values of all tasks, #fallback_values_size bytes per task. Attribute
+   * types are trivial, so the values can be compared bytewise.
+   */
+  Array<uint8_t> fallback_values;
+  int fallback_values_size = 0;
+};
+
+RealizeInstancesCache::RealizeInstancesCache() = default;
+RealizeInstancesCache::~RealizeInstancesCache() = default;
+
+static MeshSourceKey mesh_source_key(const Mesh &mesh)
+{
+  MeshSourceKey key;
+  key.verts_num = mesh.verts_num;
+  key.edges_num = mesh.edges_num;
+  key.faces_num = mesh.faces_num;
+  key.corners_num = mesh.corners_num;
+  auto add_user = [&](const ImplicitSharingInfo *sharing_info) {
+    if (sharing_info == nullptr) {
+      key.is_valid = false;
+      return ImplicitSharingPtr<ImplicitSharingInfo>();
+    }
+    sharing_info->add_user();
+    return ImplicitSharingPtr<ImplicitSharingInfo>(sharing_info);
+  };
+  if (mesh.faces_num > 0) {
+    key.face_offsets = add_user(mesh.runtime->face_offsets_sharing_info);
+  }
+  for (const CustomData *data :
+       {&mesh.vert_data, &mesh.edge_data, &mesh.face_data, &mesh.corner_data})
+  {
+    for (const CustomDataLayer &layer : Span(data->layers, data->totlayer)) {
+      key.layers.append({layer.type, layer.name, add_user(layer.sharing_info)});
+    }
+  }
+  key.materials.extend(Span(mesh.mat, mesh.totcol));
+  return key;
+}
+
+static std::unique_ptr<RealizeMeshCache> create_mesh_cache(const RealizeInstancesOptions &options,
+                                                           const AllMeshesInfo &all_meshes_info,
+                                                           const Span<RealizeMeshTask> tasks)
+{
+  std::unique_ptr<RealizeMeshCache> cache = std::make_unique<RealizeMeshCache>();
+  cache->keep_original_ids = options.keep_original_ids;
+  cache->create_id_attribute = all_meshes_info.create_id_attribute;
+  cache->create_material_index_attribute = all_meshes_info.create_material_index_attribute;
+  for (const AttributeIDRef &attribute_id : all_meshes_info.attributes.ids) {
+    cache->attribute_names.append(attribute_id.name());
+  }
+  cache->attribute_kinds = all_meshes_info.attributes.kinds;
+  cache->materials.extend(all_meshes_info.materials.as_span());
+
+  cache->sources.reinitialize(all_meshes_info.order.size());
+  threading::parallel_for(cache->sources.index_range(), 64, [&](const IndexRange range) {
+    for (const int i : range) {
+      cache->sources[i] = mesh_source_key(*all_meshes_info.order[i]);
+    }
+  });
+
+  Vector<const CPPType *> fallback_types;
+  for (const AttributeKind &kind : all_meshes_info.attributes.kinds) {
+    const CPPType *type = bke::custom_data_type_to_cpp_type(kind.data_type);
+    BLI_assert(type->is_trivial());
+    fallback_types.append(type);
+    cache->fallback_values_size += type->size();
+  }
+
+  cache->tasks.reinitialize(tasks.size());
+  cache->fallback_values.reinitialize(tasks.size() * cache->fallback_values_size);
+  threading::parallel_for(tasks.index_range(), 1024, [&](const IndexRange range) {
+    for (const int task_index : range) {
+      const RealizeMeshTask &task = tasks[task_index];
+      cache->tasks[task_index] = {task.start_indices,
+                                  int(task.mesh_info - all_meshes_info.realize_info.data()),
+                                  task.transform,
+                                  task.id};
+      uint8_t *values = cache->fallback_values.data() +
+                        task_index * cache->fallback_values_size;
+      for (const int attribute_index : fallback_types.index_range()) {
+        const CPPType &type = *fallback_types[attribute_index];
+        const void *value = task.attribute_fallbacks.array[attribute_index];
+        memcpy(values, value ? value : type.default_value(), type.size());
+        values += type.size();
+      }
+    }
+  });
+  return cache;
+}
+
+static bool mesh_cache_settings_match(const RealizeMeshCache &a, const RealizeMeshCache &b)
+{
+  if (a.keep_original_ids != b.keep_original_ids ||
+      a.create_id_attribute != b.create_id_attribute ||
+      a.create_material_index_attribute != b.create_material_index_attribute ||
+      a.attribute_names != b.attribute_names || a.materials != b.materials)
+  {
+    return false;
+  }
+  for (const int i : a.attribute_kinds.index_range()) {
+    if (a.attribute_kinds[i].domain != b.attribute_kinds[i].domain ||
+        a.attribute_kinds[i].data_type != b.attribute_kinds[i].data_type)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** The parts of the mesh from the previous call that have to be written again. */
+struct RealizeMeshChanges {
+  /** The source mesh of a changed task is different, so all data of the task is written. */
+  bool topology = false;
+  bool positions = false;
+  bool ids = false;
+  /** Generic attributes whose fallback value changed for some task, in the attribute order. */
+  Array<bool> attributes;
+};
+
+/**
+ * Find the tasks whose output is different from the output of the corresponding task in the
+ * previous call. Returns false when the mesh from the previous call can't be reused at all,
+ * because the number or the sizes of the tasks changed.
+ *
+ * \param r_changes: Which data of the changed tasks is different, so that arrays that stay the
+ * same aren't written (and copied when they are shared).
+ */
+static bool find_changed_mesh_tasks(const RealizeMeshCache &old_cache,
+                                    const RealizeMeshCache &new_cache,
+                                    const MeshElementStartIndices &totals,
+                                    IndexMaskMemory &memory,
+                                    IndexMask &r_changed_tasks,
+                                    RealizeMeshChanges &r_changes)
+{
+  const Mesh *old_mesh = old_cache.result.get_mesh();
+  if (old_mesh == nullptr || old_mesh->verts_num != totals.vertex ||
+      old_mesh->edges_num != totals.edge || old_mesh->faces_num != totals.face ||
+      old_mesh->corners_num != totals.loop)
+  {
+    return false;
+  }
+  if (!mesh_cache_settings_match(old_cache, new_cache)) {
+    return false;
+  }
+  if (old_cache.tasks.size() != new_cache.tasks.size() ||
+      old_cache.fallback_values_size != new_cache.fallback_values_size)
+  {
+    return false;
+  }
+  for (const int i : new_cache.tasks.index_range()) {
+    const MeshElementStartIndices &a = old_cache.tasks[i].start_indices;
+    const MeshElementStartIndices &b = new_cache.tasks[i].start_indices;
+    if (a.vertex != b.vertex || a.edge != b.edge || a.face != b.face || a.loop != b.loop) {
+      return false;
+    }
+  }
+
+  /* Find the source meshes that were used in the previous call already. */
+  MultiValueMap<uint64_t, int> old_sources_by_hash;
+  for (const int i : old_cache.sources.index_range()) {
+    if (old_cache.sources[i].is_valid) {
+      old_sources_by_hash.add(old_cache.sources[i].hash(), i);
+    }
+  }
+  Array<int> old_source_indices(new_cache.sources.size(), -1);
+  for (const int i : new_cache.sources.index_range()) {
+    const MeshSourceKey &source = new_cache.sources[i];
+    if (!source.is_valid) {
+      continue;
+    }
+    for (const int old_i : old_sources_by_hash.lookup(source.hash())) {
+      if (old_cache.sources[old_i] == source) {
+        old_source_indices[i] = old_i;
+        break;
+      }
+    }
+  }
+
+  const int values_size = new_cache.fallback_values_size;
+  r_changed_tasks = IndexMask::from_predicate(
+      new_cache.tasks.index_range(), GrainSize(4096), memory, [&](const int64_t i) {
+        const RealizeMeshTaskKey &old_task = old_cache.tasks[i];
+        const RealizeMeshTaskKey &new_task = new_cache.tasks[i];
+        if (old_source_indices[new_task.source_index] != old_task.source_index) {
+          return true;
+        }
+        /* Compare bitwise, so that only tasks with exactly the same output are skipped. */
+        if (memcmp(&old_task.transform, &new_task.transform, sizeof(float4x4)) != 0) {
+          return true;
+        }
+        if (old_task.id != new_task.id) {
+          return true;
+        }
+        return memcmp(old_cache.fallback_values.data() + i * values_size,
+                      new_cache.fallback_values.data() + i * values_size,
+                      values_size) != 0;
+      });
+
+  Array<IndexRange> value_ranges(new_cache.attribute_kinds.size());
+  int value_offset = 0;
+  for (const int attribute_index : value_ranges.index_range()) {
+    const eCustomDataType data_type = new_cache.attribute_kinds[attribute_index].data_type;
+    const int value_size = bke::custom_data_type_to_cpp_type(data_type)->size();
+    value_ranges[attribute_index] = IndexRange(value_offset, value_size);
+    value_offset += value_size;
+  }
+
+  r_changes.attributes.reinitialize(value_ranges.size());
+  r_changes.attributes.fill(false);
+  r_changed_tasks.foreach_index([&](const int64_t i) {
+    const RealizeMeshTaskKey &old_task = old_cache.tasks[i];
+    const RealizeMeshTaskKey &new_task = new_cache.tasks[i];
+    if (old_source_indices[new_task.source_index] != old_task.source_index) {
+      r_changes.topology = true;
+      return;
+    }
+    if (memcmp(&old_task.transform, &new_task.transform, sizeof(float4x4)) != 0) {
+      r_changes.positions = true;
+    }
+    if (old_task.id != new_task.id) {
+      r_changes.ids = true;
+    }
+    const uint8_t *old_values = old_cache.fallback_values.data() + i * values_size;
+    const uint8_t *new_values = new_cache.fallback_values.data() + i * values_size;
+    for (const int attribute_index : value_ranges.index_range()) {
+      const IndexRange range = value_ranges[attribute_index];
+      if (memcmp(old_values + range.start(), new_values + range.start(), range.size()) != 0) {
+        r_changes.attributes[attribute_index] = true;
+      }
+    }
+  });
+  return true;
+}
+
 static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
                                        const AllMeshesInfo &all_meshes_info,
                                        const Span<RealizeMeshTask> tasks,
@@ -1116,6 +1438,11 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
                                        bke::GeometrySet &r_realized_geometry)
 {
   if (tasks.is_empty()) {
+    if (options.cache) {
+      options.cache->mesh.reset();
+      options.cache->mesh_instances_num = 0;
+      options.cache->updated_mesh_instances_num = 0;
+    }
     return;
   }
 
@@ -1126,14 +1453,68 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
   const int tot_loops = last_task.start_indices.loop + last_mesh.corners_num;
   const int tot_faces = last_task.start_indices.face + last_mesh.faces_num;
 
-  Mesh *dst_mesh = BKE_mesh_new_nomain(tot_vertices, tot_edges, tot_faces, tot_loops);
+  /* Try to update the mesh from the previous call instead of building a new one. */
+  Mesh *dst_mesh = nullptr;
+  IndexMaskMemory memory;
+  IndexMask tasks_to_execute = tasks.index_range();
+  bool reuse_mesh = false;
+  RealizeMeshChanges changes;
+  std::unique_ptr<RealizeMeshCache> new_cache;
+  if (options.cache) {
+    RealizeInstancesCache &cache = *options.cache;
+    new_cache = create_mesh_cache(options, all_meshes_info, tasks);
+    const MeshElementStartIndices totals{tot_vertices, tot_edges, tot_faces, tot_loops};
+    if (cache.mesh && find_changed_mesh_tasks(*cache.mesh,
+                                              *new_cache,
+                                              totals,
+                                              memory,
+                                              tasks_to_execute,
+                                              changes))
+    {
+      bke::GeometrySet old_result = std::move(cache.mesh->result);
+      if (tasks_to_execute.is_empty()) {
+        /* Nothing changed, the previous mesh can be used as is. */
+        r_realized_geometry.add(*old_result.get_component<bke::MeshComponent>());
+        new_cache->result = std::move(old_result);
+        cache.mesh = std::move(new_cache);
+        cache.mesh_instances_num = tasks.size();
+        cache.updated_mesh_instances_num = 0;
+        return;
+      }
+      /* Only copies the mesh if it is still used elsewhere. The data arrays stay shared until
+       * they are written to below. */
+      dst_mesh = old_result.get_component_for_write<bke::MeshComponent>().release();
+      reuse_mesh = true;
+    }
+    /* Free the previous mesh early when it can't be reused. */
+    cache.mesh.reset();
+    cache.mesh_instances_num = tasks.size();
+    cache.updated_mesh_instances_num = tasks_to_execute.size();
+  }
+
+  if (dst_mesh == nullptr) {
+    dst_mesh = BKE_mesh_new_nomain(tot_vertices, tot_edges, tot_faces, tot_loops);
+  }
   r_realized_geometry.replace_mesh(dst_mesh);
   bke::MutableAttributeAccessor dst_attributes = dst_mesh->attributes_for_write();
-  MutableSpan<float3> dst_positions = dst_mesh->vert_positions_for_write();
-  MutableSpan<int2> dst_edges = dst_mesh->edges_for_write();
-  MutableSpan<int> dst_face_offsets = dst_mesh->face_offsets_for_write();
-  MutableSpan<int> dst_corner_verts = dst_mesh->corner_verts_for_write();
-  MutableSpan<int> dst_corner_edges = dst_mesh->corner_edges_for_write();
+
+  /* When the previous mesh is updated, only request write access to the arrays that change,
+   * because arrays that are still shared with the previous result are copied completely. */
+  const bool write_all = !reuse_mesh || changes.topology;
+  MutableSpan<float3> dst_positions;
+  if (write_all || changes.positions) {
+    dst_positions = dst_mesh->vert_positions_for_write();
+  }
+  MutableSpan<int2> dst_edges;
+  MutableSpan<int> dst_face_offsets;
+  MutableSpan<int> dst_corner_verts;
+  MutableSpan<int> dst_corner_edges;
+  if (write_all) {
+    dst_edges = dst_mesh->edges_for_write();
+    dst_face_offsets = dst_mesh->face_offsets_for_write();
+    dst_corner_verts = dst_mesh->corner_verts_for_write();
+    dst_corner_edges = dst_mesh->corner_edges_for_write();
+  }
 
   /* Copy settings from the first input geometry set with a mesh. */
   const RealizeMeshTask &first_task = tasks.first();
@@ -1151,13 +1532,13 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
 
   /* Prepare id attribute. */
   SpanAttributeWriter<int> vertex_ids;
-  if (all_meshes_info.create_id_attribute) {
+  if (all_meshes_info.create_id_attribute && (write_all || changes.ids)) {
     vertex_ids = dst_attributes.lookup_or_add_for_write_only_span<int>("id",
                                                                        bke::AttrDomain::Point);
   }
   /* Prepare material indices. */
   SpanAttributeWriter<int> material_indices;
-  if (all_meshes_info.create_material_index_attribute) {
+  if (all_meshes_info.create_material_index_attribute && write_all) {
     material_indices = dst_attributes.lookup_or_add_for_write_only_span<int>(
         "material_index", bke::AttrDomain::Face);
   }
@@ -1165,6 +1546,11 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
   /* Prepare generic output attributes. */
   Vector<GSpanAttributeWriter> dst_attribute_writers;
   for (const int attribute_index : ordered_attributes.index_range()) {
+    if (!write_all && !changes.attributes[attribute_index]) {
+      /* Skipped by #copy_generic_attributes_to_result. */
+      dst_attribute_writers.append({});
+      continue;
+    }
     const AttributeIDRef &attribute_id = ordered_attributes.ids[attribute_index];
     const bke::AttrDomain domain = ordered_attributes.kinds[attribute_index].domain;
     const eCustomDataType data_type = ordered_attributes.kinds[attribute_index].data_type;
@@ -1173,21 +1559,19 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
   }
 
   /* Actually execute all tasks. */
-  threading::parallel_for(tasks.index_range(), 100, [&](const IndexRange task_range) {
-    for (const int task_index : task_range) {
-      const RealizeMeshTask &task = tasks[task_index];
-      execute_realize_mesh_task(options,
-                                task,
-                                ordered_attributes,
-                                dst_attribute_writers,
-                                dst_positions,
-                                dst_edges,
-                                dst_face_offsets,
-                                dst_corner_verts,
-                                dst_corner_edges,
-                                vertex_ids.span,
-                                material_indices.span);
-    }
+  tasks_to_execute.foreach_index(GrainSize(100), [&](const int64_t task_index) {
+    const RealizeMeshTask &task = tasks[task_index];
+    execute_realize_mesh_task(options,
+                              task,
+                              ordered_attributes,
+                              dst_attribute_writers,
+                              dst_positions,
+                              dst_edges,
+                              dst_face_offsets,
+                              dst_corner_verts,
+                              dst_corner_edges,
+                              vertex_ids.span,
+                              material_indices.span);
   });
 
   /* Tag modified attributes. */
@@ -1197,6 +1581,16 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
   vertex_ids.finish();
   material_indices.finish();
 
+  if (reuse_mesh) {
+    /* The mesh from the previous call has been updated, invalidate its derived data. */
+    if (changes.topology) {
+      dst_mesh->tag_topology_changed();
+    }
+    else if (changes.positions) {
+      dst_mesh->tag_positions_changed();
+    }
+  }
+
   if (all_meshes_info.no_loose_edges_hint) {
     dst_mesh->tag_loose_edges_none();
   }
@@ -1206,6 +1600,11 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
   if (all_meshes_info.no_overlapping_hint) {
     dst_mesh->tag_overlapping_none();
   }
+
+  if (new_cache) {
+    new_cache->result.add(*r_realized_geometry.get_component<bke::MeshComponent>());
+    options.cache->mesh = std::move(new_cache);
+  }
 }
 
 /** \} */
@@ -1573,6 +1972,11 @@ bke::GeometrySet realize_instances(bke::GeometrySet geometry_set,
    */
 
   if (!geometry_set.has_instances()) {
+    if (options.cache) {
+      options.cache->mesh.reset();
+      options.cache->mesh_instances_num = 0;
+      options.cache->updated_mesh_instances_num = 0;
+    }
     return geometry_set;
   }
 
@@ -0,0 +1,158 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BKE_idtype.h"
+#include "BKE_instances.hh"
+#include "BKE_mesh.hh"
+
+#include "BLI_math_matrix.hh"
+
+#include "GEO_mesh_primitive_cuboid.hh"
+#include "GEO_realize_instances.hh"
+
+namespace blender::geometry::tests {
+
+class realize_instances_cache : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+/** Instance every geometry once, at the corresponding location. */
+static bke::GeometrySet create_instances(const Span<bke::GeometrySet> geometries,
+                                         const Span<float3> locations)
+{
+  bke::Instances *instances = new bke::Instances();
+  for (const int i : geometries.index_range()) {
+    const int handle = instances->add_reference(bke::InstanceReference(geometries[i]));
+    instances->add_instance(handle, math::from_location<float4x4>(locations[i]));
+  }
+  return bke::GeometrySet::from_instances(instances);
+}
+
+static bke::GeometrySet realize(const bke::GeometrySet &geometry, RealizeInstancesCache *cache)
+{
+  RealizeInstancesOptions options;
+  options.cache = cache;
+  return realize_instances(geometry, options);
+}
+
+/** Compare the cached result with a realization from scratch. */
+static void expect_realized_as_without_cache(const bke::GeometrySet &realized,
+                                             const bke::GeometrySet &instances)
+{
+  const bke::GeometrySet expected = realize(instances, nullptr);
+  const Mesh &mesh = *realized.get_mesh();
+  const Mesh &expected_mesh = *expected.get_mesh();
+  ASSERT_EQ(mesh.verts_num, expected_mesh.verts_num);
+  ASSERT_EQ(mesh.corners_num, expected_mesh.corners_num);
+  EXPECT_EQ_ARRAY(
+      expected_mesh.vert_positions().data(), mesh.vert_positions().data(), mesh.verts_num);
+  EXPECT_EQ_ARRAY(
+      expected_mesh.corner_verts().data(), mesh.corner_verts().data(), mesh.corners_num);
+}
+
+TEST_F(realize_instances_cache, UnchangedInputIsReused)
+{
+  const Array<bke::GeometrySet> geometries = {
+      bke::GeometrySet::from_mesh(create_cuboid_mesh(float3(1), 2, 2, 2)),
+      bke::GeometrySet::from_mesh(create_cuboid_mesh(float3(1), 3, 3, 3))};
+  const Array<float3> locations = {float3(0, 0, 0), float3(5, 0, 0)};
+
+  RealizeInstancesCache cache;
+  const bke::GeometrySet instances = create_instances(geometries, locations);
+  const bke::GeometrySet first = realize(instances, &cache);
+  EXPECT_EQ(cache.mesh_instances_num, 2);
+  EXPECT_EQ(cache.updated_mesh_instances_num, 2);
+
+  const bke::GeometrySet second = realize(create_instances(geometries, locations), &cache);
+  EXPECT_EQ(cache.mesh_instances_num, 2);
+  EXPECT_EQ(cache.updated_mesh_instances_num, 0);
+  EXPECT_EQ(first.get_mesh(), second.get_mesh());
+  expect_realized_as_without_cache(second, instances);
+}
+
+TEST_F(realize_instances_cache, ChangedMeshIsUpdated)
+{
+  Array<bke::GeometrySet> geometries = {
+      bke::GeometrySet::from_mesh(create_cuboid_mesh(float3(1), 2, 2, 2)),
+      bke::GeometrySet::from_mesh(create_cuboid_mesh(float3(1), 3, 3, 3))};
+  const Array<float3> locations = {float3(0, 0, 0), float3(5, 0, 0)};
+
+  RealizeInstancesCache cache;
+  const bke::GeometrySet first = realize(create_instances(geometries, locations), &cache);
+  const Array<float3> first_positions(first.get_mesh()->vert_positions());
+
+  /* Modify the second mesh in place. The cache still references the original positions, so they
+   * have to be copied and the instance must be realized again. */
+  Mesh *mesh = geometries[1].get_mesh_for_write();
+  for (float3 &position : mesh->vert_positions_for_write()) {
+    position.z += 1.0f;
+  }
+  mesh->tag_positions_changed();
+
+  const bke::GeometrySet instances = create_instances(geometries, locations);
+  const bke::GeometrySet second = realize(instances, &cache);
+  EXPECT_EQ(cache.mesh_instances_num, 2);
+  EXPECT_EQ(cache.updated_mesh_instances_num, 1);
+  expect_realized_as_without_cache(second, instances);
+
+  /* The result of the first call is not modified by the update. */
+  EXPECT_EQ_ARRAY(
+      first_positions.data(), first.get_mesh()->vert_positions().data(), first_positions.size());
+}
+
+TEST_F(realize_instances_cache, ChangedTransformIsUpdated)
+{
+  const Array<bke::GeometrySet> geometries = {
+      bke::GeometrySet::from_mesh(create_cuboid_mesh(float3(1), 2, 2, 2)),
+      bke::GeometrySet::from_mesh(create_cuboid_mesh(float3(1), 2, 2, 2)),
+      bke::GeometrySet::from_mesh(create_cuboid_mesh(float3(1), 3, 3, 3))};
+
+  RealizeInstancesCache cache;
+  const bke::GeometrySet first = realize(
+      create_instances(geometries, {float3(0, 0, 0), float3(5, 0, 0), float3(10, 0, 0)}), &cache);
+
+  const bke::GeometrySet instances = create_instances(
+      geometries, {float3(0, 0, 0), float3(5, 2, 0), float3(10, 0, 0)});
+  const bke::GeometrySet realized = realize(instances, &cache);
+  EXPECT_EQ(cache.mesh_instances_num, 3);
+  EXPECT_EQ(cache.updated_mesh_instances_num, 1);
+  expect_realized_as_without_cache(realized, instances);
+
+  /* Only the positions are written, the topology stays shared with the first result. */
+  const Mesh &first_mesh = *first.get_mesh();
+  const Mesh &mesh = *realized.get_mesh();
+  EXPECT_NE(&first_mesh, &mesh);
+  EXPECT_NE(first_mesh.vert_positions().data(), mesh.vert_positions().data());
+  EXPECT_EQ(first_mesh.edges().data(), mesh.edges().data());
+  EXPECT_EQ(first_mesh.face_offsets().data(), mesh.face_offsets().data());
+  EXPECT_EQ(first_mesh.corner_verts().data(), mesh.corner_verts().data());
+  EXPECT_EQ(first_mesh.corner_edges().data(), mesh.corner_edges().data());
+}
+
+TEST_F(realize_instances_cache, ChangedTopologyIsRealizedCompletely)
+{
+  Array<bke::GeometrySet> geometries = {
+      bke::GeometrySet::from_mesh(create_cuboid_mesh(float3(1), 2, 2, 2)),
+      bke::GeometrySet::from_mesh(create_cuboid_mesh(float3(1), 3, 3, 3))};
+  const Array<float3> locations = {float3(0, 0, 0), float3(5, 0, 0)};
+
+  RealizeInstancesCache cache;
+  realize(create_instances(geometries, locations), &cache);
+
+  /* The element counts change, so the previous mesh can't be updated. */
+  geometries[0] = bke::GeometrySet::from_mesh(create_cuboid_mesh(float3(1), 4, 4, 4));
+  const bke::GeometrySet instances = create_instances(geometries, locations);
+  const bke::GeometrySet realized = realize(instances, &cache);
+  EXPECT_EQ(cache.mesh_instances_num, 2);
+  EXPECT_EQ(cache.updated_mesh_instances_num, 2);
+  expect_realized_as_without_cache(realized, instances);
+}
+
+}  // namespace blender::geometry::tests
@@ -15,9 +15,10 @@
 #include "DNA_material_types.h"
 
 #include "BLI_ghash.h"
+#include "BLI_hash.hh"
 #include "BLI_hash_mm2a.h"
-#include "BLI_link_utils.h"
 #include "BLI_listbase.h"
+#include "BLI_map.hh"
 #include "BLI_string.h"
 #include "BLI_threads.h"
 #include "BLI_time.h"
@@ -88,8 +89,6 @@ struct GPUCodegenCreateInfo : ShaderCreateInfo {
 };
 
 struct GPUPass {
-  GPUPass *next;
-
   GPUShader *shader;
   GPUCodegenCreateInfo *create_info = nullptr;
   /** Orphaned GPUPasses gets freed by the garbage collector. */
@@ -115,58 +114,74 @@ struct GPUPass {
  * Internal shader cache: This prevent the shader recompilation / stall when
  * using undo/redo AND also allows for GPUPass reuse if the Shader code is the
  * same for 2 different Materials. Unused GPUPasses are free by Garbage collection.
+ *
+ * TODO: The cache doesn't persist across sessions. A persistent cache of the generated code has
+ * to be keyed on the material node tree and the pass options before the node graph is built,
+ * otherwise a hit doesn't save any work.
  * \{ */
 
-/* Only use one linklist that contains the GPUPasses grouped by hash. */
-static GPUPass *pass_cache = nullptr;
+struct GPUPassCacheKey {
+  eGPUMaterialEngine engine;
+  uint32_t code_hash;
+
+  uint64_t hash() const
+  {
+    return blender::get_default_hash_2(int(engine), code_hash);
+  }
+
+  friend bool operator==(const GPUPassCacheKey &a, const GPUPassCacheKey &b)
+  {
+    return a.engine == b.engine && a.code_hash == b.code_hash;
+  }
+};
+
+/**
+ * GPUPasses grouped by engine and hash. A group only contains more than one pass when there is a
+ * hash collision between passes with different create infos.
+ */
+using GPUPassCache = blender::Map<GPUPassCacheKey, blender::Vector<GPUPass *, 1>>;
+
+static GPUPassCache *pass_cache = nullptr;
 static SpinLock pass_cache_spin;
 
-/* Search by hash only. Return first pass with the same hash.
- * There is hash collision if (pass->next && pass->next->hash == hash) */
-static GPUPass *gpu_pass_cache_lookup(eGPUMaterialEngine engine, uint32_t hash)
+/**
+ * Search by hash only. Return first pass with the same hash and write whether other passes share
+ * the same hash (in which case the full create info has to be compared).
+ */
+static GPUPass *gpu_pass_cache_lookup(eGPUMaterialEngine engine,
+                                      uint32_t hash,
+                                      bool *r_has_collision)
 {
   BLI_spin_lock(&pass_cache_spin);
-  /* Could be optimized with a Lookup table. */
-  for (GPUPass *pass = pass_cache; pass; pass = pass->next) {
-    if (pass->hash == hash && pass->engine == engine) {
-      BLI_spin_unlock(&pass_cache_spin);
-      return pass;
-    }
-  }
+  const blender::Vector<GPUPass *, 1> *group = pass_cache->lookup_ptr({engine, hash});
+  GPUPass *pass = group ? group->first() : nullptr;
+  *r_has_collision = group && group->size() > 1;
   BLI_spin_unlock(&pass_cache_spin);
-  return nullptr;
+  return pass;
 }
 
-static void gpu_pass_cache_insert_after(GPUPass *node, GPUPass *pass)
+static void gpu_pass_cache_insert(GPUPass *pass)
 {
   BLI_spin_lock(&pass_cache_spin);
   pass->cached = true;
-  if (node != nullptr) {
-    /* Add after the first pass having the same hash. */
-    pass->next = node->next;
-    node->next = pass;
-  }
-  else {
-    /* No other pass have same hash, just prepend to the list. */
-    BLI_LINKS_PREPEND(pass_cache, pass);
-  }
+  pass_cache->lookup_or_add_default({pass->engine, pass->hash}).append(pass);
   BLI_spin_unlock(&pass_cache_spin);
 }
 
 /* Check all possible passes with the same hash. */
-static GPUPass *gpu_pass_cache_resolve_collision(GPUPass *pass,
+static GPUPass *gpu_pass_cache_resolve_collision(eGPUMaterialEngine engine,
                                                  GPUShaderCreateInfo *info,
                                                  uint32_t hash)
 {
-  eGPUMaterialEngine engine = pass->engine;
   BLI_spin_lock(&pass_cache_spin);
-  for (; pass && (pass->hash == hash); pass = pass->next) {
-    if (*reinterpret_cast<ShaderCreateInfo *>(info) ==
-            *reinterpret_cast<ShaderCreateInfo *>(pass->create_info) &&
-        pass->engine == engine)
-    {
-      BLI_spin_unlock(&pass_cache_spin);
-      return pass;
+  if (const blender::Vector<GPUPass *, 1> *group = pass_cache->lookup_ptr({engine, hash})) {
+    for (GPUPass *pass : *group) {
+      if (*reinterpret_cast<ShaderCreateInfo *>(info) ==
+          *reinterpret_cast<ShaderCreateInfo *>(pass->create_info))
+      {
+        BLI_spin_unlock(&pass_cache_spin);
+        return pass;
+      }
     }
   }
   BLI_spin_unlock(&pass_cache_spin);
@@ -766,11 +781,12 @@ GPUPass *GPU_generate_pass(GPUMaterial *material,
      * NOTE: We only perform cache look-up for non-optimized shader
      * graphs, as baked constant data among other optimizations will generate too many
      * shader source permutations, with minimal re-usability. */
-    pass_hash = gpu_pass_cache_lookup(engine, codegen.hash_get());
+    bool has_collision;
+    pass_hash = gpu_pass_cache_lookup(engine, codegen.hash_get(), &has_collision);
 
     /* FIXME(fclem): This is broken. Since we only check for the hash and not the full source
      * there is no way to have a collision currently. Some advocated to only use a bigger hash. */
-    if (pass_hash && (pass_hash->next == nullptr || pass_hash->next->hash != codegen.hash_get())) {
+    if (pass_hash && !has_collision) {
       if (!gpu_pass_is_valid(pass_hash)) {
         /* Shader has already been created but failed to compile. */
         return nullptr;
@@ -796,7 +812,7 @@ GPUPass *GPU_generate_pass(GPUMaterial *material,
   if (pass_hash) {
     /* Cache lookup: Reuse shaders already compiled. */
     pass = gpu_pass_cache_resolve_collision(
-        pass_hash, codegen.output.create_info, codegen.hash_get());
+        engine, codegen.output.create_info, codegen.hash_get());
   }
 
   if (pass) {
@@ -832,7 +848,7 @@ GPUPass *GPU_generate_pass(GPUMaterial *material,
      * editing, and thus causing the cache to fill up quickly with materials offering minimal
      * re-use. */
     if (!optimize_graph) {
-      gpu_pass_cache_insert_after(pass_hash, pass);
+      gpu_pass_cache_insert(pass);
     }
   }
   return pass;
@@ -955,36 +971,39 @@ void GPU_pass_cache_garbage_collect()
   int ctime = int(BLI_check_seconds_timer());
 
   BLI_spin_lock(&pass_cache_spin);
-  GPUPass *next, **prev_pass = &pass_cache;
-  for (GPUPass *pass = pass_cache; pass; pass = next) {
-    next = pass->next;
-    if (pass->refcount > 0) {
-      pass->gc_timestamp = ctime;
-    }
-    else if (pass->gc_timestamp + shadercollectrate < ctime) {
-      /* Remove from list */
-      *prev_pass = next;
-      gpu_pass_free(pass);
-      continue;
-    }
-    prev_pass = &pass->next;
-  }
+  pass_cache->remove_if([&](GPUPassCache::MutableItem item) {
+    item.value.remove_if([&](GPUPass *pass) {
+      if (pass->refcount > 0) {
+        pass->gc_timestamp = ctime;
+        return false;
+      }
+      if (pass->gc_timestamp + shadercollectrate < ctime) {
+        gpu_pass_free(pass);
+        return true;
+      }
+      return false;
+    });
+    return item.value.is_empty();
+  });
   BLI_spin_unlock(&pass_cache_spin);
 }
 
 void GPU_pass_cache_init()
 {
   BLI_spin_init(&pass_cache_spin);
+  pass_cache = MEM_new<GPUPassCache>(__func__);
 }
 
 void GPU_pass_cache_free()
 {
   BLI_spin_lock(&pass_cache_spin);
-  while (pass_cache) {
-    GPUPass *next = pass_cache->next;
-    gpu_pass_free(pass_cache);
-    pass_cache = next;
+  for (blender::Vector<GPUPass *, 1> &group : pass_cache->values()) {
+    for (GPUPass *pass : group) {
+      gpu_pass_free(pass);
+    }
   }
+  MEM_delete(pass_cache);
+  pass_cache = nullptr;
   BLI_spin_unlock(&pass_cache_spin);
 
   BLI_spin_end(&pass_cache_spin);
@@ -6,11 +6,16 @@
  * \ingroup imbuf
  */
 
+#include <algorithm>
 #include <cmath>
 
+#include "BLI_array.hh"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.hh"
+#include "BLI_simd.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 #include "MEM_guardedalloc.h"
 
 #include "IMB_imbuf.h"
@@ -877,145 +882,333 @@ static bool q_scale_linear_interpolation(ImBuf *ibuf, int newx, int newy)
   return true;
 }
 
-static ImBuf *scaledownx(ImBuf *ibuf, int newx)
+/* -------------------------------------------------------------------- */
+/** \name Box Filter Down-Scaling and Linear Up-Scaling
+ *
+ * The scaling passes used by #IMB_scaleImBuf. The position in the source image, and with that
+ * the weights of the source pixels, are the same for every row (or column) of the image. They
+ * are computed once up-front, after which the rows are filtered in parallel. Pixels are
+ * processed as 4 floats at a time, using SSE2 when it is available.
+ * \{ */
+
+namespace {
+
+#if BLI_HAVE_SSE2
+using ScalePixel = __m128;
+
+BLI_INLINE ScalePixel scale_pixel_load(const float *src)
 {
-  const bool do_rect = (ibuf->byte_buffer.data != nullptr);
-  const bool do_float = (ibuf->float_buffer.data != nullptr);
-  const size_t rect_size = IMB_get_rect_len(ibuf) * 4;
+  return _mm_loadu_ps(src);
+}
 
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y;
+BLI_INLINE ScalePixel scale_pixel_load(const uchar *src)
+{
+  int32_t packed;
+  memcpy(&packed, src, sizeof(packed));
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bytes = _mm_cvtsi32_si128(packed);
+  return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+}
 
-  rectf = _newrectf = newrectf = nullptr;
-  rect = _newrect = newrect = nullptr;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+BLI_INLINE void scale_pixel_store(float *dst, const ScalePixel value)
+{
+  _mm_storeu_ps(dst, value);
+}
 
-  if (!do_rect && !do_float) {
-    return ibuf;
+/** Rounds to the nearest integer, the values are known to be positive. */
+BLI_INLINE void scale_pixel_store(uchar *dst, const ScalePixel value)
+{
+  const __m128i ints = _mm_cvttps_epi32(_mm_add_ps(value, _mm_set1_ps(0.5f)));
+  const __m128i shorts = _mm_packs_epi32(ints, ints);
+  const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(shorts, shorts));
+  memcpy(dst, &packed, sizeof(packed));
+}
+
+BLI_INLINE ScalePixel scale_pixel_zero()
+{
+  return _mm_setzero_ps();
+}
+
+BLI_INLINE ScalePixel scale_pixel_madd(const ScalePixel a, const ScalePixel b, const float f)
+{
+  return _mm_add_ps(a, _mm_mul_ps(b, _mm_set1_ps(f)));
+}
+
+BLI_INLINE ScalePixel scale_pixel_sub(const ScalePixel a, const ScalePixel b)
+{
+  return _mm_sub_ps(a, b);
+}
+
+BLI_INLINE ScalePixel scale_pixel_div(const ScalePixel a, const float f)
+{
+  return _mm_div_ps(a, _mm_set1_ps(f));
+}
+#else
+struct ScalePixel {
+  float v[4];
+};
+
+BLI_INLINE ScalePixel scale_pixel_load(const float *src)
+{
+  return {{src[0], src[1], src[2], src[3]}};
+}
+
+BLI_INLINE ScalePixel scale_pixel_load(const uchar *src)
+{
+  return {{float(src[0]), float(src[1]), float(src[2]), float(src[3])}};
+}
+
+BLI_INLINE void scale_pixel_store(float *dst, const ScalePixel value)
+{
+  memcpy(dst, value.v, sizeof(value.v));
+}
+
+BLI_INLINE void scale_pixel_store(uchar *dst, const ScalePixel value)
+{
+  for (int i = 0; i < 4; i++) {
+    dst[i] = uchar(min_ff(value.v[i] + 0.5f, 255.0f));
   }
+}
 
-  if (do_rect) {
-    _newrect = static_cast<uchar *>(MEM_mallocN(sizeof(uchar[4]) * newx * ibuf->y, "scaledownx"));
-    if (_newrect == nullptr) {
-      return ibuf;
+BLI_INLINE ScalePixel scale_pixel_zero()
+{
+  return {{0.0f, 0.0f, 0.0f, 0.0f}};
+}
+
+BLI_INLINE ScalePixel scale_pixel_madd(const ScalePixel a, const ScalePixel b, const float f)
+{
+  return {{a.v[0] + b.v[0] * f, a.v[1] + b.v[1] * f, a.v[2] + b.v[2] * f, a.v[3] + b.v[3] * f}};
+}
+
+BLI_INLINE ScalePixel scale_pixel_sub(const ScalePixel a, const ScalePixel b)
+{
+  return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+}
+
+BLI_INLINE ScalePixel scale_pixel_div(const ScalePixel a, const float f)
+{
+  return {{a.v[0] / f, a.v[1] / f, a.v[2] / f, a.v[3] / f}};
+}
+#endif
+
+/**
+ * Source pixels and their weights for every destination pixel of a box filter, the destination
+ * pixel `i` is the weighted sum of the source pixels starting at `first[i]`, divided by `add`.
+ */
+struct ScaleDownWeights {
+  blender::Array<int> first;
+  blender::Array<int> offsets;
+  blender::Vector<float> weights;
+  float add;
+};
+
+/**
+ * Sums up a window of `add` source pixels for every destination pixel. The first and the last
+ * pixel of the window are partially covered.
+ */
+ScaleDownWeights scale_down_weights_compute(const int src_len, const int dst_len)
+{
+  ScaleDownWeights result;
+  result.first.reinitialize(dst_len);
+  result.offsets.reinitialize(dst_len + 1);
+  result.add = (src_len - 0.01) / dst_len;
+
+  float sample = 0.0f;
+  int src = 0;
+  for (int i = 0; i < dst_len; i++) {
+    result.offsets[i] = result.weights.size();
+    /* Remainder of the last pixel of the previous window. */
+    if (i > 0) {
+      result.first[i] = src - 1;
+      result.weights.append(-sample);
     }
-  }
-  if (do_float) {
-    _newrectf = static_cast<float *>(
-        MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaledownxf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
+    else {
+      result.first[i] = src;
     }
-  }
-
-  add = (ibuf->x - 0.01) / newx;
 
-  if (do_rect) {
-    rect = ibuf->byte_buffer.data;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->float_buffer.data;
-    newrectf = _newrectf;
+    sample += result.add;
+    while (sample >= 1.0f) {
+      sample -= 1.0f;
+      result.weights.append(1.0f);
+      src++;
+    }
+    result.weights.append(sample);
+    src++;
+    sample -= 1.0f;
   }
+  result.offsets[dst_len] = result.weights.size();
 
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
+  /* Floating point errors must not make the window read past the end of the source. */
+  for (int i = 0; i < dst_len; i++) {
+    const int len = result.offsets[i + 1] - result.offsets[i];
+    result.offsets[i + 1] = result.offsets[i] + std::min(len, src_len - result.first[i]);
+  }
+  return result;
+}
 
-      sample += add;
+/** Source pixel and interpolation factor for every destination pixel of a linear filter. */
+struct ScaleUpWeights {
+  blender::Array<int> first;
+  blender::Array<float> factors;
+};
 
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
+ScaleUpWeights scale_up_weights_compute(const int src_len, const int dst_len)
+{
+  ScaleUpWeights result;
+  result.first.reinitialize(dst_len);
+  result.factors.reinitialize(dst_len);
+
+  /* Images that are one pixel wide only repeat that pixel. */
+  const float add = (src_len > 1) ? (src_len - 1.001) / (dst_len - 1.0) : 0.0f;
+  float sample = 0.0f;
+  int src = 0;
+  for (int i = 0; i < dst_len; i++) {
+    if (sample >= 1.0f) {
+      sample -= 1.0f;
+      src++;
+    }
+    result.first[i] = std::min(src, src_len - 1);
+    result.factors[i] = sample;
+    sample += add;
+  }
+  return result;
+}
 
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
+template<typename T>
+void scale_down_x_rows(const T *src,
+                       T *dst,
+                       const int src_width,
+                       const int dst_width,
+                       const int height,
+                       const ScaleDownWeights &weights)
+{
+  using namespace blender;
+  threading::parallel_for(IndexRange(height), 16, [&](const IndexRange rows) {
+    for (const int y : rows) {
+      const T *src_row = src + size_t(y) * src_width * 4;
+      T *dst_row = dst + size_t(y) * dst_width * 4;
+      for (int x = 0; x < dst_width; x++) {
+        const T *src_pixel = src_row + size_t(weights.first[x]) * 4;
+        ScalePixel value = scale_pixel_zero();
+        for (int i = weights.offsets[x]; i < weights.offsets[x + 1]; i++) {
+          value = scale_pixel_madd(value, scale_pixel_load(src_pixel), weights.weights[i]);
+          src_pixel += 4;
         }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
+        scale_pixel_store(dst_row + size_t(x) * 4, scale_pixel_div(value, weights.add));
+      }
+    }
+  });
+}
+
+template<typename T>
+void scale_down_y_rows(const T *src,
+                       T *dst,
+                       const int width,
+                       const int dst_height,
+                       const ScaleDownWeights &weights)
+{
+  using namespace blender;
+  const size_t row_stride = size_t(width) * 4;
+  threading::parallel_for(IndexRange(dst_height), 16, [&](const IndexRange rows) {
+    for (const int y : rows) {
+      const T *src_first = src + size_t(weights.first[y]) * row_stride;
+      T *dst_row = dst + size_t(y) * row_stride;
+      for (int x = 0; x < width; x++) {
+        const T *src_pixel = src_first + size_t(x) * 4;
+        ScalePixel value = scale_pixel_zero();
+        for (int i = weights.offsets[y]; i < weights.offsets[y + 1]; i++) {
+          value = scale_pixel_madd(value, scale_pixel_load(src_pixel), weights.weights[i]);
+          src_pixel += row_stride;
         }
+        scale_pixel_store(dst_row + size_t(x) * 4, scale_pixel_div(value, weights.add));
       }
+    }
+  });
+}
 
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += 4;
+template<typename T>
+void scale_up_x_rows(const T *src,
+                     T *dst,
+                     const int src_width,
+                     const int dst_width,
+                     const int height,
+                     const ScaleUpWeights &weights)
+{
+  using namespace blender;
+  threading::parallel_for(IndexRange(height), 16, [&](const IndexRange rows) {
+    for (const int y : rows) {
+      const T *src_row = src + size_t(y) * src_width * 4;
+      T *dst_row = dst + size_t(y) * dst_width * 4;
+      for (int x = 0; x < dst_width; x++) {
+        const int first = weights.first[x];
+        const int next = std::min(first + 1, src_width - 1);
+        const ScalePixel val = scale_pixel_load(src_row + size_t(first) * 4);
+        const ScalePixel nval = scale_pixel_load(src_row + size_t(next) * 4);
+        scale_pixel_store(dst_row + size_t(x) * 4,
+                          scale_pixel_madd(val, scale_pixel_sub(nval, val), weights.factors[x]));
       }
-      if (do_float) {
+    }
+  });
+}
 
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
+template<typename T>
+void scale_up_y_rows(const T *src,
+                     T *dst,
+                     const int width,
+                     const int src_height,
+                     const int dst_height,
+                     const ScaleUpWeights &weights)
+{
+  using namespace blender;
+  const size_t row_stride = size_t(width) * 4;
+  threading::parallel_for(IndexRange(dst_height), 16, [&](const IndexRange rows) {
+    for (const int y : rows) {
+      const int first = weights.first[y];
+      const int next = std::min(first + 1, src_height - 1);
+      const T *src_row = src + size_t(first) * row_stride;
+      const T *src_next_row = src + size_t(next) * row_stride;
+      T *dst_row = dst + size_t(y) * row_stride;
+      const float factor = weights.factors[y];
+      for (int x = 0; x < width; x++) {
+        const ScalePixel val = scale_pixel_load(src_row + size_t(x) * 4);
+        const ScalePixel nval = scale_pixel_load(src_next_row + size_t(x) * 4);
+        scale_pixel_store(dst_row + size_t(x) * 4,
+                          scale_pixel_madd(val, scale_pixel_sub(nval, val), factor));
+      }
+    }
+  });
+}
 
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+}  // namespace
 
-        newrectf += 4;
-      }
+static ImBuf *scaledownx(ImBuf *ibuf, int newx)
+{
+  const bool do_rect = (ibuf->byte_buffer.data != nullptr);
+  const bool do_float = (ibuf->float_buffer.data != nullptr);
 
-      sample -= 1.0f;
-    }
+  if (!do_rect && !do_float) {
+    return ibuf;
   }
 
+  const ScaleDownWeights weights = scale_down_weights_compute(ibuf->x, newx);
+
   if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ibuf->byte_buffer.data, rect_size);
-    BLI_assert((uchar *)rect - ibuf->byte_buffer.data == rect_size); /* see bug #26502. */
+    uchar *newrect = static_cast<uchar *>(
+        MEM_mallocN(sizeof(uchar[4]) * newx * ibuf->y, "scaledownx"));
+    scale_down_x_rows(ibuf->byte_buffer.data, newrect, ibuf->x, newx, ibuf->y, weights);
 
     imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
+    IMB_assign_byte_buffer(ibuf, newrect, IB_TAKE_OWNERSHIP);
   }
   if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->float_buffer.data, rect_size);
-    BLI_assert((rectf - ibuf->float_buffer.data) == rect_size); /* see bug #26502. */
+    float *newrectf = static_cast<float *>(
+        MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaledownxf"));
+    scale_down_x_rows(ibuf->float_buffer.data, newrectf, ibuf->x, newx, ibuf->y, weights);
 
     imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
+    IMB_assign_float_buffer(ibuf, newrectf, IB_TAKE_OWNERSHIP);
   }
 
-  (void)rect_size; /* UNUSED in release builds */
-
   ibuf->x = newx;
   return ibuf;
 }
@@ -1024,153 +1217,36 @@ static ImBuf *scaledowny(ImBuf *ibuf, int newy)
 {
   const bool do_rect = (ibuf->byte_buffer.data != nullptr);
   const bool do_float = (ibuf->float_buffer.data != nullptr);
-  const size_t rect_size = IMB_get_rect_len(ibuf) * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = nullptr;
-  rect = _newrect = newrect = nullptr;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
 
   if (!do_rect && !do_float) {
     return ibuf;
   }
 
-  if (do_rect) {
-    _newrect = static_cast<uchar *>(MEM_mallocN(sizeof(uchar[4]) * newy * ibuf->x, "scaledowny"));
-    if (_newrect == nullptr) {
-      return ibuf;
-    }
-  }
-  if (do_float) {
-    _newrectf = static_cast<float *>(
-        MEM_mallocN(sizeof(float[4]) * newy * ibuf->x, "scaledownyf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
-
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ibuf->byte_buffer.data + x;
-      newrect = _newrect + x;
-    }
-    if (do_float) {
-      rectf = ibuf->float_buffer.data + x;
-      newrectf = _newrectf + x;
-    }
-
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
-        }
-      }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += skipx;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
-      }
-
-      sample -= 1.0f;
-    }
-  }
+  const ScaleDownWeights weights = scale_down_weights_compute(ibuf->y, newy);
 
   if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - byte_buffer.data, rect_size);
-    BLI_assert((uchar *)rect - ibuf->byte_buffer.data == rect_size); /* see bug #26502. */
+    uchar *newrect = static_cast<uchar *>(
+        MEM_mallocN(sizeof(uchar[4]) * newy * ibuf->x, "scaledowny"));
+    scale_down_y_rows(ibuf->byte_buffer.data, newrect, ibuf->x, newy, weights);
 
     imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
+    IMB_assign_byte_buffer(ibuf, newrect, IB_TAKE_OWNERSHIP);
   }
   if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->float_buffer.data, rect_size);
-    BLI_assert((rectf - ibuf->float_buffer.data) == rect_size); /* see bug #26502. */
+    float *newrectf = static_cast<float *>(
+        MEM_mallocN(sizeof(float[4]) * newy * ibuf->x, "scaledownyf"));
+    scale_down_y_rows(ibuf->float_buffer.data, newrectf, ibuf->x, newy, weights);
 
     imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
+    IMB_assign_float_buffer(ibuf, newrectf, IB_TAKE_OWNERSHIP);
   }
 
-  (void)rect_size; /* UNUSED in release builds */
-
   ibuf->y = newy;
   return ibuf;
 }
 
 static ImBuf *scaleupx(ImBuf *ibuf, int newx)
 {
-  uchar *rect, *_newrect = nullptr, *newrect;
-  float *rectf, *_newrectf = nullptr, *newrectf;
-  int x, y;
-  bool do_rect = false, do_float = false;
-
   if (ibuf == nullptr) {
     return nullptr;
   }
@@ -1178,186 +1254,23 @@ static ImBuf *scaleupx(ImBuf *ibuf, int newx)
     return ibuf;
   }
 
-  if (ibuf->byte_buffer.data) {
-    do_rect = true;
-    _newrect = static_cast<uchar *>(MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx"));
-    if (_newrect == nullptr) {
-      return ibuf;
-    }
-  }
-  if (ibuf->float_buffer.data) {
-    do_float = true;
-    _newrectf = static_cast<float *>(MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaleupxf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  rect = ibuf->byte_buffer.data;
-  rectf = ibuf->float_buffer.data;
-  newrect = _newrect;
-  newrectf = _newrectf;
+  const ScaleUpWeights weights = scale_up_weights_compute(ibuf->x, newx);
 
-  /* Special case, copy all columns, needed since the scaling logic assumes there is at least
-   * two rows to interpolate between causing out of bounds read for 1px images, see #70356. */
-  if (UNLIKELY(ibuf->x == 1)) {
-    if (do_rect) {
-      for (y = ibuf->y; y > 0; y--) {
-        for (x = newx; x > 0; x--) {
-          memcpy(newrect, rect, sizeof(char[4]));
-          newrect += 4;
-        }
-        rect += 4;
-      }
-    }
-    if (do_float) {
-      for (y = ibuf->y; y > 0; y--) {
-        for (x = newx; x > 0; x--) {
-          memcpy(newrectf, rectf, sizeof(float[4]));
-          newrectf += 4;
-        }
-        rectf += 4;
-      }
-    }
-  }
-  else {
-    const float add = (ibuf->x - 1.001) / (newx - 1.0);
-    float sample;
-
-    float val_a, nval_a, diff_a;
-    float val_b, nval_b, diff_b;
-    float val_g, nval_g, diff_g;
-    float val_r, nval_r, diff_r;
-    float val_af, nval_af, diff_af;
-    float val_bf, nval_bf, diff_bf;
-    float val_gf, nval_gf, diff_gf;
-    float val_rf, nval_rf, diff_rf;
-
-    val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-    val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-    val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-    val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-
-    for (y = ibuf->y; y > 0; y--) {
-
-      sample = 0;
-
-      if (do_rect) {
-        val_a = rect[0];
-        nval_a = rect[4];
-        diff_a = nval_a - val_a;
-        val_a += 0.5f;
-
-        val_b = rect[1];
-        nval_b = rect[5];
-        diff_b = nval_b - val_b;
-        val_b += 0.5f;
-
-        val_g = rect[2];
-        nval_g = rect[6];
-        diff_g = nval_g - val_g;
-        val_g += 0.5f;
-
-        val_r = rect[3];
-        nval_r = rect[7];
-        diff_r = nval_r - val_r;
-        val_r += 0.5f;
-
-        rect += 8;
-      }
-      if (do_float) {
-        val_af = rectf[0];
-        nval_af = rectf[4];
-        diff_af = nval_af - val_af;
-
-        val_bf = rectf[1];
-        nval_bf = rectf[5];
-        diff_bf = nval_bf - val_bf;
-
-        val_gf = rectf[2];
-        nval_gf = rectf[6];
-        diff_gf = nval_gf - val_gf;
-
-        val_rf = rectf[3];
-        nval_rf = rectf[7];
-        diff_rf = nval_rf - val_rf;
-
-        rectf += 8;
-      }
-      for (x = newx; x > 0; x--) {
-        if (sample >= 1.0f) {
-          sample -= 1.0f;
-
-          if (do_rect) {
-            val_a = nval_a;
-            nval_a = rect[0];
-            diff_a = nval_a - val_a;
-            val_a += 0.5f;
-
-            val_b = nval_b;
-            nval_b = rect[1];
-            diff_b = nval_b - val_b;
-            val_b += 0.5f;
-
-            val_g = nval_g;
-            nval_g = rect[2];
-            diff_g = nval_g - val_g;
-            val_g += 0.5f;
-
-            val_r = nval_r;
-            nval_r = rect[3];
-            diff_r = nval_r - val_r;
-            val_r += 0.5f;
-            rect += 4;
-          }
-          if (do_float) {
-            val_af = nval_af;
-            nval_af = rectf[0];
-            diff_af = nval_af - val_af;
-
-            val_bf = nval_bf;
-            nval_bf = rectf[1];
-            diff_bf = nval_bf - val_bf;
-
-            val_gf = nval_gf;
-            nval_gf = rectf[2];
-            diff_gf = nval_gf - val_gf;
-
-            val_rf = nval_rf;
-            nval_rf = rectf[3];
-            diff_rf = nval_rf - val_rf;
-            rectf += 4;
-          }
-        }
-        if (do_rect) {
-          newrect[0] = val_a + sample * diff_a;
-          newrect[1] = val_b + sample * diff_b;
-          newrect[2] = val_g + sample * diff_g;
-          newrect[3] = val_r + sample * diff_r;
-          newrect += 4;
-        }
-        if (do_float) {
-          newrectf[0] = val_af + sample * diff_af;
-          newrectf[1] = val_bf + sample * diff_bf;
-          newrectf[2] = val_gf + sample * diff_gf;
-          newrectf[3] = val_rf + sample * diff_rf;
-          newrectf += 4;
-        }
-        sample += add;
-      }
-    }
-  }
+  if (ibuf->byte_buffer.data) {
+    uchar *newrect = static_cast<uchar *>(
+        MEM_mallocN(sizeof(uchar[4]) * newx * ibuf->y, "scaleupx"));
+    scale_up_x_rows(ibuf->byte_buffer.data, newrect, ibuf->x, newx, ibuf->y, weights);
 
-  if (do_rect) {
     imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
+    IMB_assign_byte_buffer(ibuf, newrect, IB_TAKE_OWNERSHIP);
   }
-  if (do_float) {
+  if (ibuf->float_buffer.data) {
+    float *newrectf = static_cast<float *>(
+        MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaleupxf"));
+    scale_up_x_rows(ibuf->float_buffer.data, newrectf, ibuf->x, newx, ibuf->y, weights);
+
     imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
+    IMB_assign_float_buffer(ibuf, newrectf, IB_TAKE_OWNERSHIP);
   }
 
   ibuf->x = newx;
@@ -1366,11 +1279,6 @@ static ImBuf *scaleupx(ImBuf *ibuf, int newx)
 
 static ImBuf *scaleupy(ImBuf *ibuf, int newy)
 {
-  uchar *rect, *_newrect = nullptr, *newrect;
-  float *rectf, *_newrectf = nullptr, *newrectf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
-
   if (ibuf == nullptr) {
     return nullptr;
   }
@@ -1378,193 +1286,31 @@ static ImBuf *scaleupy(ImBuf *ibuf, int newy)
     return ibuf;
   }
 
-  if (ibuf->byte_buffer.data) {
-    do_rect = true;
-    _newrect = static_cast<uchar *>(MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy"));
-    if (_newrect == nullptr) {
-      return ibuf;
-    }
-  }
-  if (ibuf->float_buffer.data) {
-    do_float = true;
-    _newrectf = static_cast<float *>(MEM_mallocN(sizeof(float[4]) * ibuf->x * newy, "scaleupyf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  rect = ibuf->byte_buffer.data;
-  rectf = ibuf->float_buffer.data;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  skipx = 4 * ibuf->x;
-
-  /* Special case, copy all rows, needed since the scaling logic assumes there is at least
-   * two rows to interpolate between causing out of bounds read for 1px images, see #70356. */
-  if (UNLIKELY(ibuf->y == 1)) {
-    if (do_rect) {
-      for (y = newy; y > 0; y--) {
-        memcpy(newrect, rect, sizeof(char) * skipx);
-        newrect += skipx;
-      }
-    }
-    if (do_float) {
-      for (y = newy; y > 0; y--) {
-        memcpy(newrectf, rectf, sizeof(float) * skipx);
-        newrectf += skipx;
-      }
-    }
-  }
-  else {
-    const float add = (ibuf->y - 1.001) / (newy - 1.0);
-    float sample;
-
-    float val_a, nval_a, diff_a;
-    float val_b, nval_b, diff_b;
-    float val_g, nval_g, diff_g;
-    float val_r, nval_r, diff_r;
-    float val_af, nval_af, diff_af;
-    float val_bf, nval_bf, diff_bf;
-    float val_gf, nval_gf, diff_gf;
-    float val_rf, nval_rf, diff_rf;
-
-    val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-    val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-    val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-    val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-
-    for (x = ibuf->x; x > 0; x--) {
-      sample = 0;
-      if (do_rect) {
-        rect = ibuf->byte_buffer.data + 4 * (x - 1);
-        newrect = _newrect + 4 * (x - 1);
-
-        val_a = rect[0];
-        nval_a = rect[skipx];
-        diff_a = nval_a - val_a;
-        val_a += 0.5f;
-
-        val_b = rect[1];
-        nval_b = rect[skipx + 1];
-        diff_b = nval_b - val_b;
-        val_b += 0.5f;
-
-        val_g = rect[2];
-        nval_g = rect[skipx + 2];
-        diff_g = nval_g - val_g;
-        val_g += 0.5f;
-
-        val_r = rect[3];
-        nval_r = rect[skipx + 3];
-        diff_r = nval_r - val_r;
-        val_r += 0.5f;
-
-        rect += 2 * skipx;
-      }
-      if (do_float) {
-        rectf = ibuf->float_buffer.data + 4 * (x - 1);
-        newrectf = _newrectf + 4 * (x - 1);
-
-        val_af = rectf[0];
-        nval_af = rectf[skipx];
-        diff_af = nval_af - val_af;
-
-        val_bf = rectf[1];
-        nval_bf = rectf[skipx + 1];
-        diff_bf = nval_bf - val_bf;
-
-        val_gf = rectf[2];
-        nval_gf = rectf[skipx + 2];
-        diff_gf = nval_gf - val_gf;
+  const ScaleUpWeights weights = scale_up_weights_compute(ibuf->y, newy);
 
-        val_rf = rectf[3];
-        nval_rf = rectf[skipx + 3];
-        diff_rf = nval_rf - val_rf;
-
-        rectf += 2 * skipx;
-      }
-
-      for (y = newy; y > 0; y--) {
-        if (sample >= 1.0f) {
-          sample -= 1.0f;
-
-          if (do_rect) {
-            val_a = nval_a;
-            nval_a = rect[0];
-            diff_a = nval_a - val_a;
-            val_a += 0.5f;
-
-            val_b = nval_b;
-            nval_b = rect[1];
-            diff_b = nval_b - val_b;
-            val_b += 0.5f;
-
-            val_g = nval_g;
-            nval_g = rect[2];
-            diff_g = nval_g - val_g;
-            val_g += 0.5f;
-
-            val_r = nval_r;
-            nval_r = rect[3];
-            diff_r = nval_r - val_r;
-            val_r += 0.5f;
-            rect += skipx;
-          }
-          if (do_float) {
-            val_af = nval_af;
-            nval_af = rectf[0];
-            diff_af = nval_af - val_af;
-
-            val_bf = nval_bf;
-            nval_bf = rectf[1];
-            diff_bf = nval_bf - val_bf;
-
-            val_gf = nval_gf;
-            nval_gf = rectf[2];
-            diff_gf = nval_gf - val_gf;
-
-            val_rf = nval_rf;
-            nval_rf = rectf[3];
-            diff_rf = nval_rf - val_rf;
-            rectf += skipx;
-          }
-        }
-        if (do_rect) {
-          newrect[0] = val_a + sample * diff_a;
-          newrect[1] = val_b + sample * diff_b;
-          newrect[2] = val_g + sample * diff_g;
-          newrect[3] = val_r + sample * diff_r;
-          newrect += skipx;
-        }
-        if (do_float) {
-          newrectf[0] = val_af + sample * diff_af;
-          newrectf[1] = val_bf + sample * diff_bf;
-          newrectf[2] = val_gf + sample * diff_gf;
-          newrectf[3] = val_rf + sample * diff_rf;
-          newrectf += skipx;
-        }
-        sample += add;
-      }
-    }
-  }
+  if (ibuf->byte_buffer.data) {
+    uchar *newrect = static_cast<uchar *>(
+        MEM_mallocN(sizeof(uchar[4]) * ibuf->x * newy, "scaleupy"));
+    scale_up_y_rows(ibuf->byte_buffer.data, newrect, ibuf->x, ibuf->y, newy, weights);
 
-  if (do_rect) {
     imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
+    IMB_assign_byte_buffer(ibuf, newrect, IB_TAKE_OWNERSHIP);
   }
-  if (do_float) {
+  if (ibuf->float_buffer.data) {
+    float *newrectf = static_cast<float *>(
+        MEM_mallocN(sizeof(float[4]) * ibuf->x * newy, "scaleupyf"));
+    scale_up_y_rows(ibuf->float_buffer.data, newrectf, ibuf->x, ibuf->y, newy, weights);
+
     imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
+    IMB_assign_float_buffer(ibuf, newrectf, IB_TAKE_OWNERSHIP);
   }
 
   ibuf->y = newy;
   return ibuf;
 }
 
+/** \} */
+
 bool IMB_scaleImBuf(ImBuf *ibuf, uint newx, uint newy)
 {
   BLI_assert_msg(newx > 0 && newy > 0, "Images must be at least 1 on both dimensions!");
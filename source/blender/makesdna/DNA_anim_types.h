@@ -15,6 +15,18 @@
 #include "DNA_curve_types.h"
 #include "DNA_listBase.h"
 
+#ifdef __cplusplus
+namespace blender::bke {
+struct AnimationEvalPlan;
+struct FCurveRuntime;
+}  // namespace blender::bke
+using AnimationEvalPlanHandle = blender::bke::AnimationEvalPlan;
+using FCurveRuntimeHandle = blender::bke::FCurveRuntime;
+#else
+typedef struct AnimationEvalPlanHandle AnimationEvalPlanHandle;
+typedef struct FCurveRuntimeHandle FCurveRuntimeHandle;
+#endif
+
 /* ************************************************ */
 /* F-Curve DataTypes */
 
@@ -654,6 +666,9 @@ typedef struct FCurve {
   float color[3];
 
   float prev_norm_factor, prev_offset;
+
+  /** Runtime data, cached segments for batch evaluation. */
+  FCurveRuntimeHandle *runtime;
 } FCurve;
 
 /* user-editable flags/settings */
@@ -1145,6 +1160,8 @@ typedef struct AnimData {
 
   /** Runtime data, for depsgraph evaluation. */
   FCurve **driver_array;
+  /** Runtime data, resolved RNA paths of the active action on evaluated data-blocks. */
+  AnimationEvalPlanHandle *eval_plan;
 
   /* settings for animation evaluation */
   /** User-defined settings. */
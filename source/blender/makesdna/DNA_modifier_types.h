@@ -2372,6 +2372,8 @@ typedef enum NodesModifierPanelFlag {
 typedef enum NodesModifierBakeFlag {
   NODES_MODIFIER_BAKE_CUSTOM_SIMULATION_FRAME_RANGE = 1 << 0,
   NODES_MODIFIER_BAKE_CUSTOM_PATH = 1 << 1,
+  NODES_MODIFIER_BAKE_COMPRESS = 1 << 2,
+  NODES_MODIFIER_BAKE_DELTA_POSITIONS = 1 << 3,
 } NodesModifierBakeFlag;
 
 typedef enum NodesModifierBakeMode {
@@ -816,6 +816,8 @@ enum {
   SEQ_CACHE_PREFETCH_ENABLE = (1 << 10),
   SEQ_CACHE_DISK_CACHE_ENABLE = (1 << 11),
   SEQ_CACHE_STORE_THUMBNAIL = (1 << 12),
+  /** Store float images as half floats in the disk cache, only used in #UserDef. */
+  SEQ_CACHE_DISK_CACHE_HALF_FLOAT = (1 << 13),
 };
 
 /** #Sequence.color_tag. */
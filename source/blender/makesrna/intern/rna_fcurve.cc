@@ -1211,6 +1211,8 @@ static void rna_FModifierEnvelope_points_remove(
 
 static void rna_Keyframe_update(Main *bmain, Scene * /*scene*/, PointerRNA *ptr)
 {
+  /* The keyframe was edited in place, its F-Curve is not known here. */
+  BKE_fcurves_tag_keys_changed_all();
   rna_tag_animation_update(bmain, ptr->owner_id);
 }
 
@@ -1272,6 +1272,78 @@ static void rna_SequenceEditor_display_stack(ID *id,
   WM_main_add_notifier(NC_SCENE | ND_SEQUENCER, scene);
 }
 
+static PointerRNA rna_SequenceEditor_cache_statistics_get(PointerRNA *ptr)
+{
+  Scene *scene = (Scene *)ptr->owner_id;
+  SeqCacheStatistics *statistics = SEQ_cache_statistics_get(scene);
+  return rna_pointer_inherit_refine(ptr, &RNA_SequenceCacheStatistics, statistics);
+}
+
+static void rna_SequenceEditor_reset_cache_statistics(ID *id, Editing * /*ed*/)
+{
+  SEQ_cache_statistics_reset((Scene *)id);
+}
+
+static PointerRNA rna_SequenceCacheStatistics_type_get(PointerRNA *ptr,
+                                                       SeqCacheTypeStatistics *statistics)
+{
+  return rna_pointer_inherit_refine(ptr, &RNA_SequenceCacheTypeStatistics, statistics);
+}
+
+static PointerRNA rna_SequenceCacheStatistics_raw_get(PointerRNA *ptr)
+{
+  SeqCacheStatistics *statistics = (SeqCacheStatistics *)ptr->data;
+  return rna_SequenceCacheStatistics_type_get(ptr, &statistics->raw);
+}
+
+static PointerRNA rna_SequenceCacheStatistics_preprocessed_get(PointerRNA *ptr)
+{
+  SeqCacheStatistics *statistics = (SeqCacheStatistics *)ptr->data;
+  return rna_SequenceCacheStatistics_type_get(ptr, &statistics->preprocessed);
+}
+
+static PointerRNA rna_SequenceCacheStatistics_composite_get(PointerRNA *ptr)
+{
+  SeqCacheStatistics *statistics = (SeqCacheStatistics *)ptr->data;
+  return rna_SequenceCacheStatistics_type_get(ptr, &statistics->composite);
+}
+
+static PointerRNA rna_SequenceCacheStatistics_final_get(PointerRNA *ptr)
+{
+  SeqCacheStatistics *statistics = (SeqCacheStatistics *)ptr->data;
+  return rna_SequenceCacheStatistics_type_get(ptr, &statistics->final_out);
+}
+
+static PointerRNA rna_SequenceCacheStatistics_thumbnail_get(PointerRNA *ptr)
+{
+  SeqCacheStatistics *statistics = (SeqCacheStatistics *)ptr->data;
+  return rna_SequenceCacheStatistics_type_get(ptr, &statistics->thumbnail);
+}
+
+static int rna_SequenceCacheTypeStatistics_hits_get(PointerRNA *ptr)
+{
+  const SeqCacheTypeStatistics *statistics = (SeqCacheTypeStatistics *)ptr->data;
+  return int(std::min<int64_t>(statistics->hits, INT_MAX));
+}
+
+static int rna_SequenceCacheTypeStatistics_misses_get(PointerRNA *ptr)
+{
+  const SeqCacheTypeStatistics *statistics = (SeqCacheTypeStatistics *)ptr->data;
+  return int(std::min<int64_t>(statistics->misses, INT_MAX));
+}
+
+static int rna_SequenceCacheTypeStatistics_evictions_get(PointerRNA *ptr)
+{
+  const SeqCacheTypeStatistics *statistics = (SeqCacheTypeStatistics *)ptr->data;
+  return int(std::min<int64_t>(statistics->evictions, INT_MAX));
+}
+
+static float rna_SequenceCacheTypeStatistics_memory_get(PointerRNA *ptr)
+{
+  const SeqCacheTypeStatistics *statistics = (SeqCacheTypeStatistics *)ptr->data;
+  return float(double(statistics->bytes) / (1024.0 * 1024.0));
+}
+
 static bool modifier_seq_cmp_fn(Sequence *seq, void *arg_pt)
 {
   SequenceSearchData *data = static_cast<SequenceSearchData *>(arg_pt);
@@ -2544,6 +2616,14 @@ static void rna_def_editor(BlenderRNA *brna)
       "Render frames ahead of current frame in the background for faster playback");
   RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, nullptr);
 
+  prop = RNA_def_property(srna, "cache_statistics", PROP_POINTER, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_struct_type(prop, "SequenceCacheStatistics");
+  RNA_def_property_pointer_funcs(
+      prop, "rna_SequenceEditor_cache_statistics_get", nullptr, nullptr, nullptr);
+  RNA_def_property_ui_text(
+      prop, "Cache Statistics", "Usage statistics of the image cache, None if there is no cache");
+
   /* functions */
 
   func = RNA_def_function(srna, "display_stack", "rna_SequenceEditor_display_stack");
@@ -2552,6 +2632,77 @@ static void rna_def_editor(BlenderRNA *brna)
   parm = RNA_def_pointer(
       func, "meta_sequence", "Sequence", "Meta Sequence", "Meta to display its stack");
   RNA_def_parameter_flags(parm, PropertyFlag(0), PARM_REQUIRED);
+
+  func = RNA_def_function(
+      srna, "reset_cache_statistics", "rna_SequenceEditor_reset_cache_statistics");
+  RNA_def_function_flag(func, FUNC_USE_SELF_ID);
+  RNA_def_function_ui_description(func, "Reset the hit, miss and eviction counters of the cache");
+}
+
+static void rna_def_cache_type_statistics(BlenderRNA *brna)
+{
+  StructRNA *srna;
+  PropertyRNA *prop;
+
+  srna = RNA_def_struct(brna, "SequenceCacheTypeStatistics", nullptr);
+  RNA_def_struct_ui_text(
+      srna, "Sequence Cache Type Statistics", "Usage statistics of one type of cached images");
+
+  prop = RNA_def_property(srna, "hits", PROP_INT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_SequenceCacheTypeStatistics_hits_get", nullptr, nullptr);
+  RNA_def_property_ui_text(prop, "Hits", "Number of images that were found in the cache");
+
+  prop = RNA_def_property(srna, "misses", PROP_INT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(
+      prop, "rna_SequenceCacheTypeStatistics_misses_get", nullptr, nullptr);
+  RNA_def_property_ui_text(prop, "Misses", "Number of images that were not found in the cache");
+
+  prop = RNA_def_property(srna, "evictions", PROP_INT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(
+      prop, "rna_SequenceCacheTypeStatistics_evictions_get", nullptr, nullptr);
+  RNA_def_property_ui_text(
+      prop, "Evictions", "Number of images that were freed to stay within the memory limit");
+
+  prop = RNA_def_property(srna, "memory", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_float_funcs(
+      prop, "rna_SequenceCacheTypeStatistics_memory_get", nullptr, nullptr);
+  RNA_def_property_ui_text(prop, "Memory", "Memory used by the cached images, in megabytes");
+}
+
+static void rna_def_cache_statistics(BlenderRNA *brna)
+{
+  StructRNA *srna;
+  PropertyRNA *prop;
+
+  rna_def_cache_type_statistics(brna);
+
+  srna = RNA_def_struct(brna, "SequenceCacheStatistics", nullptr);
+  RNA_def_struct_ui_text(
+      srna, "Sequence Cache Statistics", "Usage statistics of the sequencer image cache");
+
+  struct {
+    const char *identifier;
+    const char *getter;
+    const char *name;
+  } types[] = {
+      {"raw", "rna_SequenceCacheStatistics_raw_get", "Raw"},
+      {"preprocessed", "rna_SequenceCacheStatistics_preprocessed_get", "Preprocessed"},
+      {"composite", "rna_SequenceCacheStatistics_composite_get", "Composite"},
+      {"final", "rna_SequenceCacheStatistics_final_get", "Final"},
+      {"thumbnail", "rna_SequenceCacheStatistics_thumbnail_get", "Thumbnail"},
+  };
+  for (const auto &type : types) {
+    prop = RNA_def_property(srna, type.identifier, PROP_POINTER, PROP_NONE);
+    RNA_def_property_flag(prop, PROP_NEVER_NULL);
+    RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+    RNA_def_property_struct_type(prop, "SequenceCacheTypeStatistics");
+    RNA_def_property_pointer_funcs(prop, type.getter, nullptr, nullptr, nullptr);
+    RNA_def_property_ui_text(prop, type.name, "");
+  }
 }
 
 static void rna_def_filter_video(StructRNA *srna)
@@ -3920,6 +4071,7 @@ void RNA_def_sequencer(BlenderRNA *brna)
   rna_def_strip_transform(brna);
 
   rna_def_sequence(brna);
+  rna_def_cache_statistics(brna);
   rna_def_editor(brna);
   rna_def_channel(brna);
 
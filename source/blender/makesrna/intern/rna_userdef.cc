@@ -5915,6 +5915,14 @@ static void rna_def_userdef_system(BlenderRNA *brna)
       "Disk Cache Compression Level",
       "Smaller compression will result in larger files, but less decoding overhead");
 
+  prop = RNA_def_property(srna, "use_sequencer_disk_cache_half_float", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(
+      prop, nullptr, "sequencer_disk_cache_flag", SEQ_CACHE_DISK_CACHE_HALF_FLOAT);
+  RNA_def_property_ui_text(prop,
+                           "Disk Cache Half Float",
+                           "Store float images with half precision, which makes cache files "
+                           "considerably smaller and faster to read and write");
+
   /* Sequencer proxy setup */
 
   prop = RNA_def_property(srna, "sequencer_proxy_setup", PROP_ENUM, PROP_NONE);
@@ -7052,6 +7060,21 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
       "Undo Legacy",
       "Use legacy undo (slower than the new default one, but may be more stable in some cases)");
 
+  prop = RNA_def_property(srna, "use_undo_id_change_tracking", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, nullptr, "use_undo_id_change_tracking", 1);
+  RNA_def_property_ui_text(prop,
+                           "Undo ID Change Tracking",
+                           "Don't write data-blocks that were not tagged for an update since the "
+                           "previous undo step, share their stored data instead. Changes that "
+                           "don't tag the data-block for an update can be missing from undo");
+
+  prop = RNA_def_property(srna, "use_parallel_blend_write", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, nullptr, "use_parallel_blend_write", 1);
+  RNA_def_property_ui_text(prop,
+                           "Parallel Blend File Writing",
+                           "Serialize independent data-blocks on multiple threads when saving "
+                           "blend files (uses more memory while saving)");
+
   prop = RNA_def_property(srna, "override_auto_resync", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, nullptr, "no_override_auto_resync", 1);
   RNA_def_property_ui_text(prop,
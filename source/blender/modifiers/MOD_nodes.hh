@@ -10,6 +10,9 @@ struct Object;
 namespace blender::bke::bake {
 struct ModifierCache;
 }
+namespace blender::nodes {
+class GeoNodesRealizeInstancesCaches;
+}
 namespace blender::nodes::geo_eval_log {
 class GeoModifierLog;
 }
@@ -35,6 +38,11 @@ struct NodesModifierRuntime {
    * used by the evaluated modifier.
    */
   std::shared_ptr<bke::bake::ModifierCache> cache;
+  /**
+   * Data of Realize Instances nodes from the last evaluation that is used to update their output
+   * incrementally. It's only stored on the evaluated modifier.
+   */
+  std::shared_ptr<nodes::GeoNodesRealizeInstancesCaches> realize_instances_caches;
 };
 
 }  // namespace blender
@@ -142,6 +142,26 @@ static bool is_disabled(const Scene * /*scene*/, ModifierData *md, bool /*use_re
   return !dtmd->ob_source || dtmd->ob_source->type != OB_MESH;
 }
 
+static void free_runtime_data(void *runtime_data)
+{
+  BKE_data_transfer_cache_free(static_cast<DataTransferCache *>(runtime_data));
+}
+
+static void free_data(ModifierData *md)
+{
+  free_runtime_data(md->runtime);
+  md->runtime = nullptr;
+}
+
+/** The geometry mappings are kept in the runtime data, to reuse them on the next evaluation. */
+static DataTransferCache *data_transfer_ensure_cache(DataTransferModifierData *dtmd)
+{
+  if (dtmd->modifier.runtime == nullptr) {
+    dtmd->modifier.runtime = BKE_data_transfer_cache_new();
+  }
+  return static_cast<DataTransferCache *>(dtmd->modifier.runtime);
+}
+
 #define DT_TYPES_AFFECT_MESH \
   (DT_TYPE_BWEIGHT_VERT | DT_TYPE_BWEIGHT_EDGE | DT_TYPE_CREASE | DT_TYPE_SHARP_EDGE | \
    DT_TYPE_LNOR | DT_TYPE_SHARP_FACE)
@@ -210,6 +230,7 @@ static Mesh *modify_mesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh
                                   dtmd->mix_factor,
                                   dtmd->defgrp_name,
                                   invert_vgroup,
+                                  data_transfer_ensure_cache(dtmd),
                                   &reports))
   {
     result->runtime->is_original_bmesh = false;
@@ -520,14 +541,14 @@ ModifierTypeInfo modifierType_DataTransfer = {
 
     /*init_data*/ init_data,
     /*required_data_mask*/ required_data_mask,
-    /*free_data*/ nullptr,
+    /*free_data*/ free_data,
     /*is_disabled*/ is_disabled,
     /*update_depsgraph*/ update_depsgraph,
     /*depends_on_time*/ nullptr,
     /*depends_on_normals*/ depends_on_normals,
     /*foreach_ID_link*/ foreach_ID_link,
     /*foreach_tex_link*/ nullptr,
-    /*free_runtime_data*/ nullptr,
+    /*free_runtime_data*/ free_runtime_data,
     /*panel_register*/ panel_register,
     /*blend_write*/ nullptr,
     /*blend_read*/ nullptr,
@@ -7,6 +7,7 @@
  */
 
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -14,6 +15,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_array.hh"
+#include "BLI_fileops.h"
 #include "BLI_listbase.h"
 #include "BLI_math_vector_types.hh"
 #include "BLI_multi_value_map.hh"
@@ -87,6 +89,7 @@
 #include "NOD_geometry.hh"
 #include "NOD_geometry_nodes_execute.hh"
 #include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_profiler.hh"
 #include "NOD_node_declaration.hh"
 
 #include "FN_field.hh"
@@ -1415,6 +1418,35 @@ class NodesModifierBakeParams : public nodes::GeoNodesBakeParams {
   }
 };
 
+/**
+ * Write the profile of one evaluation to the directory passed with
+ * `--debug-geometry-nodes-profile`, in a file named after the object, modifier and frame.
+ */
+static void write_profile(geo_log::GeoNodesProfiler &profiler,
+                          const NodesModifierData &nmd,
+                          const ModifierEvalContext &ctx)
+{
+  char filename[FILE_MAX];
+  SNPRINTF(filename,
+           "%s_%s_%04d.json",
+           ctx.object->id.name + 2,
+           nmd.modifier.name,
+           int(DEG_get_ctime(ctx.depsgraph)));
+  BLI_path_make_safe_filename(filename);
+  char filepath[FILE_MAX];
+  BLI_path_join(filepath, sizeof(filepath), G.geometry_nodes_profile_dir, filename);
+  if (!BLI_file_ensure_parent_dir_exists(filepath)) {
+    std::cerr << "Could not create directory for geometry nodes profile: " << filepath << "\n";
+    return;
+  }
+  std::ofstream stream(filepath);
+  if (!stream) {
+    std::cerr << "Could not write geometry nodes profile: " << filepath << "\n";
+    return;
+  }
+  profiler.write_trace(stream);
+}
+
 static void modifyGeometry(ModifierData *md,
                            const ModifierEvalContext *ctx,
                            bke::GeometrySet &geometry_set)
@@ -1494,6 +1526,21 @@ static void modifyGeometry(ModifierData *md,
   find_side_effect_nodes(*nmd, *ctx, side_effect_nodes);
   call_data.side_effect_nodes = &side_effect_nodes;
 
+  if (!nmd->runtime->realize_instances_caches) {
+    nmd->runtime->realize_instances_caches =
+        std::make_shared<nodes::GeoNodesRealizeInstancesCaches>();
+  }
+  nodes::GeoNodesRealizeInstancesCaches &realize_instances_caches =
+      *nmd->runtime->realize_instances_caches;
+  realize_instances_caches.begin_evaluation();
+  call_data.realize_instances_caches = &realize_instances_caches;
+
+  std::optional<geo_log::GeoNodesProfiler> profiler;
+  if (G.geometry_nodes_profile_dir[0] != '\0') {
+    profiler.emplace();
+    call_data.profiler = &*profiler;
+  }
+
   bke::ModifierComputeContext modifier_compute_context{nullptr, nmd->modifier.name};
 
   geometry_set = nodes::execute_geometry_nodes_on_geometry(tree,
@@ -1501,6 +1548,11 @@ static void modifyGeometry(ModifierData *md,
                                                            modifier_compute_context,
                                                            call_data,
                                                            std::move(geometry_set));
+  realize_instances_caches.end_evaluation();
+
+  if (profiler) {
+    write_profile(*profiler, *nmd, *ctx);
+  }
 
   if (logging_enabled(ctx)) {
     nmd_orig->runtime->eval_log = std::move(eval_log);
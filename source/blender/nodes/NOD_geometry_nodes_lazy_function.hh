@@ -20,6 +20,7 @@
  * #lazy_function::Graph is build that can be used when evaluating the graph (e.g. for logging).
  */
 
+#include <mutex>
 #include <variant>
 
 #include "FN_lazy_function_graph.hh"
@@ -37,6 +38,14 @@ struct Object;
 struct Depsgraph;
 struct Scene;
 
+namespace blender::geometry {
+class RealizeInstancesCache;
+}
+
+namespace blender::nodes::geo_eval_log {
+class GeoNodesProfiler;
+}
+
 namespace blender::nodes {
 
 using lf::LazyFunction;
@@ -150,6 +159,34 @@ struct GeoNodesSideEffectNodes {
   MultiValueMap<std::pair<ComputeContextHash, int32_t>, int> iterations_by_repeat_zone;
 };
 
+/**
+ * Caches of Realize Instances nodes that update their output incrementally. They are owned by the
+ * caller of geometry nodes, so that they can be used again in the next evaluation. Caches of
+ * nodes that are not evaluated anymore are freed at the end of an evaluation.
+ */
+class GeoNodesRealizeInstancesCaches {
+ private:
+  using Key = std::pair<ComputeContextHash, int32_t>;
+
+  std::mutex mutex_;
+  /** Caches from the previous evaluation that have not been used in this evaluation yet. */
+  Map<Key, std::shared_ptr<geometry::RealizeInstancesCache>> previous_caches_;
+  Map<Key, std::shared_ptr<geometry::RealizeInstancesCache>> caches_;
+
+ public:
+  /** Has to be called before every evaluation. */
+  void begin_evaluation();
+  /** Frees the caches that have not been used in the evaluation. */
+  void end_evaluation();
+
+  /**
+   * Get the cache for the node in the given compute context. Null is returned when the cache has
+   * been used in the current evaluation already.
+   */
+  geometry::RealizeInstancesCache *lookup_or_add(const ComputeContextHash &context_hash,
+                                                 int32_t node_id);
+};
+
 /**
  * Data that is passed into geometry nodes evaluation from the modifier.
  */
@@ -200,6 +237,15 @@ struct GeoNodesCallData {
    * If this is null, all socket values will be logged.
    */
   const Set<ComputeContextHash> *socket_log_contexts = nullptr;
+  /**
+   * Optional persistent caches that allow Realize Instances nodes to update their output
+   * incrementally.
+   */
+  GeoNodesRealizeInstancesCaches *realize_instances_caches = nullptr;
+  /**
+   * Optional profiler that records when and on which thread every node is executed.
+   */
+  geo_eval_log::GeoNodesProfiler *profiler = nullptr;
 
   /**
    * Data from the modifier that is being evaluated.
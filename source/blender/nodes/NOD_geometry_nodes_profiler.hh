@@ -0,0 +1,77 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup nodes
+ *
+ * The profiler records detailed information about every node execution during an evaluation of
+ * geometry nodes: on which thread and when it ran, how long it waited for its inputs and how the
+ * memory usage changed in the mean time. The result can be written to a file in the Chrome trace
+ * event format, which can be viewed with `chrome://tracing` or https://ui.perfetto.dev.
+ *
+ * In contrast to the execution times in #GeoModifierLog, which are only used to draw the run time
+ * of every node in the node editor, the profiler is meant to find bottlenecks in large node trees
+ * that are evaluated on many threads, e.g. nodes that stall the evaluation because many other
+ * nodes wait for them.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <iosfwd>
+
+#include "BLI_compute_context.hh"
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_vector.hh"
+
+#include "NOD_geometry_nodes_log.hh"
+
+struct bNode;
+
+namespace blender::nodes::geo_eval_log {
+
+class GeoNodesProfiler {
+ public:
+  struct NodeExecution {
+    ComputeContextHash context_hash;
+    const bNode *node;
+    TimePoint start;
+    TimePoint end;
+    /**
+     * Memory usage of the whole process before and after the execution. When other nodes are
+     * executed at the same time, their allocations are included.
+     */
+    int64_t memory_before;
+    int64_t memory_after;
+  };
+
+ private:
+  /** Logged when a node could not be executed yet, because some of its inputs are missing. */
+  struct NodeWait {
+    ComputeContextHash context_hash;
+    int32_t node_id;
+    TimePoint time;
+  };
+
+  struct ThreadLog {
+    int thread_index;
+    Vector<NodeExecution> executions;
+    Vector<NodeWait> waits;
+  };
+
+  TimePoint start_time_;
+  std::atomic<int> threads_num_ = 0;
+  threading::EnumerableThreadSpecific<ThreadLog> thread_logs_;
+
+ public:
+  GeoNodesProfiler();
+
+  void log_node_wait(const ComputeContextHash &context_hash, const bNode &node);
+  void log_node_execution(const NodeExecution &execution);
+
+  /** Write everything that has been logged as Chrome trace JSON. */
+  void write_trace(std::ostream &stream);
+};
+
+}  // namespace blender::nodes::geo_eval_log
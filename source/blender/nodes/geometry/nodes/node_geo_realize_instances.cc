@@ -9,23 +9,64 @@
 #include "UI_interface.hh"
 #include "UI_resources.hh"
 
+#include <fmt/format.h>
+
 namespace blender::nodes::node_geo_realize_instances_cc {
 
 static void node_declare(NodeDeclarationBuilder &b)
 {
   b.add_input<decl::Geometry>("Geometry");
+  b.add_input<decl::Bool>("Incremental")
+      .description(
+          "Keep the realized geometry until the next evaluation and only copy instances that "
+          "changed since then. Only meshes are updated incrementally");
   b.add_output<decl::Geometry>("Geometry").propagate_all();
 }
 
+static geometry::RealizeInstancesCache *get_realize_instances_cache(
+    const GeoNodeExecParams &params)
+{
+  const GeoNodesLFUserData *user_data = params.user_data();
+  GeoNodesRealizeInstancesCaches *caches = user_data->call_data->realize_instances_caches;
+  if (caches == nullptr) {
+    return nullptr;
+  }
+  return caches->lookup_or_add(user_data->compute_context->hash(), params.node().identifier);
+}
+
+static void log_incremental_update(const GeoNodeExecParams &params,
+                                   const geometry::RealizeInstancesCache &cache,
+                                   const std::chrono::nanoseconds duration)
+{
+  geo_eval_log::GeoTreeLogger *tree_logger = params.get_local_tree_logger();
+  if (tree_logger == nullptr) {
+    return;
+  }
+  const std::string message = fmt::format("Updated {} of {} instances in {:.2f} ms",
+                                          cache.updated_mesh_instances_num,
+                                          cache.mesh_instances_num,
+                                          double(duration.count()) / 1e6);
+  tree_logger->debug_messages.append(
+      {params.node().identifier, tree_logger->allocator->copy_string(message)});
+}
+
 static void node_geo_exec(GeoNodeExecParams params)
 {
   GeometrySet geometry_set = params.extract_input<GeometrySet>("Geometry");
+  const bool incremental = params.extract_input<bool>("Incremental");
   GeometryComponentEditData::remember_deformed_positions_if_necessary(geometry_set);
   geometry::RealizeInstancesOptions options;
   options.keep_original_ids = false;
   options.realize_instance_attributes = true;
   options.propagation_info = params.get_output_propagation_info("Geometry");
+  if (incremental) {
+    options.cache = get_realize_instances_cache(params);
+  }
+  const geo_eval_log::TimePoint start_time = geo_eval_log::Clock::now();
   geometry_set = geometry::realize_instances(geometry_set, options);
+  if (options.cache) {
+    log_incremental_update(params, *options.cache, geo_eval_log::Clock::now() - start_time);
+  }
   params.set_output("Geometry", std::move(geometry_set));
 }
 
@@ -885,6 +885,14 @@ static void node_layout_ex(uiLayout *layout, bContext *C, PointerRNA *ptr)
       uiItemR(subcol, &bake_rna, "frame_start", UI_ITEM_NONE, "Start", ICON_NONE);
       uiItemR(subcol, &bake_rna, "frame_end", UI_ITEM_NONE, "End", ICON_NONE);
     }
+    {
+      uiLayout *col = uiLayoutColumn(settings_col, true);
+      uiItemR(col, &bake_rna, "use_compression", UI_ITEM_NONE, "Compress", ICON_NONE);
+      uiLayout *subcol = uiLayoutColumn(col, true);
+      uiLayoutSetActive(subcol, bake->flag & NODES_MODIFIER_BAKE_COMPRESS);
+      uiItemR(
+          subcol, &bake_rna, "use_delta_positions", UI_ITEM_NONE, "Delta Positions", ICON_NONE);
+    }
   }
 }
 
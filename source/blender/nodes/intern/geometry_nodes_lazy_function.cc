@@ -22,6 +22,7 @@
 
 #include "NOD_geometry_exec.hh"
 #include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_profiler.hh"
 #include "NOD_multi_function.hh"
 #include "NOD_node_declaration.hh"
 
@@ -49,6 +50,8 @@
 
 #include "DEG_depsgraph_query.hh"
 
+#include "GEO_realize_instances.hh"
+
 #include <fmt/format.h>
 #include <sstream>
 
@@ -311,7 +314,11 @@ class LazyFunctionForGeometryNode : public LazyFunction {
         missing_input = true;
       }
     }
+    geo_eval_log::GeoNodesProfiler *profiler = user_data->call_data->profiler;
     if (missing_input) {
+      if (profiler) {
+        profiler->log_node_wait(user_data->compute_context->hash(), node_);
+      }
       /* Wait until all inputs are available. */
       return;
     }
@@ -324,10 +331,20 @@ class LazyFunctionForGeometryNode : public LazyFunction {
         own_lf_graph_info_.mapping.lf_input_index_for_attribute_propagation_to_output,
         get_output_attribute_id};
 
+    const int64_t memory_before = profiler ? int64_t(MEM_get_memory_in_use()) : 0;
     geo_eval_log::TimePoint start_time = geo_eval_log::Clock::now();
     node_.typeinfo->geometry_node_execute(geo_params);
     geo_eval_log::TimePoint end_time = geo_eval_log::Clock::now();
 
+    if (profiler) {
+      profiler->log_node_execution({user_data->compute_context->hash(),
+                                    &node_,
+                                    start_time,
+                                    end_time,
+                                    memory_before,
+                                    int64_t(MEM_get_memory_in_use())});
+    }
+
     if (geo_eval_log::GeoTreeLogger *tree_logger = local_user_data.try_get_tree_logger(*user_data))
     {
       tree_logger->node_execution_times.append({node_.identifier, start_time, end_time});
@@ -4243,6 +4260,37 @@ std::optional<FoundNestedNodeID> find_nested_node_id(const GeoNodesLFUserData &u
   return found;
 }
 
+void GeoNodesRealizeInstancesCaches::begin_evaluation()
+{
+  std::lock_guard lock{mutex_};
+  previous_caches_ = std::move(caches_);
+  caches_.clear();
+}
+
+void GeoNodesRealizeInstancesCaches::end_evaluation()
+{
+  std::lock_guard lock{mutex_};
+  previous_caches_.clear();
+}
+
+geometry::RealizeInstancesCache *GeoNodesRealizeInstancesCaches::lookup_or_add(
+    const ComputeContextHash &context_hash, const int32_t node_id)
+{
+  const Key key{context_hash, node_id};
+  std::lock_guard lock{mutex_};
+  if (caches_.contains(key)) {
+    return nullptr;
+  }
+  std::shared_ptr<geometry::RealizeInstancesCache> cache =
+      previous_caches_.pop_default(key, nullptr);
+  if (!cache) {
+    cache = std::make_shared<geometry::RealizeInstancesCache>();
+  }
+  geometry::RealizeInstancesCache *cache_ptr = cache.get();
+  caches_.add_new(key, std::move(cache));
+  return cache_ptr;
+}
+
 const Object *GeoNodesCallData::self_object() const
 {
   if (this->modifier_data) {
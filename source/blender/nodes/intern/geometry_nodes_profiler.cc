@@ -0,0 +1,170 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+#include <sstream>
+
+#include "BLI_map.hh"
+#include "BLI_serialize.hh"
+
+#include "DNA_node_types.h"
+
+#include "NOD_geometry_nodes_profiler.hh"
+
+namespace blender::nodes::geo_eval_log {
+
+namespace serialize = io::serialize;
+
+GeoNodesProfiler::GeoNodesProfiler()
+    : start_time_(Clock::now()), thread_logs_([&]() {
+        ThreadLog thread_log;
+        thread_log.thread_index = threads_num_.fetch_add(1);
+        return thread_log;
+      })
+{
+}
+
+void GeoNodesProfiler::log_node_wait(const ComputeContextHash &context_hash, const bNode &node)
+{
+  thread_logs_.local().waits.append({context_hash, node.identifier, Clock::now()});
+}
+
+void GeoNodesProfiler::log_node_execution(const NodeExecution &execution)
+{
+  thread_logs_.local().executions.append(execution);
+}
+
+/** Chrome traces use microseconds. */
+static double to_trace_time(const TimePoint time, const TimePoint start_time)
+{
+  return std::chrono::duration<double, std::micro>(time - start_time).count();
+}
+
+static std::string hash_to_string(const ComputeContextHash &hash)
+{
+  std::stringstream ss;
+  ss << hash;
+  return ss.str();
+}
+
+void GeoNodesProfiler::write_trace(std::ostream &stream)
+{
+  /* A node may try to run multiple times before all its inputs are available. Only the first
+   * attempt matters, because the node waits from then on. */
+  Map<std::pair<ComputeContextHash, int32_t>, TimePoint> wait_starts;
+  for (const ThreadLog &thread_log : thread_logs_) {
+    for (const NodeWait &wait : thread_log.waits) {
+      wait_starts.add_or_modify(
+          {wait.context_hash, wait.node_id},
+          [&](TimePoint *time) { *time = wait.time; },
+          [&](TimePoint *time) { *time = std::min(*time, wait.time); });
+    }
+  }
+
+  serialize::DictionaryValue root;
+  serialize::ArrayValue &events = *root.append_array("traceEvents");
+  TimePoint end_time = start_time_;
+  int64_t wait_id = 0;
+
+  auto append_event = [&](const StringRef name, const StringRef category, const char *phase) {
+    std::shared_ptr<serialize::DictionaryValue> event = events.append_dict();
+    event->append_str("name", name);
+    event->append_str("cat", category);
+    event->append_str("ph", phase);
+    event->append_int("pid", 0);
+    return event;
+  };
+
+  {
+    std::shared_ptr<serialize::DictionaryValue> event = append_event(
+        "process_name", "__metadata", "M");
+    event->append_dict("args")->append_str("name", "Geometry Nodes");
+  }
+
+  std::shared_ptr<serialize::DictionaryValue> occupancy = std::make_shared<
+      serialize::DictionaryValue>();
+  for (const ThreadLog &thread_log : thread_logs_) {
+    const std::string thread_name = "Thread " + std::to_string(thread_log.thread_index);
+    {
+      std::shared_ptr<serialize::DictionaryValue> event = append_event(
+          "thread_name", "__metadata", "M");
+      event->append_int("tid", thread_log.thread_index);
+      event->append_dict("args")->append_str("name", thread_name);
+    }
+
+    Vector<const NodeExecution *> executions;
+    for (const NodeExecution &execution : thread_log.executions) {
+      executions.append(&execution);
+    }
+    std::sort(executions.begin(), executions.end(), [](const auto *a, const auto *b) {
+      return a->start < b->start;
+    });
+
+    /* Time in which the thread executed nodes. Nested executions (when the thread executes other
+     * nodes while waiting for a multi-threaded node to finish) are only counted once. */
+    std::chrono::nanoseconds busy_time{0};
+    TimePoint busy_until = start_time_;
+
+    for (const NodeExecution *execution : executions) {
+      const bNode &node = *execution->node;
+      const bNodeTree &tree = node.owner_tree();
+      const double start = to_trace_time(execution->start, start_time_);
+      const double end = to_trace_time(execution->end, start_time_);
+      end_time = std::max(end_time, execution->end);
+      if (execution->end > busy_until) {
+        busy_time += execution->end - std::max(execution->start, busy_until);
+        busy_until = execution->end;
+      }
+
+      std::shared_ptr<serialize::DictionaryValue> event = append_event(
+          node.label_or_name(), "node", "X");
+      event->append_int("tid", thread_log.thread_index);
+      event->append_double("ts", start);
+      event->append_double("dur", end - start);
+      std::shared_ptr<serialize::DictionaryValue> args = event->append_dict("args");
+      args->append_str("tree", tree.id.name + 2);
+      args->append_str("type", node.idname);
+      args->append_str("context", hash_to_string(execution->context_hash));
+      args->append_int("memory_delta", execution->memory_after - execution->memory_before);
+
+      const TimePoint *wait_start = wait_starts.lookup_ptr(
+          {execution->context_hash, node.identifier});
+      if (wait_start != nullptr && *wait_start < execution->start) {
+        /* Show the time blocked on inputs as asynchronous event, so that it is displayed on a
+         * separate track. */
+        const double wait = to_trace_time(*wait_start, start_time_);
+        args->append_double("wait_ms", (start - wait) / 1000.0);
+        for (const auto &[phase, time] : {std::pair{"b", wait}, std::pair{"e", start}}) {
+          std::shared_ptr<serialize::DictionaryValue> wait_event = append_event(
+              node.label_or_name(), "wait", phase);
+          wait_event->append_int("tid", thread_log.thread_index);
+          wait_event->append_int("id", wait_id);
+          wait_event->append_double("ts", time);
+        }
+        wait_id++;
+      }
+
+      std::shared_ptr<serialize::DictionaryValue> memory_event = append_event(
+          "Memory", "memory", "C");
+      memory_event->append_double("ts", end);
+      memory_event->append_dict("args")->append_double(
+          "MB", double(execution->memory_after) / (1024.0 * 1024.0));
+    }
+    occupancy->append_double(thread_name,
+                             std::chrono::duration<double, std::milli>(busy_time).count());
+  }
+
+  std::shared_ptr<serialize::DictionaryValue> other_data = root.append_dict("otherData");
+  other_data->append_int("threads", threads_num_.load());
+  other_data->append_double("duration_ms",
+                            std::chrono::duration<double, std::milli>(end_time - start_time_)
+                                .count());
+  other_data->append("busy_ms", occupancy);
+  root.append_str("displayTimeUnit", "ms");
+
+  serialize::JsonFormatter formatter;
+  formatter.serialize(stream, root);
+}
+
+}  // namespace blender::nodes::geo_eval_log
@@ -8,6 +8,8 @@
  * \ingroup sequencer
  */
 
+#include <cstdint>
+
 struct ListBase;
 struct Main;
 struct MovieClip;
@@ -59,6 +61,32 @@ void SEQ_cache_iterate(
     void *userdata,
     bool callback_init(void *userdata, size_t item_count),
     bool callback_iter(void *userdata, Sequence *seq, int timeline_frame, int cache_type));
+
+struct SeqCacheTypeStatistics {
+  int64_t hits;
+  int64_t misses;
+  int64_t evictions;
+  /** Memory used by the images of this type currently in the cache. */
+  int64_t bytes;
+};
+
+struct SeqCacheStatistics {
+  SeqCacheTypeStatistics raw;
+  SeqCacheTypeStatistics preprocessed;
+  SeqCacheTypeStatistics composite;
+  SeqCacheTypeStatistics final_out;
+  SeqCacheTypeStatistics thumbnail;
+};
+
+/**
+ * Counters of the image cache of the scene, for tuning the cache settings.
+ * \return null when the scene has no cache (yet).
+ */
+SeqCacheStatistics *SEQ_cache_statistics_get(Scene *scene);
+/**
+ * Reset the hit, miss and eviction counters of the image cache.
+ */
+void SEQ_cache_statistics_reset(Scene *scene);
 /**
  * Return immediate parent meta of sequence.
  */
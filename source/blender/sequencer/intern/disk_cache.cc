@@ -6,9 +6,14 @@
  * \ingroup sequencer
  */
 
+#include <atomic>
 #include <cstddef>
+#include <cstring>
 #include <ctime>
 #include <memory.h>
+#include <string>
+
+#include <zstd.h>
 
 #include "MEM_guardedalloc.h"
 
@@ -20,6 +25,7 @@
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
@@ -27,9 +33,13 @@
 #include "BLI_fileops_types.h"
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_map.hh"
 #include "BLI_mempool.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
 
 #include "BKE_main.hh"
 #include "BKE_scene.h"
@@ -53,24 +63,43 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * ZLIB compression with user definable level can be used to compress image data(per image)
+ * Zstandard compression with user definable level can be used to compress image data (per
+ * image). The data is split into DCACHE_COMPRESS_CHUNK_SIZE chunks which are compressed and
+ * decompressed as independent frames on multiple threads.
+ * Float images can optionally be stored as half floats, with the bytes of each channel stored in
+ * separate planes (byte-shuffle) which compresses considerably better.
  * Images are written in order in which they are rendered.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
  * size specified in user preferences.
  * To distinguish 2 blend files with same name, scene->ed->disk_cache_timestamp
  * is used as UID. Blend file can still be copied manually which may cause conflict.
+ * When an image is read, the next DCACHE_READ_AHEAD_FRAMES frames of the strip are read and
+ * decompressed in the background, so that playback from the disk cache is not limited by
+ * decompression on the thread requesting the frames.
  */
 
 /* Format string:
  * `<cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf`. */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 2
+#define DCACHE_CURRENT_VERSION 3
+#define DCACHE_COMPRESS_CHUNK_SIZE (1 << 20)
+#define DCACHE_READ_AHEAD_FRAMES 4
+#define DCACHE_READ_AHEAD_MAX_IMAGES (DCACHE_READ_AHEAD_FRAMES * 4)
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in IMB intern. */
 
+/** #DiskCacheHeaderEntry.data_format */
+enum {
+  /** Image buffer data as is. */
+  DCACHE_DATA_FORMAT_DEFAULT = 0,
+  /** Float buffer stored as half floats, split into one plane per byte of each channel. */
+  DCACHE_DATA_FORMAT_HALF_SHUFFLE = 1,
+};
+
 struct DiskCacheHeaderEntry {
   uchar encoding;
+  uchar data_format;
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -82,12 +111,36 @@ struct DiskCacheHeader {
   DiskCacheHeaderEntry entry[DCACHE_IMAGES_PER_FILE];
 };
 
+struct DiskCacheReadAheadKey {
+  std::string filepath;
+  float frame_index;
+
+  uint64_t hash() const
+  {
+    return blender::get_default_hash_2(filepath, frame_index);
+  }
+
+  friend bool operator==(const DiskCacheReadAheadKey &a, const DiskCacheReadAheadKey &b)
+  {
+    return a.frame_index == b.frame_index && a.filepath == b.filepath;
+  }
+};
+
 struct SeqDiskCache {
   Main *bmain;
   int64_t timestamp;
   ListBase files;
   ThreadMutex read_write_mutex;
   size_t size_total;
+
+  /** Background pool reading and decompressing upcoming frames. */
+  TaskPool *read_ahead_pool;
+  /** Protects #read_ahead_images and #read_ahead_generation. */
+  ThreadMutex read_ahead_mutex;
+  /** Images read ahead, null while they are being read. */
+  blender::Map<DiskCacheReadAheadKey, ImBuf *> read_ahead_images;
+  /** Incremented on invalidation, read ahead tasks of older generations discard their result. */
+  int read_ahead_generation;
 };
 
 struct DiskCacheFile {
@@ -406,6 +459,17 @@ static void seq_disk_cache_delete_invalid_files(SeqDiskCache *disk_cache,
   }
 }
 
+/** Free all read ahead images. Must be called with #SeqDiskCache.read_ahead_mutex locked. */
+static void seq_disk_cache_read_ahead_clear(SeqDiskCache *disk_cache)
+{
+  for (ImBuf *ibuf : disk_cache->read_ahead_images.values()) {
+    if (ibuf) {
+      IMB_freeImBuf(ibuf);
+    }
+  }
+  disk_cache->read_ahead_images.clear();
+}
+
 void seq_disk_cache_invalidate(SeqDiskCache *disk_cache,
                                Scene *scene,
                                Sequence *seq,
@@ -423,43 +487,315 @@ void seq_disk_cache_invalidate(SeqDiskCache *disk_cache,
   seq_disk_cache_delete_invalid_files(disk_cache, scene, seq, invalidate_types, start, end);
 
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+  /* Read ahead images may be outdated now. */
+  BLI_mutex_lock(&disk_cache->read_ahead_mutex);
+  seq_disk_cache_read_ahead_clear(disk_cache);
+  disk_cache->read_ahead_generation++;
+  BLI_mutex_unlock(&disk_cache->read_ahead_mutex);
 }
 
-static size_t deflate_imbuf_to_file(ImBuf *ibuf,
-                                    FILE *file,
-                                    int level,
-                                    DiskCacheHeaderEntry *header_entry)
+static uint16_t seq_disk_cache_float_to_half(const float value)
 {
-  void *data = (ibuf->byte_buffer.data != nullptr) ? (void *)ibuf->byte_buffer.data :
-                                                     (void *)ibuf->float_buffer.data;
+  /* Round to nearest even, see "float_to_half_fast3_rtne" by Fabian Giesen. */
+  const uint32_t f32_infinity = 255u << 23;
+  const uint32_t f16_max = (127u + 16u) << 23;
+  const uint32_t denorm_magic_bits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const uint32_t sign = bits & 0x80000000u;
+  bits ^= sign;
+
+  uint16_t result;
+  if (bits >= f16_max) {
+    /* Overflow to infinity, NaN stays NaN. */
+    result = (bits > f32_infinity) ? 0x7e00 : 0x7c00;
+  }
+  else if (bits < (113u << 23)) {
+    /* Sub-normal or zero, let the FPU do the rounding with a magic value. */
+    float denorm_magic, f;
+    memcpy(&denorm_magic, &denorm_magic_bits, sizeof(denorm_magic));
+    memcpy(&f, &bits, sizeof(f));
+    f += denorm_magic;
+    memcpy(&bits, &f, sizeof(bits));
+    result = uint16_t(bits - denorm_magic_bits);
+  }
+  else {
+    const uint32_t mantissa_odd = (bits >> 13) & 1;
+    bits += (uint32_t(15 - 127) << 23) + 0xfff;
+    bits += mantissa_odd;
+    result = uint16_t(bits >> 13);
+  }
+  return result | uint16_t(sign >> 16);
+}
 
-  /* Apply compression if wanted, otherwise just write directly to the file. */
-  if (level > 0) {
-    return BLI_file_zstd_from_mem_at_pos(
-        data, header_entry->size_raw, file, header_entry->offset, level);
+static float seq_disk_cache_half_to_float(const uint16_t value)
+{
+  const uint32_t shifted_exponent = 0x7c00u << 13;
+  const uint32_t magic_bits = 113u << 23;
+
+  uint32_t bits = uint32_t(value & 0x7fff) << 13;
+  const uint32_t exponent = shifted_exponent & bits;
+  bits += (127u - 15u) << 23;
+
+  if (exponent == shifted_exponent) {
+    /* Infinity or NaN. */
+    bits += (128u - 16u) << 23;
+  }
+  else if (exponent == 0) {
+    /* Zero or sub-normal, re-normalize. */
+    float magic, f;
+    memcpy(&magic, &magic_bits, sizeof(magic));
+    bits += 1u << 23;
+    memcpy(&f, &bits, sizeof(f));
+    f -= magic;
+    memcpy(&bits, &f, sizeof(bits));
+  }
+
+  bits |= uint32_t(value & 0x8000) << 16;
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+/**
+ * Convert \a src to half floats, stored as one plane for the low and one for the high byte of
+ * each channel. Neighboring pixels usually have similar exponents, so this layout compresses
+ * much better than interleaved data.
+ */
+static void seq_disk_cache_shuffle_to_half(const float *src,
+                                           const int64_t pixels_num,
+                                           const int channels,
+                                           uchar *dst)
+{
+  using namespace blender;
+  threading::parallel_for(IndexRange(pixels_num), 64 * 1024, [&](const IndexRange range) {
+    for (const int c : IndexRange(channels)) {
+      uchar *plane_low = dst + (c * 2) * pixels_num;
+      uchar *plane_high = dst + (c * 2 + 1) * pixels_num;
+      for (const int64_t i : range) {
+        const uint16_t half = seq_disk_cache_float_to_half(src[i * channels + c]);
+        plane_low[i] = uchar(half & 0xff);
+        plane_high[i] = uchar(half >> 8);
+      }
+    }
+  });
+}
+
+static void seq_disk_cache_unshuffle_from_half(const uchar *src,
+                                               const int64_t pixels_num,
+                                               const int channels,
+                                               float *dst)
+{
+  using namespace blender;
+  threading::parallel_for(IndexRange(pixels_num), 64 * 1024, [&](const IndexRange range) {
+    for (const int c : IndexRange(channels)) {
+      const uchar *plane_low = src + (c * 2) * pixels_num;
+      const uchar *plane_high = src + (c * 2 + 1) * pixels_num;
+      for (const int64_t i : range) {
+        const uint16_t half = uint16_t(plane_low[i]) | (uint16_t(plane_high[i]) << 8);
+        dst[i * channels + c] = seq_disk_cache_half_to_float(half);
+      }
+    }
+  });
+}
+
+/**
+ * Compress \a data as independent Zstandard frames of #DCACHE_COMPRESS_CHUNK_SIZE, in parallel.
+ * The frames are concatenated, which is still a valid Zstandard stream.
+ * \return false on failure.
+ */
+static bool seq_disk_cache_compress(const blender::Span<uchar> data,
+                                    const int level,
+                                    blender::Vector<uchar> &r_compressed)
+{
+  using namespace blender;
+  const int64_t chunks_num = (data.size() + DCACHE_COMPRESS_CHUNK_SIZE - 1) /
+                             DCACHE_COMPRESS_CHUNK_SIZE;
+  Array<Vector<uchar>> chunks(chunks_num);
+  std::atomic<bool> error = false;
+
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    ZSTD_CCtx *ctx = ZSTD_createCCtx();
+    for (const int64_t i : range) {
+      const Span<uchar> chunk = data.slice_safe(i * DCACHE_COMPRESS_CHUNK_SIZE,
+                                                DCACHE_COMPRESS_CHUNK_SIZE);
+      chunks[i].resize(ZSTD_compressBound(chunk.size()));
+      const size_t size = ZSTD_compressCCtx(
+          ctx, chunks[i].data(), chunks[i].size(), chunk.data(), chunk.size(), level);
+      if (ZSTD_isError(size)) {
+        error = true;
+        break;
+      }
+      chunks[i].resize(size);
+    }
+    ZSTD_freeCCtx(ctx);
+  });
+
+  if (error) {
+    return false;
+  }
+
+  int64_t compressed_size = 0;
+  for (const Vector<uchar> &chunk : chunks) {
+    compressed_size += chunk.size();
+  }
+  r_compressed.reserve(compressed_size);
+  for (const Vector<uchar> &chunk : chunks) {
+    r_compressed.extend(chunk);
+  }
+  return true;
+}
+
+/**
+ * Decompress the frames written by #seq_disk_cache_compress in parallel.
+ * \return false when the data is corrupt or doesn't have the expected size.
+ */
+static bool seq_disk_cache_decompress(const blender::Span<uchar> compressed,
+                                      blender::MutableSpan<uchar> r_data)
+{
+  using namespace blender;
+  struct Frame {
+    Span<uchar> compressed;
+    MutableSpan<uchar> data;
+  };
+  Vector<Frame> frames;
+
+  int64_t offset = 0;
+  int64_t data_offset = 0;
+  while (offset < compressed.size()) {
+    const Span<uchar> remaining = compressed.drop_front(offset);
+    const size_t frame_size = ZSTD_findFrameCompressedSize(remaining.data(), remaining.size());
+    if (ZSTD_isError(frame_size)) {
+      return false;
+    }
+    const uint64_t data_size = ZSTD_getFrameContentSize(remaining.data(), frame_size);
+    if (ELEM(data_size, ZSTD_CONTENTSIZE_UNKNOWN, ZSTD_CONTENTSIZE_ERROR) ||
+        data_offset + int64_t(data_size) > r_data.size())
+    {
+      return false;
+    }
+    frames.append({remaining.take_front(frame_size), r_data.slice(data_offset, data_size)});
+    offset += frame_size;
+    data_offset += data_size;
   }
+  if (data_offset != r_data.size()) {
+    return false;
+  }
+
+  std::atomic<bool> error = false;
+  threading::parallel_for(frames.index_range(), 1, [&](const IndexRange range) {
+    ZSTD_DCtx *ctx = ZSTD_createDCtx();
+    for (const int64_t i : range) {
+      const Frame &frame = frames[i];
+      const size_t size = ZSTD_decompressDCtx(ctx,
+                                              frame.data.data(),
+                                              frame.data.size(),
+                                              frame.compressed.data(),
+                                              frame.compressed.size());
+      if (ZSTD_isError(size) || size != size_t(frame.data.size())) {
+        error = true;
+        break;
+      }
+    }
+    ZSTD_freeDCtx(ctx);
+  });
 
-  fseek(file, header_entry->offset, SEEK_SET);
-  return fwrite(data, 1, header_entry->size_raw, file);
+  return !error;
 }
 
-static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
+/**
+ * Encode the image buffer data as stored in the file.
+ * \param r_storage: Holds the encoded data when it is not the image buffer itself.
+ */
+static blender::Span<uchar> seq_disk_cache_encode_imbuf(ImBuf *ibuf,
+                                                        const int level,
+                                                        const bool use_half,
+                                                        blender::Vector<uchar> &r_storage,
+                                                        uchar *r_data_format)
 {
-  void *data = (ibuf->byte_buffer.data != nullptr) ? (void *)ibuf->byte_buffer.data :
-                                                     (void *)ibuf->float_buffer.data;
-  char header[4];
-  fseek(file, header_entry->offset, SEEK_SET);
-  if (fread(header, 1, sizeof(header), file) != sizeof(header)) {
-    return 0;
+  using namespace blender;
+  const int64_t pixels_num = int64_t(ibuf->x) * ibuf->y;
+  Span<uchar> data;
+  Array<uchar> half_data;
+
+  *r_data_format = DCACHE_DATA_FORMAT_DEFAULT;
+  if (ibuf->byte_buffer.data != nullptr) {
+    data = Span<uchar>(ibuf->byte_buffer.data, pixels_num * ibuf->channels);
+  }
+  else if (use_half) {
+    half_data.reinitialize(pixels_num * ibuf->channels * 2);
+    seq_disk_cache_shuffle_to_half(
+        ibuf->float_buffer.data, pixels_num, ibuf->channels, half_data.data());
+    data = half_data;
+    *r_data_format = DCACHE_DATA_FORMAT_HALF_SHUFFLE;
+  }
+  else {
+    data = Span<uchar>(reinterpret_cast<const uchar *>(ibuf->float_buffer.data),
+                       pixels_num * ibuf->channels * sizeof(float));
+  }
+
+  /* Apply compression if wanted, otherwise just write the data directly to the file. */
+  if (level > 0) {
+    if (!seq_disk_cache_compress(data, level, r_storage)) {
+      return {};
+    }
+    return r_storage;
   }
+  if (!half_data.is_empty()) {
+    r_storage.extend(half_data.as_span());
+    return r_storage;
+  }
+  return data;
+}
 
-  /* Check if the data is compressed or raw. */
-  if (BLI_file_magic_is_zstd(header)) {
-    return BLI_file_unzstd_to_mem_at_pos(data, header_entry->size_raw, file, header_entry->offset);
+/** Decode data read from the file into the image buffer. */
+static bool seq_disk_cache_decode_imbuf(ImBuf *ibuf,
+                                        const DiskCacheHeaderEntry *header_entry,
+                                        const blender::Span<uchar> stored)
+{
+  using namespace blender;
+  const int64_t pixels_num = int64_t(ibuf->x) * ibuf->y;
+  const bool is_compressed = stored.size() >= 4 &&
+                             BLI_file_magic_is_zstd(reinterpret_cast<const char *>(
+                                 stored.data()));
+
+  if (header_entry->data_format == DCACHE_DATA_FORMAT_HALF_SHUFFLE) {
+    if (ibuf->float_buffer.data == nullptr) {
+      return false;
+    }
+    Array<uchar> half_data(pixels_num * ibuf->channels * 2);
+    if (is_compressed) {
+      if (!seq_disk_cache_decompress(stored, half_data)) {
+        return false;
+      }
+    }
+    else if (stored.size() == half_data.size()) {
+      half_data.as_mutable_span().copy_from(stored);
+    }
+    else {
+      return false;
+    }
+    seq_disk_cache_unshuffle_from_half(
+        half_data.data(), pixels_num, ibuf->channels, ibuf->float_buffer.data);
+    return true;
   }
 
-  fseek(file, header_entry->offset, SEEK_SET);
-  return fread(data, 1, header_entry->size_raw, file);
+  MutableSpan<uchar> data = (ibuf->byte_buffer.data != nullptr) ?
+                                MutableSpan<uchar>(ibuf->byte_buffer.data,
+                                                   header_entry->size_raw) :
+                                MutableSpan<uchar>(
+                                    reinterpret_cast<uchar *>(ibuf->float_buffer.data),
+                                    header_entry->size_raw);
+  if (is_compressed) {
+    return seq_disk_cache_decompress(stored, data);
+  }
+  if (stored.size() != data.size()) {
+    return false;
+  }
+  data.copy_from(stored);
+  return true;
 }
 
 static bool seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
@@ -540,19 +876,21 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
   return i;
 }
 
-static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *header)
+bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
 {
-  for (int i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
-    if (header->entry[i].frameno == key->frame_index) {
-      return i;
-    }
+  /* Encode before locking, so that reading other images isn't blocked by the compression. */
+  blender::Vector<uchar> storage;
+  uchar data_format;
+  const blender::Span<uchar> stored = seq_disk_cache_encode_imbuf(
+      ibuf,
+      seq_disk_cache_compression_level(),
+      (U.sequencer_disk_cache_flag & SEQ_CACHE_DISK_CACHE_HALF_FLOAT) != 0,
+      storage,
+      &data_format);
+  if (stored.is_empty()) {
+    return false;
   }
 
-  return -1;
-}
-
-bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
-{
   BLI_mutex_lock(&disk_cache->read_write_mutex);
 
   char filepath[FILE_MAX];
@@ -583,11 +921,12 @@ bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf
     return false;
   }
   int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
+  header.entry[entry_index].data_format = data_format;
 
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+  BLI_fseek(file, header.entry[entry_index].offset, SEEK_SET);
+  size_t bytes_written = fwrite(stored.data(), 1, stored.size(), file);
 
-  if (bytes_written != 0) {
+  if (bytes_written == size_t(stored.size())) {
     /* Last step is writing header, as image data can be overwritten,
      * but missing data would cause problems.
      */
@@ -600,20 +939,25 @@ bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf
     return true;
   }
 
+  fclose(file);
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
   return false;
 }
 
-ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
+/**
+ * Read the image of \a frame_index from the cache file. Only reading the file is done while
+ * holding the lock, the decompression happens afterwards.
+ */
+static ImBuf *seq_disk_cache_read_image(SeqDiskCache *disk_cache,
+                                        const char *filepath,
+                                        const float frame_index,
+                                        const int rectx,
+                                        const int recty)
 {
   BLI_mutex_lock(&disk_cache->read_write_mutex);
 
-  char filepath[FILE_MAX];
   DiskCacheHeader header;
 
-  seq_disk_cache_get_file_path(disk_cache, key, filepath, sizeof(filepath));
-  BLI_file_ensure_parent_dir_exists(filepath);
-
   FILE *file = BLI_fopen(filepath, "rb");
   if (!file) {
     BLI_mutex_unlock(&disk_cache->read_write_mutex);
@@ -625,7 +969,14 @@ ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
     BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return nullptr;
   }
-  int entry_index = seq_disk_cache_get_header_entry(key, &header);
+
+  int entry_index = -1;
+  for (int i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
+    if (header.entry[i].frameno == frame_index && header.entry[i].size_compressed != 0) {
+      entry_index = i;
+      break;
+    }
+  }
 
   /* Item not found. */
   if (entry_index < 0) {
@@ -634,50 +985,162 @@ ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
     return nullptr;
   }
 
-  ImBuf *ibuf;
-  uint64_t size_char = uint64_t(key->context.rectx) * key->context.recty * 4;
-  uint64_t size_float = uint64_t(key->context.rectx) * key->context.recty * 16;
-  size_t expected_size;
-
-  if (header.entry[entry_index].size_raw == size_char) {
-    expected_size = size_char;
-    ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
-    IMB_colormanagement_assign_byte_colorspace(ibuf, header.entry[entry_index].colorspace_name);
-  }
-  else if (header.entry[entry_index].size_raw == size_float) {
-    expected_size = size_float;
-    ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
-    IMB_colormanagement_assign_float_colorspace(ibuf, header.entry[entry_index].colorspace_name);
-  }
-  else {
+  const DiskCacheHeaderEntry *header_entry = &header.entry[entry_index];
+  const uint64_t size_char = uint64_t(rectx) * recty * 4;
+  const uint64_t size_float = uint64_t(rectx) * recty * 16;
+  if (!ELEM(header_entry->size_raw, size_char, size_float)) {
     fclose(file);
     BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return nullptr;
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  blender::Array<uchar> stored(header_entry->size_compressed);
+  BLI_fseek(file, header_entry->offset, SEEK_SET);
+  const size_t bytes_read = fread(stored.data(), 1, stored.size(), file);
+  fclose(file);
 
   /* Sanity check. */
-  if (bytes_read != expected_size) {
-    fclose(file);
-    IMB_freeImBuf(ibuf);
+  if (bytes_read != size_t(stored.size())) {
     BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return nullptr;
   }
   BLI_file_touch(filepath);
   seq_disk_cache_update_file(disk_cache, filepath);
-  fclose(file);
 
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+  ImBuf *ibuf;
+  if (header_entry->size_raw == size_char) {
+    ibuf = IMB_allocImBuf(rectx, recty, 32, IB_rect);
+    IMB_colormanagement_assign_byte_colorspace(ibuf, header_entry->colorspace_name);
+  }
+  else {
+    ibuf = IMB_allocImBuf(rectx, recty, 32, IB_rectfloat);
+    IMB_colormanagement_assign_float_colorspace(ibuf, header_entry->colorspace_name);
+  }
+
+  if (!seq_disk_cache_decode_imbuf(ibuf, header_entry, stored)) {
+    IMB_freeImBuf(ibuf);
+    return nullptr;
+  }
+
+  return ibuf;
+}
+
+struct DiskCacheReadAheadTask {
+  DiskCacheReadAheadKey key;
+  int rectx;
+  int recty;
+  int generation;
+};
+
+static void seq_disk_cache_read_ahead_task(TaskPool *__restrict pool, void *taskdata)
+{
+  SeqDiskCache *disk_cache = static_cast<SeqDiskCache *>(BLI_task_pool_user_data(pool));
+  DiskCacheReadAheadTask *task = static_cast<DiskCacheReadAheadTask *>(taskdata);
+
+  ImBuf *ibuf = seq_disk_cache_read_image(
+      disk_cache, task->key.filepath.c_str(), task->key.frame_index, task->rectx, task->recty);
+
+  BLI_mutex_lock(&disk_cache->read_ahead_mutex);
+  ImBuf **ibuf_ptr = disk_cache->read_ahead_images.lookup_ptr(task->key);
+  if (ibuf_ptr == nullptr || *ibuf_ptr != nullptr ||
+      task->generation != disk_cache->read_ahead_generation)
+  {
+    /* Discarded or invalidated while reading. */
+    if (ibuf) {
+      IMB_freeImBuf(ibuf);
+    }
+  }
+  else if (ibuf == nullptr) {
+    disk_cache->read_ahead_images.remove(task->key);
+  }
+  else {
+    *ibuf_ptr = ibuf;
+  }
+  BLI_mutex_unlock(&disk_cache->read_ahead_mutex);
+}
+
+static void seq_disk_cache_read_ahead_task_free(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  MEM_delete(static_cast<DiskCacheReadAheadTask *>(taskdata));
+}
+
+/** Take the image from the read ahead images, if it has been read already. */
+static ImBuf *seq_disk_cache_read_ahead_pop(SeqDiskCache *disk_cache,
+                                            const DiskCacheReadAheadKey &key)
+{
+  BLI_mutex_lock(&disk_cache->read_ahead_mutex);
+  ImBuf *ibuf = disk_cache->read_ahead_images.lookup_default(key, nullptr);
+  if (ibuf != nullptr) {
+    disk_cache->read_ahead_images.remove(key);
+  }
+  BLI_mutex_unlock(&disk_cache->read_ahead_mutex);
+  return ibuf;
+}
+
+/** Start reading the frames following \a key in the background. */
+static void seq_disk_cache_read_ahead(SeqDiskCache *disk_cache, SeqCacheKey *key)
+{
+  BLI_mutex_lock(&disk_cache->read_ahead_mutex);
+
+  /* Images that are never requested, e.g. when playback stopped, are only freed here. */
+  if (disk_cache->read_ahead_images.size() >= DCACHE_READ_AHEAD_MAX_IMAGES) {
+    seq_disk_cache_read_ahead_clear(disk_cache);
+  }
+
+  for (int i = 1; i <= DCACHE_READ_AHEAD_FRAMES; i++) {
+    SeqCacheKey next_key = *key;
+    next_key.frame_index += i;
+
+    char filepath[FILE_MAX];
+    seq_disk_cache_get_file_path(disk_cache, &next_key, filepath, sizeof(filepath));
+    DiskCacheReadAheadKey read_ahead_key = {filepath, next_key.frame_index};
+    if (!disk_cache->read_ahead_images.add(read_ahead_key, nullptr)) {
+      continue;
+    }
+
+    DiskCacheReadAheadTask *task = MEM_new<DiskCacheReadAheadTask>(__func__);
+    task->key = std::move(read_ahead_key);
+    task->rectx = key->context.rectx;
+    task->recty = key->context.recty;
+    task->generation = disk_cache->read_ahead_generation;
+    BLI_task_pool_push(disk_cache->read_ahead_pool,
+                       seq_disk_cache_read_ahead_task,
+                       task,
+                       true,
+                       seq_disk_cache_read_ahead_task_free);
+  }
+
+  BLI_mutex_unlock(&disk_cache->read_ahead_mutex);
+}
+
+ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
+{
+  char filepath[FILE_MAX];
+  seq_disk_cache_get_file_path(disk_cache, key, filepath, sizeof(filepath));
+
+  const DiskCacheReadAheadKey read_ahead_key = {filepath, key->frame_index};
+  ImBuf *ibuf = seq_disk_cache_read_ahead_pop(disk_cache, read_ahead_key);
+  if (ibuf == nullptr) {
+    ibuf = seq_disk_cache_read_image(
+        disk_cache, filepath, key->frame_index, key->context.rectx, key->context.recty);
+  }
+
+  if (ibuf != nullptr) {
+    seq_disk_cache_read_ahead(disk_cache, key);
+  }
+
   return ibuf;
 }
 
 SeqDiskCache *seq_disk_cache_create(Main *bmain, Scene *scene)
 {
-  SeqDiskCache *disk_cache = static_cast<SeqDiskCache *>(
-      MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache"));
+  SeqDiskCache *disk_cache = MEM_new<SeqDiskCache>("SeqDiskCache");
   disk_cache->bmain = bmain;
   BLI_mutex_init(&disk_cache->read_write_mutex);
+  BLI_mutex_init(&disk_cache->read_ahead_mutex);
+  disk_cache->read_ahead_pool = BLI_task_pool_create_background(disk_cache, TASK_PRIORITY_LOW);
   seq_disk_cache_handle_versioning(disk_cache);
   seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
   disk_cache->timestamp = scene->ed->disk_cache_timestamp;
@@ -687,7 +1150,11 @@ SeqDiskCache *seq_disk_cache_create(Main *bmain, Scene *scene)
 
 void seq_disk_cache_free(SeqDiskCache *disk_cache)
 {
+  BLI_task_pool_cancel(disk_cache->read_ahead_pool);
+  BLI_task_pool_free(disk_cache->read_ahead_pool);
+  seq_disk_cache_read_ahead_clear(disk_cache);
   BLI_freelistN(&disk_cache->files);
   BLI_mutex_end(&disk_cache->read_write_mutex);
-  MEM_freeN(disk_cache);
+  BLI_mutex_end(&disk_cache->read_ahead_mutex);
+  MEM_delete(disk_cache);
 }
@@ -12,6 +12,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "DNA_scene_types.h"
 #include "DNA_sequence_types.h"
 #include "DNA_space_types.h" /* for FILE_MAX. */
@@ -69,24 +71,48 @@
  * entries one by one in reverse order to their creation.
  *
  * User can exclude caching of some images. Such entries will have is_temp_cache set.
+ *
+ * Locking: Entries are distributed over SEQ_CACHE_SHARDS_NUM hash tables by timeline frame.
+ * Looking up an image only locks the shard it is in, so that the UI and the prefetch job don't
+ * contend for a single lock while scrubbing. All modifications of the cache lock the
+ * `iterator_mutex` first and additionally the shard that is modified.
+ *
+ * Recycling: Permanent entries are kept in a least recently used list, the frame of the least
+ * recently used entry is freed first.
  */
 
 #define THUMB_CACHE_LIMIT 5000
+#define SEQ_CACHE_SHARDS_NUM 16
+
+struct SeqCacheShard {
+  GHash *hash;
+  /** Locked when modifying the hash, or when reading it without holding the `iterator_mutex`. */
+  ThreadMutex mutex;
+};
 
 struct SeqCache {
   Main *bmain;
-  GHash *hash;
+  SeqCacheShard shards[SEQ_CACHE_SHARDS_NUM];
   ThreadMutex iterator_mutex;
   BLI_mempool *keys_pool;
   BLI_mempool *items_pool;
   SeqCacheKey *last_key;
+  /** Permanent keys, from most (first) to least (last) recently used. */
+  SeqCacheKey *lru_first;
+  SeqCacheKey *lru_last;
+  SpinLock lru_lock;
   SeqDiskCache *disk_cache;
   int thumbnail_count;
+  SeqCacheStatistics statistics;
 };
 
 struct SeqCacheItem {
   SeqCache *cache_owner;
+  SeqCacheKey *key;
   ImBuf *ibuf;
+  size_t size_in_memory;
+  /** Copy of the key type, the key may be freed before the item. */
+  int type;
 };
 
 static ThreadMutex cache_create_lock = BLI_MUTEX_INITIALIZER;
@@ -164,6 +190,76 @@ static SeqCache *seq_cache_get_from_scene(Scene *scene)
   return nullptr;
 }
 
+static SeqCacheShard *seq_cache_shard_get(SeqCache *cache, const SeqCacheKey *key)
+{
+  const uint frame = uint(int(floorf(key->timeline_frame)));
+  return &cache->shards[frame % SEQ_CACHE_SHARDS_NUM];
+}
+
+static SeqCacheTypeStatistics *seq_cache_statistics_get_for_type(SeqCache *cache, const int type)
+{
+  switch (type) {
+    case SEQ_CACHE_STORE_RAW:
+      return &cache->statistics.raw;
+    case SEQ_CACHE_STORE_PREPROCESSED:
+      return &cache->statistics.preprocessed;
+    case SEQ_CACHE_STORE_COMPOSITE:
+      return &cache->statistics.composite;
+    case SEQ_CACHE_STORE_THUMBNAIL:
+      return &cache->statistics.thumbnail;
+  }
+  return &cache->statistics.final_out;
+}
+
+/* Must be called with #SeqCache.lru_lock locked. */
+static void seq_cache_lru_unlink(SeqCache *cache, SeqCacheKey *key)
+{
+  if (key->lru_prev) {
+    key->lru_prev->lru_next = key->lru_next;
+  }
+  else {
+    cache->lru_first = key->lru_next;
+  }
+  if (key->lru_next) {
+    key->lru_next->lru_prev = key->lru_prev;
+  }
+  else {
+    cache->lru_last = key->lru_prev;
+  }
+  key->lru_prev = nullptr;
+  key->lru_next = nullptr;
+  key->is_in_lru = false;
+}
+
+/* Must be called with #SeqCache.lru_lock locked. */
+static void seq_cache_lru_link_first(SeqCache *cache, SeqCacheKey *key)
+{
+  key->lru_prev = nullptr;
+  key->lru_next = cache->lru_first;
+  if (cache->lru_first) {
+    cache->lru_first->lru_prev = key;
+  }
+  else {
+    cache->lru_last = key;
+  }
+  cache->lru_first = key;
+  key->is_in_lru = true;
+}
+
+/** Mark the key as most recently used, if it is a permanent key. */
+static void seq_cache_lru_touch(SeqCache *cache, SeqCacheKey *key)
+{
+  BLI_spin_lock(&cache->lru_lock);
+  if (key->is_in_lru && cache->lru_first != key) {
+    seq_cache_lru_unlink(cache, key);
+    seq_cache_lru_link_first(cache, key);
+  }
+  BLI_spin_unlock(&cache->lru_lock);
+}
+
+/** Remove the key and its item. Must be called with #SeqCache.iterator_mutex locked. */
+static void seq_cache_remove(SeqCache *cache, SeqCacheKey *key);
+
 static void seq_cache_lock(Scene *scene)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
@@ -196,12 +292,35 @@ static void seq_cache_keyfree(void *val)
 static void seq_cache_valfree(void *val)
 {
   SeqCacheItem *item = (SeqCacheItem *)val;
+  SeqCache *cache = item->cache_owner;
+
+  SeqCacheTypeStatistics *statistics = seq_cache_statistics_get_for_type(cache, item->type);
+  atomic_sub_and_fetch_int64(&statistics->bytes, int64_t(item->size_in_memory));
 
   if (item->ibuf) {
     IMB_freeImBuf(item->ibuf);
   }
 
-  BLI_mempool_free(item->cache_owner->items_pool, item);
+  BLI_mempool_free(cache->items_pool, item);
+}
+
+static void seq_cache_remove(SeqCache *cache, SeqCacheKey *key)
+{
+  BLI_spin_lock(&cache->lru_lock);
+  if (key->is_in_lru) {
+    seq_cache_lru_unlink(cache, key);
+  }
+  BLI_spin_unlock(&cache->lru_lock);
+
+  SeqCacheShard *shard = seq_cache_shard_get(cache, key);
+  BLI_mutex_lock(&shard->mutex);
+  BLI_ghash_remove(shard->hash, key, seq_cache_keyfree, seq_cache_valfree);
+  BLI_mutex_unlock(&shard->mutex);
+}
+
+static bool seq_cache_haskey(SeqCache *cache, const SeqCacheKey *key)
+{
+  return BLI_ghash_haskey(seq_cache_shard_get(cache, key)->hash, key);
 }
 
 static int get_stored_types_flag(Scene *scene, SeqCacheKey *key)
@@ -226,7 +345,10 @@ static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
   SeqCacheItem *item;
   item = static_cast<SeqCacheItem *>(BLI_mempool_alloc(cache->items_pool));
   item->cache_owner = cache;
+  item->key = key;
   item->ibuf = ibuf;
+  item->size_in_memory = IMB_get_size_in_memory(ibuf);
+  item->type = key->type;
 
   const int stored_types_flag = get_stored_types_flag(scene, key);
 
@@ -236,9 +358,21 @@ static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
     key->link_prev = cache->last_key;
   }
 
-  BLI_assert(!BLI_ghash_haskey(cache->hash, key));
-  BLI_ghash_insert(cache->hash, key, item);
+  SeqCacheShard *shard = seq_cache_shard_get(cache, key);
+  BLI_mutex_lock(&shard->mutex);
+  BLI_assert(!BLI_ghash_haskey(shard->hash, key));
+  BLI_ghash_insert(shard->hash, key, item);
   IMB_refImBuf(ibuf);
+  BLI_mutex_unlock(&shard->mutex);
+
+  SeqCacheTypeStatistics *statistics = seq_cache_statistics_get_for_type(cache, key->type);
+  atomic_add_and_fetch_int64(&statistics->bytes, int64_t(item->size_in_memory));
+
+  if (!key->is_temp_cache) {
+    BLI_spin_lock(&cache->lru_lock);
+    seq_cache_lru_link_first(cache, key);
+    BLI_spin_unlock(&cache->lru_lock);
+  }
 
   /* Store pointer to last cached key. */
   SeqCacheKey *temp_last_key = cache->last_key;
@@ -260,17 +394,25 @@ static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
   }
 }
 
+/* Only locks the shard of the key, does not require #SeqCache.iterator_mutex. */
 static ImBuf *seq_cache_get_ex(SeqCache *cache, SeqCacheKey *key)
 {
-  SeqCacheItem *item = static_cast<SeqCacheItem *>(BLI_ghash_lookup(cache->hash, key));
+  SeqCacheShard *shard = seq_cache_shard_get(cache, key);
+  ImBuf *ibuf = nullptr;
 
+  BLI_mutex_lock(&shard->mutex);
+  SeqCacheItem *item = static_cast<SeqCacheItem *>(BLI_ghash_lookup(shard->hash, key));
   if (item && item->ibuf) {
     IMB_refImBuf(item->ibuf);
-
-    return item->ibuf;
+    ibuf = item->ibuf;
+    seq_cache_lru_touch(cache, item->key);
   }
+  BLI_mutex_unlock(&shard->mutex);
 
-  return nullptr;
+  SeqCacheTypeStatistics *statistics = seq_cache_statistics_get_for_type(cache, key->type);
+  atomic_add_and_fetch_int64(ibuf ? &statistics->hits : &statistics->misses, 1);
+
+  return ibuf;
 }
 
 static void seq_cache_key_unlink(SeqCacheKey *key)
@@ -285,69 +427,6 @@ static void seq_cache_key_unlink(SeqCacheKey *key)
   }
 }
 
-/* Choose a key out of 2 candidates(leftmost and rightmost items)
- * to recycle based on currently used strategy */
-static SeqCacheKey *seq_cache_choose_key(Scene *scene, SeqCacheKey *lkey, SeqCacheKey *rkey)
-{
-  SeqCacheKey *finalkey = nullptr;
-
-  /* Ideally, cache would not need to check the state of prefetching task
-   * that is tricky to do however, because prefetch would need to know,
-   * if a key, that is about to be created would be removed by itself.
-   *
-   * This can happen because only FINAL_OUT item insertion will trigger recycling
-   * but that is also the point, where prefetch can be suspended.
-   *
-   * We could use temp cache as a shield and later make it a non-temporary entry,
-   * but it is not worth of increasing system complexity.
-   */
-  if (scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE && seq_prefetch_job_is_running(scene)) {
-    int pfjob_start, pfjob_end;
-    seq_prefetch_get_time_range(scene, &pfjob_start, &pfjob_end);
-
-    if (lkey) {
-      if (lkey->timeline_frame < pfjob_start || lkey->timeline_frame > pfjob_end) {
-        return lkey;
-      }
-    }
-
-    if (rkey) {
-      if (rkey->timeline_frame < pfjob_start || rkey->timeline_frame > pfjob_end) {
-        return rkey;
-      }
-    }
-
-    return nullptr;
-  }
-
-  if (rkey && lkey) {
-    if (lkey->timeline_frame > rkey->timeline_frame) {
-      SeqCacheKey *swapkey = lkey;
-      lkey = rkey;
-      rkey = swapkey;
-    }
-
-    int l_diff = scene->r.cfra - lkey->timeline_frame;
-    int r_diff = rkey->timeline_frame - scene->r.cfra;
-
-    if (l_diff > r_diff) {
-      finalkey = lkey;
-    }
-    else {
-      finalkey = rkey;
-    }
-  }
-  else {
-    if (lkey) {
-      finalkey = lkey;
-    }
-    else {
-      finalkey = rkey;
-    }
-  }
-  return finalkey;
-}
-
 static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
@@ -358,7 +437,7 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
   SeqCacheKey *next = base->link_next;
 
   while (base) {
-    if (!BLI_ghash_haskey(cache->hash, base)) {
+    if (!seq_cache_haskey(cache, base)) {
       break; /* Key has already been removed from cache. */
     }
 
@@ -370,14 +449,16 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
     }
 
     seq_cache_key_unlink(base);
-    BLI_ghash_remove(cache->hash, base, seq_cache_keyfree, seq_cache_valfree);
+    atomic_add_and_fetch_int64(&seq_cache_statistics_get_for_type(cache, base->type)->evictions,
+                               1);
     BLI_assert(base != cache->last_key);
+    seq_cache_remove(cache, base);
     base = prev;
   }
 
   base = next;
   while (base) {
-    if (!BLI_ghash_haskey(cache->hash, base)) {
+    if (!seq_cache_haskey(cache, base)) {
       break; /* Key has already been removed from cache. */
     }
 
@@ -389,66 +470,61 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
     }
 
     seq_cache_key_unlink(base);
-    BLI_ghash_remove(cache->hash, base, seq_cache_keyfree, seq_cache_valfree);
+    atomic_add_and_fetch_int64(&seq_cache_statistics_get_for_type(cache, base->type)->evictions,
+                               1);
     BLI_assert(base != cache->last_key);
+    seq_cache_remove(cache, base);
     base = next;
   }
 }
 
+/* Find the least recently used permanent key, its whole frame is freed. */
 static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
   SeqCacheKey *finalkey = nullptr;
-  /* Leftmost key. */
-  SeqCacheKey *lkey = nullptr;
-  /* Rightmost key. */
-  SeqCacheKey *rkey = nullptr;
-  SeqCacheKey *key = nullptr;
-
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  int total_count = 0;
-
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    SeqCacheItem *item = static_cast<SeqCacheItem *>(BLI_ghashIterator_getValue(&gh_iter));
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_assert(key->cache_owner == cache);
-
-    /* This shouldn't happen, but better be safe than sorry. */
-    if (!item->ibuf) {
-      seq_cache_recycle_linked(scene, key);
-      /* Can not continue iterating after linked remove. */
-      BLI_ghashIterator_init(&gh_iter, cache->hash);
-      continue;
-    }
 
-    if (key->is_temp_cache || key->link_next != nullptr) {
-      continue;
-    }
+  /* Ideally, cache would not need to check the state of prefetching task
+   * that is tricky to do however, because prefetch would need to know,
+   * if a key, that is about to be created would be removed by itself.
+   *
+   * This can happen because only FINAL_OUT item insertion will trigger recycling
+   * but that is also the point, where prefetch can be suspended.
+   *
+   * We could use temp cache as a shield and later make it a non-temporary entry,
+   * but it is not worth of increasing system complexity.
+   */
+  const bool use_prefetch_range = (scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) &&
+                                  seq_prefetch_job_is_running(scene);
+  int pfjob_start = 0, pfjob_end = 0;
+  if (use_prefetch_range) {
+    seq_prefetch_get_time_range(scene, &pfjob_start, &pfjob_end);
+  }
 
-    total_count++;
+  BLI_spin_lock(&cache->lru_lock);
+  SeqCacheKey *key = cache->lru_last;
+  while (key) {
+    SeqCacheKey *prev = key->lru_prev;
 
-    if (lkey) {
-      if (key->timeline_frame < lkey->timeline_frame) {
-        lkey = key;
-      }
+    if (key->is_temp_cache) {
+      /* Changed to a temporary key, which is freed separately. */
+      seq_cache_lru_unlink(cache, key);
     }
-    else {
-      lkey = key;
+    else if (cache->last_key && key->timeline_frame == cache->last_key->timeline_frame) {
+      /* Don't free the frame that is currently being rendered. */
     }
-    if (rkey) {
-      if (key->timeline_frame > rkey->timeline_frame) {
-        rkey = key;
-      }
+    else if (use_prefetch_range && key->timeline_frame >= pfjob_start &&
+             key->timeline_frame <= pfjob_end)
+    {
+      /* Don't free frames the prefetch job is working on. */
     }
     else {
-      rkey = key;
+      finalkey = key;
+      break;
     }
+    key = prev;
   }
-  (void)total_count; /* Quiet set-but-unused warning (may be removed). */
-
-  finalkey = seq_cache_choose_key(scene, lkey, rkey);
+  BLI_spin_unlock(&cache->lru_lock);
 
   return finalkey;
 }
@@ -508,11 +584,15 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     SeqCache *cache = static_cast<SeqCache *>(MEM_callocN(sizeof(SeqCache), "SeqCache"));
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
-    cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
+    for (SeqCacheShard &shard : cache->shards) {
+      shard.hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
+      BLI_mutex_init(&shard.mutex);
+    }
     cache->last_key = nullptr;
     cache->bmain = bmain;
     cache->thumbnail_count = 0;
     BLI_mutex_init(&cache->iterator_mutex);
+    BLI_spin_init(&cache->lru_lock);
     scene->ed->cache = cache;
 
     if (scene->ed->disk_cache_timestamp == 0) {
@@ -537,6 +617,9 @@ static void seq_cache_populate_key(SeqCacheKey *key,
   key->type = type;
   key->link_prev = nullptr;
   key->link_next = nullptr;
+  key->lru_prev = nullptr;
+  key->lru_next = nullptr;
+  key->is_in_lru = false;
   key->is_temp_cache = true;
   key->task_id = context->task_id;
 }
@@ -563,25 +646,28 @@ void seq_cache_free_temp_cache(Scene *scene, short id, int timeline_frame)
 
   seq_cache_lock(scene);
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_assert(key->cache_owner == cache);
-
-    if (key->is_temp_cache && key->task_id == id && key->type != SEQ_CACHE_STORE_THUMBNAIL) {
-      /* Use frame_index here to avoid freeing raw images if they are used for multiple frames. */
-      float frame_index = seq_cache_timeline_frame_to_frame_index(
-          scene, key->seq, timeline_frame, key->type);
-      if (frame_index != key->frame_index ||
-          timeline_frame > SEQ_time_right_handle_frame_get(scene, key->seq) ||
-          timeline_frame < SEQ_time_left_handle_frame_get(scene, key->seq))
-      {
-        seq_cache_key_unlink(key);
-        BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
-        if (key == cache->last_key) {
-          cache->last_key = nullptr;
+  for (SeqCacheShard &shard : cache->shards) {
+    GHashIterator gh_iter;
+    BLI_ghashIterator_init(&gh_iter, shard.hash);
+    while (!BLI_ghashIterator_done(&gh_iter)) {
+      SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
+      BLI_ghashIterator_step(&gh_iter);
+      BLI_assert(key->cache_owner == cache);
+
+      if (key->is_temp_cache && key->task_id == id && key->type != SEQ_CACHE_STORE_THUMBNAIL) {
+        /* Use frame_index here to avoid freeing raw images if they are used for multiple
+         * frames. */
+        float frame_index = seq_cache_timeline_frame_to_frame_index(
+            scene, key->seq, timeline_frame, key->type);
+        if (frame_index != key->frame_index ||
+            timeline_frame > SEQ_time_right_handle_frame_get(scene, key->seq) ||
+            timeline_frame < SEQ_time_left_handle_frame_get(scene, key->seq))
+        {
+          seq_cache_key_unlink(key);
+          if (key == cache->last_key) {
+            cache->last_key = nullptr;
+          }
+          seq_cache_remove(cache, key);
         }
       }
     }
@@ -596,10 +682,14 @@ void seq_cache_destruct(Scene *scene)
     return;
   }
 
-  BLI_ghash_free(cache->hash, seq_cache_keyfree, seq_cache_valfree);
+  for (SeqCacheShard &shard : cache->shards) {
+    BLI_ghash_free(shard.hash, seq_cache_keyfree, seq_cache_valfree);
+    BLI_mutex_end(&shard.mutex);
+  }
   BLI_mempool_destroy(cache->keys_pool);
   BLI_mempool_destroy(cache->items_pool);
   BLI_mutex_end(&cache->iterator_mutex);
+  BLI_spin_end(&cache->lru_lock);
 
   if (cache->disk_cache != nullptr) {
     seq_disk_cache_free(cache->disk_cache);
@@ -628,16 +718,18 @@ void SEQ_cache_cleanup(Scene *scene)
 
   seq_cache_lock(scene);
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    BLI_assert(key->cache_owner == cache);
+  for (SeqCacheShard &shard : cache->shards) {
+    GHashIterator gh_iter;
+    BLI_ghashIterator_init(&gh_iter, shard.hash);
+    while (!BLI_ghashIterator_done(&gh_iter)) {
+      SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
+      BLI_assert(key->cache_owner == cache);
 
-    BLI_ghashIterator_step(&gh_iter);
+      BLI_ghashIterator_step(&gh_iter);
 
-    /* NOTE: no need to call #seq_cache_key_unlink as all keys are removed. */
-    BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
+      /* NOTE: no need to call #seq_cache_key_unlink as all keys are removed. */
+      seq_cache_remove(cache, key);
+    }
   }
   cache->last_key = nullptr;
   cache->thumbnail_count = 0;
@@ -673,26 +765,28 @@ void seq_cache_cleanup_sequence(Scene *scene,
   int invalidate_source = invalidate_types & (SEQ_CACHE_STORE_RAW | SEQ_CACHE_STORE_PREPROCESSED |
                                               SEQ_CACHE_STORE_COMPOSITE);
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_assert(key->cache_owner == cache);
-
-    /* Clean all final and composite in intersection of seq and seq_changed. */
-    if (key->type & invalidate_composite && key->timeline_frame >= range_start &&
-        key->timeline_frame <= range_end)
-    {
-      seq_cache_key_unlink(key);
-      BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
-    }
-    else if (key->type & invalidate_source && key->seq == seq &&
-             key->timeline_frame >= SEQ_time_left_handle_frame_get(scene, seq_changed) &&
-             key->timeline_frame <= SEQ_time_right_handle_frame_get(scene, seq_changed))
-    {
-      seq_cache_key_unlink(key);
-      BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
+  for (SeqCacheShard &shard : cache->shards) {
+    GHashIterator gh_iter;
+    BLI_ghashIterator_init(&gh_iter, shard.hash);
+    while (!BLI_ghashIterator_done(&gh_iter)) {
+      SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
+      BLI_ghashIterator_step(&gh_iter);
+      BLI_assert(key->cache_owner == cache);
+
+      /* Clean all final and composite in intersection of seq and seq_changed. */
+      if (key->type & invalidate_composite && key->timeline_frame >= range_start &&
+          key->timeline_frame <= range_end)
+      {
+        seq_cache_key_unlink(key);
+        seq_cache_remove(cache, key);
+      }
+      else if (key->type & invalidate_source && key->seq == seq &&
+               key->timeline_frame >= SEQ_time_left_handle_frame_get(scene, seq_changed) &&
+               key->timeline_frame <= SEQ_time_right_handle_frame_get(scene, seq_changed))
+      {
+        seq_cache_key_unlink(key);
+        seq_cache_remove(cache, key);
+      }
     }
   }
   cache->last_key = nullptr;
@@ -712,31 +806,36 @@ void seq_cache_thumbnail_cleanup(Scene *scene, rctf *view_area_safe)
     return;
   }
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_assert(key->cache_owner == cache);
-
-    const int frame_index = key->timeline_frame - SEQ_time_left_handle_frame_get(scene, key->seq);
-    const int frame_step = SEQ_render_thumbnails_guaranteed_set_frame_step_get(scene, key->seq);
-    const int relative_base_frame = round_fl_to_int(frame_index / float(frame_step)) * frame_step;
-    const int nearest_guaranted_absolute_frame = relative_base_frame +
-                                                 SEQ_time_left_handle_frame_get(scene, key->seq);
-
-    if (nearest_guaranted_absolute_frame == key->timeline_frame) {
-      continue;
-    }
+  for (SeqCacheShard &shard : cache->shards) {
+    GHashIterator gh_iter;
+    BLI_ghashIterator_init(&gh_iter, shard.hash);
+    while (!BLI_ghashIterator_done(&gh_iter)) {
+      SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
+      BLI_ghashIterator_step(&gh_iter);
+      BLI_assert(key->cache_owner == cache);
+
+      const int frame_index = key->timeline_frame -
+                              SEQ_time_left_handle_frame_get(scene, key->seq);
+      const int frame_step = SEQ_render_thumbnails_guaranteed_set_frame_step_get(scene, key->seq);
+      const int relative_base_frame = round_fl_to_int(frame_index / float(frame_step)) *
+                                      frame_step;
+      const int nearest_guaranted_absolute_frame = relative_base_frame +
+                                                   SEQ_time_left_handle_frame_get(scene,
+                                                                                  key->seq);
+
+      if (nearest_guaranted_absolute_frame == key->timeline_frame) {
+        continue;
+      }
 
-    if ((key->type & SEQ_CACHE_STORE_THUMBNAIL) &&
-        (key->timeline_frame > view_area_safe->xmax ||
-         key->timeline_frame < view_area_safe->xmin || key->seq->machine > view_area_safe->ymax ||
-         key->seq->machine < view_area_safe->ymin))
-    {
-      seq_cache_key_unlink(key);
-      BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
-      cache->thumbnail_count--;
+      if ((key->type & SEQ_CACHE_STORE_THUMBNAIL) &&
+          (key->timeline_frame > view_area_safe->xmax ||
+           key->timeline_frame < view_area_safe->xmin ||
+           key->seq->machine > view_area_safe->ymax || key->seq->machine < view_area_safe->ymin))
+      {
+        seq_cache_key_unlink(key);
+        seq_cache_remove(cache, key);
+        cache->thumbnail_count--;
+      }
     }
   }
   cache->last_key = nullptr;
@@ -765,7 +864,6 @@ ImBuf *seq_cache_get(const SeqRenderData *context, Sequence *seq, float timeline
     seq_cache_create(context->bmain, scene);
   }
 
-  seq_cache_lock(scene);
   SeqCache *cache = seq_cache_get_from_scene(scene);
   ImBuf *ibuf = nullptr;
   SeqCacheKey key;
@@ -775,7 +873,6 @@ ImBuf *seq_cache_get(const SeqRenderData *context, Sequence *seq, float timeline
     seq_cache_populate_key(&key, context, seq, timeline_frame, type);
     ibuf = seq_cache_get_ex(cache, &key);
   }
-  seq_cache_unlock(scene);
 
   if (ibuf) {
     return ibuf;
@@ -795,8 +892,13 @@ ImBuf *seq_cache_get(const SeqRenderData *context, Sequence *seq, float timeline
 
     /* Store read image in RAM. Only recycle item for final type. */
     if (key.type != SEQ_CACHE_STORE_FINAL_OUT || seq_cache_recycle_item(scene)) {
-      SeqCacheKey *new_key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
-      seq_cache_put_ex(scene, new_key, ibuf);
+      seq_cache_lock(scene);
+      /* The image may have been read and stored by another thread in the meantime. */
+      if (!seq_cache_haskey(cache, &key)) {
+        SeqCacheKey *new_key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
+        seq_cache_put_ex(scene, new_key, ibuf);
+      }
+      seq_cache_unlock(scene);
     }
   }
 
@@ -846,7 +948,8 @@ void seq_cache_thumbnail_put(const SeqRenderData *context,
       cache, context, seq, timeline_frame, SEQ_CACHE_STORE_THUMBNAIL);
 
   /* Prevent reinserting, it breaks cache key linking. */
-  if (BLI_ghash_haskey(cache->hash, key)) {
+  if (seq_cache_haskey(cache, key)) {
+    BLI_mempool_free(cache->keys_pool, key);
     seq_cache_unlock(scene);
     return;
   }
@@ -919,23 +1022,55 @@ void SEQ_cache_iterate(
   }
 
   seq_cache_lock(scene);
-  bool interrupt = callback_init(userdata, BLI_ghash_len(cache->hash));
+  size_t item_count = 0;
+  for (const SeqCacheShard &shard : cache->shards) {
+    item_count += BLI_ghash_len(shard.hash);
+  }
+  bool interrupt = callback_init(userdata, item_count);
 
-  GHashIterator gh_iter;
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
+  for (SeqCacheShard &shard : cache->shards) {
+    GHashIterator gh_iter;
+    BLI_ghashIterator_init(&gh_iter, shard.hash);
 
-  while (!BLI_ghashIterator_done(&gh_iter) && !interrupt) {
-    SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
-    BLI_ghashIterator_step(&gh_iter);
-    BLI_assert(key->cache_owner == cache);
+    while (!BLI_ghashIterator_done(&gh_iter) && !interrupt) {
+      SeqCacheKey *key = static_cast<SeqCacheKey *>(BLI_ghashIterator_getKey(&gh_iter));
+      BLI_ghashIterator_step(&gh_iter);
+      BLI_assert(key->cache_owner == cache);
 
-    interrupt = callback_iter(userdata, key->seq, key->timeline_frame, key->type);
+      interrupt = callback_iter(userdata, key->seq, key->timeline_frame, key->type);
+    }
   }
 
   cache->last_key = nullptr;
   seq_cache_unlock(scene);
 }
 
+SeqCacheStatistics *SEQ_cache_statistics_get(Scene *scene)
+{
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  return cache ? &cache->statistics : nullptr;
+}
+
+void SEQ_cache_statistics_reset(Scene *scene)
+{
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (!cache) {
+    return;
+  }
+
+  for (SeqCacheTypeStatistics *statistics : {&cache->statistics.raw,
+                                             &cache->statistics.preprocessed,
+                                             &cache->statistics.composite,
+                                             &cache->statistics.final_out,
+                                             &cache->statistics.thumbnail})
+  {
+    /* The memory usage is not a counter, it stays valid. */
+    statistics->hits = 0;
+    statistics->misses = 0;
+    statistics->evictions = 0;
+  }
+}
+
 bool seq_cache_is_full()
 {
   return seq_cache_get_mem_total() < MEM_get_memory_in_use();
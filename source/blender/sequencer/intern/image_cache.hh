@@ -22,6 +22,9 @@ struct SeqCacheKey {
   void *userkey;
   SeqCacheKey *link_prev; /* Used for linking intermediate items to final frame. */
   SeqCacheKey *link_next; /* Used for linking intermediate items to final frame. */
+  SeqCacheKey *lru_prev;  /* Least recently used list of permanent keys, see #SeqCache. */
+  SeqCacheKey *lru_next;
+  bool is_in_lru;
   Sequence *seq;
   SeqRenderData context;
   float frame_index;    /* Usually same as timeline_frame. Mapped to media for RAW entries. */
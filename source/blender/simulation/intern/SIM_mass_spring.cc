@@ -19,6 +19,7 @@
 #include "BLI_math_vector.h"
 #include "BLI_math_vector.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_cloth.hh"
 #include "BKE_collision.h"
@@ -775,13 +776,37 @@ static void cloth_calc_force(
   }
 
   /* calculate spring forces */
+  blender::Vector<ClothSpring *> springs;
   for (LinkNode *link = cloth->springs; link; link = link->next) {
-    ClothSpring *spring = (ClothSpring *)link->link;
-    /* only handle active springs */
-    if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
-      cloth_calc_spring_force(clmd, spring);
-    }
+    springs.append((ClothSpring *)link->link);
   }
+  SIM_mass_spring_force_springs_parallel(
+      data,
+      springs.size(),
+      [&](const int i, blender::Vector<int, 16> &r_verts) {
+        const ClothSpring *spring = springs[i];
+        r_verts.append(spring->ij);
+        r_verts.append(spring->kl);
+        if (spring->type & CLOTH_SPRING_TYPE_BENDING_HAIR) {
+          r_verts.append(spring->mn);
+        }
+        /* Angular bending springs also add forces to the vertices of both faces. */
+        if (spring->pa) {
+          r_verts.extend(blender::Span(spring->pa, spring->la));
+        }
+        if (spring->pb) {
+          r_verts.extend(blender::Span(spring->pb, spring->lb));
+        }
+        /* Same number of blocks as in #cloth_count_nondiag_blocks. */
+        return (spring->type == CLOTH_SPRING_TYPE_BENDING_HAIR) ? 3 : 1;
+      },
+      [&](const int i) {
+        ClothSpring *spring = springs[i];
+        /* only handle active springs */
+        if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
+          cloth_calc_spring_force(clmd, spring);
+        }
+      });
 }
 
 /* returns vertices' motion state */
@@ -14,6 +14,11 @@
 
 #include "BKE_collision.h"
 
+#ifdef __cplusplus
+#  include "BLI_function_ref.hh"
+#  include "BLI_vector.hh"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -283,3 +288,25 @@ void SIM_hair_volume_vertex_grid_forces(struct HairGrid *grid,
 #ifdef __cplusplus
 }
 #endif
+
+#ifdef __cplusplus
+/**
+ * Compute the forces of many springs on multiple threads. Springs are split into levels of
+ * springs that don't share vertices, the levels are computed one after the other and the springs
+ * of a level in parallel. Every spring adds its blocks into slots reserved in spring order, so the
+ * result is exactly the same as computing all springs in order on one thread.
+ *
+ * The levels are cached in the solver data and only rebuilt when the number of springs changes,
+ * so the vertices of the springs must not change during the lifetime of the solver.
+ *
+ * \param spring_verts_fn: Get all vertices that a spring adds forces to, and return the maximum
+ * number of blocks that the spring adds.
+ * \param spring_force_fn: Compute the force of a spring with the
+ * `SIM_mass_spring_force_spring_*` functions.
+ */
+void SIM_mass_spring_force_springs_parallel(
+    struct Implicit_Data *data,
+    int springs_num,
+    blender::FunctionRef<int(int spring, blender::Vector<int, 16> &r_verts)> spring_verts_fn,
+    blender::FunctionRef<void(int spring)> spring_force_fn);
+#endif
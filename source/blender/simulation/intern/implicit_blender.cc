@@ -17,9 +17,12 @@
 #  include "DNA_scene_types.h"
 #  include "DNA_texture_types.h"
 
+#  include "BLI_array.hh"
 #  include "BLI_math_geom.h"
 #  include "BLI_math_matrix.h"
 #  include "BLI_math_vector.h"
+#  include "BLI_offset_indices.hh"
+#  include "BLI_task.hh"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.hh"
@@ -28,13 +31,19 @@
 
 #  include "SIM_mass_spring.h"
 
+
 #  ifdef __GNUC__
 #    pragma GCC diagnostic ignored "-Wtype-limits"
 #  endif
 
-#  ifdef _OPENMP
-#    define CLOTH_OPENMP_LIMIT 512
-#  endif
+/* Number of vertices handled by one task in the long vector and big matrix functions. */
+#  define CLOTH_PARALLEL_GRAIN_SIZE 2048
+
+using blender::Array;
+using blender::IndexRange;
+using blender::MutableSpan;
+using blender::OffsetIndices;
+using blender::Span;
 
 // #define DEBUG_TIME
 
@@ -119,6 +128,17 @@ DO_INLINE void print_lfvector(float (*fLongVector)[3], uint verts)
 }
 #  endif
 
+/* Call `fn(i)` for every index of a long vector or big matrix, on multiple threads. */
+template<typename Fn> BLI_INLINE void parallel_for_each_index(uint size, const Fn &fn)
+{
+  blender::threading::parallel_for(
+      IndexRange(size), CLOTH_PARALLEL_GRAIN_SIZE, [&](const IndexRange range) {
+        for (const int64_t i : range) {
+          fn(i);
+        }
+      });
+}
+
 /* create long vector */
 DO_INLINE lfVector *create_lfvector(uint verts)
 {
@@ -142,10 +162,7 @@ DO_INLINE void cp_lfvector(float (*to)[3], float (*from)[3], uint verts)
 /* init long vector with float[3] */
 DO_INLINE void init_lfvector(float (*fLongVector)[3], const float vector[3], uint verts)
 {
-  uint i = 0;
-  for (i = 0; i < verts; i++) {
-    copy_v3_v3(fLongVector[i], vector);
-  }
+  parallel_for_each_index(verts, [&](const int64_t i) { copy_v3_v3(fLongVector[i], vector); });
 }
 /* zero long vector with float[3] */
 DO_INLINE void zero_lfvector(float (*to)[3], uint verts)
@@ -155,20 +172,15 @@ DO_INLINE void zero_lfvector(float (*to)[3], uint verts)
 /* Multiply long vector with scalar. */
 DO_INLINE void mul_lfvectorS(float (*to)[3], float (*fLongVector)[3], float scalar, uint verts)
 {
-  uint i = 0;
-
-  for (i = 0; i < verts; i++) {
-    mul_fvector_S(to[i], fLongVector[i], scalar);
-  }
+  parallel_for_each_index(
+      verts, [&](const int64_t i) { mul_fvector_S(to[i], fLongVector[i], scalar); });
 }
 /* Multiply long vector with scalar.
  * `A -= B * float` */
 DO_INLINE void submul_lfvectorS(float (*to)[3], float (*fLongVector)[3], float scalar, uint verts)
 {
-  uint i = 0;
-  for (i = 0; i < verts; i++) {
-    VECSUBMUL(to[i], fLongVector[i], scalar);
-  }
+  parallel_for_each_index(verts,
+                          [&](const int64_t i) { VECSUBMUL(to[i], fLongVector[i], scalar); });
 }
 /* dot product for big vector */
 DO_INLINE float dot_lfvector(float (*fLongVectorA)[3], float (*fLongVectorB)[3], uint verts)
@@ -191,21 +203,15 @@ DO_INLINE void add_lfvector_lfvector(float (*to)[3],
                                      float (*fLongVectorB)[3],
                                      uint verts)
 {
-  uint i = 0;
-
-  for (i = 0; i < verts; i++) {
-    add_v3_v3v3(to[i], fLongVectorA[i], fLongVectorB[i]);
-  }
+  parallel_for_each_index(
+      verts, [&](const int64_t i) { add_v3_v3v3(to[i], fLongVectorA[i], fLongVectorB[i]); });
 }
 /* `A = B + C * float` -> for big vector. */
 DO_INLINE void add_lfvector_lfvectorS(
     float (*to)[3], float (*fLongVectorA)[3], float (*fLongVectorB)[3], float bS, uint verts)
 {
-  uint i = 0;
-
-  for (i = 0; i < verts; i++) {
-    VECADDS(to[i], fLongVectorA[i], fLongVectorB[i], bS);
-  }
+  parallel_for_each_index(
+      verts, [&](const int64_t i) { VECADDS(to[i], fLongVectorA[i], fLongVectorB[i], bS); });
 }
 /* `A = B * float + C * float` -> for big vector */
 DO_INLINE void add_lfvectorS_lfvectorS(float (*to)[3],
@@ -215,20 +221,16 @@ DO_INLINE void add_lfvectorS_lfvectorS(float (*to)[3],
                                        float bS,
                                        uint verts)
 {
-  uint i = 0;
-
-  for (i = 0; i < verts; i++) {
+  parallel_for_each_index(verts, [&](const int64_t i) {
     VECADDSS(to[i], fLongVectorA[i], aS, fLongVectorB[i], bS);
-  }
+  });
 }
 /* `A = B - C * float` -> for big vector. */
 DO_INLINE void sub_lfvector_lfvectorS(
     float (*to)[3], float (*fLongVectorA)[3], float (*fLongVectorB)[3], float bS, uint verts)
 {
-  uint i = 0;
-  for (i = 0; i < verts; i++) {
-    VECSUBS(to[i], fLongVectorA[i], fLongVectorB[i], bS);
-  }
+  parallel_for_each_index(
+      verts, [&](const int64_t i) { VECSUBS(to[i], fLongVectorA[i], fLongVectorB[i], bS); });
 }
 /* `A = B - C` -> for big vector. */
 DO_INLINE void sub_lfvector_lfvector(float (*to)[3],
@@ -236,11 +238,8 @@ DO_INLINE void sub_lfvector_lfvector(float (*to)[3],
                                      float (*fLongVectorB)[3],
                                      uint verts)
 {
-  uint i = 0;
-
-  for (i = 0; i < verts; i++) {
-    sub_v3_v3v3(to[i], fLongVectorA[i], fLongVectorB[i]);
-  }
+  parallel_for_each_index(
+      verts, [&](const int64_t i) { sub_v3_v3v3(to[i], fLongVectorA[i], fLongVectorB[i]); });
 }
 ///////////////////////////
 // 3x3 matrix
@@ -557,60 +556,102 @@ DO_INLINE void cp_bfmatrix(fmatrix3x3 *to, fmatrix3x3 *from)
 }
 
 /* init big matrix */
-/* slow in parallel */
 DO_INLINE void init_bfmatrix(fmatrix3x3 *matrix, float m3[3][3])
 {
-  uint i;
-
-  for (i = 0; i < matrix[0].vcount + matrix[0].scount; i++) {
-    cp_fmatrix(matrix[i].m, m3);
-  }
+  parallel_for_each_index(matrix[0].vcount + matrix[0].scount,
+                          [&](const int64_t i) { cp_fmatrix(matrix[i].m, m3); });
 }
 
 /* init the diagonal of big matrix */
-/* slow in parallel */
 DO_INLINE void initdiag_bfmatrix(fmatrix3x3 *matrix, float m3[3][3])
 {
-  uint i, j;
   float tmatrix[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
 
-  for (i = 0; i < matrix[0].vcount; i++) {
-    cp_fmatrix(matrix[i].m, m3);
+  parallel_for_each_index(matrix[0].vcount + matrix[0].scount, [&](const int64_t i) {
+    cp_fmatrix(matrix[i].m, i < int64_t(matrix[0].vcount) ? m3 : tmatrix);
+  });
+}
+
+/**
+ * Off-diagonal blocks of a big matrix grouped by their row and by their column vertex, so that
+ * the product with a long vector can be computed for every vertex independently. Within a row or
+ * column the blocks keep their order in the matrix.
+ */
+struct BigMatrixLayout {
+  Array<int> row_offsets;
+  Array<int> row_blocks;
+  Array<int> col_offsets;
+  Array<int> col_blocks;
+};
+
+static void build_bfmatrix_group(const fmatrix3x3 *matrix,
+                                 const int num_blocks,
+                                 const bool by_column,
+                                 Array<int> &r_offsets,
+                                 Array<int> &r_blocks)
+{
+  const int vcount = matrix[0].vcount;
+  Array<int> verts(num_blocks);
+  for (const int i : verts.index_range()) {
+    const fmatrix3x3 &block = matrix[vcount + i];
+    verts[i] = by_column ? block.c : block.r;
   }
-  for (j = matrix[0].vcount; j < matrix[0].vcount + matrix[0].scount; j++) {
-    cp_fmatrix(matrix[j].m, tmatrix);
+  r_offsets.reinitialize(vcount + 1);
+  r_offsets.fill(0);
+  blender::offset_indices::build_reverse_offsets(verts, r_offsets);
+
+  /* Fill the groups in block order, which gives the same summation order as a loop over all
+   * blocks of the matrix. */
+  Array<int> cursor(r_offsets.as_span().drop_back(1));
+  r_blocks.reinitialize(num_blocks);
+  for (const int i : verts.index_range()) {
+    r_blocks[cursor[verts[i]]++] = vcount + i;
   }
 }
 
-/* SPARSE SYMMETRIC multiply big matrix with long vector. */
-/* STATUS: verified */
-DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3], fmatrix3x3 *from, lfVector *fLongVector)
+static void build_bfmatrix_layout(const fmatrix3x3 *matrix,
+                                  const int num_blocks,
+                                  BigMatrixLayout &layout)
 {
-  uint vcount = from[0].vcount;
-  lfVector *temp = create_lfvector(vcount);
-
-  zero_lfvector(to, vcount);
+  blender::threading::parallel_invoke(
+      num_blocks > CLOTH_PARALLEL_GRAIN_SIZE,
+      [&]() {
+        build_bfmatrix_group(matrix, num_blocks, false, layout.row_offsets, layout.row_blocks);
+      },
+      [&]() {
+        build_bfmatrix_group(matrix, num_blocks, true, layout.col_offsets, layout.col_blocks);
+      });
+}
 
-#  pragma omp parallel sections if (vcount > CLOTH_OPENMP_LIMIT)
-  {
-#  pragma omp section
-    {
-      for (uint i = from[0].vcount; i < from[0].vcount + from[0].scount; i++) {
-        /* This is the lower triangle of the sparse matrix,
-         * therefore multiplication occurs with transposed sub-matrices. */
-        muladd_fmatrixT_fvector(to[from[i].c], from[i].m, fLongVector[from[i].r]);
-      }
+/* SPARSE SYMMETRIC multiply big matrix with long vector. */
+/* STATUS: verified */
+DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3],
+                                     fmatrix3x3 *from,
+                                     const BigMatrixLayout &layout,
+                                     lfVector *fLongVector)
+{
+  const OffsetIndices<int> rows(layout.row_offsets);
+  const OffsetIndices<int> cols(layout.col_offsets);
+
+  /* Sums are computed in the same order as a sequential loop over all blocks, so the result does
+   * not depend on the number of threads. */
+  parallel_for_each_index(from[0].vcount, [&](const int64_t v) {
+    float col_sum[3] = {0.0f, 0.0f, 0.0f};
+    float row_sum[3] = {0.0f, 0.0f, 0.0f};
+
+    for (const int i : layout.col_blocks.as_span().slice(cols[v])) {
+      /* This is the lower triangle of the sparse matrix,
+       * therefore multiplication occurs with transposed sub-matrices. */
+      muladd_fmatrixT_fvector(col_sum, from[i].m, fLongVector[from[i].r]);
     }
-#  pragma omp section
-    {
-      for (uint i = 0; i < from[0].vcount + from[0].scount; i++) {
-        muladd_fmatrix_fvector(temp[from[i].r], from[i].m, fLongVector[from[i].c]);
-      }
+
+    muladd_fmatrix_fvector(row_sum, from[v].m, fLongVector[v]);
+    for (const int i : layout.row_blocks.as_span().slice(rows[v])) {
+      muladd_fmatrix_fvector(row_sum, from[i].m, fLongVector[from[i].c]);
     }
-  }
-  add_lfvector_lfvector(to, to, temp, from[0].vcount);
 
-  del_lfvector(temp);
+    add_v3_v3v3(to[v], col_sum, row_sum);
+  });
 }
 
 /* SPARSE SYMMETRIC sub big matrix with big matrix. */
@@ -619,18 +660,32 @@ DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3], fmatrix3x3 *from, lfVector
 DO_INLINE void subadd_bfmatrixS_bfmatrixS(
     fmatrix3x3 *to, fmatrix3x3 *from, float aS, fmatrix3x3 *matrix, float bS)
 {
-  uint i = 0;
-
-  /* process diagonal elements */
-  for (i = 0; i < matrix[0].vcount + matrix[0].scount; i++) {
+  parallel_for_each_index(matrix[0].vcount + matrix[0].scount, [&](const int64_t i) {
     subadd_fmatrixS_fmatrixS(to[i].m, from[i].m, aS, matrix[i].m, bS);
-  }
+  });
 }
 
 ///////////////////////////////////////////////////////////////////
 /* simulator start */
 ///////////////////////////////////////////////////////////////////
 
+/**
+ * Springs split into levels of springs that don't share any vertices, so that all springs of a
+ * level can add their forces at the same time. See #SIM_mass_spring_force_springs_parallel.
+ */
+struct SpringSchedule {
+  int springs_num = 0;
+  /**
+   * Spring indices of every level, in spring order. Every vertex gets the forces of its springs
+   * in spring order, because a spring is always in a later level than the previous springs that
+   * share one of its vertices.
+   */
+  Array<int> level_offsets;
+  Array<int> level_springs;
+  /** Offsets of the blocks reserved for every spring, in spring order. */
+  Array<int> block_offsets;
+};
+
 struct Implicit_Data {
   /* inputs */
   fmatrix3x3 *bigI;        /* identity (constant) */
@@ -652,6 +707,8 @@ struct Implicit_Data {
   lfVector *z;          /* target velocity in constrained directions */
   fmatrix3x3 *S;        /* filtering matrix for constraints */
   fmatrix3x3 *P, *Pinv; /* pre-conditioning matrix */
+
+  SpringSchedule *spring_schedule; /* cached schedule for parallel spring forces */
 };
 
 Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
@@ -703,6 +760,8 @@ void SIM_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->dV);
   del_lfvector(id->z);
 
+  MEM_delete(id->spring_schedule);
+
   MEM_freeN(id);
 }
 
@@ -742,11 +801,7 @@ BLI_INLINE void root_to_world_m3(Implicit_Data *data,
 
 DO_INLINE void filter(lfVector *V, fmatrix3x3 *S)
 {
-  uint i = 0;
-
-  for (i = 0; i < S[0].vcount; i++) {
-    mul_m3_v3(S[i].m, V[S[i].r]);
-  }
+  parallel_for_each_index(S[0].vcount, [&](const int64_t i) { mul_m3_v3(S[i].m, V[S[i].r]); });
 }
 
 /* this version of the CG algorithm does not work very well with partial constraints
@@ -821,6 +876,7 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 
 static int cg_filtered(lfVector *ldV,
                        fmatrix3x3 *lA,
+                       const BigMatrixLayout &layout,
                        lfVector *lB,
                        lfVector *z,
                        fmatrix3x3 *S,
@@ -848,7 +904,7 @@ static int cg_filtered(lfVector *ldV,
   delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
   /* r = filter(B - A * dV) */
-  mul_bfmatrix_lfvector(AdV, lA, ldV);
+  mul_bfmatrix_lfvector(AdV, lA, layout, ldV);
   sub_lfvector_lfvector(r, lB, AdV, numverts);
   filter(r, S);
 
@@ -871,7 +927,7 @@ static int cg_filtered(lfVector *ldV,
 #  endif
 
   while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-    mul_bfmatrix_lfvector(q, lA, c);
+    mul_bfmatrix_lfvector(q, lA, layout, c);
     filter(q, S);
 
     alpha = delta_new / dot_lfvector(c, q, numverts);
@@ -1131,7 +1187,11 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 
   subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  /* All matrices share the block structure of the force jacobians. */
+  BigMatrixLayout layout;
+  build_bfmatrix_layout(data->dFdX, data->num_blocks, layout);
+
+  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, layout, data->V);
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1140,7 +1200,7 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 #  endif
 
   /* Conjugate gradient algorithm to solve Ax=b. */
-  cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
+  cg_filtered(data->dV, data->A, layout, data->B, data->z, data->S, result);
 
   // cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 
@@ -1251,11 +1311,29 @@ void SIM_mass_spring_set_new_velocity(Implicit_Data *data, int index, const floa
 
 /* -------------------------------- */
 
+/**
+ * Blocks reserved for the spring that is computed on the current thread, see
+ * #SIM_mass_spring_force_springs_parallel.
+ */
+struct SpringBlockReservation {
+  int next;
+  int end;
+};
+
+static thread_local SpringBlockReservation *spring_block_reservation = nullptr;
+
 static int SIM_mass_spring_add_block(Implicit_Data *data, int v1, int v2)
 {
-  int s = data->M[0].vcount + data->num_blocks; /* index from array start */
+  /* Index from array start. */
+  int s;
+  if (SpringBlockReservation *reservation = spring_block_reservation) {
+    BLI_assert(reservation->next < reservation->end);
+    s = data->M[0].vcount + reservation->next++;
+  }
+  else {
+    s = data->M[0].vcount + data->num_blocks++;
+  }
   BLI_assert(s < data->M[0].vcount + data->M[0].scount);
-  ++data->num_blocks;
 
   /* tfm and S don't have spring entries (diagonal blocks only) */
   init_fmatrix(data->bigI + s, v1, v2);
@@ -2336,4 +2414,154 @@ bool SIM_mass_spring_force_spring_goal(Implicit_Data *data,
   return false;
 }
 
+/* -------------------------------- */
+
+/* Levels with fewer springs are computed on the calling thread. */
+#  define SPRING_LEVEL_PARALLEL_MIN 256
+
+static void build_spring_schedule(
+    const int verts_num,
+    const int springs_num,
+    const blender::FunctionRef<int(int spring, blender::Vector<int, 16> &r_verts)> verts_fn,
+    SpringSchedule &schedule)
+{
+  /* Every spring goes into the level after the last level that uses any of its vertices. */
+  Array<int> vert_next_level(verts_num, 0);
+  Array<int> spring_levels(springs_num);
+  schedule.block_offsets.reinitialize(springs_num + 1);
+  blender::Vector<int, 16> verts;
+  int levels_num = 0;
+  for (const int spring : spring_levels.index_range()) {
+    verts.clear();
+    schedule.block_offsets[spring] = verts_fn(spring, verts);
+    int level = 0;
+    for (const int vert : verts) {
+      level = std::max(level, vert_next_level[vert]);
+    }
+    for (const int vert : verts) {
+      vert_next_level[vert] = level + 1;
+    }
+    spring_levels[spring] = level;
+    levels_num = std::max(levels_num, level + 1);
+  }
+  blender::offset_indices::accumulate_counts_to_offsets(schedule.block_offsets);
+
+  schedule.springs_num = springs_num;
+  schedule.level_offsets.reinitialize(levels_num + 1);
+  schedule.level_offsets.fill(0);
+  blender::offset_indices::build_reverse_offsets(spring_levels, schedule.level_offsets);
+
+  Array<int> cursor(schedule.level_offsets.as_span().drop_back(1));
+  schedule.level_springs.reinitialize(springs_num);
+  for (const int spring : spring_levels.index_range()) {
+    schedule.level_springs[cursor[spring_levels[spring]]++] = spring;
+  }
+}
+
+static void compute_spring_force(const SpringSchedule &schedule,
+                                 const int first_block,
+                                 const int spring,
+                                 const blender::FunctionRef<void(int spring)> spring_force_fn,
+                                 MutableSpan<int> r_blocks_num)
+{
+  const IndexRange blocks = OffsetIndices<int>(schedule.block_offsets)[spring];
+  SpringBlockReservation reservation{first_block + int(blocks.start()),
+                                     first_block + int(blocks.one_after_last())};
+  spring_block_reservation = &reservation;
+  spring_force_fn(spring);
+  spring_block_reservation = nullptr;
+  r_blocks_num[spring] = reservation.next - first_block - int(blocks.start());
+}
+
+/**
+ * Move the blocks that were added into the reserved slots together, keeping them in spring order
+ * like the blocks of a sequential loop over all springs.
+ */
+static void compact_spring_blocks(Implicit_Data *data,
+                                  const SpringSchedule &schedule,
+                                  const int first_block,
+                                  MutableSpan<int> blocks_num)
+{
+  const OffsetIndices<int> reserved(schedule.block_offsets);
+  const OffsetIndices<int> used = blender::offset_indices::accumulate_counts_to_offsets(
+      blocks_num);
+  data->num_blocks = first_block + used.total_size();
+  if (used.total_size() == reserved.total_size()) {
+    return;
+  }
+
+  const int start = data->M[0].vcount + first_block;
+  fmatrix3x3 *dFdX = data->dFdX;
+  fmatrix3x3 *dFdV = data->dFdV;
+  Array<fmatrix3x3> used_dFdX(used.total_size());
+  Array<fmatrix3x3> used_dFdV(used.total_size());
+  parallel_for_each_index(schedule.springs_num, [&](const int64_t spring) {
+    for (const int i : used[spring].index_range()) {
+      used_dFdX[used[spring][i]] = dFdX[start + reserved[spring][i]];
+      used_dFdV[used[spring][i]] = dFdV[start + reserved[spring][i]];
+    }
+  });
+  parallel_for_each_index(used.total_size(), [&](const int64_t i) {
+    const int s = start + int(i);
+    const int v1 = used_dFdX[i].r;
+    const int v2 = used_dFdX[i].c;
+    copy_m3_m3(dFdX[s].m, used_dFdX[i].m);
+    copy_m3_m3(dFdV[s].m, used_dFdV[i].m);
+    init_fmatrix(data->bigI + s, v1, v2);
+    init_fmatrix(data->M + s, v1, v2);
+    init_fmatrix(dFdX + s, v1, v2);
+    init_fmatrix(dFdV + s, v1, v2);
+    init_fmatrix(data->A + s, v1, v2);
+    init_fmatrix(data->P + s, v1, v2);
+    init_fmatrix(data->Pinv + s, v1, v2);
+  });
+}
+
+void SIM_mass_spring_force_springs_parallel(
+    Implicit_Data *data,
+    int springs_num,
+    blender::FunctionRef<int(int spring, blender::Vector<int, 16> &r_verts)> spring_verts_fn,
+    blender::FunctionRef<void(int spring)> spring_force_fn)
+{
+  if (data->spring_schedule == nullptr) {
+    data->spring_schedule = MEM_new<SpringSchedule>(__func__);
+  }
+  SpringSchedule &schedule = *data->spring_schedule;
+  if (schedule.springs_num != springs_num || schedule.level_offsets.is_empty()) {
+    build_spring_schedule(data->M[0].vcount, springs_num, spring_verts_fn, schedule);
+  }
+
+  const int first_block = data->num_blocks;
+  if (first_block + schedule.block_offsets.last() > int(data->M[0].scount)) {
+    /* Not enough space to reserve the blocks, the springs can't be computed in parallel. */
+    for (const int spring : IndexRange(springs_num)) {
+      spring_force_fn(spring);
+    }
+    return;
+  }
+
+  /* Springs of a level write to different vertices and each add their blocks into the slots that
+   * are reserved for them, so the result is the same as computing the springs in order. */
+  Array<int> blocks_num(springs_num + 1);
+  const OffsetIndices<int> levels(schedule.level_offsets);
+  for (const int level : levels.index_range()) {
+    const Span<int> springs = schedule.level_springs.as_span().slice(levels[level]);
+    if (springs.size() < SPRING_LEVEL_PARALLEL_MIN) {
+      for (const int spring : springs) {
+        compute_spring_force(schedule, first_block, spring, spring_force_fn, blocks_num);
+      }
+      continue;
+    }
+    blender::threading::parallel_for(springs.index_range(), 256, [&](const IndexRange range) {
+      for (const int spring : springs.slice(range)) {
+        compute_spring_force(schedule, first_block, spring, spring_force_fn, blocks_num);
+      }
+    });
+  }
+
+  compact_spring_blocks(data, schedule, first_block, blocks_num);
+}
+
+#  undef SPRING_LEVEL_PARALLEL_MIN
+
 #endif /* IMPLICIT_SOLVER_BLENDER */
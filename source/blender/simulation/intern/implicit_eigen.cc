@@ -701,6 +701,18 @@ void SIM_mass_spring_clear_forces(Implicit_Data *data)
   data->dFdV.setZero();
 }
 
+void SIM_mass_spring_force_springs_parallel(
+    Implicit_Data * /*data*/,
+    int springs_num,
+    blender::FunctionRef<int(int spring, blender::Vector<int, 16> &r_verts)> /*spring_verts_fn*/,
+    blender::FunctionRef<void(int spring)> spring_force_fn)
+{
+  /* All springs add to the same triplet lists, compute them one after the other. */
+  for (int i = 0; i < springs_num; i++) {
+    spring_force_fn(i);
+  }
+}
+
 void SIM_mass_spring_force_reference_frame(Implicit_Data *data,
                                            int index,
                                            const float acceleration[3],
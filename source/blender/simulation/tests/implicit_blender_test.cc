@@ -0,0 +1,173 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "SIM_mass_spring.h"
+#include "implicit.h"
+
+#ifdef WITH_TBB
+#  include <tbb/task_arena.h>
+#endif
+
+namespace blender::sim::tests {
+
+struct TestSpring {
+  int i;
+  int j;
+  float restlen;
+  bool bending;
+};
+
+struct TestCloth {
+  Array<float3> positions;
+  Vector<TestSpring> springs;
+};
+
+/**
+ * Square grid of stretched and slightly wrinkled cloth with structural, shear and bending springs.
+ * Some of the springs don't add any force, so that not all reserved blocks are used.
+ */
+static TestCloth create_grid(const int size)
+{
+  TestCloth cloth;
+  cloth.positions.reinitialize(size * size);
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      cloth.positions[y * size + x] = float3(
+          float(x) * 1.1f, float(y) * 1.1f, 0.05f * std::sin(float(x * 7 + y * 3)));
+    }
+  }
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const int v = y * size + x;
+      if (x + 1 < size) {
+        cloth.springs.append({v, v + 1, 1.0f, false});
+      }
+      if (y + 1 < size) {
+        cloth.springs.append({v, v + size, 1.0f, false});
+      }
+      if (x + 1 < size && y + 1 < size) {
+        cloth.springs.append({v, v + size + 1, float(M_SQRT2), false});
+        /* Compressed without compression resistance, no force. */
+        cloth.springs.append({v + 1, v + size, 1.6f, false});
+      }
+      if (x + 2 < size) {
+        /* Bending springs only add a force when they are compressed. */
+        cloth.springs.append({v, v + 2, (x % 2) ? 2.0f : 2.3f, true});
+      }
+    }
+  }
+  return cloth;
+}
+
+static void add_spring_force(Implicit_Data *data, const TestSpring &spring)
+{
+  if (spring.bending) {
+    SIM_mass_spring_force_spring_bending(data, spring.i, spring.j, spring.restlen, 2.0f, 2.0f);
+    return;
+  }
+  SIM_mass_spring_force_spring_linear(
+      data, spring.i, spring.j, spring.restlen, 15.0f, 5.0f, 15.0f, 5.0f, false, false, 0.0f);
+}
+
+template<typename Fn> static void run_with_threads(const int threads_num, const Fn &fn)
+{
+#ifdef WITH_TBB
+  tbb::task_arena arena(threads_num);
+  arena.execute(fn);
+#else
+  UNUSED_VARS(threads_num);
+  fn();
+#endif
+}
+
+/**
+ * Solve one time step and return the new velocities. The spring forces are added in order on the
+ * calling thread when \a threads_num is zero.
+ */
+static Array<float3> solve_step(const TestCloth &cloth, const int threads_num)
+{
+  const int verts_num = int(cloth.positions.size());
+  Implicit_Data *data = SIM_mass_spring_solver_create(verts_num, int(cloth.springs.size()));
+
+  float tfm[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+  const float3 velocity(0.0f, 0.0f, 0.1f);
+  const float3 gravity(0.0f, 0.0f, -9.81f);
+  for (const int v : IndexRange(verts_num)) {
+    SIM_mass_spring_set_vertex_mass(data, v, 0.3f);
+    SIM_mass_spring_set_rest_transform(data, v, tfm);
+    SIM_mass_spring_set_motion_state(data, v, cloth.positions[v], velocity);
+  }
+
+  SIM_mass_spring_clear_constraints(data);
+  SIM_mass_spring_add_constraint_ndof0(data, 0, float3(0.0f));
+  SIM_mass_spring_add_constraint_ndof0(data, verts_num - 1, float3(0.0f));
+
+  SIM_mass_spring_clear_forces(data);
+  for (const int v : IndexRange(verts_num)) {
+    SIM_mass_spring_force_gravity(data, v, 0.3f, gravity);
+  }
+  if (threads_num > 0) {
+    run_with_threads(threads_num, [&]() {
+      SIM_mass_spring_force_springs_parallel(
+          data,
+          int(cloth.springs.size()),
+          [&](const int i, Vector<int, 16> &r_verts) {
+            r_verts.append(cloth.springs[i].i);
+            r_verts.append(cloth.springs[i].j);
+            return 1;
+          },
+          [&](const int i) { add_spring_force(data, cloth.springs[i]); });
+    });
+  }
+  else {
+    for (const TestSpring &spring : cloth.springs) {
+      add_spring_force(data, spring);
+    }
+  }
+
+  ImplicitSolverResult result;
+  SIM_mass_spring_solve_velocities(data, 0.02f, &result);
+  EXPECT_EQ(result.status, SIM_SOLVER_SUCCESS);
+
+  Array<float3> new_velocities(verts_num);
+  for (const int v : IndexRange(verts_num)) {
+    SIM_mass_spring_get_new_velocity(data, v, new_velocities[v]);
+  }
+
+  SIM_mass_spring_solver_free(data);
+  return new_velocities;
+}
+
+TEST(implicit_blender, ParallelSpringsMatchSequential)
+{
+  const TestCloth cloth = create_grid(64);
+  const Array<float3> sequential = solve_step(cloth, 0);
+  for (const int threads_num : {1, 2, 3, 8}) {
+    const Array<float3> parallel = solve_step(cloth, threads_num);
+    for (const int v : sequential.index_range()) {
+      EXPECT_EQ(sequential[v], parallel[v]);
+    }
+  }
+}
+
+TEST(implicit_blender, ParallelSpringsDeterministic)
+{
+  const TestCloth cloth = create_grid(64);
+  const Array<float3> first = solve_step(cloth, 8);
+  for ([[maybe_unused]] const int iteration : IndexRange(4)) {
+    const Array<float3> result = solve_step(cloth, 8);
+    for (const int v : first.index_range()) {
+      EXPECT_EQ(first[v], result[v]);
+    }
+  }
+}
+
+}  // namespace blender::sim::tests
@@ -2018,6 +2018,7 @@ static bool wm_file_write(bContext *C,
   blend_write_params.remap_mode = remap_mode;
   blend_write_params.use_save_versions = true;
   blend_write_params.use_save_as_copy = use_save_as_copy;
+  blend_write_params.use_parallel_write = USER_EXPERIMENTAL_TEST(&U, use_parallel_blend_write);
   blend_write_params.thumb = thumb;
 
   const bool success = BLO_write_file(bmain, filepath, fileflags, &blend_write_params, reports);
@@ -2129,6 +2130,7 @@ static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
 
     /* Error reporting into console. */
     BlendFileWriteParams params{};
+    params.use_parallel_write = USER_EXPERIMENTAL_TEST(&U, use_parallel_blend_write);
     BLO_write_file(bmain, filepath, fileflags, &params, nullptr);
   }
 }
@@ -674,6 +674,7 @@ static void print_help(bArgs *ba, bool all)
   }
   BLI_args_print_arg_doc(ba, "--debug-all");
   BLI_args_print_arg_doc(ba, "--debug-io");
+  BLI_args_print_arg_doc(ba, "--debug-geometry-nodes-profile");
 
   PRINT("\n");
   BLI_args_print_arg_doc(ba, "--debug-fpe");
@@ -696,6 +697,7 @@ static void print_help(bArgs *ba, bool all)
   BLI_args_print_arg_doc(ba, "--app-template");
   BLI_args_print_arg_doc(ba, "--factory-startup");
   BLI_args_print_arg_doc(ba, "--enable-event-simulate");
+  BLI_args_print_arg_doc(ba, "--enable-mmap-sharing");
   PRINT("\n");
   BLI_args_print_arg_doc(ba, "--env-system-datafiles");
   BLI_args_print_arg_doc(ba, "--env-system-scripts");
@@ -1209,6 +1211,24 @@ static int arg_handle_debug_gpu_set(int /*argc*/, const char ** /*argv*/, void *
   return 0;
 }
 
+static const char arg_handle_debug_geometry_nodes_profile_set_doc[] =
+    "<directory>\n"
+    "\tProfile every evaluation of geometry nodes modifiers and write the results to the\n"
+    "\tdirectory as Chrome trace files (one file per modifier and frame).";
+static int arg_handle_debug_geometry_nodes_profile_set(int argc,
+                                                       const char **argv,
+                                                       void * /*data*/)
+{
+  const char *arg_id = "--debug-geometry-nodes-profile";
+  if (argc > 1) {
+    STRNCPY(G.geometry_nodes_profile_dir, argv[1]);
+    BLI_path_abs_from_cwd(G.geometry_nodes_profile_dir, sizeof(G.geometry_nodes_profile_dir));
+    return 1;
+  }
+  fprintf(stderr, "\nError: '%s' no args given.\n", arg_id);
+  return 0;
+}
+
 static const char arg_handle_debug_gpu_renderdoc_set_doc[] =
     "\n"
     "\tEnable Renderdoc integration for GPU frame grabbing and debugging.";
@@ -1331,6 +1351,17 @@ static int arg_handle_enable_event_simulate(int /*argc*/, const char ** /*argv*/
   return 0;
 }
 
+static const char arg_handle_enable_mmap_sharing_doc[] =
+    "\n\t"
+    "Reference large data arrays of uncompressed blend-files directly in the mapped file.\n"
+    "\tData is only copied when it's modified, reducing memory usage and load time when\n"
+    "\tmany processes read the same files (e.g. linked asset libraries on a render farm).";
+static int arg_handle_enable_mmap_sharing(int /*argc*/, const char ** /*argv*/, void * /*data*/)
+{
+  G.f |= G_FLAG_READFILE_MMAP_SHARING;
+  return 0;
+}
+
 static const char arg_handle_env_system_set_doc_datafiles[] =
     "\n\t"
     "Set the " STRINGIFY_ARG(BLENDER_SYSTEM_DATAFILES) " environment variable.";
@@ -2400,6 +2431,11 @@ void main_args_setup(bContext *C, bArgs *ba, bool all)
   BLI_args_add(ba, nullptr, "--debug-all", CB(arg_handle_debug_mode_all), nullptr);
 
   BLI_args_add(ba, nullptr, "--debug-io", CB(arg_handle_debug_mode_io), nullptr);
+  BLI_args_add(ba,
+               nullptr,
+               "--debug-geometry-nodes-profile",
+               CB(arg_handle_debug_geometry_nodes_profile_set),
+               nullptr);
 
   BLI_args_add(ba, nullptr, "--debug-fpe", CB(arg_handle_debug_fpe_set), nullptr);
 
@@ -2477,6 +2513,7 @@ void main_args_setup(bContext *C, bArgs *ba, bool all)
   BLI_args_add(ba, nullptr, "--factory-startup", CB(arg_handle_factory_startup_set), nullptr);
   BLI_args_add(
       ba, nullptr, "--enable-event-simulate", CB(arg_handle_enable_event_simulate), nullptr);
+  BLI_args_add(ba, nullptr, "--enable-mmap-sharing", CB(arg_handle_enable_mmap_sharing), nullptr);
 
   /* Pass: Custom Window Stuff. */
   BLI_args_pass_set(ba, ARG_PASS_SETTINGS_GUI);
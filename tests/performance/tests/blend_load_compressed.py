@@ -0,0 +1,67 @@
+# SPDX-FileCopyrightText: 2024 Blender Authors
+#
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import os
+    import tempfile
+    import time
+
+    # Generate a large synthetic file: a dense grid with a few attribute layers,
+    # duplicated into independent meshes so the file has many data-blocks.
+    bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
+    bpy.ops.mesh.primitive_grid_add(x_subdivisions=args['subdivisions'], y_subdivisions=args['subdivisions'])
+    base_object = bpy.context.active_object
+    for name in ("attr_a", "attr_b", "attr_c"):
+        attribute = base_object.data.attributes.new(name, 'FLOAT_VECTOR', 'POINT')
+        attribute.data.foreach_set("vector", [float(i % 97) for i in range(len(attribute.data) * 3)])
+    for _ in range(args['copies'] - 1):
+        copy = base_object.copy()
+        copy.data = base_object.data.copy()
+        bpy.context.collection.objects.link(copy)
+
+    with tempfile.TemporaryDirectory() as tempdir:
+        filepath = os.path.join(tempdir, "synthetic_compressed.blend")
+        bpy.ops.wm.save_as_mainfile(filepath=filepath, compress=True)
+        file_size = os.path.getsize(filepath)
+
+        # Load once to ensure it's cached by OS
+        bpy.ops.wm.open_mainfile(filepath=filepath)
+        bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
+
+        # Measure loading the second time
+        start_time = time.time()
+        bpy.ops.wm.open_mainfile(filepath=filepath)
+        elapsed_time = time.time() - start_time
+
+    result = {'time': elapsed_time, 'file_size': file_size}
+    return result
+
+
+class BlendLoadCompressedTest(api.Test):
+    def __init__(self, name, subdivisions, copies):
+        self.name_ = name
+        self.subdivisions = subdivisions
+        self.copies = copies
+
+    def name(self):
+        return self.name_
+
+    def category(self):
+        return "blend_load"
+
+    def run(self, env, device_id):
+        args = {'subdivisions': self.subdivisions, 'copies': self.copies}
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    return [
+        BlendLoadCompressedTest("synthetic_compressed_medium", 1000, 8),
+        BlendLoadCompressedTest("synthetic_compressed_large", 2000, 16),
+    ]
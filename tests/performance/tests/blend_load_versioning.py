@@ -0,0 +1,43 @@
+# SPDX-FileCopyrightText: 2024 Blender Authors
+#
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(filepath):
+    import bpy
+    import time
+
+    # Load once to ensure it's cached by OS
+    bpy.ops.wm.open_mainfile(filepath=filepath)
+    bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
+
+    # Measure loading the second time, including versioning and lib-linking of all data-blocks.
+    start_time = time.time()
+    bpy.ops.wm.open_mainfile(filepath=filepath)
+    elapsed_time = time.time() - start_time
+
+    result = {'time': elapsed_time, 'file_version': "%d.%d.%d" % tuple(bpy.data.version)}
+    return result
+
+
+class BlendLoadVersioningTest(api.Test):
+    def __init__(self, filepath):
+        self.filepath = filepath
+
+    def name(self):
+        return self.filepath.stem
+
+    def category(self):
+        return "blend_load_versioning"
+
+    def run(self, env, device_id):
+        result, _ = env.run_in_blender(_run, str(self.filepath))
+        return result
+
+
+def generate(env):
+    # Files saved with older Blender versions, so that opening them runs the versioning code.
+    filepaths = env.find_blend_files('versioning/*')
+    return [BlendLoadVersioningTest(filepath) for filepath in filepaths]
@@ -0,0 +1,115 @@
+# SPDX-FileCopyrightText: 2024 Blender Authors
+#
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import os
+    import tempfile
+    import time
+
+    bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
+    scene = bpy.context.scene
+    scene.frame_start = 1
+    scene.frame_end = args['frames']
+
+    # Simulation that moves a large random point cloud along a noise field every frame.
+    tree = bpy.data.node_groups.new("Simulation", 'GeometryNodeTree')
+    tree.interface.new_socket("Geometry", in_out='OUTPUT', socket_type='NodeSocketGeometry')
+    nodes = tree.nodes
+    links = tree.links
+
+    random_position = nodes.new('FunctionNodeRandomValue')
+    random_position.data_type = 'FLOAT_VECTOR'
+    points = nodes.new('GeometryNodePoints')
+    points.inputs["Count"].default_value = args['points']
+    links.new(random_position.outputs["Value"], points.inputs["Position"])
+
+    simulation_input = nodes.new('GeometryNodeSimulationInput')
+    simulation_output = nodes.new('GeometryNodeSimulationOutput')
+    simulation_input.pair_with_output(simulation_output)
+
+    noise = nodes.new('ShaderNodeTexNoise')
+    scale = nodes.new('ShaderNodeVectorMath')
+    scale.operation = 'SCALE'
+    scale.inputs["Scale"].default_value = 0.01
+    set_position = nodes.new('GeometryNodeSetPosition')
+    group_output = nodes.new('NodeGroupOutput')
+
+    links.new(points.outputs["Points"], simulation_input.inputs["Geometry"])
+    links.new(simulation_input.outputs["Geometry"], set_position.inputs["Geometry"])
+    links.new(noise.outputs["Color"], scale.inputs[0])
+    links.new(scale.outputs["Vector"], set_position.inputs["Offset"])
+    links.new(set_position.outputs["Geometry"], simulation_output.inputs["Geometry"])
+    links.new(simulation_output.outputs["Geometry"], group_output.inputs["Geometry"])
+
+    mesh = bpy.data.meshes.new("Simulation")
+    ob = bpy.data.objects.new("Simulation", mesh)
+    scene.collection.objects.link(ob)
+    bpy.context.view_layer.objects.active = ob
+    modifier = ob.modifiers.new("Simulation", 'NODES')
+    modifier.node_group = tree
+    bake = modifier.bakes[0]
+    bake.use_compression = args['use_compression']
+    bake.use_delta_positions = args['use_delta_positions']
+
+    with tempfile.TemporaryDirectory() as tempdir:
+        filepath = os.path.join(tempdir, "simulation.blend")
+        bpy.ops.wm.save_as_mainfile(filepath=filepath)
+
+        start_time = time.time()
+        bpy.ops.object.simulation_nodes_cache_bake(selected=False)
+        bake_time = time.time() - start_time
+
+        bake_size = 0
+        for root, _, files in os.walk(tempdir):
+            for file in files:
+                if file.endswith(".blob"):
+                    bake_size += os.path.getsize(os.path.join(root, file))
+
+        # Reload so that all frames are read from disk.
+        bpy.ops.wm.save_mainfile()
+        bpy.ops.wm.open_mainfile(filepath=filepath)
+        scene = bpy.context.scene
+
+        start_time = time.time()
+        for frame in range(scene.frame_start, scene.frame_end + 1):
+            scene.frame_set(frame)
+        replay_time = time.time() - start_time
+
+    result = {'time': replay_time, 'bake_time': bake_time, 'bake_size': bake_size}
+    return result
+
+
+class GeometryNodesBakeTest(api.Test):
+    def __init__(self, name, use_compression, use_delta_positions):
+        self.name_ = name
+        self.use_compression = use_compression
+        self.use_delta_positions = use_delta_positions
+
+    def name(self):
+        return self.name_
+
+    def category(self):
+        return "geometry_nodes_bake"
+
+    def run(self, env, device_id):
+        args = {
+            'points': 2_000_000,
+            'frames': 50,
+            'use_compression': self.use_compression,
+            'use_delta_positions': self.use_delta_positions,
+        }
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    return [
+        GeometryNodesBakeTest("point_cloud_simulation", False, False),
+        GeometryNodesBakeTest("point_cloud_simulation_compressed", True, False),
+        GeometryNodesBakeTest("point_cloud_simulation_compressed_delta", True, True),
+    ]
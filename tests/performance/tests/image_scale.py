@@ -0,0 +1,76 @@
+# SPDX-FileCopyrightText: 2024 Blender Authors
+#
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
+
+    src_width, src_height = args['src_size']
+    dst_width, dst_height = args['dst_size']
+
+    # Scale a fresh image every iteration, scaling modifies the image in place.
+    elapsed_time = 0.0
+    for _ in range(args['iterations']):
+        image = bpy.data.images.new(
+            "scale",
+            src_width,
+            src_height,
+            alpha=True,
+            float_buffer=args['float_buffer'])
+        image.generated_type = 'COLOR_GRID'
+        # Make sure the buffer is generated before timing.
+        image.pixels[0]
+
+        start_time = time.time()
+        image.scale(dst_width, dst_height)
+        elapsed_time += time.time() - start_time
+
+        bpy.data.images.remove(image)
+
+    result = {'time': elapsed_time / args['iterations']}
+    return result
+
+
+class ImageScaleTest(api.Test):
+    def __init__(self, name, src_size, dst_size, float_buffer):
+        self.name_ = name
+        self.src_size = src_size
+        self.dst_size = dst_size
+        self.float_buffer = float_buffer
+
+    def name(self):
+        return self.name_
+
+    def category(self):
+        return "image_scale"
+
+    def run(self, env, device_id):
+        args = {
+            'src_size': self.src_size,
+            'dst_size': self.dst_size,
+            'float_buffer': self.float_buffer,
+            'iterations': 5,
+        }
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    size_4k = (3840, 2160)
+    size_8k = (7680, 4320)
+    size_preview = (960, 540)
+    tests = []
+    for float_buffer in (False, True):
+        suffix = "float" if float_buffer else "byte"
+        tests += [
+            ImageScaleTest("downscale_4k_preview_" + suffix, size_4k, size_preview, float_buffer),
+            ImageScaleTest("downscale_8k_4k_" + suffix, size_8k, size_4k, float_buffer),
+            ImageScaleTest("upscale_4k_8k_" + suffix, size_4k, size_8k, float_buffer),
+        ]
+    return tests